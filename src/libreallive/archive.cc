@@ -35,9 +35,11 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <cstring>
 #include <string>
 
+#include "libreallive/bytecode.h"
 #include "libreallive/compression.h"
 
 using boost::istarts_with;
@@ -47,7 +49,11 @@ namespace fs = boost::filesystem;
 namespace libreallive {
 
 Archive::Archive(const std::string& filename)
-    : name_(filename), info_(filename, Read), second_level_xor_key_(NULL) {
+    : name_(filename),
+      info_(filename, Read),
+      second_level_xor_key_(NULL),
+      blocking_scenario_loads_(0),
+      stop_parsing_(false) {
   ReadTOC();
   ReadOverrides();
 }
@@ -56,7 +62,9 @@ Archive::Archive(const std::string& filename, const std::string& regname)
     : name_(filename),
       info_(filename, Read),
       second_level_xor_key_(NULL),
-      regname_(regname) {
+      regname_(regname),
+      blocking_scenario_loads_(0),
+      stop_parsing_(false) {
   ReadTOC();
   ReadOverrides();
 
@@ -92,7 +100,7 @@ Archive::Archive(const std::string& filename, const std::string& regname)
   }
 }
 
-Archive::~Archive() {}
+Archive::~Archive() { StopBackgroundParsing(); }
 
 Scenario* Archive::GetScenario(int index) {
   accessed_t::const_iterator at = accessed_.find(index);
@@ -100,14 +108,50 @@ Scenario* Archive::GetScenario(int index) {
     return at->second.get();
   scenarios_t::const_iterator st = scenarios_.find(index);
   if (st != scenarios_.end()) {
-    Scenario* scene =
-        new Scenario(st->second, index, regname_, second_level_xor_key_);
+    bool blocked = true;
+    Scenario* scene = NULL;
+    if (!parse_threads_.empty())
+      scene = TakeBackgroundParsedScenario(index, &blocked);
+    if (!scene)
+      scene = ParseScenario(index);
+    if (blocked)
+      blocking_scenario_loads_++;
     accessed_[index].reset(scene);
+
+    if (!parse_threads_.empty())
+      PrioritizeCallees(*scene);
     return scene;
   }
   return NULL;
 }
 
+void Archive::StartBackgroundParsing(int thread_count) {
+  if (!parse_threads_.empty() || thread_count <= 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(parse_mutex_);
+    for (auto const& scenario : scenarios_) {
+      if (accessed_.find(scenario.first) == accessed_.end())
+        parse_queue_.push_back(scenario.first);
+    }
+  }
+
+  for (auto const& scenario : accessed_)
+    PrioritizeCallees(*scenario.second);
+
+  for (int i = 0; i < thread_count; ++i)
+    parse_threads_.emplace_back(&Archive::BackgroundParseLoop, this);
+}
+
+void Archive::WaitForBackgroundParsing() {
+  std::unique_lock<std::mutex> lock(parse_mutex_);
+  parse_finished_.wait(lock, [&] {
+    return parse_threads_.empty() ||
+           (parse_queue_.empty() && parse_in_progress_.empty());
+  });
+}
+
 int Archive::GetProbableEncodingType() const {
   // Directly create Header objects instead of Scenarios. We don't want to
   // parse the entire SEEN file here.
@@ -120,6 +164,121 @@ int Archive::GetProbableEncodingType() const {
   return 0;
 }
 
+Scenario* Archive::ParseScenario(int index) const {
+  scenarios_t::const_iterator st = scenarios_.find(index);
+  return new Scenario(st->second, index, regname_, second_level_xor_key_);
+}
+
+Scenario* Archive::TakeBackgroundParsedScenario(int index, bool* blocked) {
+  std::unique_lock<std::mutex> lock(parse_mutex_);
+
+  accessed_t::iterator it = background_parsed_.find(index);
+  if (it != background_parsed_.end()) {
+    *blocked = false;
+    Scenario* scene = it->second.release();
+    background_parsed_.erase(it);
+    return scene;
+  }
+
+  *blocked = true;
+
+  // If nobody has started on it yet, take it out of the queue so no thread
+  // wastes time building a scenario we're about to build ourselves.
+  auto queued = std::find(parse_queue_.begin(), parse_queue_.end(), index);
+  if (queued != parse_queue_.end()) {
+    parse_queue_.erase(queued);
+    return NULL;
+  }
+
+  parse_finished_.wait(lock, [&] {
+    return parse_in_progress_.find(index) == parse_in_progress_.end();
+  });
+
+  it = background_parsed_.find(index);
+  if (it == background_parsed_.end())
+    return NULL;
+
+  Scenario* scene = it->second.release();
+  background_parsed_.erase(it);
+  return scene;
+}
+
+void Archive::PrioritizeCallees(const Scenario& scenario) {
+  // Collect the scenario numbers that are constant arguments to jump (11),
+  // farcall (12) and farcall_with (18) in the Jmp (0:1) and Bra (0:6)
+  // modules. Anything computed at runtime is left to the numeric order.
+  std::vector<int> callees;
+  for (const BytecodeElement* element : scenario) {
+    const CommandElement* command =
+        dynamic_cast<const CommandElement*>(element);
+    if (!command || command->modtype() != 0 ||
+        (command->module() != 1 && command->module() != 6))
+      continue;
+    int opcode = command->opcode();
+    if (opcode != 11 && opcode != 12 && opcode != 18)
+      continue;
+    if (command->GetParamCount() == 0)
+      continue;
+
+    string param = command->GetParam(0);
+    if (param.size() == 6 && param[0] == '$' &&
+        static_cast<unsigned char>(param[1]) == 0xff) {
+      callees.push_back(read_i32(param.data() + 2));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(parse_mutex_);
+  for (auto callee = callees.rbegin(); callee != callees.rend(); ++callee) {
+    auto queued =
+        std::find(parse_queue_.begin(), parse_queue_.end(), *callee);
+    if (queued != parse_queue_.end()) {
+      parse_queue_.erase(queued);
+      parse_queue_.push_front(*callee);
+    }
+  }
+}
+
+void Archive::BackgroundParseLoop() {
+  std::unique_lock<std::mutex> lock(parse_mutex_);
+  while (true) {
+    parse_queue_changed_.wait(
+        lock, [&] { return stop_parsing_ || !parse_queue_.empty(); });
+    if (stop_parsing_)
+      return;
+
+    int index = parse_queue_.front();
+    parse_queue_.pop_front();
+    parse_in_progress_.insert(index);
+    lock.unlock();
+
+    // Failures are left for GetScenario() to rediscover on the main thread,
+    // where it can report them.
+    std::unique_ptr<Scenario> scene;
+    try {
+      scene.reset(ParseScenario(index));
+    } catch (...) {
+    }
+
+    lock.lock();
+    if (scene)
+      background_parsed_[index] = std::move(scene);
+    parse_in_progress_.erase(index);
+    parse_finished_.notify_all();
+  }
+}
+
+void Archive::StopBackgroundParsing() {
+  {
+    std::lock_guard<std::mutex> lock(parse_mutex_);
+    stop_parsing_ = true;
+  }
+  parse_queue_changed_.notify_all();
+
+  for (std::thread& thread : parse_threads_)
+    thread.join();
+  parse_threads_.clear();
+}
+
 void Archive::ReadTOC() {
   const char* idx = info_.get();
   for (int i = 0; i < 10000; ++i, idx += 8) {
@@ -34,9 +34,14 @@
 #ifndef SRC_LIBREALLIVE_ARCHIVE_H_
 #define SRC_LIBREALLIVE_ARCHIVE_H_
 
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "libreallive/defs.h"
@@ -67,6 +72,28 @@ class Archive {
   // Returns a specific scenario by |index| number or NULL if none exist.
   Scenario* GetScenario(int index);
 
+  // Starts |thread_count| background threads that decompress and parse every
+  // scenario that hasn't been asked for yet, so that GetScenario() usually
+  // finds its result already built. Scenarios that are the constant target of
+  // a jump or farcall in a scenario GetScenario() has returned are parsed
+  // first; everything else follows in numeric order. Opt-in; GetScenario()
+  // must still only be called from one thread.
+  void StartBackgroundParsing(int thread_count);
+
+  // Blocks until the background threads have worked through every scenario
+  // queued for them. Does nothing if background parsing was never started.
+  void WaitForBackgroundParsing();
+
+  // Number of GetScenario() calls that returned a scenario which wasn't
+  // already cached, and therefore had to parse it or wait for a background
+  // thread to finish parsing it.
+  int blocking_scenario_loads() const { return blocking_scenario_loads_; }
+
+  // Builds scenario |index|, which must exist, on the calling thread without
+  // caching it; the caller owns the result. Safe to call from several threads
+  // at once.
+  Scenario* ParseScenario(int index) const;
+
   // Does a quick pass through all scenarios in the archive, looking for any
   // with non-default encoding. This short circuits when it finds one.
   int GetProbableEncodingType() const;
@@ -79,6 +106,21 @@ class Archive {
 
   void ReadOverrides();
 
+  // Gets |index| from the background threads, waiting if one of them is
+  // working on it. Returns NULL if no thread has or will have it, in which
+  // case the caller has to parse it itself. Sets |blocked| unless the
+  // scenario was already finished.
+  Scenario* TakeBackgroundParsedScenario(int index, bool* blocked);
+
+  // Moves the scenarios |scenario| jumps or farcalls to to the front of the
+  // background parse queue.
+  void PrioritizeCallees(const Scenario& scenario);
+
+  // Body of each background thread.
+  void BackgroundParseLoop();
+
+  void StopBackgroundParsing();
+
   scenarios_t scenarios_;
   accessed_t accessed_;
   string name_;
@@ -94,6 +136,21 @@ class Archive {
   // The #REGNAME key from the Gameexe.ini file. Passed down to Scenario for
   // prettier error messages.
   std::string regname_;
+
+  int blocking_scenario_loads_;
+
+  // Background parsing state. The threads only touch the members below, and
+  // only while holding |parse_mutex_|; |accessed_| is only ever touched by
+  // the thread calling GetScenario(), which takes finished scenarios out of
+  // |background_parsed_|.
+  std::vector<std::thread> parse_threads_;
+  std::mutex parse_mutex_;
+  std::condition_variable parse_queue_changed_;
+  std::condition_variable parse_finished_;
+  std::deque<int> parse_queue_;
+  std::set<int> parse_in_progress_;
+  accessed_t background_parsed_;
+  bool stop_parsing_;
 };
 
 }  // namespace libreallive
@@ -33,7 +33,9 @@
 
 #include "libreallive/bytecode.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <exception>
 #include <iomanip>
@@ -51,6 +53,45 @@ namespace libreallive {
 
 namespace {
 
+// Size of the blocks of element storage in a BytecodeList. Each block is
+// twice the size of the last, so small scripts stay small.
+const size_t kMinBytecodeBlockSize = 1024;
+const size_t kMaxBytecodeBlockSize = 32 * 1024;
+
+// Every element is placed on this boundary.
+const size_t kBytecodeAlignment = alignof(std::max_align_t);
+
+// Constructs an element in the script being read, or on the heap for an
+// element read on its own.
+template <typename T, typename... Args>
+T* Construct(ConstructionData& cdata, Args&&... args) {
+  if (cdata.list)
+    return cdata.list->Construct<T>(std::forward<Args>(args)...);
+  return new T(std::forward<Args>(args)...);
+}
+
+CommandElement* ReadFunctionElement(const char* stream,
+                                    ConstructionData& cdata) {
+  const char* ptr = stream;
+  ptr += 8;
+  std::vector<boost::string_ref> params;
+  if (*ptr == '(') {
+    const char* end = ptr + 1;
+    while (*end != ')') {
+      const size_t len = NextData(end);
+      params.emplace_back(end, len);
+      end += len;
+    }
+  }
+
+  if (params.size() == 0)
+    return Construct<VoidFunctionElement>(cdata, stream);
+  else if (params.size() == 1)
+    return Construct<SingleArgFunctionElement>(cdata, stream, params.front());
+  else
+    return Construct<FunctionElement>(cdata, stream, params);
+}
+
 inline BytecodeElement* ReadFunction(const char* stream,
                                      ConstructionData& cdata) {
   // opcode: 0xttmmoooo (Type, Module, Opcode: e.g. 0x01030101 = 1:03:00257
@@ -63,7 +104,7 @@ inline BytecodeElement* ReadFunction(const char* stream,
     case 0x00050005:
     case 0x00060001:
     case 0x00060005:
-      return new GotoElement(stream, cdata);
+      return Construct<GotoElement>(cdata, stream, cdata);
     case 0x00010001:
     case 0x00010002:
     case 0x00010006:
@@ -75,24 +116,24 @@ inline BytecodeElement* ReadFunction(const char* stream,
     case 0x00060002:
     case 0x00060006:
     case 0x00060007:
-      return new GotoIfElement(stream, cdata);
+      return Construct<GotoIfElement>(cdata, stream, cdata);
     case 0x00010003:
     case 0x00010008:
     case 0x00050003:
     case 0x00050008:
     case 0x00060003:
     case 0x00060008:
-      return new GotoOnElement(stream, cdata);
+      return Construct<GotoOnElement>(cdata, stream, cdata);
     case 0x00010004:
     case 0x00010009:
     case 0x00050004:
     case 0x00050009:
     case 0x00060004:
     case 0x00060009:
-      return new GotoCaseElement(stream, cdata);
+      return Construct<GotoCaseElement>(cdata, stream, cdata);
     case 0x00010010:
     case 0x00060010:
-      return new GosubWithElement(stream, cdata);
+      return Construct<GosubWithElement>(cdata, stream, cdata);
 
     // Select elements.
     case 0x00020000:
@@ -100,10 +141,10 @@ inline BytecodeElement* ReadFunction(const char* stream,
     case 0x00020002:
     case 0x00020003:
     case 0x00020010:
-      return new SelectElement(stream);
+      return Construct<SelectElement>(cdata, stream);
   }
 
-  return BuildFunctionElement(stream);
+  return ReadFunctionElement(stream, cdata);
 }
 
 }  // namespace
@@ -111,24 +152,8 @@ inline BytecodeElement* ReadFunction(const char* stream,
 char BytecodeElement::entrypoint_marker = '@';
 
 CommandElement* BuildFunctionElement(const char* stream) {
-  const char* ptr = stream;
-  ptr += 8;
-  std::vector<std::string> params;
-  if (*ptr == '(') {
-    const char* end = ptr + 1;
-    while (*end != ')') {
-      const size_t len = NextData(end);
-      params.emplace_back(end, len);
-      end += len;
-    }
-  }
-
-  if (params.size() == 0)
-    return new VoidFunctionElement(stream);
-  else if (params.size() == 1)
-    return new SingleArgFunctionElement(stream, params.front());
-  else
-    return new FunctionElement(stream, params);
+  ConstructionData cdata(0);
+  return ReadFunctionElement(stream, cdata);
 }
 
 void PrintParameterString(std::ostream& oss,
@@ -159,8 +184,8 @@ void PrintParameterString(std::ostream& oss,
 // ConstructionData
 // -----------------------------------------------------------------------
 
-ConstructionData::ConstructionData(size_t kt, pointer_t pt)
-    : kidoku_table(kt), null(pt) {}
+ConstructionData::ConstructionData(size_t kt, BytecodeList* list)
+    : kidoku_table(kt), list(list) {}
 
 // -----------------------------------------------------------------------
 
@@ -186,6 +211,35 @@ void Pointers::SetPointers(ConstructionData& cdata) {
   target_ids.clear();
 }
 
+// -----------------------------------------------------------------------
+// BytecodeList
+// -----------------------------------------------------------------------
+
+BytecodeList::BytecodeList()
+    : block_size_(0), block_used_(0), allocated_bytes_(0) {}
+
+BytecodeList::~BytecodeList() {
+  for (BytecodeElement* element : elements_)
+    element->~BytecodeElement();
+}
+
+void* BytecodeList::Allocate(size_t size) {
+  size = (size + kBytecodeAlignment - 1) & ~(kBytecodeAlignment - 1);
+  if (block_used_ + size > block_size_) {
+    block_size_ = std::max(
+        size,
+        std::min(std::max(block_size_ * 2, kMinBytecodeBlockSize),
+                 kMaxBytecodeBlockSize));
+    block_used_ = 0;
+    blocks_.emplace_back(new char[block_size_]);
+  }
+
+  void* memory = blocks_.back().get() + block_used_;
+  block_used_ += size;
+  allocated_bytes_ += size;
+  return memory;
+}
+
 // -----------------------------------------------------------------------
 // BytecodeElement
 // -----------------------------------------------------------------------
@@ -223,18 +277,18 @@ BytecodeElement* BytecodeElement::Read(const char* stream,
   switch (c) {
     case 0:
     case ',':
-      return new CommaElement;
+      return Construct<CommaElement>(cdata);
     case '\n':
-      return new MetaElement(0, stream);
+      return Construct<MetaElement>(cdata, nullptr, stream);
     case '@':  // fall through
     case '!':
-      return new MetaElement(&cdata, stream);
+      return Construct<MetaElement>(cdata, &cdata, stream);
     case '$':
-      return new ExpressionElement(stream);
+      return Construct<ExpressionElement>(cdata, stream);
     case '#':
       return ReadFunction(stream, cdata);
     default:
-      return new TextoutElement(stream, end);
+      return Construct<TextoutElement>(cdata, stream, end);
   }
 }
 
@@ -322,7 +376,7 @@ TextoutElement::TextoutElement(const char* src, const char* file_end) {
     else
       ++end;
   }
-  repr.assign(src, end);
+  repr = boost::string_ref(src, end - src);
 }
 
 TextoutElement::~TextoutElement() {}
@@ -330,7 +384,7 @@ TextoutElement::~TextoutElement() {}
 const string TextoutElement::GetText() const {
   string rv;
   bool quoted = false;
-  string::const_iterator it = repr.cbegin();
+  boost::string_ref::const_iterator it = repr.cbegin();
   while (it != repr.cend()) {
     if (*it == '"') {
       ++it;
@@ -373,16 +427,19 @@ ExpressionElement::ExpressionElement(const char* src)
   const char* end = src;
   parsed_expression_ = GetAssignment(end);
   length_ = std::distance(src, end);
+  program_ = ExpressionProgram(parsed_expression_);
 }
 
 ExpressionElement::ExpressionElement(const long val)
     : length_(0),
-      parsed_expression_(ExpressionPiece::IntConstant(val)) {
+      parsed_expression_(ExpressionPiece::IntConstant(val)),
+      program_(parsed_expression_) {
 }
 
 ExpressionElement::ExpressionElement(const ExpressionElement& rhs)
     : length_(0),
-      parsed_expression_(rhs.parsed_expression_) {
+      parsed_expression_(rhs.parsed_expression_),
+      program_(rhs.program_) {
 }
 
 ExpressionElement::~ExpressionElement() {}
@@ -469,14 +526,13 @@ void CommandElement::RunOnMachine(RLMachine& machine) const {
 
 SelectElement::SelectElement(const char* src)
     : CommandElement(src), uselessjunk(0) {
-  repr.assign(src, 8);
-
+  const char* start = src;
   src += 8;
   if (*src == '(') {
     const int elen = NextExpression(src);
-    repr.append(src, elen);
     src += elen;
   }
+  repr = boost::string_ref(start, src - start);
 
   if (*src++ != '{')
     throw Error("SelectElement(): expected `{'");
@@ -550,8 +606,8 @@ SelectElement::SelectElement(const char* src)
 SelectElement::~SelectElement() {}
 
 ExpressionPiece SelectElement::GetWindowExpression() const {
-  if (repr[8] == '(') {
-    const char* location = repr.c_str() + 9;
+  if (repr.size() > 8 && repr[8] == '(') {
+    const char* location = repr.data() + 9;
     return GetExpression(location);
   }
   return ExpressionPiece::IntConstant(-1);
@@ -560,8 +616,8 @@ ExpressionPiece SelectElement::GetWindowExpression() const {
 const size_t SelectElement::GetParamCount() const { return params.size(); }
 
 string SelectElement::GetParam(int i) const {
-  string rv(params[i].cond_text);
-  rv.append(params[i].text);
+  string rv(params[i].cond_text.data(), params[i].cond_text.size());
+  rv.append(params[i].text.data(), params[i].text.size());
   return rv;
 }
 
@@ -577,8 +633,9 @@ const size_t SelectElement::GetBytecodeLength() const {
 // FunctionElement
 // -----------------------------------------------------------------------
 
-FunctionElement::FunctionElement(const char* src,
-                                 const std::vector<string>& params)
+FunctionElement::FunctionElement(
+    const char* src,
+    const std::vector<boost::string_ref>& params)
     : CommandElement(src), params(params) {}
 
 FunctionElement::~FunctionElement() {}
@@ -590,19 +647,19 @@ const size_t FunctionElement::GetParamCount() const {
   // dropping the parameter will put the stream cursor in the wrong place), so
   // hack this here.
   if (!params.empty()) {
-    string final = params.back();
+    const boost::string_ref& final = params.back();
     if (final.size() == 3 && final[0] == '\n')
       return params.size() - 1;
   }
   return params.size();
 }
 
-string FunctionElement::GetParam(int i) const { return params[i]; }
+string FunctionElement::GetParam(int i) const { return params[i].to_string(); }
 
 const size_t FunctionElement::GetBytecodeLength() const {
   if (params.size() > 0) {
     size_t rv(COMMAND_SIZE + 2);
-    for (std::string const& param : params)
+    for (boost::string_ref const& param : params)
       rv += param.size();
     return rv;
   } else {
@@ -616,8 +673,8 @@ std::string FunctionElement::GetSerializedCommand(RLMachine& machine) const {
     rv.push_back(command[i]);
   if (params.size() > 0) {
     rv.push_back('(');
-    for (string const& param : params) {
-      const char* data = param.c_str();
+    for (boost::string_ref const& param : params) {
+      const char* data = param.data();
       ExpressionPiece expression(GetData(data));
       rv.append(expression.GetSerializedExpression(machine));
     }
@@ -655,8 +712,9 @@ std::string VoidFunctionElement::GetSerializedCommand(RLMachine& machine)
 // SingleArgFunctionElement
 // -----------------------------------------------------------------------
 
-SingleArgFunctionElement::SingleArgFunctionElement(const char* src,
-                                                   const std::string& arg)
+SingleArgFunctionElement::SingleArgFunctionElement(
+    const char* src,
+    const boost::string_ref& arg)
     : CommandElement(src), arg_(arg) {}
 
 SingleArgFunctionElement::~SingleArgFunctionElement() {}
@@ -664,7 +722,7 @@ SingleArgFunctionElement::~SingleArgFunctionElement() {}
 const size_t SingleArgFunctionElement::GetParamCount() const { return 1; }
 
 string SingleArgFunctionElement::GetParam(int i) const {
-  return i == 0 ? arg_ : std::string();
+  return i == 0 ? arg_.to_string() : std::string();
 }
 
 const size_t SingleArgFunctionElement::GetBytecodeLength() const {
@@ -677,7 +735,7 @@ std::string SingleArgFunctionElement::GetSerializedCommand(RLMachine& machine)
   for (int i = 0; i < COMMAND_SIZE; ++i)
     rv.push_back(command[i]);
   rv.push_back('(');
-  const char* data = arg_.c_str();
+  const char* data = arg_.data();
   ExpressionPiece expression(GetData(data));
   rv.append(expression.GetSerializedExpression(machine));
   rv.push_back(')');
@@ -741,18 +799,16 @@ void GotoElement::SetPointers(ConstructionData& cdata) {
 
 GotoIfElement::GotoIfElement(const char* src, ConstructionData& cdata)
     : CommandElement(src) {
-  repr.assign(src, 8);
+  const char* start = src;
   src += 8;
 
   if (*src++ != '(')
     throw Error("GotoIfElement(): expected `('");
   int expr = NextExpression(src);
-  repr.push_back('(');
-  repr.append(src, expr);
-  repr.push_back(')');
   src += expr;
   if (*src++ != ')')
     throw Error("GotoIfElement(): expected `)'");
+  repr = boost::string_ref(start, src - start);
 
   id_ = read_i32(src);
 }
@@ -765,9 +821,10 @@ const size_t GotoIfElement::GetParamCount() const {
 }
 
 string GotoIfElement::GetParam(int i) const {
-  return i == 0
-             ? (repr.size() == 8 ? string() : repr.substr(9, repr.size() - 10))
-             : string();
+  return i == 0 ? (repr.size() == 8
+                        ? string()
+                        : repr.substr(9, repr.size() - 10).to_string())
+                : string();
 }
 
 const size_t GotoIfElement::GetPointersCount() const { return 1; }
@@ -793,12 +850,12 @@ void GotoIfElement::SetPointers(ConstructionData& cdata) {
 
 GotoCaseElement::GotoCaseElement(const char* src, ConstructionData& cdata)
     : PointerElement(src) {
-  repr.assign(src, 8);
+  const char* start = src;
   src += 8;
   // Condition
   const int expr = NextExpression(src);
-  repr.append(src, expr);
   src += expr;
+  repr = boost::string_ref(start, src - start);
   // Cases
   if (*src++ != '{')
     throw Error("GotoCaseElement(): expected `{'");
@@ -833,12 +890,14 @@ const size_t GotoCaseElement::GetParamCount() const {
 }
 
 string GotoCaseElement::GetParam(int i) const {
-  return i == 0 ? repr.substr(8, repr.size() - 8) : string();
+  return i == 0 ? repr.substr(8).to_string() : string();
 }
 
 const size_t GotoCaseElement::GetCaseCount() const { return cases.size(); }
 
-const string GotoCaseElement::GetCase(int i) const { return cases[i]; }
+const string GotoCaseElement::GetCase(int i) const {
+  return cases[i].to_string();
+}
 
 const size_t GotoCaseElement::GetBytecodeLength() const {
   size_t rv = repr.size() + 2;
@@ -853,12 +912,12 @@ const size_t GotoCaseElement::GetBytecodeLength() const {
 
 GotoOnElement::GotoOnElement(const char* src, ConstructionData& cdata)
     : PointerElement(src) {
-  repr.assign(src, 8);
+  const char* start = src;
   src += 8;
   // Condition
   const int expr = NextExpression(src);
-  repr.append(src, expr);
   src += expr;
+  repr = boost::string_ref(start, src - start);
   // Pointers
   if (*src++ != '{')
     throw Error("GotoOnElement(): expected `{'");
@@ -877,7 +936,7 @@ GotoOnElement::~GotoOnElement() {}
 const size_t GotoOnElement::GetParamCount() const { return 1; }
 
 string GotoOnElement::GetParam(int i) const {
-  return i == 0 ? repr.substr(8, repr.size() - 8) : string();
+  return i == 0 ? repr.substr(8).to_string() : string();
 }
 
 const size_t GotoOnElement::GetBytecodeLength() const {
@@ -916,7 +975,9 @@ const size_t GosubWithElement::GetParamCount() const {
   return params.size();
 }
 
-string GosubWithElement::GetParam(int i) const { return params[i]; }
+string GosubWithElement::GetParam(int i) const {
+  return params[i].to_string();
+}
 
 const size_t GosubWithElement::GetPointersCount() const { return 1; }
 
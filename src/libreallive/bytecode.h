@@ -34,33 +34,42 @@
 #ifndef SRC_LIBREALLIVE_BYTECODE_H_
 #define SRC_LIBREALLIVE_BYTECODE_H_
 
+#include <boost/utility/string_ref.hpp>
+
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "libreallive/bytecode_fwd.h"
 #include "libreallive/defs.h"
 #include "libreallive/expression.h"
+#include "libreallive/expression_program.h"
 
 class RLMachine;
+class RLOperation;
 
 namespace libreallive {
 
 class CommandElement;
 
-// Returns a representation of the non-special cased function.
+// Returns a representation of the non-special cased function. The element
+// refers to the parameter bytes in |stream|, which must outlive it.
 CommandElement* BuildFunctionElement(const char* stream);
 
 void PrintParameterString(std::ostream& oss,
                           const std::vector<std::string>& paramseters);
 
 struct ConstructionData {
-  ConstructionData(size_t kt, pointer_t pt);
+  // When |list| is NULL, elements are heap allocated and owned by the caller
+  // of BytecodeElement::Read().
+  explicit ConstructionData(size_t kt, BytecodeList* list = NULL);
   ~ConstructionData();
 
   std::vector<unsigned long> kidoku_table;
-  pointer_t null;
+  BytecodeList* list;
   typedef std::map<unsigned long, pointer_t> offsets_t;
   offsets_t offsets;
 };
@@ -120,7 +129,9 @@ class BytecodeElement {
   // Execute this bytecode instruction on this virtual machine
   virtual void RunOnMachine(RLMachine& machine) const;
 
-  // Read the next element from a stream.
+  // Read the next element from a stream. The element is appended to
+  // |cdata.list| if there is one. Elements refer to the text and parameter
+  // bytes in |stream| instead of copying them, so it must outlive them.
   static BytecodeElement* Read(const char* stream,
                                const char* end,
                                ConstructionData& cdata);
@@ -133,6 +144,49 @@ class BytecodeElement {
   friend class Script;
 };
 
+// The instructions of a Script as one contiguous array, indexed by
+// pointer_t. Instead of each element being its own heap allocation, the
+// elements are constructed in large blocks owned by the list.
+class BytecodeList {
+ public:
+  typedef std::vector<BytecodeElement*>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+  BytecodeList();
+  ~BytecodeList();
+
+  const_iterator begin() const { return elements_.cbegin(); }
+  const_iterator end() const { return elements_.cend(); }
+  size_t size() const { return elements_.size(); }
+  BytecodeElement* operator[](pointer_t i) const { return elements_[i]; }
+
+  // Constructs a T in the list's storage and appends it.
+  template <typename T, typename... Args>
+  T* Construct(Args&&... args) {
+    elements_.push_back(NULL);
+    try {
+      T* element = new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+      elements_.back() = element;
+      return element;
+    } catch (...) {
+      elements_.pop_back();
+      throw;
+    }
+  }
+
+  // Bytes of block storage handed out to elements.
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+ private:
+  void* Allocate(size_t size);
+
+  std::vector<BytecodeElement*> elements_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t block_size_;
+  size_t block_used_;
+  size_t allocated_bytes_;
+};
+
 class CommaElement : public BytecodeElement {
  public:
   CommaElement();
@@ -182,7 +236,7 @@ class TextoutElement : public BytecodeElement {
   virtual void RunOnMachine(RLMachine& machine) const final;
 
  private:
-  string repr;
+  boost::string_ref repr;
 };
 
 // Expression elements.
@@ -199,6 +253,10 @@ class ExpressionElement : public BytecodeElement {
   // Returns an ExpressionPiece representing this expression.
   const ExpressionPiece& ParsedExpression() const;
 
+  // Returns the expression compiled for the stack machine. Empty when the
+  // expression has to be evaluated through ParsedExpression().
+  const ExpressionProgram& CompiledExpression() const { return program_; }
+
   // Overridden from BytecodeElement:
   virtual void PrintSourceRepresentation(RLMachine* machine,
                                          std::ostream& oss) const final;
@@ -211,6 +269,8 @@ class ExpressionElement : public BytecodeElement {
   // Storage for the parsed expression so we only have to calculate
   // it once (and so we can return it by const reference)
   ExpressionPiece parsed_expression_;
+
+  ExpressionProgram program_;
 };
 
 // Command elements.
@@ -237,6 +297,18 @@ class CommandElement : public BytecodeElement {
   void SetParsedParameters(ExpressionPiecesVector p) const;
   const ExpressionPiecesVector& GetParsedParameters() const;
 
+  // Gets/Sets the RLOperation that last executed this command, so RLMachine
+  // can skip looking up the module and opcode. |generation| identifies the
+  // machine and its set of modules; the cached operation is only returned to
+  // the same generation that stored it.
+  RLOperation* GetCachedOperation(unsigned int generation) const {
+    return generation == cached_generation_ ? cached_operation_ : nullptr;
+  }
+  void SetCachedOperation(RLOperation* op, unsigned int generation) const {
+    cached_operation_ = op;
+    cached_generation_ = generation;
+  }
+
   // Returns the number of parameters.
   virtual const size_t GetParamCount() const = 0;
   virtual string GetParam(int index) const = 0;
@@ -259,6 +331,9 @@ class CommandElement : public BytecodeElement {
   unsigned char command[COMMAND_SIZE];
 
   mutable std::vector<ExpressionPiece> parsed_parameters_;
+
+  mutable RLOperation* cached_operation_ = nullptr;
+  mutable unsigned int cached_generation_ = 0;
 };
 
 class SelectElement : public CommandElement {
@@ -277,8 +352,8 @@ class SelectElement : public CommandElement {
 
   struct Param {
     std::vector<Condition> cond_parsed;
-    string cond_text;
-    string text;
+    boost::string_ref cond_text;
+    boost::string_ref text;
     int line;
     Param() : cond_text(), text(), line(0) {}
     Param(const char* tsrc, const size_t tlen, const int lnum)
@@ -308,7 +383,7 @@ class SelectElement : public CommandElement {
   virtual const size_t GetBytecodeLength() const final;
 
  private:
-  string repr;
+  boost::string_ref repr;
   params_t params;
   int firstline;
   int uselessjunk;
@@ -316,7 +391,8 @@ class SelectElement : public CommandElement {
 
 class FunctionElement : public CommandElement {
  public:
-  FunctionElement(const char* src, const std::vector<string>& params);
+  FunctionElement(const char* src,
+                  const std::vector<boost::string_ref>& params);
   virtual ~FunctionElement();
 
   // Overridden from CommandElement:
@@ -328,7 +404,7 @@ class FunctionElement : public CommandElement {
   virtual string GetSerializedCommand(RLMachine& machine) const final;
 
  private:
-  std::vector<string> params;
+  std::vector<boost::string_ref> params;
 };
 
 class VoidFunctionElement : public CommandElement {
@@ -348,7 +424,7 @@ class VoidFunctionElement : public CommandElement {
 class SingleArgFunctionElement : public CommandElement {
  public:
   SingleArgFunctionElement(const char* src,
-                           const std::string& arg);
+                           const boost::string_ref& arg);
   virtual ~SingleArgFunctionElement();
 
   // Overridden from CommandElement:
@@ -360,7 +436,7 @@ class SingleArgFunctionElement : public CommandElement {
   virtual string GetSerializedCommand(RLMachine& machine) const final;
 
  private:
-  std::string arg_;
+  boost::string_ref arg_;
 };
 
 class PointerElement : public CommandElement {
@@ -417,7 +493,7 @@ class GotoIfElement : public CommandElement {
  private:
   unsigned long id_;
   pointer_t pointer_;
-  string repr;
+  boost::string_ref repr;
 };
 
 class GotoCaseElement : public PointerElement {
@@ -435,8 +511,8 @@ class GotoCaseElement : public PointerElement {
   virtual const size_t GetBytecodeLength() const final;
 
  private:
-  string repr;
-  std::vector<string> cases;
+  boost::string_ref repr;
+  std::vector<boost::string_ref> cases;
 };
 
 class GotoOnElement : public PointerElement {
@@ -452,7 +528,7 @@ class GotoOnElement : public PointerElement {
   virtual const size_t GetBytecodeLength() const final;
 
  private:
-  string repr;
+  boost::string_ref repr;
 };
 
 class GosubWithElement : public CommandElement {
@@ -474,7 +550,7 @@ class GosubWithElement : public CommandElement {
   unsigned long id_;
   pointer_t pointer_;
   int repr_size;
-  std::vector<string> params;
+  std::vector<boost::string_ref> params;
 };
 
 }  // namespace libreallive
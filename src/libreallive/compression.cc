@@ -33,6 +33,15 @@
 
 #include "libreallive/compression.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <string>
 
 namespace libreallive {
@@ -40,7 +49,7 @@ namespace compression {
 
 /* RealLive uses a rather basic XOR encryption scheme, to which this
  * is the key. */
-static char xor_mask[256] = {
+const char xor_mask[256] = {
     0x8b, 0xe5, 0x5d, 0xc3, 0xa1, 0xe0, 0x30, 0x44, 0x00, 0x85, 0xc0, 0x74,
     0x09, 0x5f, 0x5e, 0x33, 0xc0, 0x5b, 0x8b, 0xe5, 0x5d, 0xc3, 0x8b, 0x45,
     0x0c, 0x85, 0xc0, 0x75, 0x14, 0x8b, 0x55, 0xec, 0x83, 0xc2, 0x20, 0x52,
@@ -114,12 +123,149 @@ const XorKey kud_wafter_all_ages_xor_mask[] = {
 
 // -----------------------------------------------------------------------
 
+namespace {
+
+// A back reference stores its distance in twelve bits, so nothing more than
+// this many bytes behind the output cursor can ever be read again.
+const size_t kMaxBackReference = 4095;
+
+// Undoes the first level xor over |len| bytes of |src|. The mask repeats every
+// 256 bytes of the compressed stream, starting from the very first byte of
+// the block, so the whole block can be stripped up front instead of per
+// token.
+void StripXorMask(const unsigned char* src, unsigned char* dst, size_t len) {
+  const unsigned char* mask =
+      reinterpret_cast<const unsigned char*>(xor_mask);
+  size_t i = 0;
+  while (i < len) {
+    size_t run = std::min(len - i, size_t(256));
+    size_t j = 0;
+#if defined(__SSE2__)
+    for (; j + 16 <= run; j += 16) {
+      __m128i data =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + j));
+      __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + j));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + j),
+                       _mm_xor_si128(data, key));
+    }
+#endif
+    for (; j + 8 <= run; j += 8) {
+      uint64_t data, key;
+      memcpy(&data, src + i + j, 8);
+      memcpy(&key, mask + j, 8);
+      data ^= key;
+      memcpy(dst + i + j, &data, 8);
+    }
+    for (; j < run; ++j)
+      dst[i + j] = src[i + j] ^ mask[j];
+    i += run;
+  }
+}
+
+// Applies one second level |key| to the output buffer.
+void ApplyXorKey(const XorKey& key, char* dst, size_t dst_len) {
+  if (key.xor_offset < 0 || size_t(key.xor_offset) >= dst_len)
+    return;
+  char* out = dst + key.xor_offset;
+  size_t length = std::min(size_t(key.xor_length), dst_len - key.xor_offset);
+  for (size_t i = 0; i < length; ++i)
+    out[i] ^= key.xor_key[i & 0x0f];
+}
+
+// Copies a back reference. Most references are far enough behind the cursor
+// that the source and destination don't overlap and can be moved in one go;
+// the rest are run-length style repeats that have to go byte by byte.
+inline void CopyBackReference(char* dst, size_t distance, size_t count) {
+  const char* from = dst - distance;
+  if (distance >= count) {
+    memcpy(dst, from, count);
+  } else {
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = from[i];
+  }
+}
+
+}  // namespace
+
 // Decompress an archived file.
+//
+// The stream is a sequence of groups: one flag byte followed by eight tokens,
+// where a set bit is a literal byte and a clear bit is a two byte back
+// reference. The whole input is un-xored in one vectorized pass first, whole
+// groups of literals are copied in one go, and the per game second level key
+// ranges are applied as soon as the decoder has moved far enough past them
+// that no back reference can see the pre-key bytes.
 void Decompress(const char* src,
                 size_t src_len,
                 char* dst,
                 size_t dst_len,
                 const XorKey* per_game_xor_key) {
+  if (src_len <= 8)
+    return;
+
+  std::unique_ptr<unsigned char[]> plain(new unsigned char[src_len]);
+  StripXorMask(reinterpret_cast<const unsigned char*>(src), plain.get(),
+               src_len);
+
+  const unsigned char* in = plain.get() + 8;
+  const unsigned char* in_end = plain.get() + src_len;
+  char* out = dst;
+  char* out_end = dst + dst_len;
+
+  // Key ranges whose xor hasn't been applied yet, in table order.
+  const XorKey* pending_key = per_game_xor_key;
+  if (pending_key && pending_key->xor_offset == -1)
+    pending_key = NULL;
+
+  while (in < in_end && out < out_end) {
+    unsigned int flag = *in++;
+
+    if (flag == 0xff && in_end - in >= 8 && out_end - out >= 8) {
+      memcpy(out, in, 8);
+      in += 8;
+      out += 8;
+    } else {
+      for (int bit = 0; bit < 8 && in < in_end && out < out_end;
+           ++bit, flag >>= 1) {
+        if (flag & 1) {
+          *out++ = *in++;
+        } else {
+          if (in_end - in < 2)
+            throw Error("corrupt data");
+          unsigned int token = in[0] | (in[1] << 8);
+          in += 2;
+
+          size_t distance = token >> 4;
+          size_t count = (token & 0x0f) + 2;
+          if (distance == 0 || distance > size_t(out - dst))
+            throw Error("corrupt data");
+          count = std::min(count, size_t(out_end - out));
+          CopyBackReference(out, distance, count);
+          out += count;
+        }
+      }
+    }
+
+    while (pending_key &&
+           size_t(out - dst) >= size_t(pending_key->xor_offset) +
+                                    pending_key->xor_length +
+                                    kMaxBackReference) {
+      ApplyXorKey(*pending_key, dst, dst_len);
+      ++pending_key;
+      if (pending_key->xor_offset == -1)
+        pending_key = NULL;
+    }
+  }
+
+  for (; pending_key && pending_key->xor_offset != -1; ++pending_key)
+    ApplyXorKey(*pending_key, dst, dst_len);
+}
+
+void ReferenceDecompress(const char* src,
+                         size_t src_len,
+                         char* dst,
+                         size_t dst_len,
+                         const XorKey* per_game_xor_key) {
   int bit = 1;
   const char* srcend = src + src_len;
   char* dststart = dst;
@@ -36,6 +36,9 @@
 namespace libreallive {
 namespace compression {
 
+// The key every compressed bytecode block is xored with before decoding.
+extern const char xor_mask[256];
+
 // An individual xor key; some games use multiple ones.
 struct XorKey {
   char xor_key[16];
@@ -52,9 +55,17 @@ extern const XorKey snow_standard_edition_xor_mask[];
 extern const XorKey kud_wafter_xor_mask[];
 extern const XorKey kud_wafter_all_ages_xor_mask[];
 
+// Decompresses a scenario's bytecode block, applying the per game key (if
+// any) to the output.
 void Decompress(const char* src, size_t src_len, char* dst, size_t dst_len,
                 const XorKey* per_game_xor_key);
 
+// The original bit-at-a-time decoder. Produces exactly the same output as
+// Decompress() and is kept so the tests and benchmarks have something to
+// check the fast path against.
+void ReferenceDecompress(const char* src, size_t src_len, char* dst,
+                         size_t dst_len, const XorKey* per_game_xor_key);
+
 }  // namespace compression
 }  // namespace libreallive
 
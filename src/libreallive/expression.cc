@@ -43,6 +43,7 @@
 #include <string>
 
 #include "libreallive/defs.h"
+#include "libreallive/expression_program.h"
 #include "libreallive/intmemref.h"
 #include "machine/reference.h"
 #include "machine/rlmachine.h"
@@ -656,7 +657,7 @@ ExpressionPiece::ExpressionPiece(invalid_expression_piece_t)
 }
 
 ExpressionPiece::ExpressionPiece(const ExpressionPiece& rhs)
-    : piece_type(rhs.piece_type) {
+    : piece_type(rhs.piece_type), compiled_program(rhs.compiled_program) {
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
       break;
@@ -707,7 +708,8 @@ ExpressionPiece::ExpressionPiece(const ExpressionPiece& rhs)
 }
 
 ExpressionPiece::ExpressionPiece(ExpressionPiece&& rhs)
-    : piece_type(rhs.piece_type) {
+    : piece_type(rhs.piece_type),
+      compiled_program(std::move(rhs.compiled_program)) {
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
       break;
@@ -767,6 +769,7 @@ ExpressionPiece& ExpressionPiece::operator=(const ExpressionPiece& rhs) {
   Invalidate();
 
   piece_type = rhs.piece_type;
+  compiled_program = rhs.compiled_program;
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
       break;
@@ -822,6 +825,7 @@ ExpressionPiece& ExpressionPiece::operator=(ExpressionPiece&& rhs) {
   Invalidate();
 
   piece_type = rhs.piece_type;
+  compiled_program = std::move(rhs.compiled_program);
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
       break;
@@ -933,6 +937,9 @@ void ExpressionPiece::SetIntegerValue(RLMachine& machine, int rvalue) {
 }
 
 int ExpressionPiece::GetIntegerValue(RLMachine& machine) const {
+  if (compiled_program)
+    return compiled_program->Evaluate(machine);
+
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
       return machine.store_register();
@@ -983,6 +990,33 @@ int ExpressionPiece::GetIntegerValue(RLMachine& machine) const {
   }
 }
 
+void ExpressionPiece::CompileIntegerValue() {
+  switch (piece_type) {
+    case TYPE_MEMORY_REFERENCE:
+    case TYPE_UNIARY_EXPRESSION:
+    case TYPE_BINARY_EXPRESSION: {
+      if (compiled_program ||
+          GetExpressionValueType() != ValueTypeInteger)
+        break;
+
+      auto program = std::make_shared<ExpressionProgram>(*this);
+      if (!program->empty())
+        compiled_program = std::move(program);
+      break;
+    }
+    case TYPE_COMPLEX_EXPRESSION:
+      for (ExpressionPiece& piece : complex_expression)
+        piece.CompileIntegerValue();
+      break;
+    case TYPE_SPECIAL_EXPRESSION:
+      for (ExpressionPiece& piece : special_expression.pieces)
+        piece.CompileIntegerValue();
+      break;
+    default:
+      break;
+  }
+}
+
 void ExpressionPiece::SetStringValue(RLMachine& machine,
                                      const std::string& rvalue) {
   switch (piece_type) {
@@ -1166,6 +1200,8 @@ void ExpressionPiece::Invalidate() {
   using string_type = std::string;
   using vec_type = std::vector<ExpressionPiece>;
 
+  compiled_program.reset();
+
   switch (piece_type) {
     case TYPE_STORE_REGISTER:
     case TYPE_INT_CONSTANT:
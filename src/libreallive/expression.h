@@ -53,6 +53,7 @@ size_t NextData(const char* src);
 
 // Parse expression functions
 class ExpressionPiece;
+class ExpressionProgram;
 ExpressionPiece GetExpressionToken(const char*& src);
 ExpressionPiece GetExpressionTerm(const char*& src);
 ExpressionPiece GetExpressionArithmatic(const char*& src);
@@ -146,6 +147,13 @@ class ExpressionPiece {
   // a memory access or a calculation based on some subexpressions.
   int GetIntegerValue(RLMachine& machine) const;
 
+  // Flattens an integer expression into an ExpressionProgram that
+  // GetIntegerValue() evaluates instead of walking the tree. Called once on
+  // parsed opcode parameters; constants and simple references are already
+  // cheap and are left alone. Complex and special parameters compile each of
+  // their contained pieces.
+  void CompileIntegerValue();
+
   void SetStringValue(RLMachine& machine, const std::string& rvalue);
   const std::string& GetStringValue(RLMachine& machine) const;
 
@@ -173,6 +181,8 @@ class ExpressionPiece {
   int GetOverloadTag() const;
 
  private:
+  friend class ExpressionProgram;
+
   ExpressionPiece();
 
   // Frees all possible memory and sets |piece_type| to TYPE_INVALID.
@@ -197,6 +207,10 @@ class ExpressionPiece {
 
   ExpressionPieceType piece_type;
 
+  // Set by CompileIntegerValue(). Programs are immutable, so copies of this
+  // piece share it.
+  std::shared_ptr<const ExpressionProgram> compiled_program;
+
   union {
     // TYPE_INT_CONSTANT
     int int_constant;
@@ -0,0 +1,443 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of libreallive, a dependency of RLVM.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (c) 2026 The rlvm contributors
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// -----------------------------------------------------------------------
+
+#include "libreallive/expression_program.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "libreallive/expression.h"
+#include "libreallive/intmemref.h"
+#include "machine/rlmachine.h"
+
+namespace libreallive {
+
+namespace {
+
+// Evaluate() keeps its stack in a fixed array of this many values. Anything
+// that needs more is left to the tree walk.
+const int kMaxStackDepth = 32;
+
+// The instruction set. Operands follow the opcode word; the comments give the
+// operands and the effect on the stack.
+enum Opcode {
+  OP_CONSTANT,           // value: push value
+  OP_STORE_REGISTER,     // push the store register
+  OP_LOAD,               // bank, type, location: push memory
+  OP_LOAD_INDIRECT,      // bank, type: replace location with memory
+  OP_NEGATE,             // negate top
+
+  // Binary operators: pop rhs, replace lhs with the result.
+  OP_ADD,
+  OP_SUBTRACT,
+  OP_MULTIPLY,
+  OP_DIVIDE,
+  OP_MODULO,
+  OP_AND,
+  OP_OR,
+  OP_XOR,
+  OP_SHIFT_LEFT,
+  OP_SHIFT_RIGHT,
+  OP_EQUAL,
+  OP_NOT_EQUAL,
+  OP_LESS_OR_EQUAL,
+  OP_LESS,
+  OP_GREATER_OR_EQUAL,
+  OP_GREATER,
+  OP_LOGICAL_AND,
+  OP_LOGICAL_OR,
+
+  OP_SET_STORE_REGISTER,  // store register = top
+  OP_STORE,               // bank, type, location: memory = top
+  OP_STORE_INDIRECT,      // bank, type: pop location, memory = top
+  OP_ASSIGN               // bank, type, location, value: memory = value,
+                          // push value
+};
+
+// Number of operand words following each opcode.
+int OperandCount(int32_t opcode) {
+  switch (opcode) {
+    case OP_CONSTANT:
+      return 1;
+    case OP_LOAD_INDIRECT:
+    case OP_STORE_INDIRECT:
+      return 2;
+    case OP_LOAD:
+    case OP_STORE:
+      return 3;
+    case OP_ASSIGN:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// How each opcode changes the depth of the stack.
+int StackEffect(int32_t opcode) {
+  switch (opcode) {
+    case OP_CONSTANT:
+    case OP_STORE_REGISTER:
+    case OP_LOAD:
+    case OP_ASSIGN:
+      return 1;
+    case OP_LOAD_INDIRECT:
+    case OP_NEGATE:
+    case OP_SET_STORE_REGISTER:
+    case OP_STORE:
+      return 0;
+    default:
+      // Binary operators and OP_STORE_INDIRECT.
+      return -1;
+  }
+}
+
+// Maps a RealLive operator (as stored in ExpressionPiece) to its opcode. The
+// compound assignment operators 20-29 share the opcodes of 0-9. Returns -1
+// for anything else.
+int OperatorOpcode(int operation) {
+  if (operation >= 0 && operation <= 9)
+    return OP_ADD + operation;
+  if (operation >= 20 && operation <= 29)
+    return OP_ADD + operation - 20;
+  if (operation >= 40 && operation <= 45)
+    return OP_EQUAL + operation - 40;
+  if (operation == 60)
+    return OP_LOGICAL_AND;
+  if (operation == 61)
+    return OP_LOGICAL_OR;
+  return -1;
+}
+
+// Returns true if the code from |start| to the end of |code| is a single
+// constant.
+bool IsConstantAt(const std::vector<int32_t>& code, size_t start) {
+  return code.size() - start == 2 && code[start] == OP_CONSTANT;
+}
+
+// Appends a memory operation on |ref|'s bank and access type.
+void EmitMemoryOperation(Opcode opcode,
+                         const IntMemRef& ref,
+                         std::vector<int32_t>& code) {
+  code.push_back(opcode);
+  code.push_back(ref.bank());
+  code.push_back(ref.type());
+}
+
+}  // namespace
+
+ExpressionProgram::ExpressionProgram() : length_(0) {}
+
+ExpressionProgram::ExpressionProgram(const ExpressionPiece& piece)
+    : length_(0) {
+  Code code;
+  if (!Compile(piece, code))
+    return;
+
+  int depth = 0;
+  for (size_t i = 0; i < code.size(); i += 1 + OperandCount(code[i])) {
+    depth += StackEffect(code[i]);
+    if (depth > kMaxStackDepth)
+      return;
+  }
+
+  code_.reset(new int32_t[code.size()]);
+  std::copy(code.begin(), code.end(), code_.get());
+  length_ = code.size();
+}
+
+ExpressionProgram::ExpressionProgram(const ExpressionProgram& rhs)
+    : length_(0) {
+  *this = rhs;
+}
+
+ExpressionProgram::~ExpressionProgram() {}
+
+ExpressionProgram& ExpressionProgram::operator=(const ExpressionProgram& rhs) {
+  if (this != &rhs) {
+    code_.reset(rhs.length_ ? new int32_t[rhs.length_] : NULL);
+    if (rhs.length_)
+      memcpy(code_.get(), rhs.code_.get(), rhs.length_ * sizeof(int32_t));
+    length_ = rhs.length_;
+  }
+  return *this;
+}
+
+bool ExpressionProgram::IsConstant() const {
+  return length_ == 2 && code_[0] == OP_CONSTANT;
+}
+
+int ExpressionProgram::Evaluate(RLMachine& machine) const {
+  int stack[kMaxStackDepth];
+  int* top = stack;
+  const int32_t* pc = code_.get();
+  const int32_t* end = pc + length_;
+  while (pc != end) {
+    switch (*pc++) {
+      case OP_CONSTANT:
+        *top++ = *pc++;
+        break;
+      case OP_STORE_REGISTER:
+        *top++ = machine.store_register();
+        break;
+      case OP_LOAD:
+        *top++ = machine.GetIntValue(IntMemRef(pc[0], pc[1], pc[2]));
+        pc += 3;
+        break;
+      case OP_LOAD_INDIRECT:
+        top[-1] = machine.GetIntValue(IntMemRef(pc[0], pc[1], top[-1]));
+        pc += 2;
+        break;
+      case OP_NEGATE:
+        top[-1] = -top[-1];
+        break;
+      case OP_ADD:
+        --top;
+        top[-1] = top[-1] + top[0];
+        break;
+      case OP_SUBTRACT:
+        --top;
+        top[-1] = top[-1] - top[0];
+        break;
+      case OP_MULTIPLY:
+        --top;
+        top[-1] = top[-1] * top[0];
+        break;
+      case OP_DIVIDE:
+        --top;
+        if (top[0] != 0)
+          top[-1] = top[-1] / top[0];
+        break;
+      case OP_MODULO:
+        --top;
+        if (top[0] != 0)
+          top[-1] = top[-1] % top[0];
+        break;
+      case OP_AND:
+        --top;
+        top[-1] = top[-1] & top[0];
+        break;
+      case OP_OR:
+        --top;
+        top[-1] = top[-1] | top[0];
+        break;
+      case OP_XOR:
+        --top;
+        top[-1] = top[-1] ^ top[0];
+        break;
+      case OP_SHIFT_LEFT:
+        --top;
+        top[-1] = top[-1] << top[0];
+        break;
+      case OP_SHIFT_RIGHT:
+        --top;
+        top[-1] = top[-1] >> top[0];
+        break;
+      case OP_EQUAL:
+        --top;
+        top[-1] = top[-1] == top[0];
+        break;
+      case OP_NOT_EQUAL:
+        --top;
+        top[-1] = top[-1] != top[0];
+        break;
+      case OP_LESS_OR_EQUAL:
+        --top;
+        top[-1] = top[-1] <= top[0];
+        break;
+      case OP_LESS:
+        --top;
+        top[-1] = top[-1] < top[0];
+        break;
+      case OP_GREATER_OR_EQUAL:
+        --top;
+        top[-1] = top[-1] >= top[0];
+        break;
+      case OP_GREATER:
+        --top;
+        top[-1] = top[-1] > top[0];
+        break;
+      case OP_LOGICAL_AND:
+        // Both sides have already been evaluated; RealLive doesn't short
+        // circuit.
+        --top;
+        top[-1] = top[-1] && top[0];
+        break;
+      case OP_LOGICAL_OR:
+        --top;
+        top[-1] = top[-1] || top[0];
+        break;
+      case OP_SET_STORE_REGISTER:
+        machine.set_store_register(top[-1]);
+        break;
+      case OP_STORE:
+        machine.SetIntValue(IntMemRef(pc[0], pc[1], pc[2]), top[-1]);
+        pc += 3;
+        break;
+      case OP_STORE_INDIRECT:
+        --top;
+        machine.SetIntValue(IntMemRef(pc[0], pc[1], top[0]), top[-1]);
+        pc += 2;
+        break;
+      case OP_ASSIGN:
+        machine.SetIntValue(IntMemRef(pc[0], pc[1], pc[2]), pc[3]);
+        *top++ = pc[3];
+        pc += 4;
+        break;
+    }
+  }
+
+  return top[-1];
+}
+
+// static
+bool ExpressionProgram::Compile(const ExpressionPiece& piece, Code& code) {
+  switch (piece.piece_type) {
+    case TYPE_STORE_REGISTER:
+      code.push_back(OP_STORE_REGISTER);
+      return true;
+    case TYPE_INT_CONSTANT:
+      code.push_back(OP_CONSTANT);
+      code.push_back(piece.int_constant);
+      return true;
+    case TYPE_SIMPLE_MEMORY_REFERENCE:
+      EmitMemoryOperation(OP_LOAD,
+                          IntMemRef(piece.simple_mem_reference.type, 0),
+                          code);
+      code.push_back(piece.simple_mem_reference.location);
+      return true;
+    case TYPE_MEMORY_REFERENCE:
+      if (!Compile(*piece.mem_reference.location, code))
+        return false;
+      EmitMemoryOperation(OP_LOAD_INDIRECT,
+                          IntMemRef(piece.mem_reference.type, 0),
+                          code);
+      return true;
+    case TYPE_UNIARY_EXPRESSION: {
+      size_t start = code.size();
+      if (!Compile(*piece.uniary_expression.operand, code))
+        return false;
+      // Every operator but negation leaves the operand as is.
+      if (piece.uniary_expression.operation == 0x01) {
+        if (IsConstantAt(code, start))
+          code[start + 1] = -code[start + 1];
+        else
+          code.push_back(OP_NEGATE);
+      }
+      return true;
+    }
+    case TYPE_BINARY_EXPRESSION: {
+      const char operation = piece.binary_expression.operation;
+      const ExpressionPiece& lhs = *piece.binary_expression.left_operand;
+      const ExpressionPiece& rhs = *piece.binary_expression.right_operand;
+      if (operation == 30) {
+        // Like GetIntegerValue(), evaluate the value before the location it
+        // is stored to.
+        return Compile(rhs, code) && CompileStore(lhs, code);
+      }
+
+      size_t lhs_start = code.size();
+      if (!Compile(lhs, code))
+        return false;
+      size_t rhs_start = code.size();
+      if (!Compile(rhs, code))
+        return false;
+      if (!CompileOperator(operation, lhs_start, rhs_start, code))
+        return false;
+      if (operation >= 20 && operation < 30)
+        return CompileStore(lhs, code);
+      return true;
+    }
+    case TYPE_SIMPLE_ASSIGNMENT: {
+      EmitMemoryOperation(OP_ASSIGN,
+                          IntMemRef(piece.simple_assignment.type, 0),
+                          code);
+      code.push_back(piece.simple_assignment.location);
+      code.push_back(piece.simple_assignment.value);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// static
+bool ExpressionProgram::CompileStore(const ExpressionPiece& lvalue,
+                                     Code& code) {
+  switch (lvalue.piece_type) {
+    case TYPE_STORE_REGISTER:
+      code.push_back(OP_SET_STORE_REGISTER);
+      return true;
+    case TYPE_SIMPLE_MEMORY_REFERENCE:
+      EmitMemoryOperation(OP_STORE,
+                          IntMemRef(lvalue.simple_mem_reference.type, 0),
+                          code);
+      code.push_back(lvalue.simple_mem_reference.location);
+      return true;
+    case TYPE_MEMORY_REFERENCE:
+      // SetIntegerValue() evaluates the location again, after the value.
+      if (!Compile(*lvalue.mem_reference.location, code))
+        return false;
+      EmitMemoryOperation(OP_STORE_INDIRECT,
+                          IntMemRef(lvalue.mem_reference.type, 0),
+                          code);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// static
+bool ExpressionProgram::CompileOperator(char operation,
+                                        size_t lhs_start,
+                                        size_t rhs_start,
+                                        Code& code) {
+  int opcode = OperatorOpcode(operation);
+  if (opcode < 0)
+    return false;
+
+  const bool assignment = operation >= 20 && operation <= 30;
+  if (!assignment && IsConstantAt(code, rhs_start) &&
+      rhs_start - lhs_start == 2 && code[lhs_start] == OP_CONSTANT) {
+    int value = ExpressionPiece::PerformBinaryOperationOn(
+        operation, code[lhs_start + 1], code[rhs_start + 1]);
+    code.resize(lhs_start);
+    code.push_back(OP_CONSTANT);
+    code.push_back(value);
+    return true;
+  }
+
+  code.push_back(opcode);
+  return true;
+}
+
+}  // namespace libreallive
@@ -0,0 +1,101 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of libreallive, a dependency of RLVM.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (c) 2026 The rlvm contributors
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// -----------------------------------------------------------------------
+
+#ifndef SRC_LIBREALLIVE_EXPRESSION_PROGRAM_H_
+#define SRC_LIBREALLIVE_EXPRESSION_PROGRAM_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class RLMachine;
+
+namespace libreallive {
+
+class ExpressionPiece;
+
+// An integer ExpressionPiece flattened into a postfix program for a small
+// stack machine. The tree walk in ExpressionPiece::GetIntegerValue() chases a
+// heap pointer and switches on the operator character for every node; a
+// program is one array of words evaluated in a single loop, with constant
+// subexpressions already folded.
+//
+// Evaluate() has exactly the side effects of GetIntegerValue() on the piece
+// it was compiled from, in the same order. Pieces that can't be compiled
+// (strings, complex and special parameters, unknown operators, or anything
+// that would need a deeper stack than Evaluate() keeps) produce an empty
+// program, and callers should fall back to the tree.
+class ExpressionProgram {
+ public:
+  ExpressionProgram();
+  explicit ExpressionProgram(const ExpressionPiece& piece);
+  ExpressionProgram(const ExpressionProgram& rhs);
+  ~ExpressionProgram();
+
+  ExpressionProgram& operator=(const ExpressionProgram& rhs);
+
+  bool empty() const { return length_ == 0; }
+
+  // Number of words in the program.
+  size_t size() const { return length_; }
+
+  // Returns true when the whole program is a single constant.
+  bool IsConstant() const;
+
+  int Evaluate(RLMachine& machine) const;
+
+ private:
+  typedef std::vector<int32_t> Code;
+
+  // Appends the code for |piece| to |code|. Returns false if |piece| can't
+  // be compiled.
+  static bool Compile(const ExpressionPiece& piece, Code& code);
+
+  // Appends the code that stores the value on top of the stack into
+  // |lvalue|, leaving the value on the stack.
+  static bool CompileStore(const ExpressionPiece& lvalue, Code& code);
+
+  // Appends the binary |operation| on the operands compiled at |lhs_start|
+  // and |rhs_start|, folding it into a constant when both are constants.
+  static bool CompileOperator(char operation,
+                              size_t lhs_start,
+                              size_t rhs_start,
+                              Code& code);
+
+  std::unique_ptr<int32_t[]> code_;
+  size_t length_;
+};
+
+}  // namespace libreallive
+
+#endif  // SRC_LIBREALLIVE_EXPRESSION_PROGRAM_H_
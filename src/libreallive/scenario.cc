@@ -117,7 +117,7 @@ Script::Script(const Header& hdr,
   // Kidoku/entrypoint table
   const int kidoku_offs = read_i32(data + 0x08);
   const size_t kidoku_length = read_i32(data + 0x0c);
-  ConstructionData cdat(kidoku_length, elts_.end());
+  ConstructionData cdat(kidoku_length, &elts_);
   for (size_t i = 0; i < kidoku_length; ++i)
     cdat.kidoku_table[i] = read_i32(data + kidoku_offs + i * 4);
 
@@ -140,29 +140,29 @@ Script::Script(const Header& hdr,
     }
   }
 
-  char* uncompressed = new char[dlen];
+  bytecode_.reset(new char[dlen]);
   compression::Decompress(data + read_i32(data + 0x20),
                           read_i32(data + 0x28),
-                          uncompressed,
+                          bytecode_.get(),
                           dlen,
                           key);
   // Read bytecode
-  const char* stream = uncompressed;
-  const char* end = uncompressed + dlen;
+  const char* stream = bytecode_.get();
+  const char* end = bytecode_.get() + dlen;
   size_t pos = 0;
-  pointer_t it = elts_.before_begin();
   while (pos < dlen) {
     // Read element
-    it = elts_.emplace_after(it, BytecodeElement::Read(stream, end, cdat));
-    cdat.offsets[pos] = it;
+    const pointer_t index = elts_.size();
+    cdat.offsets[pos] = index;
+    BytecodeElement* element = BytecodeElement::Read(stream, end, cdat);
 
     // Keep track of the entrypoints
-    int entrypoint = (*it)->GetEntrypoint();
+    int entrypoint = element->GetEntrypoint();
     if (entrypoint != BytecodeElement::kInvalidEntrypoint)
-      entrypoint_associations_.emplace(entrypoint, it);
+      entrypoint_associations_.emplace(entrypoint, index);
 
     // Advance
-    size_t l = (*it)->GetBytecodeLength();
+    size_t l = element->GetBytecodeLength();
     if (l <= 0)
       l = 1;  // Failsafe: always advance at least one byte.
     stream += l;
@@ -170,11 +170,9 @@ Script::Script(const Header& hdr,
   }
 
   // Resolve pointers
-  for (auto& element : elts_) {
+  for (BytecodeElement* element : elts_) {
     element->SetPointers(cdat);
   }
-
-  delete[] uncompressed;
 }
 
 Script::~Script() {}
@@ -208,7 +206,7 @@ Scenario::Scenario(const FilePos& fp, int sn,
 Scenario::~Scenario() {}
 
 Scenario::const_iterator Scenario::FindEntrypoint(int entrypoint) const {
-  return script.GetEntrypoint(entrypoint);
+  return InstructionAt(script.GetEntrypoint(entrypoint));
 }
 
 }  // namespace libreallive
@@ -73,8 +73,13 @@ class Scenario {
   typedef BytecodeList::const_iterator const_iterator;
   typedef BytecodeList::iterator iterator;
 
-  const_iterator begin() const  { return script.elts_.cbegin(); }
-  const_iterator end() const    { return script.elts_.cend();   }
+  const_iterator begin() const  { return script.elts_.begin(); }
+  const_iterator end() const    { return script.elts_.end();   }
+
+  // Returns the instruction a pointer from this scenario refers to.
+  const_iterator InstructionAt(pointer_t pointer) const {
+    return begin() + pointer;
+  }
 
   // Locate the entrypoint
   const_iterator FindEntrypoint(int entrypoint) const;
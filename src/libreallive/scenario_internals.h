@@ -30,6 +30,7 @@
 #define SRC_LIBREALLIVE_SCENARIO_INTERNALS_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -86,6 +87,10 @@ class Script {
          bool use_xor_2, const compression::XorKey* second_level_xor_key);
   ~Script();
 
+  // The decompressed bytecode. Elements refer to their text and parameters in
+  // place, so this must outlive |elts_|.
+  std::unique_ptr<char[]> bytecode_;
+
   BytecodeList elts_;
 
   // Entrypoint handeling
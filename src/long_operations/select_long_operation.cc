@@ -69,7 +69,7 @@ SelectLongOperation::SelectLongOperation(RLMachine& machine,
     o.use_colour = false;
 
     std::string evaluated_native =
-        libreallive::EvaluatePRINT(machine, param.text);
+        libreallive::EvaluatePRINT(machine, param.text.to_string());
     o.str = cp932toUTF8(evaluated_native, machine.GetTextEncoding());
 
     for (auto const& condition : param.cond_parsed) {
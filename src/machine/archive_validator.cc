@@ -0,0 +1,237 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "machine/archive_validator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libreallive/archive.h"
+#include "libreallive/bytecode.h"
+#include "libreallive/scenario.h"
+#include "machine/rlmachine.h"
+#include "machine/rloperation.h"
+#include "utilities/exception.h"
+
+using libreallive::BytecodeElement;
+using libreallive::CommandElement;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The name RLMachine::ExecuteCommand() would log |f| under if no module has
+// it.
+std::string OpcodeName(const CommandElement& f) {
+  std::ostringstream oss;
+  oss << "opcode<" << f.modtype() << ":" << f.module() << ":" << f.opcode()
+      << ", " << f.overload() << ">";
+  return oss.str();
+}
+
+void RecordError(ScenarioValidation& result,
+                 size_t element,
+                 const std::string& what) {
+  if (result.first_error.empty()) {
+    std::ostringstream oss;
+    oss << "element " << element << ": " << what;
+    result.first_error = oss.str();
+  }
+}
+
+void CheckCommand(const RLMachine& machine,
+                  const CommandElement& command,
+                  size_t element,
+                  ScenarioValidation& result) {
+  RLOperation* op = machine.FindOperation(command);
+  if (!op) {
+    result.unimplemented.Increment(OpcodeName(command));
+    return;
+  }
+
+  try {
+    libreallive::ExpressionPiecesVector output;
+    op->ParseParameters(command.GetUnparsedParameters(), output);
+  }
+  catch (rlvm::UnimplementedOpcode& e) {
+    result.unimplemented.Increment(e.opcode_name());
+  }
+  catch (std::exception& e) {
+    result.bad_parameters++;
+    RecordError(result, element, op->name() + ": " + e.what());
+  }
+}
+
+void ValidateScenario(const RLMachine& machine,
+                      const libreallive::Archive& archive,
+                      ScenarioValidation& result) {
+  Clock::time_point start = Clock::now();
+  std::unique_ptr<libreallive::Scenario> scenario;
+  try {
+    scenario.reset(archive.ParseScenario(result.scenario));
+  }
+  catch (std::exception& e) {
+    result.parse_failed = true;
+    result.first_error = e.what();
+    return;
+  }
+  result.parse_time = SecondsSince(start);
+
+  start = Clock::now();
+  for (const BytecodeElement* element : *scenario) {
+    if (const CommandElement* command =
+            dynamic_cast<const CommandElement*>(element)) {
+      CheckCommand(machine, *command, result.elements, result);
+      result.commands++;
+    }
+    result.elements++;
+  }
+  result.check_time = SecondsSince(start);
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// ScenarioValidation
+// -----------------------------------------------------------------------
+ScenarioValidation::ScenarioValidation()
+    : scenario(0),
+      parse_time(0),
+      check_time(0),
+      elements(0),
+      commands(0),
+      bad_parameters(0),
+      parse_failed(false) {}
+
+// -----------------------------------------------------------------------
+
+std::vector<ScenarioValidation> ValidateArchive(const RLMachine& machine,
+                                                libreallive::Archive& archive,
+                                                int thread_count) {
+  std::vector<ScenarioValidation> results;
+  for (auto it = archive.begin(); it != archive.end(); ++it) {
+    results.emplace_back();
+    results.back().scenario = it->first;
+  }
+
+  if (thread_count <= 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+  // Each thread takes the next unclaimed scenario; results are written in
+  // place so nothing needs to be locked.
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < results.size(); i = next++)
+      ValidateScenario(machine, archive, results[i]);
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < thread_count; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return results;
+}
+
+void PrintArchiveValidation(std::ostream& os,
+                            const std::vector<ScenarioValidation>& results) {
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+
+  os << "SEEN   Elements  Commands  Unimpl.  Bad params  Parse (ms)  "
+     << "Check (ms)" << std::endl;
+  os << "----   --------  --------  -------  ----------  ----------  "
+     << "----------" << std::endl;
+
+  OpcodeLog unimplemented;
+  size_t elements = 0, commands = 0, bad_parameters = 0, failed = 0;
+  double parse_time = 0, check_time = 0;
+  for (const ScenarioValidation& result : results) {
+    size_t unimplemented_count = 0;
+    for (auto const& entry : result.unimplemented)
+      unimplemented_count += entry.second;
+
+    os << std::setw(4) << std::setfill('0') << std::right << result.scenario
+       << std::setfill(' ');
+    if (result.parse_failed) {
+      os << "   Failed to parse: " << result.first_error << std::endl;
+      failed++;
+      continue;
+    }
+
+    os << "   " << std::setw(8) << result.elements << "  " << std::setw(8)
+       << result.commands << "  " << std::setw(7) << unimplemented_count
+       << "  " << std::setw(10) << result.bad_parameters << "  " << std::fixed
+       << std::setprecision(2) << std::setw(10) << result.parse_time * 1000
+       << "  " << std::setw(10) << result.check_time * 1000 << std::endl;
+    if (!result.first_error.empty())
+      os << "       " << result.first_error << std::endl;
+
+    unimplemented.Add(result.unimplemented);
+    elements += result.elements;
+    commands += result.commands;
+    bad_parameters += result.bad_parameters;
+    parse_time += result.parse_time;
+    check_time += result.check_time;
+  }
+
+  for (const ScenarioValidation& result : results) {
+    if (result.unimplemented.size() == 0)
+      continue;
+    os << std::endl << "Unimplemented opcodes in SEEN" << std::setw(4)
+       << std::setfill('0') << result.scenario << std::setfill(' ') << ":"
+       << std::endl << result.unimplemented << std::endl;
+  }
+
+  os << std::endl << "Scenarios: " << results.size() << " (" << failed
+     << " failed to parse)" << std::endl
+     << "Elements: " << elements << ", commands: " << commands
+     << ", commands with bad parameters: " << bad_parameters << std::endl
+     << "Total parse time: " << std::fixed << std::setprecision(2)
+     << parse_time * 1000 << " ms, check time: " << check_time * 1000
+     << " ms" << std::endl << std::endl
+     << "Unimplemented opcodes in the whole archive:" << std::endl
+     << unimplemented << std::endl;
+
+  os.flags(flags);
+  os.precision(precision);
+}
@@ -0,0 +1,85 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#ifndef SRC_MACHINE_ARCHIVE_VALIDATOR_H_
+#define SRC_MACHINE_ARCHIVE_VALIDATOR_H_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "machine/opcode_log.h"
+
+namespace libreallive {
+class Archive;
+}
+
+class RLMachine;
+
+// What ValidateArchive() found in one scenario.
+struct ScenarioValidation {
+  ScenarioValidation();
+
+  int scenario;
+
+  // Seconds spent decompressing and parsing the bytecode, and then checking
+  // every command in it.
+  double parse_time;
+  double check_time;
+
+  size_t elements;
+  size_t commands;
+
+  // Commands that no module registers, or that are registered as undefined.
+  OpcodeLog unimplemented;
+
+  // Commands whose parameters ParseParameters() rejected.
+  size_t bad_parameters;
+
+  // Description of the first problem found, if any.
+  std::string first_error;
+
+  // Set when the scenario itself couldn't be parsed.
+  bool parse_failed;
+};
+
+// Decompresses and parses every scenario in |archive| across |thread_count|
+// threads (one per core if zero), without caching them in |archive|. Each
+// CommandElement is looked up in the modules attached to |machine| and has
+// its parameters run through its RLOperation's ParseParameters(). Nothing is
+// executed. Results are in scenario order.
+std::vector<ScenarioValidation> ValidateArchive(
+    const RLMachine& machine,
+    libreallive::Archive& archive,
+    int thread_count);
+
+// Prints a table of |results|, each scenario's unimplemented opcodes, and a
+// summary of the whole archive.
+void PrintArchiveValidation(std::ostream& os,
+                            const std::vector<ScenarioValidation>& results);
+
+#endif  // SRC_MACHINE_ARCHIVE_VALIDATOR_H_
@@ -29,10 +29,13 @@
 
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "libreallive/gameexe.h"
 #include "libreallive/intmemref.h"
+#include "machine/packed_bank.h"
 #include "machine/rlmachine.h"
 #include "utilities/exception.h"
 #include "utilities/string_utilities.h"
@@ -51,6 +54,22 @@ const IntegerBank_t GLOBAL_INTEGER_BANKS = {
   make_pair(libreallive::INTG_LOCATION, 'G'),
   make_pair(libreallive::INTZ_LOCATION, 'Z')};
 
+// -----------------------------------------------------------------------
+// GlobalMemoryChanges
+// -----------------------------------------------------------------------
+bool GlobalMemoryChanges::empty() const {
+  return intG.empty() && intZ.empty() && strM.empty() &&
+         global_names.empty() && kidoku.empty();
+}
+
+void GlobalMemoryChanges::clear() {
+  intG.clear();
+  intZ.clear();
+  strM.clear();
+  global_names.clear();
+  kidoku.clear();
+}
+
 // -----------------------------------------------------------------------
 // GlobalMemory
 // -----------------------------------------------------------------------
@@ -117,6 +136,11 @@ void Memory::ConnectIntVarPointers() {
   original_int_var[5] = &local_.original_intF;
   original_int_var[6] = NULL;
   original_int_var[7] = NULL;
+
+  for (int i = 0; i < 6; ++i)
+    changed_int_var[i] = NULL;
+  changed_int_var[6] = &global_->changes.intG;
+  changed_int_var[7] = &global_->changes.intZ;
 }
 
 const std::string& Memory::GetStringValue(int type, int location) {
@@ -151,15 +175,11 @@ void Memory::SetStringValue(int type, int number, const std::string& value) {
       break;
     case libreallive::STRM_LOCATION:
       global_->strM[number] = value;
+      global_->changes.strM.insert(number);
       break;
     case libreallive::STRS_LOCATION: {
       // Possibly record the original value for a piece of local memory.
-      std::map<int, std::string>::iterator it =
-          local_.original_strS.find(number);
-      if (it == local_.original_strS.end()) {
-        local_.original_strS.insert(
-            std::make_pair(number, local_.strS[number]));
-      }
+      local_.original_strS.Record(number, local_.strS[number]);
       local_.strS[number] = value;
       break;
     }
@@ -179,6 +199,7 @@ void Memory::CheckNameIndex(int index, const std::string& name) const {
 void Memory::SetName(int index, const std::string& name) {
   CheckNameIndex(index, "Memory::set_name");
   global_->global_names[index] = name;
+  global_->changes.global_names.insert(index);
 }
 
 const std::string& Memory::GetName(int index) const {
@@ -212,17 +233,122 @@ void Memory::RecordKidoku(int scenario, int kidoku) {
   if (bitset.size() <= static_cast<size_t>(kidoku))
     bitset.resize(kidoku + 1, false);
 
-  bitset[kidoku] = true;
+  if (!bitset[kidoku]) {
+    bitset[kidoku] = true;
+    global_->changes.kidoku.emplace(scenario, kidoku);
+  }
+}
+
+void Memory::FillIntRange(const libreallive::IntMemRef& first,
+                          int count,
+                          int value) {
+  int width;
+  int* bank = GetIntRangeBank(first, count, width);
+  RecordIntRangeWrite(first, width, count);
+  packed_bank::Fill(bank, width, first.location(), count, value);
+}
+
+void Memory::SetIntRange(const libreallive::IntMemRef& first,
+                         const int* values,
+                         int count) {
+  int width;
+  int* bank = GetIntRangeBank(first, count, width);
+  RecordIntRangeWrite(first, width, count);
+  packed_bank::Store(bank, width, first.location(), values, count);
+}
+
+void Memory::CopyIntRange(const libreallive::IntMemRef& source,
+                          const libreallive::IntMemRef& dest,
+                          int count) {
+  int source_width, dest_width;
+  const int* source_bank = GetIntRangeBank(source, count, source_width);
+  int* dest_bank = GetIntRangeBank(dest, count, dest_width);
+  RecordIntRangeWrite(dest, dest_width, count);
+  packed_bank::Copy(source_bank, source_width, source.location(),
+                    dest_bank, dest_width, dest.location(),
+                    count);
+}
+
+int Memory::SumIntRange(const libreallive::IntMemRef& first, int count) {
+  int width;
+  const int* bank = GetIntRangeBank(first, count, width);
+  return packed_bank::Sum(bank, width, first.location(), count);
+}
+
+bool Memory::IntRangesEqual(const libreallive::IntMemRef& lhs,
+                            const libreallive::IntMemRef& rhs,
+                            int count) {
+  int lhs_width, rhs_width;
+  const int* lhs_bank = GetIntRangeBank(lhs, count, lhs_width);
+  const int* rhs_bank = GetIntRangeBank(rhs, count, rhs_width);
+  if (lhs_width == rhs_width) {
+    return packed_bank::Equal(lhs_bank, lhs.location(),
+                              rhs_bank, rhs.location(),
+                              lhs_width, count);
+  }
+
+  std::vector<int> lhs_values(count), rhs_values(count);
+  packed_bank::Load(lhs_bank, lhs_width, lhs.location(),
+                    lhs_values.data(), count);
+  packed_bank::Load(rhs_bank, rhs_width, rhs.location(),
+                    rhs_values.data(), count);
+  return lhs_values == rhs_values;
+}
+
+int* Memory::GetIntRangeBank(const libreallive::IntMemRef& first,
+                             int count,
+                             int& width) {
+  int index = first.bank();
+  int type = first.type();
+
+  int* bank = NULL;
+  int words = SIZE_OF_MEM_BANK;
+  if (index == libreallive::INTL_LOCATION) {
+    bank = machine_.CurrentIntLBank();
+    words = SIZE_OF_INT_PASSING_MEM;
+  } else if (index >= 0 && index < NUMBER_OF_INT_LOCATIONS) {
+    bank = int_var[index];
+  }
+
+  width = (type <= 0 || type > 5) ? 32 : 1 << (type - 1);
+  int elements = words * (32 / width);
+  if (!bank || type < 0 || type > 5 || count < 0 || first.location() < 0 ||
+      first.location() + count > elements) {
+    std::ostringstream ss;
+    ss << "Invalid memory range " << first << " + " << count;
+    throw rlvm::Exception(ss.str());
+  }
+
+  return bank;
+}
+
+void Memory::RecordIntRangeWrite(const libreallive::IntMemRef& first,
+                                 int width,
+                                 int count) {
+  int index = first.bank();
+  if (count <= 0 || index == libreallive::INTL_LOCATION)
+    return;
+
+  int begin = first.location() * width / 32;
+  int end = ((first.location() + count) * width + 31) / 32;
+  SavepointJournal<int>* original = original_int_var[index];
+  ChangedSlots<SIZE_OF_MEM_BANK>* changed = changed_int_var[index];
+  for (int word = begin; word < end; ++word) {
+    if (original)
+      original->Record(word, int_var[index][word]);
+    if (changed)
+      changed->insert(word);
+  }
 }
 
 void Memory::TakeSavepointSnapshot() {
-  local_.original_intA.clear();
-  local_.original_intB.clear();
-  local_.original_intC.clear();
-  local_.original_intD.clear();
-  local_.original_intE.clear();
-  local_.original_intF.clear();
-  local_.original_strS.clear();
+  local_.original_intA.Clear();
+  local_.original_intB.Clear();
+  local_.original_intC.Clear();
+  local_.original_intD.Clear();
+  local_.original_intE.Clear();
+  local_.original_intF.Clear();
+  local_.original_strS.Clear();
 }
 
 // static
@@ -33,8 +33,10 @@
 #include <boost/serialization/version.hpp>
 
 #include <algorithm>
+#include <bitset>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -53,6 +55,63 @@ extern const IntegerBank_t GLOBAL_INTEGER_BANKS;
 class RLMachine;
 class Gameexe;
 
+// The slots of an |N| element bank written since the last clear(). A bit per
+// slot filters out repeated writes and the slots are appended to a vector
+// whose storage is kept across clears, so marking a slot doesn't allocate in
+// the steady state. Slots are iterated in the order they were first written.
+template <size_t N>
+class ChangedSlots {
+ public:
+  typedef std::vector<int>::const_iterator const_iterator;
+
+  void insert(int slot) {
+    if (!changed_[slot]) {
+      changed_.set(slot);
+      slots_.push_back(slot);
+    }
+  }
+
+  // Takes time in proportion to the number of changed slots.
+  void clear() {
+    for (int slot : slots_)
+      changed_.reset(slot);
+    slots_.clear();
+  }
+
+  bool empty() const { return slots_.empty(); }
+  size_t size() const { return slots_.size(); }
+  const_iterator begin() const { return slots_.begin(); }
+  const_iterator end() const { return slots_.end(); }
+
+ private:
+  std::bitset<N> changed_;
+  std::vector<int> slots_;
+};
+
+// Records which parts of GlobalMemory have been written to since it was last
+// saved, so Serialization::saveGlobalMemory() can append just those entries
+// to the global memory journal instead of rewriting everything.
+struct GlobalMemoryChanges {
+  // Indexes into intG[], intZ[], strM[] and global_names[].
+  ChangedSlots<SIZE_OF_MEM_BANK> intG;
+  ChangedSlots<SIZE_OF_MEM_BANK> intZ;
+  ChangedSlots<SIZE_OF_MEM_BANK> strM;
+  ChangedSlots<SIZE_OF_NAME_BANK> global_names;
+
+  // (scenario, kidoku) pairs newly set in kidoku_data. Kidoku bits are never
+  // cleared, so these are all that changed.
+  std::set<std::pair<int, int>> kidoku;
+
+  // The serialized System globals as of the last save. They don't go through
+  // Memory, so they're compared instead of tracked.
+  std::string system_globals;
+
+  bool empty() const;
+
+  // Forgets all changes except |system_globals|.
+  void clear();
+};
+
 // Struct that represents Global Memory. In any one rlvm process, there
 // should only be one GlobalMemory struct existing, as it will be
 // shared over all the Memory objects in the process.
@@ -70,6 +129,9 @@ struct GlobalMemory {
   // represents a specific kidoku bit.
   std::map<int, boost::dynamic_bitset<>> kidoku_data;
 
+  // Not serialized.
+  GlobalMemoryChanges changes;
+
   // boost::serialization
   template <class Archive>
   void serialize(Archive& ar, unsigned int version) {
@@ -87,6 +149,51 @@ BOOST_CLASS_VERSION(GlobalMemory, 1)
 
 struct dont_initialize {};
 
+// The values one local memory bank held at the last savepoint, for the slots
+// that have been written since. A bit per slot says whether it has been
+// journaled yet, and the old values are appended to a vector whose storage is
+// kept across savepoints, so writes don't allocate once the journal has grown
+// to a scene's worth of changes.
+template <typename T>
+class SavepointJournal {
+ public:
+  typedef std::pair<int, T> Entry;
+
+  // Keeps a copy of |current|, the value in |slot| right now, unless |slot|
+  // has already been journaled since the last Clear(). |current| is left
+  // untouched: the value about to be written over it may be a reference to
+  // that same slot.
+  void Record(int slot, const T& current) {
+    if (!journaled_[slot]) {
+      journaled_.set(slot);
+      entries_.emplace_back(slot, current);
+    }
+  }
+
+  // Forgets every entry. Takes time in proportion to the number of entries,
+  // not the size of the bank.
+  void Clear() {
+    for (const Entry& entry : entries_)
+      journaled_.reset(entry.first);
+    entries_.clear();
+  }
+
+  // Writes |bank| as it was at the last savepoint to |out|.
+  void Revert(const T (&bank)[SIZE_OF_MEM_BANK],
+              T (&out)[SIZE_OF_MEM_BANK]) const {
+    std::copy(bank, bank + SIZE_OF_MEM_BANK, out);
+    for (const Entry& entry : entries_)
+      out[entry.first] = entry.second;
+  }
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+ private:
+  std::bitset<SIZE_OF_MEM_BANK> journaled_;
+  std::vector<Entry> entries_;
+};
+
 // Struct that represents Local Memory. In any one rlvm process, lots
 // of these things will be created, because there are commands
 struct LocalMemory {
@@ -114,13 +221,13 @@ struct LocalMemory {
   // Savepoint(). Instead of doing some sort of copying entire memory banks
   // whenever we hit a Savepoint() call, only reconstruct the original memory
   // when we save.
-  std::map<int, int> original_intA;
-  std::map<int, int> original_intB;
-  std::map<int, int> original_intC;
-  std::map<int, int> original_intD;
-  std::map<int, int> original_intE;
-  std::map<int, int> original_intF;
-  std::map<int, std::string> original_strS;
+  SavepointJournal<int> original_intA;
+  SavepointJournal<int> original_intB;
+  SavepointJournal<int> original_intC;
+  SavepointJournal<int> original_intD;
+  SavepointJournal<int> original_intE;
+  SavepointJournal<int> original_intF;
+  SavepointJournal<std::string> original_strS;
 
   std::string local_names[SIZE_OF_NAME_BANK];
 
@@ -129,12 +236,14 @@ struct LocalMemory {
   template <class Archive, typename T>
   void saveArrayRevertingChanges(Archive& ar,
                                  const T (&a)[SIZE_OF_MEM_BANK],
-                                 const std::map<int, T>& original) const {
-    T merged[SIZE_OF_MEM_BANK];
-    std::copy(a, a + SIZE_OF_MEM_BANK, merged);
-    for (auto it = original.cbegin(); it != original.cend(); ++it) {
-      merged[it->first] = it->second;
+                                 const SavepointJournal<T>& original) const {
+    if (original.empty()) {
+      ar& a;
+      return;
     }
+
+    T merged[SIZE_OF_MEM_BANK];
+    original.Revert(a, merged);
     ar& merged;
   }
 
@@ -212,6 +321,22 @@ class Memory {
   // Sets the value of a certain memory location
   void SetIntValue(const libreallive::IntMemRef& ref, int value);
 
+  // Bulk versions of GetIntValue() and SetIntValue() over the |count|
+  // elements starting at |first|, at whatever bit width |first| accesses.
+  // These work on whole words of the bank instead of one element at a time,
+  // and check the entire range before writing anything.
+  void FillIntRange(const libreallive::IntMemRef& first, int count, int value);
+  void SetIntRange(const libreallive::IntMemRef& first,
+                   const int* values,
+                   int count);
+  void CopyIntRange(const libreallive::IntMemRef& source,
+                    const libreallive::IntMemRef& dest,
+                    int count);
+  int SumIntRange(const libreallive::IntMemRef& first, int count);
+  bool IntRangesEqual(const libreallive::IntMemRef& lhs,
+                      const libreallive::IntMemRef& rhs,
+                      int count);
+
   // Returns the string value of a string memory bank
   const std::string& GetStringValue(int type, int location);
 
@@ -257,6 +382,17 @@ class Memory {
   // Connects the memory banks in local_ and in global_ into int_var.
   void ConnectIntVarPointers();
 
+  // Returns the bank that |count| elements starting at |first| live in and
+  // sets |width| to their size in bits. Throws if the range doesn't fit.
+  int* GetIntRangeBank(const libreallive::IntMemRef& first,
+                       int count,
+                       int& width);
+
+  // Journals the words of the bank that writing the range will change.
+  void RecordIntRangeWrite(const libreallive::IntMemRef& first,
+                           int width,
+                           int count);
+
   // Input validating function to the {get,set}(Local)?Name set of functions.
   void CheckNameIndex(int index, const std::string& name) const;
 
@@ -283,7 +419,10 @@ class Memory {
   int* int_var[NUMBER_OF_INT_LOCATIONS];
 
   // Change records for original.
-  std::map<int, int>* original_int_var[NUMBER_OF_INT_LOCATIONS];
+  SavepointJournal<int>* original_int_var[NUMBER_OF_INT_LOCATIONS];
+
+  // Change records for global memory; NULL for the local banks.
+  ChangedSlots<SIZE_OF_MEM_BANK>* changed_int_var[NUMBER_OF_INT_LOCATIONS];
 };  // end of class Memory
 
 // Implementation of getting an integer out of an array. Global because we need
@@ -61,14 +61,16 @@ void throwIllegalIndex(const IntMemRef& ref, const std::string& function) {
 }
 
 void saveOriginalValue(int* bank,
-                       std::map<int, int>* original_bank,
+                       SavepointJournal<int>* original_bank,
                        int location) {
-  if (bank && original_bank) {
-    std::map<int, int>::iterator it = original_bank->find(location);
-    if (it == original_bank->end()) {
-      original_bank->emplace(location, bank[location]);
-    }
-  }
+  if (bank && original_bank)
+    original_bank->Record(location, bank[location]);
+}
+
+void recordChange(ChangedSlots<SIZE_OF_MEM_BANK>* changed_bank,
+                  int location) {
+  if (changed_bank)
+    changed_bank->insert(location);
 }
 
 }  // namespace
@@ -111,7 +113,8 @@ void Memory::SetIntValue(const IntMemRef& ref, int value) {
   int location = ref.location();
 
   int* bank = NULL;
-  std::map<int, int>* original_bank = NULL;
+  SavepointJournal<int>* original_bank = NULL;
+  ChangedSlots<SIZE_OF_MEM_BANK>* changed_bank = NULL;
   if (index == 8) {
     bank = machine_.CurrentIntLBank();
   } else if (index < 0 || index > NUMBER_OF_INT_LOCATIONS) {
@@ -119,6 +122,7 @@ void Memory::SetIntValue(const IntMemRef& ref, int value) {
   } else {
     bank = int_var[index];
     original_bank = original_int_var[index];
+    changed_bank = changed_int_var[index];
   }
 
   if (type == 0) {
@@ -126,6 +130,7 @@ void Memory::SetIntValue(const IntMemRef& ref, int value) {
     if ((unsigned int)(location) >= 2000)
       throwIllegalIndex(ref, "RLMachine::SetIntValue()");
     saveOriginalValue(bank, original_bank, location);
+    recordChange(changed_bank, location);
     bank[location] = value;
   } else {
     // Ab[]..G4b[], Z8b[] などを書く
@@ -137,6 +142,7 @@ void Memory::SetIntValue(const IntMemRef& ref, int value) {
       throwIllegalIndex(ref, "RLMachine::SetIntValue()");
 
     saveOriginalValue(bank, original_bank, location / eltsize);
+    recordChange(changed_bank, location / eltsize);
     bank[location / eltsize] =
         (bank[location / eltsize] & ~(eltmask << shift)) | (value & eltmask)
                                                                << shift;
@@ -40,6 +40,11 @@ OpcodeLog::~OpcodeLog() {}
 
 void OpcodeLog::Increment(const std::string& name) { storage_[name]++; }
 
+void OpcodeLog::Add(const OpcodeLog& log) {
+  for (auto const& entry : log)
+    storage_[entry.first] += entry.second;
+}
+
 static bool nameLessThan(const OpcodeLog::Storage::value_type& lhs,
                          const OpcodeLog::Storage::value_type& rhs) {
   return lhs.first.size() < rhs.first.size();
@@ -46,6 +46,9 @@ class OpcodeLog {
   // Increments the number of times we've encountered "name".
   void Increment(const std::string& name);
 
+  // Adds every count in |log| to this one.
+  void Add(const OpcodeLog& log);
+
   Storage::const_iterator begin() const { return storage_.begin(); }
   Storage::const_iterator end() const { return storage_.end(); }
   size_t size() const { return storage_.size(); }
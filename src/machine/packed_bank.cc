@@ -0,0 +1,311 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "machine/packed_bank.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace packed_bank {
+
+namespace {
+
+// Unaligned copies and compares stage elements through a buffer this size.
+const int kChunkSize = 256;
+
+uint32_t ElementMask(int width) {
+  return width == 32 ? 0xffffffffu : (1u << width) - 1;
+}
+
+// Bits [begin, end) of a word, where 0 <= begin <= end <= 32.
+uint32_t BitMask(int begin, int end) {
+  uint64_t bits = (uint64_t(1) << (end - begin)) - 1;
+  return static_cast<uint32_t>(bits << begin);
+}
+
+// The words a range of elements touches: whole words in [body_begin,
+// body_end), plus partially covered words at either end. |head| and |tail|
+// are -1 when the range starts or ends on a word boundary.
+struct WordSpan {
+  int head = -1;
+  uint32_t head_mask = 0;
+  int body_begin = 0;
+  int body_end = 0;
+  int tail = -1;
+  uint32_t tail_mask = 0;
+};
+
+WordSpan SpanOf(int width, int first, int count) {
+  WordSpan span;
+  int begin = first * width;
+  int end = (first + count) * width;
+  int begin_word = begin / 32;
+  int end_word = end / 32;
+
+  if (begin_word == end_word) {
+    span.head = begin_word;
+    span.head_mask = BitMask(begin % 32, end % 32);
+    span.body_begin = span.body_end = begin_word;
+    return span;
+  }
+
+  span.body_begin = begin_word;
+  if (begin % 32) {
+    span.head = begin_word;
+    span.head_mask = BitMask(begin % 32, 32);
+    span.body_begin++;
+  }
+  span.body_end = end_word;
+  if (end % 32) {
+    span.tail = end_word;
+    span.tail_mask = BitMask(0, end % 32);
+  }
+  return span;
+}
+
+// Replaces the bits of words[index] selected by |mask| with those of |bits|.
+void Merge(uint32_t* words, int index, uint32_t mask, uint32_t bits) {
+  if (index >= 0)
+    words[index] = (words[index] & ~mask) | (bits & mask);
+}
+
+// Whether the words behind two ranges share any memory.
+bool Overlaps(const int* lhs, int lhs_width, int lhs_first,
+              const int* rhs, int rhs_width, int rhs_first,
+              int count) {
+  std::less<const int*> less;
+  const int* lhs_begin = lhs + lhs_first * lhs_width / 32;
+  const int* lhs_end = lhs + ((lhs_first + count) * lhs_width + 31) / 32;
+  const int* rhs_begin = rhs + rhs_first * rhs_width / 32;
+  const int* rhs_end = rhs + ((rhs_first + count) * rhs_width + 31) / 32;
+  return less(lhs_begin, rhs_end) && less(rhs_begin, lhs_end);
+}
+
+// Adds up the WIDTH bit lanes of |word| by repeatedly folding neighbouring
+// lanes into lanes twice as wide; for WIDTH 1 this is a popcount.
+template <int WIDTH>
+uint32_t SumLanes(uint32_t word) {
+  static const uint32_t kLowLanes[] = {0x55555555u, 0x33333333u, 0x0f0f0f0fu,
+                                       0x00ff00ffu, 0x0000ffffu};
+  int i = 0;
+  for (int w = 1; w < WIDTH; w *= 2)
+    ++i;
+  for (int w = WIDTH; w < 32; w *= 2, ++i)
+    word = (word & kLowLanes[i]) + ((word >> w) & kLowLanes[i]);
+  return word;
+}
+
+// Kept free of data dependent branches so the compiler can vectorize it.
+template <int WIDTH>
+uint64_t SumWords(const uint32_t* begin, const uint32_t* end) {
+  uint64_t total = 0;
+  for (; begin != end; ++begin)
+    total += SumLanes<WIDTH>(*begin);
+  return total;
+}
+
+template <int WIDTH>
+int SumRange(const uint32_t* words, const WordSpan& span) {
+  uint64_t total =
+      SumWords<WIDTH>(words + span.body_begin, words + span.body_end);
+  if (span.head >= 0)
+    total += SumLanes<WIDTH>(words[span.head] & span.head_mask);
+  if (span.tail >= 0)
+    total += SumLanes<WIDTH>(words[span.tail] & span.tail_mask);
+  return static_cast<int>(static_cast<uint32_t>(total));
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+
+void Fill(int* bank, int width, int first, int count, int value) {
+  if (count <= 0)
+    return;
+
+  // Multiplying by 0x...0101 repeats the element into every lane.
+  uint32_t mask = ElementMask(width);
+  uint32_t pattern =
+      (static_cast<uint32_t>(value) & mask) * (0xffffffffu / mask);
+
+  uint32_t* words = reinterpret_cast<uint32_t*>(bank);
+  WordSpan span = SpanOf(width, first, count);
+  Merge(words, span.head, span.head_mask, pattern);
+  std::fill(words + span.body_begin, words + span.body_end, pattern);
+  Merge(words, span.tail, span.tail_mask, pattern);
+}
+
+void Store(int* bank, int width, int first, const int* values, int count) {
+  if (count <= 0)
+    return;
+  if (width == 32) {
+    std::copy(values, values + count, bank + first);
+    return;
+  }
+
+  uint32_t* words = reinterpret_cast<uint32_t*>(bank);
+  const int per_word = 32 / width;
+  const uint32_t mask = ElementMask(width);
+  int word = first / per_word;
+  int lane = first % per_word;
+  while (count > 0) {
+    int lanes = std::min(per_word - lane, count);
+    uint32_t bits = 0;
+    for (int i = 0; i < lanes; ++i)
+      bits |= (static_cast<uint32_t>(values[i]) & mask) << ((lane + i) * width);
+    Merge(words, word, BitMask(lane * width, (lane + lanes) * width), bits);
+
+    values += lanes;
+    count -= lanes;
+    lane = 0;
+    ++word;
+  }
+}
+
+void Load(const int* bank, int width, int first, int* values, int count) {
+  if (count <= 0)
+    return;
+  if (width == 32) {
+    std::copy(bank + first, bank + first + count, values);
+    return;
+  }
+
+  const uint32_t* words = reinterpret_cast<const uint32_t*>(bank);
+  const int per_word = 32 / width;
+  const uint32_t mask = ElementMask(width);
+  int word = first / per_word;
+  int lane = first % per_word;
+  while (count > 0) {
+    int lanes = std::min(per_word - lane, count);
+    uint32_t bits = words[word] >> (lane * width);
+    for (int i = 0; i < lanes; ++i, bits >>= width)
+      values[i] = bits & mask;
+
+    values += lanes;
+    count -= lanes;
+    lane = 0;
+    ++word;
+  }
+}
+
+void Copy(const int* source, int source_width, int source_first,
+          int* dest, int dest_width, int dest_first,
+          int count) {
+  if (count <= 0)
+    return;
+
+  if (Overlaps(source, source_width, source_first,
+               dest, dest_width, dest_first, count)) {
+    std::vector<int> values(count);
+    Load(source, source_width, source_first, values.data(), count);
+    Store(dest, dest_width, dest_first, values.data(), count);
+    return;
+  }
+
+  if (source_width == dest_width &&
+      (source_first * source_width) % 32 == (dest_first * dest_width) % 32) {
+    // Elements sit at the same place in their words, so whole words move.
+    const uint32_t* from = reinterpret_cast<const uint32_t*>(source);
+    uint32_t* to = reinterpret_cast<uint32_t*>(dest);
+    WordSpan from_span = SpanOf(source_width, source_first, count);
+    WordSpan to_span = SpanOf(dest_width, dest_first, count);
+    if (to_span.head >= 0)
+      Merge(to, to_span.head, to_span.head_mask, from[from_span.head]);
+    std::memcpy(to + to_span.body_begin,
+                from + from_span.body_begin,
+                (from_span.body_end - from_span.body_begin) * sizeof(uint32_t));
+    if (to_span.tail >= 0)
+      Merge(to, to_span.tail, to_span.tail_mask, from[from_span.tail]);
+    return;
+  }
+
+  int buffer[kChunkSize];
+  for (int done = 0; done < count; done += kChunkSize) {
+    int n = std::min(kChunkSize, count - done);
+    Load(source, source_width, source_first + done, buffer, n);
+    Store(dest, dest_width, dest_first + done, buffer, n);
+  }
+}
+
+int Sum(const int* bank, int width, int first, int count) {
+  if (count <= 0)
+    return 0;
+
+  const uint32_t* words = reinterpret_cast<const uint32_t*>(bank);
+  WordSpan span = SpanOf(width, first, count);
+  switch (width) {
+    case 1:
+      return SumRange<1>(words, span);
+    case 2:
+      return SumRange<2>(words, span);
+    case 4:
+      return SumRange<4>(words, span);
+    case 8:
+      return SumRange<8>(words, span);
+    case 16:
+      return SumRange<16>(words, span);
+    default:
+      return SumRange<32>(words, span);
+  }
+}
+
+bool Equal(const int* lhs, int lhs_first,
+           const int* rhs, int rhs_first,
+           int width, int count) {
+  if (count <= 0)
+    return true;
+
+  if ((lhs_first * width) % 32 == (rhs_first * width) % 32) {
+    const uint32_t* left = reinterpret_cast<const uint32_t*>(lhs);
+    const uint32_t* right = reinterpret_cast<const uint32_t*>(rhs);
+    WordSpan l = SpanOf(width, lhs_first, count);
+    WordSpan r = SpanOf(width, rhs_first, count);
+    if (l.head >= 0 && ((left[l.head] ^ right[r.head]) & l.head_mask))
+      return false;
+    if (l.tail >= 0 && ((left[l.tail] ^ right[r.tail]) & l.tail_mask))
+      return false;
+    return std::memcmp(left + l.body_begin,
+                       right + r.body_begin,
+                       (l.body_end - l.body_begin) * sizeof(uint32_t)) == 0;
+  }
+
+  int lhs_values[kChunkSize];
+  int rhs_values[kChunkSize];
+  for (int done = 0; done < count; done += kChunkSize) {
+    int n = std::min(kChunkSize, count - done);
+    Load(lhs, width, lhs_first + done, lhs_values, n);
+    Load(rhs, width, rhs_first + done, rhs_values, n);
+    if (!std::equal(lhs_values, lhs_values + n, rhs_values))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace packed_bank
@@ -0,0 +1,64 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#ifndef SRC_MACHINE_PACKED_BANK_H_
+#define SRC_MACHINE_PACKED_BANK_H_
+
+// Word-at-a-time operations on an integer memory bank viewed as an array of
+// |width| bit elements, the way Ab[]..Z8b[] view intA[]..intZ[]. |width| is
+// 1, 2, 4, 8, 16 or 32. Element i lives in word i / (32 / width), starting at
+// bit (i % (32 / width)) * width. Ranges are |count| elements starting at
+// element |first|; callers are responsible for bounds checking.
+namespace packed_bank {
+
+// Sets every element in the range to |value|, truncated to |width| bits.
+void Fill(int* bank, int width, int first, int count, int value);
+
+// Writes |values| into the range, truncating each to |width| bits.
+void Store(int* bank, int width, int first, const int* values, int count);
+
+// Reads the range into |values|.
+void Load(const int* bank, int width, int first, int* values, int count);
+
+// Copies |count| elements from one range to another, converting between
+// widths as if each element were read and then written. Overlapping ranges
+// behave as if the source were read completely before writing.
+void Copy(const int* source, int source_width, int source_first,
+          int* dest, int dest_width, int dest_first,
+          int count);
+
+// Returns the sum of the elements in the range, wrapping like int addition.
+int Sum(const int* bank, int width, int first, int count);
+
+// Returns whether two ranges of the same width hold the same values.
+bool Equal(const int* lhs, int lhs_first,
+           const int* rhs, int rhs_first,
+           int width, int count);
+
+}  // namespace packed_bank
+
+#endif  // SRC_MACHINE_PACKED_BANK_H_
@@ -104,6 +104,9 @@ class MemoryReferenceIterator
   int type() const { return type_; }
   int location() const { return location_; }
 
+  // The Memory this iterator points into; NULL for the store register.
+  Memory* memory() const { return memory_; }
+
   // -------------------------------------------------------- Iterated Interface
   ACCESS operator*() { return ACCESS(this); }
 
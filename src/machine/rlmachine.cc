@@ -25,6 +25,8 @@
 //
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>  // NOLINT
+#include <boost/archive/binary_oarchive.hpp>  // NOLINT
 #include <boost/archive/text_iarchive.hpp>  // NOLINT
 #include <boost/archive/text_oarchive.hpp>  // NOLINT
 #include <boost/serialization/vector.hpp>   // NOLINT
@@ -35,6 +37,7 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/path.hpp>
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <sstream>
@@ -45,6 +48,7 @@
 #include "libreallive/archive.h"
 #include "libreallive/bytecode.h"
 #include "libreallive/expression.h"
+#include "libreallive/expression_program.h"
 #include "libreallive/gameexe.h"
 #include "libreallive/intmemref.h"
 #include "libreallive/scenario.h"
@@ -56,6 +60,7 @@
 #include "machine/reallive_dll.h"
 #include "machine/rlmodule.h"
 #include "machine/rloperation.h"
+#include "machine/save_game_index.h"
 #include "machine/serialization.h"
 #include "machine/stack_frame.h"
 #include "systems/base/graphics_system.h"
@@ -94,6 +99,17 @@ bool IsNotLongOp(StackFrame& frame) {
   return frame.frame_type != StackFrame::TYPE_LONGOP;
 }
 
+// Returns a new value for RLMachine::dispatch_generation_. Zero is never
+// returned, so it can't match a CommandElement that has no cached operation.
+unsigned int NextDispatchGeneration() {
+  static std::atomic<unsigned int> generation(0);
+  unsigned int next;
+  do {
+    next = ++generation;
+  } while (next == 0);
+  return next;
+}
+
 }  // namespace
 
 // -----------------------------------------------------------------------
@@ -102,6 +118,7 @@ bool IsNotLongOp(StackFrame& frame) {
 
 RLMachine::RLMachine(System& in_system, libreallive::Archive& in_archive)
     : memory_(new Memory(*this, in_system.gameexe())),
+      dispatch_generation_(NextDispatchGeneration()),
       archive_(in_archive),
       system_(in_system) {
   // Search in the Gameexe for #SEEN_START and place us there
@@ -169,6 +186,10 @@ void RLMachine::AttachModule(RLModule* module) {
   }
 
   modules_.emplace(packed_module, std::unique_ptr<RLModule>(module));
+
+  // Operations cached on CommandElements were resolved against the old set of
+  // modules.
+  dispatch_generation_ = NextDispatchGeneration();
 }
 
 int RLMachine::GetIntValue(const libreallive::IntMemRef& ref) {
@@ -339,13 +360,22 @@ std::string RLMachine::GetCommandName(const libreallive::CommandElement& f) {
 }
 
 void RLMachine::ExecuteCommand(const libreallive::CommandElement& f) {
-  ModuleMap::iterator it =
-      modules_.find(PackModuleNumber(f.modtype(), f.module()));
-  if (it != modules_.end()) {
-    it->second->DispatchFunction(*this, f);
-  } else {
-    throw rlvm::UnimplementedOpcode(*this, f);
+  RLOperation* op = f.GetCachedOperation(dispatch_generation_);
+  if (!op) {
+    op = FindOperation(f);
+    if (!op)
+      throw rlvm::UnimplementedOpcode(*this, f);
+    f.SetCachedOperation(op, dispatch_generation_);
   }
+
+  RLModule::DispatchOperation(*this, *op, f);
+}
+
+RLOperation* RLMachine::FindOperation(
+    const libreallive::CommandElement& f) const {
+  ModuleMap::const_iterator it =
+      modules_.find(PackModuleNumber(f.modtype(), f.module()));
+  return it != modules_.end() ? it->second->FindOperation(f) : nullptr;
 }
 
 void RLMachine::Jump(int scenario_num, int entrypoint) {
@@ -370,10 +400,12 @@ void RLMachine::Jump(int scenario_num, int entrypoint) {
     if (it != call_stack_.rend()) {
       it->scenario = scenario;
       it->ip = scenario->FindEntrypoint(entrypoint);
+      NotifySceneEntered(*scenario, it->ip);
     }
   } else {
     call_stack_.back().scenario = scenario;
     call_stack_.back().ip = scenario->FindEntrypoint(entrypoint);
+    NotifySceneEntered(*scenario, call_stack_.back().ip);
   }
 }
 
@@ -393,6 +425,14 @@ void RLMachine::Farcall(int scenario_num, int entrypoint) {
     MarkSavepoint();
 
   PushStackFrame(StackFrame(scenario, it, StackFrame::TYPE_FARCALL));
+  NotifySceneEntered(*scenario, it);
+}
+
+void RLMachine::NotifySceneEntered(
+    const libreallive::Scenario& scenario,
+    libreallive::Scenario::const_iterator entrypoint) {
+  for (auto& module : modules_)
+    module.second->SceneEntered(*this, scenario, entrypoint);
 }
 
 void RLMachine::ReturnFromFarcall() {
@@ -404,14 +444,17 @@ void RLMachine::ReturnFromFarcall() {
   PopStackFrame();
 }
 
-void RLMachine::GotoLocation(libreallive::BytecodeList::iterator new_location) {
+void RLMachine::GotoLocation(libreallive::pointer_t new_location) {
   // Modify the current frame of the call stack so that it's
-  call_stack_.back().ip = new_location;
+  StackFrame& frame = call_stack_.back();
+  frame.ip = frame.scenario->InstructionAt(new_location);
 }
 
-void RLMachine::Gosub(libreallive::BytecodeList::iterator new_location) {
-  PushStackFrame(StackFrame(
-      call_stack_.back().scenario, new_location, StackFrame::TYPE_GOSUB));
+void RLMachine::Gosub(libreallive::pointer_t new_location) {
+  const libreallive::Scenario* scenario = call_stack_.back().scenario;
+  PushStackFrame(StackFrame(scenario,
+                            scenario->InstructionAt(new_location),
+                            StackFrame::TYPE_GOSUB));
 }
 
 void RLMachine::ReturnFromGosub() {
@@ -545,8 +588,16 @@ const libreallive::Scenario& RLMachine::Scenario() const {
   return *call_stack_.back().scenario;
 }
 
+libreallive::Scenario::const_iterator RLMachine::CurrentInstruction() const {
+  return call_stack_.back().ip;
+}
+
 void RLMachine::ExecuteExpression(const libreallive::ExpressionElement& e) {
-  e.ParsedExpression().GetIntegerValue(*this);
+  const libreallive::ExpressionProgram& program = e.CompiledExpression();
+  if (program.empty())
+    e.ParsedExpression().GetIntegerValue(*this);
+  else
+    program.Evaluate(*this);
   AdvanceInstructionPointer();
 }
 
@@ -654,7 +705,7 @@ int RLMachine::CallDLL(int slot,
   }
 }
 
-unsigned int RLMachine::PackModuleNumber(int modtype, int module) {
+unsigned int RLMachine::PackModuleNumber(int modtype, int module) const {
   return (modtype << 8) | module;
 }
 
@@ -666,6 +717,12 @@ void RLMachine::RecordUndefinedOpcodeCounts() {
   undefined_log_.reset(new OpcodeLog);
 }
 
+SaveGameIndex& RLMachine::save_game_index() {
+  if (!save_game_index_)
+    save_game_index_.reset(new SaveGameIndex(system().GameSaveDirectory()));
+  return *save_game_index_;
+}
+
 void RLMachine::Halt() { halted_ = true; }
 
 void RLMachine::SetHaltOnException(bool halt_on_exception) {
@@ -714,13 +771,19 @@ void RLMachine::load(Archive& ar, unsigned int version) {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void RLMachine::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void RLMachine::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void RLMachine::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void RLMachine::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
@@ -50,7 +50,9 @@ class LongOperation;
 class Memory;
 class OpcodeLog;
 class RLModule;
+class RLOperation;
 class RealLiveDLL;
+class SaveGameIndex;
 class System;
 struct StackFrame;
 
@@ -170,17 +172,22 @@ class RLMachine {
   // Push a new stack frame onto the call stack
   void Farcall(int scenario, int entrypoint);
 
+  // Tells every attached module that |scenario| is about to run from
+  // |entrypoint|. Jump() and Farcall() call this themselves.
+  void NotifySceneEntered(const libreallive::Scenario& scenario,
+                          libreallive::Scenario::const_iterator entrypoint);
+
   // Return from the most recent farcall().
   void ReturnFromFarcall();
 
   // Permanently moves the instruction pointer to the passed in
-  // iterator in the current stack frame.
-  void GotoLocation(libreallive::BytecodeList::iterator new_location);
+  // instruction in the current stack frame's scenario.
+  void GotoLocation(libreallive::pointer_t new_location);
 
   // Pushes a new stack frame onto the call stack, saving the current
   // location. The new frame contains the current SEEN with
   // new_location as the instruction pointer.
-  void Gosub(libreallive::BytecodeList::iterator new_location);
+  void Gosub(libreallive::pointer_t new_location);
 
   // Returns from the most recent gosub call. Throws if there's a mismatch
   // between farcall()/rtl() gosub()/ret() pairs.
@@ -210,6 +217,10 @@ class RLMachine {
   // Returns the actual Scenario on the top top of the call stack.
   const libreallive::Scenario& Scenario() const;
 
+  // Returns the instruction pointer on the top of the call stack, which
+  // points into Scenario().
+  libreallive::Scenario::const_iterator CurrentInstruction() const;
+
   // ------------------------------------------------ [ Execution interface ]
   // Normally, execute_next_instruction will call RunOnMachine() on
   // whatever BytecodeElement is currently pointed to by the
@@ -236,6 +247,12 @@ class RLMachine {
   int GetProbableEncodingType() const;
 
   void ExecuteCommand(const libreallive::CommandElement& f);
+
+  // Returns the operation an attached module registered for |f|, or NULL.
+  // Doesn't touch the dispatch cache, so it's safe to call from other threads
+  // as long as no modules are being attached.
+  RLOperation* FindOperation(const libreallive::CommandElement& f) const;
+
   void ExecuteExpression(const libreallive::ExpressionElement& e);
   void PerformTextout(const libreallive::TextoutElement& e);
   void PerformTextout(const std::string& cp932str);
@@ -305,6 +322,12 @@ class RLMachine {
 
   // ---------------------------------------------------------------------
 
+  // Returns the index of the save games in the system's save directory,
+  // creating it on first use.
+  SaveGameIndex& save_game_index();
+
+  // ---------------------------------------------------------------------
+
   // Force the machine to halt. This should terminate the execution of
   // bytecode, and theoretically, the program.
   void Halt();
@@ -314,7 +337,7 @@ class RLMachine {
   // it will.
   void SetHaltOnException(bool halt_on_exception);
 
-  unsigned int PackModuleNumber(int modtype, int module);
+  unsigned int PackModuleNumber(int modtype, int module) const;
 
   // Pushes a stack frame onto the call stack, alerting possible
   // LongOperations of this change if needed.
@@ -362,6 +385,11 @@ class RLMachine {
   // Mapping between the module_type:module pair and the module implementation
   ModuleMap modules_;
 
+  // Identifies this machine and its current set of modules to the operation
+  // cache on CommandElement. Unique across all machines, since several can
+  // run the same Archive, and changed whenever a module is attached.
+  unsigned int dispatch_generation_;
+
   // States whether the RLMachine is in the halted state (and thus won't
   // execute more instructions)
   bool halted_ = false;
@@ -393,6 +421,9 @@ class RLMachine {
   // undefined opcodes.
   std::unique_ptr<OpcodeLog> undefined_log_;
 
+  // Lazily created by save_game_index().
+  std::unique_ptr<SaveGameIndex> save_game_index_;
+
   // Override defaults
   bool mark_savepoints_ = true;
 
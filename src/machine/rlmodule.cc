@@ -95,6 +95,7 @@ void RLModule::AddUnsupportedOpcode(int opcode,
 }
 
 void RLModule::SetProperty(int property, int value) {
+  RLOperation::property_generation_++;
   if (!property_list_) {
     property_list_.reset(new std::vector<std::pair<int, int>>);
   }
@@ -137,29 +138,45 @@ std::string RLModule::GetCommandName(RLMachine& machine,
   return name;
 }
 
-void RLModule::DispatchFunction(RLMachine& machine,
-                                const libreallive::CommandElement& f) {
+RLOperation* RLModule::FindOperation(const libreallive::CommandElement& f) {
   OpcodeMap::iterator it =
       stored_operations_.find(PackOpcodeNumber(f.opcode(), f.overload()));
-  if (it != stored_operations_.end()) {
-    try {
-      if (machine.is_tracing_on()) {
-        std::cerr << "(SEEN" << std::setw(4) << std::setfill('0')
-                  << machine.SceneNumber()
-                  << ")(Line " << std::setw(4) << std::setfill('0')
-                  << machine.line_number() << "): " << it->second->name();
-        libreallive::PrintParameterString(std::cerr,
-                                          f.GetUnparsedParameters());
-        std::cerr << std::endl;
-      }
-      it->second->DispatchFunction(machine, f);
-    }
-    catch (rlvm::Exception& e) {
-      e.setOperation(it->second.get());
-      throw;
-    }
-  } else {
+  return it != stored_operations_.end() ? it->second.get() : nullptr;
+}
+
+void RLModule::DispatchFunction(RLMachine& machine,
+                                const libreallive::CommandElement& f) {
+  RLOperation* op = FindOperation(f);
+  if (op)
+    DispatchOperation(machine, *op, f);
+  else
     throw rlvm::UnimplementedOpcode(machine, f);
+}
+
+void RLModule::SceneEntered(RLMachine& machine,
+                            const libreallive::Scenario& scenario,
+                            libreallive::Scenario::const_iterator entrypoint) {
+}
+
+// static
+void RLModule::DispatchOperation(RLMachine& machine,
+                                 RLOperation& op,
+                                 const libreallive::CommandElement& f) {
+  try {
+    if (machine.is_tracing_on()) {
+      std::cerr << "(SEEN" << std::setw(4) << std::setfill('0')
+                << machine.SceneNumber()
+                << ")(Line " << std::setw(4) << std::setfill('0')
+                << machine.line_number() << "): " << op.name();
+      libreallive::PrintParameterString(std::cerr,
+                                        f.GetUnparsedParameters());
+      std::cerr << std::endl;
+    }
+    op.DispatchFunction(machine, f);
+  }
+  catch (rlvm::Exception& e) {
+    e.setOperation(&op);
+    throw;
   }
 }
 
@@ -35,6 +35,8 @@
 #include <utility>
 #include <vector>
 
+#include "libreallive/scenario.h"
+
 namespace libreallive {
 class CommandElement;
 };
@@ -130,6 +132,21 @@ class RLModule {
   void DispatchFunction(RLMachine& machine,
                         const libreallive::CommandElement& f);
 
+  // Returns the RLOperation implementing |f| in this module, or NULL.
+  RLOperation* FindOperation(const libreallive::CommandElement& f);
+
+  // Called when |machine| starts running |scenario| at |entrypoint|: after a
+  // jump or a farcall, and after a save is loaded. Modules that get ready
+  // for what a scene is about to do override this. Does nothing by default.
+  virtual void SceneEntered(RLMachine& machine,
+                            const libreallive::Scenario& scenario,
+                            libreallive::Scenario::const_iterator entrypoint);
+
+  // Executes |f| with |op|, which was found through FindOperation().
+  static void DispatchOperation(RLMachine& machine,
+                                RLOperation& op,
+                                const libreallive::CommandElement& f);
+
   std::string GetCommandName(RLMachine& machine,
                              const libreallive::CommandElement& f);
 
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "libreallive/bytecode.h"
+#include "machine/memory.h"
 #include "machine/rloperation/references.h"
 #include "machine/rlmachine.h"
 #include "machine/rlmodule.h"
@@ -46,7 +47,10 @@ RLOperation::RLOperation() : name_() {}
 
 RLOperation::~RLOperation() {}
 
+unsigned int RLOperation::property_generation_ = 1;
+
 RLOperation* RLOperation::SetProperty(int property, int value) {
+  property_generation_++;
   if (!property_list_) {
     property_list_.reset(new std::vector<std::pair<int, int>>);
   }
@@ -63,6 +67,19 @@ RLOperation* RLOperation::SetProperty(int property, int value) {
 }
 
 bool RLOperation::GetProperty(int property, int& value) const {
+  if (property < 0 || property >= kCachedPropertyCount)
+    return LookupProperty(property, value);
+
+  if (resolved_generation_ != property_generation_)
+    ResolveProperties();
+  if (resolved_present_ & (1u << property)) {
+    value = resolved_values_[property];
+    return true;
+  }
+  return false;
+}
+
+bool RLOperation::LookupProperty(int property, int& value) const {
   if (property_list_) {
     PropertyList::iterator it = FindProperty(property);
     if (it != property_list_->end()) {
@@ -79,6 +96,15 @@ bool RLOperation::GetProperty(int property, int& value) const {
   return false;
 }
 
+void RLOperation::ResolveProperties() const {
+  resolved_present_ = 0;
+  for (int i = 0; i < kCachedPropertyCount; ++i) {
+    if (LookupProperty(i, resolved_values_[i]))
+      resolved_present_ |= 1u << i;
+  }
+  resolved_generation_ = property_generation_;
+}
+
 RLOperation::PropertyList::iterator RLOperation::FindProperty(int property)
     const {
   return find_if(property_list_->begin(),
@@ -133,6 +159,7 @@ void IntConstant_T::ParseParameters(
     throw rlvm::Exception(oss.str());
   }
 
+  ep.CompileIntegerValue();
   output.push_back(std::move(ep));
   position++;
 }
@@ -223,6 +250,36 @@ void StrConstant_T::ParseParameters(
   position++;
 }
 
+BorrowedString::BorrowedString(BorrowedString&& rhs)
+    : owned_(std::move(rhs.owned_)),
+      str_(rhs.str_ == &rhs.owned_ ? &owned_ : rhs.str_) {}
+
+BorrowedString StrRef_T::getData(RLMachine& machine,
+                                 const libreallive::ExpressionPiecesVector& p,
+                                 unsigned int& position) {
+  const libreallive::ExpressionPiece& piece = p[position++];
+  const std::string& value = piece.GetStringValue(machine);
+  if (!piece.IsMemoryReference())
+    return BorrowedString(value);
+
+  // strS[] and strM[] are fixed arrays; anything else (strK[]) is copied.
+  const Memory& memory = machine.memory();
+  const std::string* strs = memory.local().strS;
+  const std::string* strm = memory.global().strM;
+  if ((&value >= strs && &value < strs + SIZE_OF_MEM_BANK) ||
+      (&value >= strm && &value < strm + SIZE_OF_MEM_BANK)) {
+    return BorrowedString(value);
+  }
+
+  return BorrowedString(std::string(value));
+}
+
+void StrRef_T::ParseParameters(unsigned int& position,
+                               const std::vector<std::string>& input,
+                               libreallive::ExpressionPiecesVector& output) {
+  StrConstant_T::ParseParameters(position, input, output);
+}
+
 StrReference_T::type StrReference_T::getData(
     RLMachine& machine,
     const libreallive::ExpressionPiecesVector& p,
@@ -304,6 +361,10 @@ template class RLNormalOpcode<StrConstant_T>;
 template class RLNormalOpcode<StrConstant_T, IntConstant_T>;
 template class RLNormalOpcode<StrConstant_T, StrConstant_T>;
 template class RLNormalOpcode<StrReference_T>;
+template class RLNormalOpcode<IntConstant_T, StrRef_T>;
+template class RLNormalOpcode<StrRef_T>;
+template class RLNormalOpcode<StrRef_T, IntConstant_T>;
+template class RLNormalOpcode<StrReference_T, StrRef_T>;
 
 template class RLOpcode<>;
 template class RLOpcode<IntConstant_T>;
@@ -318,3 +379,7 @@ template class RLOpcode<StrConstant_T>;
 template class RLOpcode<StrConstant_T, IntConstant_T>;
 template class RLOpcode<StrConstant_T, StrConstant_T>;
 template class RLOpcode<StrReference_T>;
+template class RLOpcode<IntConstant_T, StrRef_T>;
+template class RLOpcode<StrRef_T>;
+template class RLOpcode<StrRef_T, IntConstant_T>;
+template class RLOpcode<StrReference_T, StrRef_T>;
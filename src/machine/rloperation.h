@@ -52,8 +52,8 @@ class RLModule;
 // parameters.
 //
 // Valid type parameters are IntConstant_T, IntReference_T,
-// StrConstant_T, StrReference_T, Argc_T< U > (takes another type as a
-// parameter). The type parameters change the arguments to the
+// StrConstant_T, StrRef_T, StrReference_T, Argc_T< U > (takes another type
+// as a parameter). The type parameters change the arguments to the
 // implementation function.
 //
 // Let's say we want to implement an operation with the following
@@ -134,9 +134,24 @@ class RLOperation {
   typedef std::pair<int, int> Property;
   typedef std::vector<Property> PropertyList;
 
+  // Properties with ids below this are resolved into a flat table the first
+  // time one of them is asked for, so GetProperty() doesn't search this
+  // operation's list and then its module's on every call.
+  static const int kCachedPropertyCount = 4;
+
   // Searches for a property on this object.
   PropertyList::iterator FindProperty(int property) const;
 
+  // Looks |property| up on this operation, then on its module.
+  bool LookupProperty(int property, int& value) const;
+
+  // Fills the resolved property table.
+  void ResolveProperties() const;
+
+  // Bumped by every SetProperty() on an operation or module, invalidating all
+  // resolved property tables.
+  static unsigned int property_generation_;
+
   // Our properties (for the number of properties O(n) is faster than O(log
   // n)...)
   std::unique_ptr<PropertyList> property_list_;
@@ -146,6 +161,13 @@ class RLOperation {
 
   // The human readable name for this operation
   std::string name_;
+
+  // The resolved property table, valid while |resolved_generation_| matches
+  // |property_generation_|. Bit i of |resolved_present_| is set if property
+  // i has a value.
+  mutable unsigned int resolved_generation_ = 0;
+  mutable unsigned int resolved_present_ = 0;
+  mutable int resolved_values_[kCachedPropertyCount];
 };
 
 // Type definition for a Constant integer value.
@@ -194,6 +216,53 @@ struct StrConstant_T {
   enum { is_complex = false };
 };
 
+// The value StrRef_T::getData() hands to Dispatch. Usually this is just a
+// pointer to the string in the bytecode or in strS[]/strM[], which stay put
+// for the length of the call. strK[] lives in a vector in the current stack
+// frame that an assignment can resize, so those strings are copied instead.
+class BorrowedString {
+ public:
+  explicit BorrowedString(const std::string& borrowed) : str_(&borrowed) {}
+  explicit BorrowedString(std::string&& owned)
+      : owned_(std::move(owned)), str_(&owned_) {}
+  BorrowedString(BorrowedString&& rhs);
+
+  // Only lvalues convert; binding a reference to a temporary BorrowedString
+  // would dangle as soon as an owned copy is destroyed.
+  operator const std::string&() const& { return *str_; }
+  operator const std::string&() const&& = delete;
+
+ private:
+  std::string owned_;
+  const std::string* str_;
+};
+
+// Type definition for a borrowed string value.
+//
+// Works like StrConstant_T, except that operator() receives a const
+// reference to the string instead of its own copy, so passing a string
+// through Dispatch costs no allocations. Implementations that need to keep
+// the value must copy it, and ones that write to string memory must be done
+// reading the argument first, since it may alias the destination. Because
+// the value only lives for the duration of Dispatch, this type can't be
+// composed into Argc_T or Complex_T.
+struct StrRef_T {
+  // The output type of this type struct
+  typedef const std::string& type;
+
+  // Convert the incoming parameter objects into the resulting type
+  static BorrowedString getData(RLMachine& machine,
+                                const libreallive::ExpressionPiecesVector& p,
+                                unsigned int& position);
+
+  // Parse the raw parameter string and put the results in ExpressionPiece
+  static void ParseParameters(unsigned int& position,
+                              const std::vector<std::string>& input,
+                              libreallive::ExpressionPiecesVector& output);
+
+  enum { is_complex = false };
+};
+
 struct empty_struct {};
 
 // Defines a null type for the Special parameter.
@@ -296,6 +365,19 @@ template<typename ... Types>
 struct make_indexes : make_indexes_impl<0, index_tuple<>, Types...>
 {};
 
+// What Dispatch stores in its argument tuple for each parameter type. This is
+// the type itself, except for borrowed types whose backing value has to
+// outlive the call to operator().
+template <typename T>
+struct DispatchStorage {
+  typedef typename T::type type;
+};
+
+template <>
+struct DispatchStorage<StrRef_T> {
+  typedef BorrowedString type;
+};
+
 }  // namespace internal
 
 // This is the fourth time we have overhauled the implementation of RLOperation
@@ -345,9 +427,12 @@ class RLOpcode : public RLNormalOpcode<Args...> {
   virtual void operator()(RLMachine&, typename Args::type...) = 0;
 
  private:
+  typedef std::tuple<typename internal::DispatchStorage<Args>::type...>
+      ArgumentTuple;
+
   template<int... Indexes>
   void DispatchImpl(RLMachine& machine,
-                    const std::tuple<typename Args::type...>& args,
+                    const ArgumentTuple& args,
                     internal::index_tuple<Indexes...>) {
     operator()(machine, std::get<Indexes>(args)...);
   }
@@ -369,10 +454,7 @@ void RLOpcode<Args...>::Dispatch(
   //
   // http://stackoverflow.com/questions/12048221/c11-variadic-template-function-parameter-pack-expansion-execution-order
   unsigned int position = 0;
-  std::tuple<typename Args::type...> tuple =
-      std::tuple<typename Args::type...>{
-    Args::getData(machine, parameters, position)...
-  };
+  ArgumentTuple tuple{Args::getData(machine, parameters, position)...};
   DispatchImpl(machine, tuple,
                typename internal::make_indexes<Args...>::type());
 }
@@ -401,6 +483,10 @@ extern template class RLNormalOpcode<StrConstant_T>;
 extern template class RLNormalOpcode<StrConstant_T, IntConstant_T>;
 extern template class RLNormalOpcode<StrConstant_T, StrConstant_T>;
 extern template class RLNormalOpcode<StrReference_T>;
+extern template class RLNormalOpcode<IntConstant_T, StrRef_T>;
+extern template class RLNormalOpcode<StrRef_T>;
+extern template class RLNormalOpcode<StrRef_T, IntConstant_T>;
+extern template class RLNormalOpcode<StrReference_T, StrRef_T>;
 
 extern template class RLOpcode<>;
 extern template class RLOpcode<IntConstant_T>;
@@ -415,5 +501,9 @@ extern template class RLOpcode<StrConstant_T>;
 extern template class RLOpcode<StrConstant_T, IntConstant_T>;
 extern template class RLOpcode<StrConstant_T, StrConstant_T>;
 extern template class RLOpcode<StrReference_T>;
+extern template class RLOpcode<IntConstant_T, StrRef_T>;
+extern template class RLOpcode<StrRef_T>;
+extern template class RLOpcode<StrRef_T, IntConstant_T>;
+extern template class RLOpcode<StrReference_T, StrRef_T>;
 
 #endif  // SRC_MACHINE_RLOPERATION_H_
@@ -73,6 +73,7 @@ void Complex_T<Args...>::ParseParameters(
     libreallive::ExpressionPiecesVector& output) {
   const char* data = input.at(position).c_str();
   libreallive::ExpressionPiece ep(libreallive::GetComplexParam(data));
+  ep.CompileIntegerValue();
   output.push_back(std::move(ep));
   position++;
 }
@@ -40,3 +40,5 @@ template class RLStoreOpcode<IntConstant_T>;
 template class RLStoreOpcode<IntConstant_T, IntConstant_T>;
 template class RLStoreOpcode<IntReference_T>;
 template class RLStoreOpcode<IntReference_T, IntReference_T>;
+template class RLStoreOpcode<StrRef_T>;
+template class RLStoreOpcode<StrRef_T, StrRef_T>;
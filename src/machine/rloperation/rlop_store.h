@@ -39,9 +39,12 @@ class RLStoreOpcode : public RLNormalOpcode<Args...> {
   virtual int operator()(RLMachine&, typename Args::type...) = 0;
 
  private:
+  typedef std::tuple<typename internal::DispatchStorage<Args>::type...>
+      ArgumentTuple;
+
   template<int... Indexes>
   void DispatchImpl(RLMachine& machine,
-                    const std::tuple<typename Args::type...>& args,
+                    const ArgumentTuple& args,
                     internal::index_tuple<Indexes...>) {
     int store = operator()(machine, std::get<Indexes>(args)...);
     machine.set_store_register(store);
@@ -64,10 +67,7 @@ void RLStoreOpcode<Args...>::Dispatch(
   //
   // http://stackoverflow.com/questions/12048221/c11-variadic-template-function-parameter-pack-expansion-execution-order
   unsigned int position = 0;
-  std::tuple<typename Args::type...> tuple =
-      std::tuple<typename Args::type...>{
-    Args::getData(machine, parameters, position)...
-  };
+  ArgumentTuple tuple{Args::getData(machine, parameters, position)...};
   DispatchImpl(machine, tuple,
                typename internal::make_indexes<Args...>::type());
 }
@@ -82,5 +82,7 @@ extern template class RLStoreOpcode<IntConstant_T>;
 extern template class RLStoreOpcode<IntConstant_T, IntConstant_T>;
 extern template class RLStoreOpcode<IntReference_T>;
 extern template class RLStoreOpcode<IntReference_T, IntReference_T>;
+extern template class RLStoreOpcode<StrRef_T>;
+extern template class RLStoreOpcode<StrRef_T, StrRef_T>;
 
 #endif  // SRC_MACHINE_RLOPERATION_RLOP_STORE_H_
@@ -156,6 +156,7 @@ struct Special_T {
                               libreallive::ExpressionPiecesVector& output) {
     const char* data = input.at(position).c_str();
     output.emplace_back(libreallive::GetData(data));
+    output.back().CompileIntegerValue();
     position++;
   }
 
@@ -67,7 +67,11 @@ RLVMInstance::RLVMInstance()
       count_undefined_copcodes_(false),
       tracing_(false),
       load_save_(-1),
-      dump_seen_(-1) {
+      dump_seen_(-1),
+      preparse_threads_(0),
+      image_cache_megabytes_(-1),
+      backlog_pages_(-1),
+      backlog_megabytes_(-1) {
   srand(time(NULL));
 }
 
@@ -103,6 +107,14 @@ void RLVMInstance::Run(const boost::filesystem::path& gamerootPath) {
       gameexe("__GAMEFONT") = custom_font_;
     }
 
+    if (image_cache_megabytes_ >= 0)
+      gameexe("__IMAGE_CACHE_MB") = image_cache_megabytes_;
+
+    if (backlog_pages_ >= 0)
+      gameexe("__BACKLOG_PAGES") = backlog_pages_;
+    if (backlog_megabytes_ >= 0)
+      gameexe("__BACKLOG_MB") = backlog_megabytes_;
+
     libreallive::Archive arc(seenPath.string(), gameexe("REGNAME"));
     SDLSystem sdlSystem(gameexe);
     RLMachine rlmachine(sdlSystem, arc);
@@ -140,6 +152,8 @@ void RLVMInstance::Run(const boost::filesystem::path& gamerootPath) {
     if (tracing_)
       rlmachine.set_tracing_on();
 
+    arc.StartBackgroundParsing(preparse_threads_);
+
     Serialization::loadGlobalMemory(rlmachine);
 
     // Now to preform a quick integrity check. If the user opened the Japanese
@@ -181,7 +195,7 @@ void RLVMInstance::Run(const boost::filesystem::path& gamerootPath) {
       sdlSystem.set_force_wait(false);
     }
 
-    Serialization::saveGlobalMemory(rlmachine);
+    Serialization::compactGlobalMemory(rlmachine);
   }
   catch (rlvm::UserPresentableError& e) {
     ReportFatalError(e.message_text(), e.informative_text());
@@ -53,6 +53,10 @@ class RLVMInstance {
   void set_custom_font(const std::string& font) { custom_font_ = font; }
 
   void set_dump_seen(int in) { dump_seen_ = in; }
+  void set_preparse_threads(int in) { preparse_threads_ = in; }
+  void set_image_cache_megabytes(int in) { image_cache_megabytes_ = in; }
+  void set_backlog_pages(int in) { backlog_pages_ = in; }
+  void set_backlog_megabytes(int in) { backlog_megabytes_ = in; }
 
   // Optionally brings up a file selection dialog to get the game directory. In
   // case this isn't implemented or the user clicks cancel, returns an empty
@@ -110,6 +114,18 @@ class RLVMInstance {
 
   // Dumps pseudo-kepago of the current seen to stdout and exit if not -1.
   int dump_seen_;
+
+  // Number of threads parsing scenarios ahead of use (0 to parse on demand).
+  int preparse_threads_;
+
+  // Byte budget of the graphics system's image cache in megabytes, or -1 for
+  // the default.
+  int image_cache_megabytes_;
+
+  // Limits on the text backlog, in pages and megabytes, or -1 for the
+  // defaults.
+  int backlog_pages_;
+  int backlog_megabytes_;
 };
 
 #endif  // SRC_MACHINE_RLVM_INSTANCE_H_
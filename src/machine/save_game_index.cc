@@ -0,0 +1,385 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "machine/save_game_index.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "libreallive/defs.h"
+#include "machine/serialization.h"
+#include "systems/base/rect.h"
+#include "systems/base/surface.h"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// The index file is:
+//
+//   "RLVMSIDX"
+//   i32  kIndexVersion
+//   i32  number of entries
+//
+// followed by each entry:
+//
+//   i32  slot
+//   i64  save file modification time
+//   i64  save file size
+//   i64  save time, microseconds since 1970 (local time)
+//   i32  title length
+//        title
+//   i32  thumbnail width
+//   i32  thumbnail height
+//        thumbnail pixels
+//
+// All integers are little endian; i64s are stored low word first.
+const char kIndexFilename[] = "saveindex.dat";
+const char kMagic[] = "RLVMSIDX";
+const size_t kMagicLength = 8;
+const int kIndexVersion = 1;
+
+const boost::posix_time::ptime kEpoch(boost::gregorian::date(1970, 1, 1));
+
+void AppendInt(std::string& out, int value) {
+  size_t pos = out.size();
+  out.resize(pos + 4);
+  libreallive::insert_i32(out, pos, value);
+}
+
+void AppendInt64(std::string& out, int64_t value) {
+  AppendInt(out, value & 0xffffffff);
+  AppendInt(out, value >> 32);
+}
+
+// Bounds checked reads out of the index file.
+class IndexReader {
+ public:
+  explicit IndexReader(const std::string& data) : data_(data), pos_(0) {}
+
+  bool ReadInt(int& value) {
+    if (data_.size() - pos_ < 4)
+      return false;
+    value = libreallive::read_i32(data_, pos_);
+    pos_ += 4;
+    return true;
+  }
+
+  bool ReadInt64(int64_t& value) {
+    int low, high;
+    if (!ReadInt(low) || !ReadInt(high))
+      return false;
+    value = uint32_t(low) | (int64_t(high) << 32);
+    return true;
+  }
+
+  bool ReadBytes(size_t length, std::string& out) {
+    if (data_.size() - pos_ < length)
+      return false;
+    out.assign(data_, pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+};
+
+// Returns the slot of a file named by SaveGameIndex::FilenameForSlot(), or
+// -1.
+int SlotForFilename(const std::string& filename) {
+  if (filename.size() != 14 || !boost::starts_with(filename, "save") ||
+      !boost::ends_with(filename, ".sav.gz"))
+    return -1;
+
+  int slot = 0;
+  for (int i = 4; i < 7; ++i) {
+    if (filename[i] < '0' || filename[i] > '9')
+      return -1;
+    slot = slot * 10 + (filename[i] - '0');
+  }
+  return slot;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// SaveGameIndex::Entry
+// -----------------------------------------------------------------------
+SaveGameIndex::Entry::Entry()
+    : mtime(0), size(0), thumbnail_width(0), thumbnail_height(0) {}
+
+// -----------------------------------------------------------------------
+// SaveGameIndex
+// -----------------------------------------------------------------------
+const int SaveGameIndex::kThumbnailWidth;
+
+SaveGameIndex::SaveGameIndex(const fs::path& directory)
+    : directory_(directory), loaded_(false) {}
+
+SaveGameIndex::~SaveGameIndex() {}
+
+// static
+std::string SaveGameIndex::FilenameForSlot(int slot) {
+  std::ostringstream oss;
+  oss << "save" << std::setw(3) << std::setfill('0') << slot << ".sav.gz";
+  return oss.str();
+}
+
+const SaveGameIndex::Entry* SaveGameIndex::Find(int slot) {
+  if (!loaded_ && !Load())
+    Rescan();
+
+  fs::path path = directory_ / FilenameForSlot(slot);
+  boost::system::error_code ec;
+  std::time_t mtime = fs::last_write_time(path, ec);
+  if (ec)
+    return NULL;
+  uintmax_t size = fs::file_size(path, ec);
+  if (ec)
+    return NULL;
+
+  auto bad = unreadable_.find(slot);
+  if (bad != unreadable_.end() && bad->second == std::make_pair(mtime, size))
+    return NULL;
+
+  auto it = entries_.find(slot);
+  if (it == entries_.end() || it->second.mtime != mtime ||
+      it->second.size != size) {
+    Rescan();
+    it = entries_.find(slot);
+  }
+
+  return it != entries_.end() ? &it->second : NULL;
+}
+
+void SaveGameIndex::Update(int slot,
+                           const SaveGameHeader& header,
+                           const Surface* screenshot) {
+  if (!loaded_ && !Load())
+    Rescan();
+
+  unreadable_.erase(slot);
+
+  fs::path path = directory_ / FilenameForSlot(slot);
+  boost::system::error_code ec;
+  std::time_t mtime = fs::last_write_time(path, ec);
+  uintmax_t file_size = ec ? 0 : fs::file_size(path, ec);
+  if (ec) {
+    // The save itself was written; leave the slot for Find() to rescan.
+    std::cerr << "WARNING: Couldn't index " << path << ": " << ec.message()
+              << std::endl;
+    entries_.erase(slot);
+    return;
+  }
+
+  Entry& entry = entries_[slot];
+  entry.header = header;
+  entry.mtime = mtime;
+  entry.size = file_size;
+  entry.thumbnail_width = 0;
+  entry.thumbnail_height = 0;
+  entry.thumbnail.clear();
+
+  if (screenshot) {
+    Size size = screenshot->GetSize();
+    if (size.width() > 0 && size.height() > 0) {
+      entry.thumbnail_width = kThumbnailWidth;
+      entry.thumbnail_height =
+          std::max(1, size.height() * kThumbnailWidth / size.width());
+      entry.thumbnail.reserve(entry.thumbnail_width * entry.thumbnail_height *
+                              3);
+      for (int y = 0; y < entry.thumbnail_height; ++y) {
+        for (int x = 0; x < entry.thumbnail_width; ++x) {
+          int r = 0, g = 0, b = 0;
+          screenshot->GetDCPixel(
+              Point(x * size.width() / entry.thumbnail_width,
+                    y * size.height() / entry.thumbnail_height),
+              r, g, b);
+          entry.thumbnail.push_back(r);
+          entry.thumbnail.push_back(g);
+          entry.thumbnail.push_back(b);
+        }
+      }
+    }
+  }
+
+  try {
+    Write();
+  }
+  catch (std::exception& e) {
+    std::cerr << "WARNING: Couldn't write save game index: " << e.what()
+              << std::endl;
+  }
+}
+
+bool SaveGameIndex::Load() {
+  loaded_ = true;
+  entries_.clear();
+
+  fs::ifstream file(directory_ / kIndexFilename, std::ios::binary);
+  if (!file)
+    return false;
+  std::string data((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+
+  IndexReader reader(data);
+  std::string magic;
+  int version, count;
+  if (!reader.ReadBytes(kMagicLength, magic) || magic != kMagic ||
+      !reader.ReadInt(version) || version != kIndexVersion ||
+      !reader.ReadInt(count))
+    return false;
+
+  for (int i = 0; i < count; ++i) {
+    Entry entry;
+    int slot, title_length;
+    int64_t mtime, size, save_time;
+    std::string pixels;
+    if (!reader.ReadInt(slot) || !reader.ReadInt64(mtime) ||
+        !reader.ReadInt64(size) || !reader.ReadInt64(save_time) ||
+        !reader.ReadInt(title_length) || title_length < 0 ||
+        !reader.ReadBytes(title_length, entry.header.title) ||
+        !reader.ReadInt(entry.thumbnail_width) ||
+        !reader.ReadInt(entry.thumbnail_height) ||
+        entry.thumbnail_width < 0 || entry.thumbnail_height < 0 ||
+        !reader.ReadBytes(
+            size_t(entry.thumbnail_width) * entry.thumbnail_height * 3,
+            pixels)) {
+      entries_.clear();
+      return false;
+    }
+
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.header.save_time = kEpoch + boost::posix_time::microseconds(save_time);
+    entry.thumbnail.assign(pixels.begin(), pixels.end());
+    entries_[slot] = entry;
+  }
+
+  return true;
+}
+
+void SaveGameIndex::Rescan() {
+  loaded_ = true;
+
+  std::map<int, Entry> entries;
+  std::map<int, std::pair<std::time_t, uintmax_t>> unreadable;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(directory_, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    int slot = SlotForFilename(it->path().filename().string());
+    if (slot == -1)
+      continue;
+
+    Entry entry;
+    entry.mtime = fs::last_write_time(it->path(), ec);
+    entry.size = fs::file_size(it->path(), ec);
+    if (ec) {
+      ec.clear();
+      continue;
+    }
+
+    auto old = entries_.find(slot);
+    if (old != entries_.end() && old->second.mtime == entry.mtime &&
+        old->second.size == entry.size) {
+      entries[slot] = old->second;
+      continue;
+    }
+
+    std::pair<std::time_t, uintmax_t> stamp(entry.mtime, entry.size);
+    auto bad = unreadable_.find(slot);
+    if (bad != unreadable_.end() && bad->second == stamp) {
+      unreadable[slot] = stamp;
+      continue;
+    }
+
+    try {
+      fs::ifstream file(it->path(), std::ios::binary);
+      entry.header = Serialization::loadHeaderFrom(file);
+      entries[slot] = entry;
+    }
+    catch (std::exception& e) {
+      std::cerr << "WARNING: Couldn't read the header of " << it->path()
+                << ": " << e.what() << std::endl;
+      unreadable[slot] = stamp;
+    }
+  }
+
+  entries_.swap(entries);
+  unreadable_.swap(unreadable);
+
+  try {
+    Write();
+  }
+  catch (std::exception& e) {
+    // The index is only a cache; we can still list saves without it.
+    std::cerr << "WARNING: Couldn't write save game index: " << e.what()
+              << std::endl;
+  }
+}
+
+void SaveGameIndex::Write() const {
+  std::string out(kMagic, kMagicLength);
+  AppendInt(out, kIndexVersion);
+  AppendInt(out, entries_.size());
+  for (auto const& it : entries_) {
+    const Entry& entry = it.second;
+    AppendInt(out, it.first);
+    AppendInt64(out, entry.mtime);
+    AppendInt64(out, entry.size);
+    AppendInt64(out, (entry.header.save_time - kEpoch).total_microseconds());
+    AppendInt(out, entry.header.title.size());
+    out += entry.header.title;
+    AppendInt(out, entry.thumbnail_width);
+    AppendInt(out, entry.thumbnail_height);
+    out.append(entry.thumbnail.begin(), entry.thumbnail.end());
+  }
+
+  fs::path path = directory_ / kIndexFilename;
+  fs::path temp(path.string() + ".tmp");
+  {
+    fs::ofstream file(temp, std::ios::binary);
+    file.write(out.data(), out.size());
+    file.flush();
+    if (!file)
+      throw std::runtime_error("Couldn't write " + temp.string());
+  }
+  fs::rename(temp, path);
+}
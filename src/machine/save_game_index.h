@@ -0,0 +1,113 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_MACHINE_SAVE_GAME_INDEX_H_
+#define SRC_MACHINE_SAVE_GAME_INDEX_H_
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "machine/save_game_header.h"
+
+class Surface;
+
+// An index of the header of every save game in a directory, kept in a single
+// file next to them so the load and save menus don't have to open, inflate
+// and parse every slot's file to list them.
+//
+// Each entry remembers the modification time and size of the save file it
+// describes; when either no longer matches, or when the index file is missing
+// or unreadable, the directory is rescanned and the headers of the changed
+// files are read again.
+class SaveGameIndex {
+ public:
+  struct Entry {
+    Entry();
+
+    SaveGameHeader header;
+
+    // The save file's modification time and size when it was indexed.
+    std::time_t mtime;
+    uintmax_t size;
+
+    // A downscaled RGB screenshot taken at save time, three bytes per pixel
+    // in rows. Empty if there was no screen to capture, or if the entry was
+    // rebuilt from the save file.
+    int thumbnail_width;
+    int thumbnail_height;
+    std::vector<unsigned char> thumbnail;
+  };
+
+  explicit SaveGameIndex(const boost::filesystem::path& directory);
+  ~SaveGameIndex();
+
+  // Returns the name of the save file for |slot|.
+  static std::string FilenameForSlot(int slot);
+
+  // Returns the entry for |slot|, or NULL if there's no readable save in it.
+  const Entry* Find(int slot);
+
+  // Records the save just written to |slot| and writes out the index.
+  // |screenshot| may be NULL. Failures are logged rather than thrown, since
+  // the save itself has already been written.
+  void Update(int slot,
+              const SaveGameHeader& header,
+              const Surface* screenshot);
+
+  // The width thumbnails are scaled to.
+  static const int kThumbnailWidth = 160;
+
+ private:
+  // Reads the index file. Returns false if it's missing or corrupt.
+  bool Load();
+
+  // Drops entries whose files are gone and rereads the headers of new or
+  // changed save files, then writes out the index.
+  void Rescan();
+
+  // Atomically replaces the index file.
+  void Write() const;
+
+  boost::filesystem::path directory_;
+
+  bool loaded_;
+
+  std::map<int, Entry> entries_;
+
+  // The modification time and size of save files whose headers couldn't be
+  // read, so Find() doesn't rescan the directory for them until they change.
+  std::map<int, std::pair<std::time_t, uintmax_t>> unreadable_;
+};
+
+#endif  // SRC_MACHINE_SAVE_GAME_INDEX_H_
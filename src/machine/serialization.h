@@ -46,17 +46,37 @@ namespace Serialization {
 //          here; this is a likely location for errors
 extern RLMachine* g_current_machine;
 
+// Global memory is kept as a full snapshot plus a journal of the entries
+// changed since. saveGlobalMemory() appends what changed since the last save
+// to the journal; compactGlobalMemory() atomically rewrites the snapshot and
+// drops the journal, and should be called on exit.
 void saveGlobalMemory(RLMachine& machine);
+void compactGlobalMemory(RLMachine& machine);
 void saveGlobalMemoryTo(std::ostream& oss, RLMachine& machine);
+void saveGlobalMemoryChangesTo(std::ostream& oss, RLMachine& machine);
 
 void loadGlobalMemory(RLMachine& machine);
 void loadGlobalMemoryFrom(std::istream& iss, RLMachine& machine);
+// Returns false if the journal ended in a torn or malformed record, which was
+// dropped along with anything after it.
+bool loadGlobalMemoryChangesFrom(std::istream& iss, RLMachine& machine);
 
 boost::filesystem::path buildSaveGameFilename(RLMachine& machine, int slot);
 
+// Also records the save, with a thumbnail of the screen, in the machine's
+// SaveGameIndex.
 void saveGameForSlot(RLMachine& machine, int slot);
 void saveGameTo(std::ostream& oss, RLMachine& machine);
+void saveGameTo(std::ostream& oss,
+                RLMachine& machine,
+                const SaveGameHeader& header);
 
+// Writes the zlib'd text archive older versions of rlvm saved games as. The
+// load functions below still read it.
+void saveLegacyGameTo(std::ostream& oss, RLMachine& machine);
+
+// Reads the header from the machine's SaveGameIndex, falling back to the save
+// file if the index doesn't have it.
 SaveGameHeader loadHeaderForSlot(RLMachine& machine, int slot);
 SaveGameHeader loadHeaderFrom(std::istream& iss);
 
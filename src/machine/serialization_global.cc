@@ -28,6 +28,8 @@
 #include "machine/serialization.h"
 
 // include headers that implement a archive in simple text format
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/split_free.hpp>
@@ -42,7 +44,10 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <limits>
+#include <string>
 
+#include "libreallive/defs.h"
 #include "libreallive/intmemref.h"
 #include "machine/memory.h"
 #include "machine/rlmachine.h"
@@ -57,6 +62,120 @@
 
 namespace fs = boost::filesystem;
 
+namespace {
+
+// Between full saves, changes to global memory are appended to a journal next
+// to global.sav.gz. Each record is:
+//
+//   i32  JournalRecord
+//   i32  key (an index into the bank, or a scenario number)
+//   i32  payload length
+//        payload
+//
+// All integers are little endian. Records hold absolute values, so replaying
+// a journal over a snapshot that already contains it changes nothing; a torn
+// record at the end of the journal, or one longer than kMaxJournalSize, is
+// dropped.
+enum JournalRecord {
+  JOURNAL_INT_G = 1,
+  JOURNAL_INT_Z,
+  JOURNAL_STR_M,
+  JOURNAL_GLOBAL_NAME,
+  // Key is the scenario; payload is the kidoku marker that was read.
+  JOURNAL_KIDOKU,
+  // Payload is a binary archive of the System globals.
+  JOURNAL_SYSTEM_GLOBALS
+};
+
+const size_t kRecordHeaderSize = 12;
+
+// Once the journal grows past this, saveGlobalMemory() rewrites the snapshot
+// instead of appending to it.
+const uintmax_t kMaxJournalSize = 256 * 1024;
+
+void AppendRecord(std::string& out,
+                  JournalRecord type,
+                  int key,
+                  const std::string& payload) {
+  size_t pos = out.size();
+  out.resize(pos + kRecordHeaderSize);
+  libreallive::insert_i32(out, pos, type);
+  libreallive::insert_i32(out, pos + 4, key);
+  libreallive::insert_i32(out, pos + 8, payload.size());
+  out += payload;
+}
+
+std::string IntPayload(int value) {
+  std::string payload(4, '\0');
+  libreallive::insert_i32(payload, 0, value);
+  return payload;
+}
+
+std::string SerializeSystemGlobals(System& sys) {
+  std::ostringstream oss(std::ios::binary);
+  {
+    boost::archive::binary_oarchive oa(oss);
+    oa << const_cast<const SystemGlobals&>(sys.globals())
+       << const_cast<const GraphicsSystemGlobals&>(sys.graphics().globals())
+       << const_cast<const EventSystemGlobals&>(sys.event().globals())
+       << const_cast<const TextSystemGlobals&>(sys.text().globals())
+       << const_cast<const SoundSystemGlobals&>(sys.sound().globals());
+  }
+  return oss.str();
+}
+
+// Applies one journal record. Returns false if it's malformed.
+bool ReplayRecord(RLMachine& machine,
+                  int type,
+                  int key,
+                  const std::string& payload) {
+  GlobalMemory& global = machine.memory().global();
+  bool in_bank = key >= 0 && key < SIZE_OF_MEM_BANK;
+  switch (type) {
+    case JOURNAL_INT_G:
+    case JOURNAL_INT_Z:
+      if (!in_bank || payload.size() != 4)
+        return false;
+      (type == JOURNAL_INT_G ? global.intG : global.intZ)[key] =
+          libreallive::read_i32(payload, 0);
+      return true;
+    case JOURNAL_STR_M:
+      if (!in_bank)
+        return false;
+      global.strM[key] = payload;
+      return true;
+    case JOURNAL_GLOBAL_NAME:
+      if (key < 0 || key >= SIZE_OF_NAME_BANK)
+        return false;
+      global.global_names[key] = payload;
+      return true;
+    case JOURNAL_KIDOKU:
+      if (payload.size() != 4 || libreallive::read_i32(payload, 0) < 0)
+        return false;
+      machine.memory().RecordKidoku(key, libreallive::read_i32(payload, 0));
+      return true;
+    case JOURNAL_SYSTEM_GLOBALS: {
+      System& sys = machine.system();
+      try {
+        std::istringstream iss(payload, std::ios::binary);
+        boost::archive::binary_iarchive ia(iss);
+        ia >> sys.globals() >> sys.graphics().globals() >>
+            sys.event().globals() >> sys.text().globals() >>
+            sys.sound().globals();
+      }
+      catch (std::exception&) {
+        return false;
+      }
+      sys.sound().RestoreFromGlobals();
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
 namespace Serialization {
 
 // - Was at 2 was most of rlvm's lifetime.
@@ -70,14 +189,56 @@ fs::path buildGlobalMemoryFilename(RLMachine& machine) {
   return machine.system().GameSaveDirectory() / "global.sav.gz";
 }
 
+fs::path buildGlobalMemoryJournalFilename(RLMachine& machine) {
+  return machine.system().GameSaveDirectory() / "global.journal";
+}
+
 void saveGlobalMemory(RLMachine& machine) {
   fs::path home = buildGlobalMemoryFilename(machine);
-  fs::ofstream file(home, std::ios::binary);
+  fs::path journal = buildGlobalMemoryJournalFilename(machine);
+  if (!fs::exists(home) ||
+      (fs::exists(journal) && fs::file_size(journal) > kMaxJournalSize)) {
+    compactGlobalMemory(machine);
+    return;
+  }
+
+  fs::ofstream file(journal, std::ios::binary | std::ios::app);
   if (!file) {
     throw rlvm::Exception(_("Could not open global memory file."));
   }
 
-  saveGlobalMemoryTo(file, machine);
+  saveGlobalMemoryChangesTo(file, machine);
+}
+
+void compactGlobalMemory(RLMachine& machine) {
+  fs::path home = buildGlobalMemoryFilename(machine);
+  fs::path journal = buildGlobalMemoryJournalFilename(machine);
+
+  // Bring the journal up to date first. If we die between replacing the
+  // snapshot and removing the journal, replaying the journal over the new
+  // snapshot then leaves every entry at its newest value.
+  if (fs::exists(journal)) {
+    fs::ofstream file(journal, std::ios::binary | std::ios::app);
+    if (file)
+      saveGlobalMemoryChangesTo(file, machine);
+  }
+
+  fs::path temp(home.string() + ".tmp");
+  {
+    fs::ofstream file(temp, std::ios::binary);
+    if (!file) {
+      throw rlvm::Exception(_("Could not open global memory file."));
+    }
+
+    saveGlobalMemoryTo(file, machine);
+    file.flush();
+    if (!file) {
+      throw rlvm::Exception(_("Could not write global memory file."));
+    }
+  }
+
+  fs::rename(temp, home);
+  fs::remove(journal);
 }
 
 void saveGlobalMemoryTo(std::ostream& oss, RLMachine& machine) {
@@ -95,6 +256,42 @@ void saveGlobalMemoryTo(std::ostream& oss, RLMachine& machine) {
      << const_cast<const EventSystemGlobals&>(sys.event().globals())
      << const_cast<const TextSystemGlobals&>(sys.text().globals())
      << const_cast<const SoundSystemGlobals&>(sys.sound().globals());
+
+  machine.memory().global().changes.clear();
+  machine.memory().global().changes.system_globals =
+      SerializeSystemGlobals(sys);
+}
+
+void saveGlobalMemoryChangesTo(std::ostream& oss, RLMachine& machine) {
+  GlobalMemory& global = machine.memory().global();
+  GlobalMemoryChanges& changes = global.changes;
+
+  std::string out;
+  for (int i : changes.intG)
+    AppendRecord(out, JOURNAL_INT_G, i, IntPayload(global.intG[i]));
+  for (int i : changes.intZ)
+    AppendRecord(out, JOURNAL_INT_Z, i, IntPayload(global.intZ[i]));
+  for (int i : changes.strM)
+    AppendRecord(out, JOURNAL_STR_M, i, global.strM[i]);
+  for (int i : changes.global_names)
+    AppendRecord(out, JOURNAL_GLOBAL_NAME, i, global.global_names[i]);
+  for (const std::pair<int, int>& kidoku : changes.kidoku)
+    AppendRecord(out, JOURNAL_KIDOKU, kidoku.first, IntPayload(kidoku.second));
+
+  std::string system_globals = SerializeSystemGlobals(machine.system());
+  if (system_globals != changes.system_globals)
+    AppendRecord(out, JOURNAL_SYSTEM_GLOBALS, 0, system_globals);
+
+  if (!out.empty()) {
+    oss.write(out.data(), out.size());
+    oss.flush();
+    if (!oss) {
+      throw rlvm::Exception(_("Could not write global memory file."));
+    }
+  }
+
+  changes.clear();
+  changes.system_globals.swap(system_globals);
 }
 
 void loadGlobalMemory(RLMachine& machine) {
@@ -105,8 +302,14 @@ void loadGlobalMemory(RLMachine& machine) {
   // complain if we're unable to, since this may be the first run on
   // this certain game and it may not exist yet.
   if (file) {
+    bool journal_intact = true;
     try {
       loadGlobalMemoryFrom(file, machine);
+
+      fs::ifstream journal(buildGlobalMemoryJournalFilename(machine),
+                           std::ios::binary);
+      if (journal)
+        journal_intact = loadGlobalMemoryChangesFrom(journal, machine);
     }
     catch (...) {
       // Swallow ALL exceptions during file reading. If loading the global
@@ -125,6 +328,18 @@ void loadGlobalMemory(RLMachine& machine) {
       std::cerr << "WARNING: Unable to read saved global memory file. Moving "
                 << save_dir << " to " << dest_save_dir << std::endl;
     }
+
+    // Records appended after a torn one would never be read back, so start
+    // over from a snapshot of what we did load.
+    if (!journal_intact) {
+      try {
+        compactGlobalMemory(machine);
+      }
+      catch (std::exception& e) {
+        std::cerr << "WARNING: Couldn't rewrite global memory: " << e.what()
+                  << std::endl;
+      }
+    }
   }
 }
 
@@ -161,6 +376,62 @@ void loadGlobalMemoryFrom(std::istream& iss, RLMachine& machine) {
     // will probably expand as more of RealLive is implemented).
     sys.sound().RestoreFromGlobals();
   }
+
+  // Everything we just loaded is already on disk.
+  machine.memory().global().changes.clear();
+  machine.memory().global().changes.system_globals =
+      SerializeSystemGlobals(sys);
+}
+
+bool loadGlobalMemoryChangesFrom(std::istream& iss, RLMachine& machine) {
+  // A torn length field mustn't make us allocate more than the journal holds.
+  std::streamoff remaining = std::numeric_limits<std::streamoff>::max();
+  std::streampos start = iss.tellg();
+  if (start != std::streampos(-1)) {
+    iss.seekg(0, std::ios::end);
+    std::streampos end = iss.tellg();
+    if (end != std::streampos(-1))
+      remaining = end - start;
+    iss.clear();
+    iss.seekg(start);
+  }
+
+  bool intact = true;
+  char header[kRecordHeaderSize];
+  while (true) {
+    if (!iss.read(header, kRecordHeaderSize)) {
+      intact = iss.gcount() == 0;
+      break;
+    }
+    remaining -= kRecordHeaderSize;
+
+    int type = libreallive::read_i32(header);
+    int key = libreallive::read_i32(header + 4);
+    size_t length = static_cast<uint32_t>(libreallive::read_i32(header + 8));
+    if (length > kMaxJournalSize || std::streamoff(length) > remaining) {
+      intact = false;
+      break;
+    }
+
+    std::string payload(length, '\0');
+    if (!iss.read(&payload[0], length)) {
+      intact = false;
+      break;
+    }
+    remaining -= length;
+
+    if (!ReplayRecord(machine, type, key, payload)) {
+      std::cerr << "WARNING: Ignoring malformed global memory journal record "
+                << "of type " << type << std::endl;
+      intact = false;
+      break;
+    }
+  }
+
+  GlobalMemoryChanges& changes = machine.memory().global().changes;
+  changes.clear();
+  changes.system_globals = SerializeSystemGlobals(machine.system());
+  return intact;
 }
 
 }  // namespace Serialization
@@ -26,6 +26,9 @@
 // -----------------------------------------------------------------------
 
 // include headers that implement a archive in simple text format
+#include <boost/archive/basic_archive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/split_free.hpp>
@@ -36,18 +39,24 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <zlib.h>
+
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <exception>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
 #include "libreallive/archive.h"
+#include "libreallive/defs.h"
 #include "libreallive/intmemref.h"
 #include "machine/memory.h"
 #include "machine/rlmachine.h"
 #include "machine/save_game_header.h"
+#include "machine/save_game_index.h"
 #include "machine/serialization.h"
 #include "machine/stack_frame.h"
 #include "systems/base/anm_graphics_object_data.h"
@@ -58,6 +67,7 @@
 #include "systems/base/graphics_stack_frame.h"
 #include "systems/base/graphics_system.h"
 #include "systems/base/sound_system.h"
+#include "systems/base/surface.h"
 #include "systems/base/system.h"
 #include "systems/base/text_system.h"
 #include "utilities/exception.h"
@@ -83,19 +93,258 @@ void checkInFileOpened(TYPE& file, const fs::path& home) {
   }
 }
 
+// Save games are a fixed size, uncompressed header followed by one section
+// per object we save. The header's integers are little endian.
+//
+// Header (kHeaderSize bytes, zero padded):
+//   0x00  "RLVMSAVE"
+//   0x08  i32  kFormatVersion
+//   0x0c  i32  CURRENT_LOCAL_VERSION
+//   0x10  i32  save time, microseconds since 1970 (local time), low word
+//   0x14  i32  save time, high word
+//   0x18  i32  number of sections
+//   0x1c  i32  title length, at most kMaxTitleLength
+//   0x20       ArchivePlatform() of the machine that wrote the sections
+//   0x30       title
+//
+// Section:
+//   i32  section id
+//   i32  uncompressed length
+//   i32  compressed length
+//        the section's binary_oarchive, deflated at zlib's fastest level
+//
+// Each section is its own archive so loading the header or local memory only
+// reads what it needs. Unlike the header, a binary_oarchive is in the
+// writer's byte order and type sizes, and its layout can change between
+// Boost versions, so sections are only read back where ArchivePlatform()
+// matches. Files that don't start with the magic are the zlib'd
+// text_oarchive streams older versions wrote, and are read the old way.
+//
+// Version 1 files have no platform record and keep the title at 0x20; only
+// their header can be read.
+const char kMagic[] = "RLVMSAVE";
+const size_t kMagicLength = 8;
+const int kFormatVersion = 2;
+const size_t kHeaderSize = 512;
+const size_t kPlatformOffset = 0x20;
+const size_t kPlatformLength = 16;
+const size_t kTitleOffset = 0x30;
+const size_t kMaxTitleLength = kHeaderSize - kTitleOffset;
+const size_t kSectionHeaderSize = 12;
+
+enum SectionId {
+  SECTION_LOCAL_MEMORY = 1,
+  SECTION_MACHINE,
+  SECTION_SYSTEM,
+  SECTION_GRAPHICS,
+  SECTION_TEXT,
+  SECTION_SOUND,
+  SECTION_COUNT = SECTION_SOUND
+};
+
+const boost::posix_time::ptime kEpoch(boost::gregorian::date(1970, 1, 1));
+
+void ThrowCorrupted() {
+  throw rlvm::Exception(_("Save game file is corrupted"));
+}
+
+// Rejects save games we can't make sense of. Older local versions are fine:
+// the sections' boost class versions take care of what changed since.
+void CheckVersions(int format_version, int local_version) {
+  if (format_version > kFormatVersion ||
+      local_version > Serialization::CURRENT_LOCAL_VERSION) {
+    throw rlvm::Exception(
+        _("Save game file was written by a newer version of rlvm"));
+  }
+  if (format_version < 1 || local_version < 1)
+    ThrowCorrupted();
+}
+
+// What the encoding of a binary_oarchive depends on: the archive library's
+// version, the byte order, and the sizes of the primitive types.
+std::string ArchivePlatform() {
+  std::string out(kPlatformLength, '\0');
+  libreallive::insert_i32(
+      out, 0, static_cast<int>(boost::archive::BOOST_ARCHIVE_VERSION()));
+  uint32_t byte_order = 0x01020304;
+  std::memcpy(&out[4], &byte_order, sizeof(byte_order));
+  const char sizes[] = {sizeof(short), sizeof(int), sizeof(long),
+                        sizeof(long long), sizeof(float), sizeof(double),
+                        sizeof(wchar_t), sizeof(size_t)};
+  std::memcpy(&out[8], sizes, sizeof(sizes));
+  return out;
+}
+
+std::string SerializeHeader(const SaveGameHeader& header) {
+  std::string out(kHeaderSize, '\0');
+  std::memcpy(&out[0], kMagic, kMagicLength);
+  libreallive::insert_i32(out, 0x08, kFormatVersion);
+  libreallive::insert_i32(out, 0x0c, Serialization::CURRENT_LOCAL_VERSION);
+
+  int64_t time = (header.save_time - kEpoch).total_microseconds();
+  libreallive::insert_i32(out, 0x10, time & 0xffffffff);
+  libreallive::insert_i32(out, 0x14, time >> 32);
+  libreallive::insert_i32(out, 0x18, SECTION_COUNT);
+
+  size_t title_length = std::min(header.title.size(), kMaxTitleLength);
+  libreallive::insert_i32(out, 0x1c, title_length);
+  std::string platform = ArchivePlatform();
+  std::memcpy(&out[kPlatformOffset], platform.data(), kPlatformLength);
+  std::memcpy(&out[kTitleOffset], header.title.data(), title_length);
+  return out;
+}
+
+// Reads the header of a binary save game. Returns false, leaving |iss| where
+// it was, if the stream is in the old format. When |reading_sections|, also
+// refuses files whose sections this build can't decode.
+bool ReadHeader(std::istream& iss,
+                SaveGameHeader& header,
+                bool reading_sections) {
+  std::istream::pos_type start = iss.tellg();
+  char buf[kHeaderSize];
+  if (!iss.read(buf, kMagicLength) ||
+      std::memcmp(buf, kMagic, kMagicLength) != 0) {
+    iss.clear();
+    iss.seekg(start);
+    return false;
+  }
+
+  if (!iss.read(buf + kMagicLength, kHeaderSize - kMagicLength))
+    ThrowCorrupted();
+  int format_version = libreallive::read_i32(buf + 0x08);
+  CheckVersions(format_version, libreallive::read_i32(buf + 0x0c));
+  if (libreallive::read_i32(buf + 0x18) != SECTION_COUNT)
+    ThrowCorrupted();
+
+  if (reading_sections &&
+      (format_version < 2 ||
+       std::memcmp(buf + kPlatformOffset, ArchivePlatform().data(),
+                   kPlatformLength) != 0)) {
+    throw rlvm::Exception(
+        _("Save game file was written on a different platform or with a "
+          "different version of Boost"));
+  }
+
+  uint64_t time = uint32_t(libreallive::read_i32(buf + 0x10)) |
+                  (uint64_t(uint32_t(libreallive::read_i32(buf + 0x14))) << 32);
+  header.save_time =
+      kEpoch + boost::posix_time::microseconds(int64_t(time));
+
+  size_t title_offset = format_version < 2 ? kPlatformOffset : kTitleOffset;
+  size_t title_length = uint32_t(libreallive::read_i32(buf + 0x1c));
+  if (title_length > kHeaderSize - title_offset)
+    ThrowCorrupted();
+  header.title.assign(buf + title_offset, title_length);
+  return true;
+}
+
+template <typename T>
+void WriteSection(std::ostream& oss, SectionId id, const T& object) {
+  std::ostringstream raw(std::ios::binary);
+  {
+    boost::archive::binary_oarchive oa(raw);
+    oa << object;
+  }
+  std::string data = raw.str();
+
+  uLongf compressed_length = compressBound(data.size());
+  std::string out(kSectionHeaderSize + compressed_length, '\0');
+  if (compress2(reinterpret_cast<Bytef*>(&out[kSectionHeaderSize]),
+                &compressed_length,
+                reinterpret_cast<const Bytef*>(data.data()),
+                data.size(),
+                Z_BEST_SPEED) != Z_OK) {
+    throw rlvm::Exception("Couldn't compress save game section");
+  }
+
+  libreallive::insert_i32(out, 0, id);
+  libreallive::insert_i32(out, 4, data.size());
+  libreallive::insert_i32(out, 8, compressed_length);
+  oss.write(out.data(), kSectionHeaderSize + compressed_length);
+}
+
+// Reads the next section, which must be |id|, and inflates it.
+std::string ReadSection(std::istream& iss, SectionId id) {
+  char buf[kSectionHeaderSize];
+  if (!iss.read(buf, kSectionHeaderSize) ||
+      libreallive::read_i32(buf) != id)
+    ThrowCorrupted();
+
+  uLongf length = uint32_t(libreallive::read_i32(buf + 4));
+  size_t compressed_length = uint32_t(libreallive::read_i32(buf + 8));
+  std::string compressed(compressed_length, '\0');
+  std::string data(length, '\0');
+  if (!iss.read(&compressed[0], compressed_length) ||
+      uncompress(reinterpret_cast<Bytef*>(&data[0]),
+                 &length,
+                 reinterpret_cast<const Bytef*>(compressed.data()),
+                 compressed_length) != Z_OK ||
+      length != data.size()) {
+    ThrowCorrupted();
+  }
+  return data;
+}
+
+template <typename T>
+void LoadSection(std::istream& iss, SectionId id, T& object) {
+  std::istringstream raw(ReadSection(iss, id), std::ios::binary);
+  boost::archive::binary_iarchive ia(raw);
+  ia >> object;
+}
+
 }  // namespace
 
 namespace Serialization {
 
 void saveGameForSlot(RLMachine& machine, int slot) {
+  const SaveGameHeader header(machine.system().graphics().window_subtitle());
+
   fs::path path = buildSaveGameFilename(machine, slot);
-  fs::ofstream file(path, std::ios::binary);
-  checkInFileOpened(file, path);
+  {
+    fs::ofstream file(path, std::ios::binary);
+    checkInFileOpened(file, path);
 
-  saveGameTo(file, machine);
+    saveGameTo(file, machine, header);
+  }
+
+  std::shared_ptr<Surface> screenshot =
+      machine.system().graphics().RenderToSurface();
+  machine.save_game_index().Update(slot, header, screenshot.get());
 }
 
 void saveGameTo(std::ostream& oss, RLMachine& machine) {
+  saveGameTo(oss,
+             machine,
+             SaveGameHeader(machine.system().graphics().window_subtitle()));
+}
+
+void saveGameTo(std::ostream& oss,
+                RLMachine& machine,
+                const SaveGameHeader& header) {
+  g_current_machine = &machine;
+
+  try {
+    std::string header_data = SerializeHeader(header);
+    oss.write(header_data.data(), header_data.size());
+    WriteSection(oss, SECTION_LOCAL_MEMORY, machine.memory().local());
+    WriteSection(oss, SECTION_MACHINE, machine);
+    WriteSection(oss, SECTION_SYSTEM, machine.system());
+    WriteSection(oss, SECTION_GRAPHICS, machine.system().graphics());
+    WriteSection(oss, SECTION_TEXT, machine.system().text());
+    WriteSection(oss, SECTION_SOUND, machine.system().sound());
+  }
+  catch (std::exception& e) {
+    std::cerr << "--- WARNING: ERROR DURING SAVING FILE: " << e.what() << " ---"
+              << std::endl;
+
+    g_current_machine = NULL;
+    throw e;
+  }
+
+  g_current_machine = NULL;
+}
+
+void saveLegacyGameTo(std::ostream& oss, RLMachine& machine) {
   boost::iostreams::filtering_stream<boost::iostreams::output> filtered_output;
   filtered_output.push(boost::iostreams::zlib_compressor());
   filtered_output.push(oss);
@@ -126,13 +375,15 @@ void saveGameTo(std::ostream& oss, RLMachine& machine) {
 }
 
 fs::path buildSaveGameFilename(RLMachine& machine, int slot) {
-  std::ostringstream oss;
-  oss << "save" << std::setw(3) << std::setfill('0') << slot << ".sav.gz";
-
-  return machine.system().GameSaveDirectory() / oss.str();
+  return machine.system().GameSaveDirectory() /
+         SaveGameIndex::FilenameForSlot(slot);
 }
 
 SaveGameHeader loadHeaderForSlot(RLMachine& machine, int slot) {
+  if (const SaveGameIndex::Entry* entry =
+          machine.save_game_index().Find(slot))
+    return entry->header;
+
   fs::path path = buildSaveGameFilename(machine, slot);
   fs::ifstream file(path, std::ios::binary);
   checkInFileOpened(file, path);
@@ -141,12 +392,15 @@ SaveGameHeader loadHeaderForSlot(RLMachine& machine, int slot) {
 }
 
 SaveGameHeader loadHeaderFrom(std::istream& iss) {
+  SaveGameHeader header;
+  if (ReadHeader(iss, header, false))
+    return header;
+
   boost::iostreams::filtering_stream<boost::iostreams::input> filtered_input;
   filtered_input.push(boost::iostreams::zlib_decompressor());
   filtered_input.push(iss);
 
   int version;
-  SaveGameHeader header;
 
   // Only load the header
   boost::archive::text_iarchive ia(filtered_input);
@@ -164,12 +418,17 @@ void loadLocalMemoryForSlot(RLMachine& machine, int slot, Memory& memory) {
 }
 
 void loadLocalMemoryFrom(std::istream& iss, Memory& memory) {
+  SaveGameHeader header;
+  if (ReadHeader(iss, header, true)) {
+    LoadSection(iss, SECTION_LOCAL_MEMORY, memory.local());
+    return;
+  }
+
   boost::iostreams::filtering_stream<boost::iostreams::input> filtered_input;
   filtered_input.push(boost::iostreams::zlib_decompressor());
   filtered_input.push(iss);
 
   int version;
-  SaveGameHeader header;
 
   // Only load the header
   boost::archive::text_iarchive ia(filtered_input);
@@ -185,12 +444,8 @@ void loadGameForSlot(RLMachine& machine, int slot) {
 }
 
 void loadGameFrom(std::istream& iss, RLMachine& machine) {
-  boost::iostreams::filtering_stream<boost::iostreams::input> filtered_input;
-  filtered_input.push(boost::iostreams::zlib_decompressor());
-  filtered_input.push(iss);
-
-  int version;
   SaveGameHeader header;
+  bool binary = ReadHeader(iss, header, true);
 
   g_current_machine = &machine;
 
@@ -199,14 +454,33 @@ void loadGameFrom(std::istream& iss, RLMachine& machine) {
     // often hold references to objects in the System heiarchy.
     machine.Reset();
 
-    boost::archive::text_iarchive ia(filtered_input);
-    ia >> version >> header >> machine.memory().local() >> machine >>
-        machine.system() >> machine.system().graphics() >>
-        machine.system().text() >> machine.system().sound();
+    if (binary) {
+      LoadSection(iss, SECTION_LOCAL_MEMORY, machine.memory().local());
+      LoadSection(iss, SECTION_MACHINE, machine);
+      LoadSection(iss, SECTION_SYSTEM, machine.system());
+      LoadSection(iss, SECTION_GRAPHICS, machine.system().graphics());
+      LoadSection(iss, SECTION_TEXT, machine.system().text());
+      LoadSection(iss, SECTION_SOUND, machine.system().sound());
+    } else {
+      boost::iostreams::filtering_stream<boost::iostreams::input>
+          filtered_input;
+      filtered_input.push(boost::iostreams::zlib_decompressor());
+      filtered_input.push(iss);
+
+      int version;
+      boost::archive::text_iarchive ia(filtered_input);
+      ia >> version >> header >> machine.memory().local() >> machine >>
+          machine.system() >> machine.system().graphics() >>
+          machine.system().text() >> machine.system().sound();
+    }
 
     machine.system().graphics().ReplayGraphicsStack(machine);
 
     machine.system().graphics().ForceRefresh();
+
+    // Let modules get ready for the scene we're resuming.
+    machine.NotifySceneEntered(machine.Scenario(),
+                               machine.CurrentInstruction());
   }
   catch (std::exception& e) {
     std::cerr << "--- WARNING: ERROR DURING LOADING FILE: " << e.what()
@@ -25,6 +25,8 @@
 //
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>  // NOLINT
+#include <boost/archive/binary_oarchive.hpp>  // NOLINT
 #include <boost/archive/text_iarchive.hpp>  // NOLINT
 #include <boost/archive/text_oarchive.hpp>  // NOLINT
 
@@ -126,13 +128,19 @@ void StackFrame::load(Archive& ar, unsigned int version) {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void StackFrame::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void StackFrame::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void StackFrame::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void StackFrame::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
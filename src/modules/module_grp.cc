@@ -30,6 +30,8 @@
 #include <boost/algorithm/string.hpp>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -38,6 +40,7 @@
 #include "libreallive/bytecode.h"
 #include "libreallive/expression.h"
 #include "libreallive/gameexe.h"
+#include "libreallive/scenario.h"
 #include "long_operations/wait_long_operation.h"
 #include "long_operations/zoom_long_operation.h"
 #include "machine/general_operations.h"
@@ -72,6 +75,26 @@ const std::string GRP_LOAD = "grpLoad";
 const std::string GRP_OPEN = "grpOpen";
 const std::string GRP_OPENBG = "grpOpenBg";
 
+// How many bytecode elements PrefetchUpcomingImages() looks through, and how
+// many images it starts decoding.
+const int kImageLookaheadElements = 64;
+const int kImageLookaheadImages = 4;
+
+// Returns which parameter of the command |name| is the image file it loads,
+// or -1 if it doesn't load one.
+int imageParameterOf(const std::string& name) {
+  static const std::set<std::string> grp_loads = {
+      "grpLoad", "grpMaskLoad", "grpOpen", "grpMaskOpen", "grpOpenBg",
+      "recLoad", "recMaskLoad", "recOpen", "recMaskOpen", "recOpenBg"};
+  static const std::set<std::string> obj_loads = {"objOfFile", "objOfFile2"};
+
+  if (grp_loads.count(name))
+    return 0;
+  if (obj_loads.count(name))
+    return 1;
+  return -1;
+}
+
 void blitDC1toDC0(RLMachine& machine) {
   GraphicsSystem& graphics = machine.system().graphics();
 
@@ -96,7 +119,7 @@ void blitDC1toDC0(RLMachine& machine) {
 // Kanon uses the recOpen('?', ...) form for rendering Last Regrets. This isn't
 // documented in the rldev manual, and we must check for that case.
 void loadImageToDC1(RLMachine& machine,
-                    std::string name,
+                    const std::string& name,
                     const Rect& srcRect,
                     const Point& dest,
                     int opacity,
@@ -104,8 +127,8 @@ void loadImageToDC1(RLMachine& machine,
   GraphicsSystem& graphics = machine.system().graphics();
 
   if (name != "?") {
-    if (name == "???")
-      name = graphics.default_grp_name();
+    const std::string& filename =
+        name == "???" ? graphics.default_grp_name() : name;
 
     std::shared_ptr<Surface> dc0 = graphics.GetDC(0);
     std::shared_ptr<Surface> dc1 = graphics.GetDC(1);
@@ -116,8 +139,9 @@ void loadImageToDC1(RLMachine& machine,
     dc0->BlitToSurface(*dc1, dc0->GetRect(), dc0->GetRect(), 255);
 
     // Load the section of the image file on top of dc1
+    PrefetchUpcomingImages(machine);
     std::shared_ptr<const Surface> surface(
-        graphics.GetSurfaceNamedAndMarkViewed(machine, name));
+        graphics.GetSurfaceNamedAndMarkViewed(machine, filename));
     surface->BlitToSurface(*graphics.GetDC(1),
                            Rect(srcRect.origin(), size),
                            Rect(dest, size),
@@ -250,13 +274,17 @@ struct shake : public RLOpcode<IntConstant_T> {
 // to worry about the difference between grp/rec coordinate space), we write
 // one function for both versions.
 struct load_1
-    : public RLOpcode<StrConstant_T, IntConstant_T, DefaultIntValue_T<255>> {
+    : public RLOpcode<StrRef_T, IntConstant_T, DefaultIntValue_T<255>> {
   bool use_alpha_;
   explicit load_1(bool in) : use_alpha_(in) {}
 
-  void operator()(RLMachine& machine, string filename, int dc, int opacity) {
+  void operator()(RLMachine& machine,
+                  const string& filename,
+                  int dc,
+                  int opacity) {
     GraphicsSystem& graphics = machine.system().graphics();
 
+    PrefetchUpcomingImages(machine);
     std::shared_ptr<const Surface> surface(
         graphics.GetSurfaceNamedAndMarkViewed(machine, filename));
 
@@ -278,7 +306,7 @@ struct load_1
 // Loads filename into dc; note that filename may not be '???'. Using this
 // form, the given area of the bitmap is loaded at the given location.
 template <typename SPACE>
-struct load_3 : public RLOpcode<StrConstant_T,
+struct load_3 : public RLOpcode<StrRef_T,
                                IntConstant_T,
                                Rect_T<SPACE>,
                                Point_T,
@@ -287,12 +315,13 @@ struct load_3 : public RLOpcode<StrConstant_T,
   explicit load_3(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int dc,
                   Rect srcRect,
                   Point dest,
                   int opacity) {
     GraphicsSystem& graphics = machine.system().graphics();
+    PrefetchUpcomingImages(machine);
     std::shared_ptr<const Surface> surface(
         graphics.GetSurfaceNamedAndMarkViewed(machine, filename));
 
@@ -440,12 +469,12 @@ struct display_4 : public RLOpcode<IntConstant_T,
 //
 // TODO(erg): factor out the common code between grpOpens!
 struct open_1
-    : public RLOpcode<StrConstant_T, IntConstant_T, IntConstant_T> {
+    : public RLOpcode<StrRef_T, IntConstant_T, IntConstant_T> {
   bool use_alpha_;
   explicit open_1(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int effectNum,
                   int opacity) {
     Rect src;
@@ -469,18 +498,18 @@ struct open_1
 // Load and display a bitmap. |filename| is loaded into DC1, and then is passed
 // off to whatever transition effect, which will perform some intermediary
 // steps and then render DC1 to DC0.
-struct open_0 : public RLOpcode<StrConstant_T, IntConstant_T> {
+struct open_0 : public RLOpcode<StrRef_T, IntConstant_T> {
   open_1 delegate_;
   explicit open_0(bool in) : delegate_(in) {}
 
-  void operator()(RLMachine& machine, string filename, int effectNum) {
+  void operator()(RLMachine& machine, const string& filename, int effectNum) {
     std::vector<int> selEffect = GetSELEffect(machine, effectNum);
     delegate_(machine, filename, effectNum, selEffect[14]);
   }
 };
 
 template <typename SPACE>
-struct open_3 : public RLOpcode<StrConstant_T,
+struct open_3 : public RLOpcode<StrRef_T,
                                IntConstant_T,
                                Rect_T<SPACE>,
                                Point_T,
@@ -489,7 +518,7 @@ struct open_3 : public RLOpcode<StrConstant_T,
   explicit open_3(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int effectNum,
                   Rect srcRect,
                   Point dest,
@@ -517,12 +546,12 @@ struct open_3 : public RLOpcode<StrConstant_T,
 // perform some intermediary steps and then render DC1 to DC0.
 template <typename SPACE>
 struct open_2
-    : public RLOpcode<StrConstant_T, IntConstant_T, Rect_T<SPACE>, Point_T> {
+    : public RLOpcode<StrRef_T, IntConstant_T, Rect_T<SPACE>, Point_T> {
   open_3<SPACE> delegate_;
   explicit open_2(bool in) : delegate_(in) {}
 
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int effectNum,
                   Rect src,
                   Point dest) {
@@ -532,7 +561,7 @@ struct open_2
 };
 
 template <typename SPACE>
-struct open_4 : public RLOpcode<StrConstant_T,
+struct open_4 : public RLOpcode<StrRef_T,
                                     Rect_T<SPACE>,
                                     Point_T,
                                     IntConstant_T,
@@ -549,7 +578,7 @@ struct open_4 : public RLOpcode<StrConstant_T,
   explicit open_4(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string fileName,
+                  const string& fileName,
                   Rect srcRect,
                   Point dest,
                   int time,
@@ -589,9 +618,9 @@ struct open_4 : public RLOpcode<StrConstant_T,
 };
 
 struct openBg_1
-    : public RLOpcode<StrConstant_T, IntConstant_T, IntConstant_T> {
+    : public RLOpcode<StrRef_T, IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine,
-                  string fileName,
+                  const string& fileName,
                   int effectNum,
                   int opacity) {
     GraphicsSystem& graphics = machine.system().graphics();
@@ -612,17 +641,17 @@ struct openBg_1
   }
 };
 
-struct openBg_0 : public RLOpcode<StrConstant_T, IntConstant_T> {
+struct openBg_0 : public RLOpcode<StrRef_T, IntConstant_T> {
   openBg_1 delegate_;
 
-  void operator()(RLMachine& machine, string filename, int effectNum) {
+  void operator()(RLMachine& machine, const string& filename, int effectNum) {
     std::vector<int> selEffect = GetSELEffect(machine, effectNum);
     delegate_(machine, filename, effectNum, selEffect[14]);
   }
 };
 
 template <typename SPACE>
-struct openBg_3 : public RLOpcode<StrConstant_T,
+struct openBg_3 : public RLOpcode<StrRef_T,
                                  IntConstant_T,
                                  Rect_T<SPACE>,
                                  Point_T,
@@ -631,7 +660,7 @@ struct openBg_3 : public RLOpcode<StrConstant_T,
   explicit openBg_3(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string fileName,
+                  const string& fileName,
                   int effectNum,
                   Rect srcRect,
                   Point destPt,
@@ -653,12 +682,12 @@ struct openBg_3 : public RLOpcode<StrConstant_T,
 
 template <typename SPACE>
 struct openBg_2
-    : public RLOpcode<StrConstant_T, IntConstant_T, Rect_T<SPACE>, Point_T> {
+    : public RLOpcode<StrRef_T, IntConstant_T, Rect_T<SPACE>, Point_T> {
   openBg_3<SPACE> delegate_;
   explicit openBg_2(bool in) : delegate_(in) {}
 
   void operator()(RLMachine& machine,
-                  string fileName,
+                  const string& fileName,
                   int effectNum,
                   Rect srcRect,
                   Point destPt) {
@@ -668,7 +697,7 @@ struct openBg_2
 };
 
 template <typename SPACE>
-struct openBg_4 : public RLOpcode<StrConstant_T,
+struct openBg_4 : public RLOpcode<StrRef_T,
                                       Rect_T<SPACE>,
                                       Point_T,
                                       IntConstant_T,
@@ -685,7 +714,7 @@ struct openBg_4 : public RLOpcode<StrConstant_T,
   explicit openBg_4(bool in) : use_alpha_(in) {}
 
   void operator()(RLMachine& machine,
-                  string fileName,
+                  const string& fileName,
                   Rect srcRect,
                   Point destPt,
                   int time,
@@ -1117,13 +1146,13 @@ void multi_command<SPACE>::handleMultiCommands(
 
 // fun grpMulti <1:Grp:00075, 4> (<strC 'filename', <'effect', MultiCommand)
 template <typename SPACE>
-struct multi_str_1 : public RLOpcode<StrConstant_T,
+struct multi_str_1 : public RLOpcode<StrRef_T,
                                     IntConstant_T,
                                     IntConstant_T,
                                     MultiCommand>,
                      public multi_command<SPACE> {
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int effect,
                   int alpha,
                   MultiCommand::type commands) {
@@ -1135,11 +1164,11 @@ struct multi_str_1 : public RLOpcode<StrConstant_T,
 
 template <typename SPACE>
 struct multi_str_0
-    : public RLOpcode<StrConstant_T, IntConstant_T, MultiCommand> {
+    : public RLOpcode<StrRef_T, IntConstant_T, MultiCommand> {
   multi_str_1<SPACE> delegate_;
 
   void operator()(RLMachine& machine,
-                  string filename,
+                  const string& filename,
                   int effect,
                   MultiCommand::type commands) {
     delegate_(machine, filename, effect, 255, commands);
@@ -1439,18 +1468,61 @@ GrpModule::GrpModule() : MappedRLModule(GraphicsStackMappingFun, "Grp", 1, 33) {
 
 // -----------------------------------------------------------------------
 
+void PrefetchUpcomingImages(RLMachine& machine) {
+  if (machine.replaying_graphics_stack())
+    return;
+
+  GraphicsSystem& graphics = machine.system().graphics();
+  const libreallive::Scenario& scenario = machine.Scenario();
+  libreallive::Scenario::const_iterator it = machine.CurrentInstruction();
+
+  int found = 0;
+  for (int i = 0; i < kImageLookaheadElements && found < kImageLookaheadImages;
+       ++i) {
+    if (it == scenario.end() || ++it == scenario.end())
+      break;
+
+    const libreallive::CommandElement* f =
+        dynamic_cast<const libreallive::CommandElement*>(*it);
+    if (!f)
+      continue;
+
+    int param = imageParameterOf(machine.GetCommandName(*f));
+    if (param < 0 || param >= static_cast<int>(f->GetParamCount()))
+      continue;
+
+    try {
+      std::string data = f->GetParam(param);
+      const char* src = data.c_str();
+      std::string name = libreallive::GetData(src).GetStringValue(machine);
+      if (name == "???")
+        name = graphics.default_grp_name();
+      if (name.empty() || name == "?")
+        continue;
+
+      graphics.PrefetchSurface(name);
+      found++;
+    }
+    catch (std::exception& e) {
+      // Leave it for the command itself to report.
+    }
+  }
+}
+
+// -----------------------------------------------------------------------
+
 void ReplayGraphicsStackCommand(RLMachine& machine,
                                 const std::deque<std::string>& stack) {
   try {
     for (auto const& command : stack) {
       if (command != "") {
         // Parse the string as a chunk of Reallive bytecode.
-        libreallive::ConstructionData cdata(0, libreallive::pointer_t());
-        libreallive::BytecodeElement* element =
+        libreallive::ConstructionData cdata(0);
+        std::unique_ptr<libreallive::BytecodeElement> element(
             libreallive::BytecodeElement::Read(
-                command.c_str(), command.c_str() + command.size(), cdata);
+                command.c_str(), command.c_str() + command.size(), cdata));
         libreallive::CommandElement* command =
-            dynamic_cast<libreallive::CommandElement*>(element);
+            dynamic_cast<libreallive::CommandElement*>(element.get());
         if (command) {
           machine.ExecuteCommand(*command);
         }
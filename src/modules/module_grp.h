@@ -49,6 +49,14 @@ RLOperation* GraphicsStackMappingFun(RLOperation* op);
 
 // -----------------------------------------------------------------------
 
+// Scans the bytecode after the current command for grp/rec loads and
+// objOfFile with constant file names, and has the graphics system start
+// decoding those images in the background. Names computed from memory are
+// evaluated with today's values; a wrong guess only costs a wasted decode.
+void PrefetchUpcomingImages(RLMachine& machine);
+
+// -----------------------------------------------------------------------
+
 // Replays the new Graphics stack, string representations of reallive bytecode.
 void ReplayGraphicsStackCommand(RLMachine& machine,
                                 const std::deque<std::string>& stack);
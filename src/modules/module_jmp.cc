@@ -148,7 +148,8 @@ struct Jmp_goto : public RLOp_SpecialCase {
 };
 
 // The rest of the goto statements must parse their expressions before use. By
-// default, special cases treat this as data instead of expressions.
+// default, special cases treat this as data instead of expressions. A
+// condition is evaluated each time its branch is reached, so it is compiled.
 struct ParseGotoParametersAsExpressions : public RLOp_SpecialCase {
   virtual void ParseParameters(
       const std::vector<std::string>& input,
@@ -156,6 +157,7 @@ struct ParseGotoParametersAsExpressions : public RLOp_SpecialCase {
     for (auto const& parameter : input) {
       const char* src = parameter.c_str();
       output.push_back(libreallive::GetExpression(src));
+      output.back().CompileIntegerValue();
     }
   }
 };
@@ -27,8 +27,13 @@
 
 #include "modules/module_koe.h"
 
+#include <exception>
 #include <functional>
+#include <string>
 
+#include "libreallive/bytecode.h"
+#include "libreallive/expression.h"
+#include "libreallive/scenario.h"
 #include "long_operations/wait_long_operation.h"
 #include "machine/general_operations.h"
 #include "machine/long_operation.h"
@@ -42,6 +47,66 @@
 
 namespace {
 
+// How many bytecode elements prefetchKoeFrom() searches for voices, and
+// how many of those voices are decoded ahead of time.
+const int kKoeLookaheadElements = 256;
+const int kKoeLookaheadVoices = 3;
+
+// Whether |f| is one of the koePlay variants, all of which take the voice id
+// as their first parameter.
+bool isKoePlay(const libreallive::CommandElement& f) {
+  if (f.modtype() != 1 || f.module() != 23 || f.GetParamCount() == 0)
+    return false;
+
+  switch (f.opcode()) {
+    case 0:
+    case 1:
+    case 7:
+    case 8:
+    case 9:
+    case 10:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Scans |scenario| from |from| onwards for the next few koePlay commands and
+// has the sound system start decoding those voices in the background. Ids
+// computed from memory are evaluated with today's values; a wrong guess only
+// costs a wasted decode.
+void prefetchKoeFrom(RLMachine& machine,
+                     const libreallive::Scenario& scenario,
+                     libreallive::Scenario::const_iterator from) {
+  int found = 0;
+  for (int i = 0; i < kKoeLookaheadElements && found < kKoeLookaheadVoices &&
+                  from != scenario.end();
+       ++i, ++from) {
+    const libreallive::CommandElement* f =
+        dynamic_cast<const libreallive::CommandElement*>(*from);
+    if (!f || !isKoePlay(*f))
+      continue;
+
+    try {
+      std::string param = f->GetParam(0);
+      const char* src = param.c_str();
+      int id = libreallive::GetExpression(src).GetIntegerValue(machine);
+      machine.system().sound().KoePrefetch(id);
+      found++;
+    }
+    catch (std::exception& e) {
+      // Leave it for koePlay to report.
+    }
+  }
+}
+
+// Prefetches the voices after the koePlay being executed.
+void prefetchUpcomingKoe(RLMachine& machine) {
+  libreallive::Scenario::const_iterator it = machine.CurrentInstruction();
+  if (it != machine.Scenario().end())
+    prefetchKoeFrom(machine, machine.Scenario(), ++it);
+}
+
 void addKoeIcon(RLMachine& machine, int id) {
   machine.system().text().GetCurrentPage().KoeMarker(id);
 }
@@ -69,6 +134,7 @@ struct koePlay_0 : public RLOpcode<IntConstant_T> {
   void operator()(RLMachine& machine, int koe) {
     machine.system().sound().KoePlay(koe);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
   }
 };
 
@@ -76,6 +142,7 @@ struct koePlay_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe, character);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
   }
 };
 
@@ -83,6 +150,7 @@ struct koePlayEx_0 : public RLOpcode<IntConstant_T> {
   void operator()(RLMachine& machine, int koe) {
     machine.system().sound().KoePlay(koe);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWait(machine);
   }
 };
@@ -91,6 +159,7 @@ struct koePlayEx_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe, character);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWait(machine);
   }
 };
@@ -99,6 +168,7 @@ struct koeDoPlayEx_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWait(machine);
   }
 };
@@ -107,6 +177,7 @@ struct koePlayExC_0 : public RLOpcode<IntConstant_T> {
   void operator()(RLMachine& machine, int koe) {
     machine.system().sound().KoePlay(koe);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWaitC(machine);
   }
 };
@@ -115,6 +186,7 @@ struct koePlayExC_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe, character);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWait(machine);
   }
 };
@@ -123,6 +195,7 @@ struct koeDoPlayExC_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe);
     addKoeIcon(machine, koe);
+    prefetchUpcomingKoe(machine);
     addKoeWaitC(machine);
   }
 };
@@ -139,6 +212,7 @@ struct koeWaitC : public RLOpcode<> {
 struct koeDoPlay_1 : public RLOpcode<IntConstant_T, IntConstant_T> {
   void operator()(RLMachine& machine, int koe, int character) {
     machine.system().sound().KoePlay(koe);
+    prefetchUpcomingKoe(machine);
   }
 };
 
@@ -203,3 +277,11 @@ KoeModule::KoeModule() : RLModule("Koe", 1, 23) {
       14, 0, "koeMute", CallFunctionWith(&SoundSystem::SetKoeVolume, 0, 0));
   AddOpcode(14, 1, "koeMute", new koeMute_1);
 }
+
+void KoeModule::SceneEntered(RLMachine& machine,
+                             const libreallive::Scenario& scenario,
+                             libreallive::Scenario::const_iterator entrypoint) {
+  // So the first voice of a scene is ready too, not just the ones after a
+  // koePlay.
+  prefetchKoeFrom(machine, scenario, entrypoint);
+}
@@ -28,12 +28,21 @@
 #ifndef SRC_MODULES_MODULE_KOE_H_
 #define SRC_MODULES_MODULE_KOE_H_
 
+#include "libreallive/scenario.h"
 #include "machine/rlmodule.h"
 
+class RLMachine;
+
 // Contains functions for mod<1:23>, Koe.
 class KoeModule : public RLModule {
  public:
   KoeModule();
+
+  // Starts decoding the first few voices of the scene in the background.
+  virtual void SceneEntered(
+      RLMachine& machine,
+      const libreallive::Scenario& scenario,
+      libreallive::Scenario::const_iterator entrypoint) override;
 };
 
 #endif  // SRC_MODULES_MODULE_KOE_H_
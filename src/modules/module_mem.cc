@@ -32,16 +32,39 @@
 #include <numeric>
 #include <vector>
 
+#include "libreallive/intmemref.h"
+#include "machine/memory.h"
 #include "machine/rloperation.h"
 #include "machine/rloperation/argc_t.h"
 #include "machine/rloperation/complex_t.h"
 #include "machine/rloperation/rlop_store.h"
 #include "machine/rloperation/references.h"
 
+using libreallive::IntMemRef;
+
 // -----------------------------------------------------------------------
 
 namespace {
 
+IntMemRef ToIntMemRef(const IntReferenceIterator& it) {
+  return IntMemRef(it.type(), it.location());
+}
+
+// Whether the inclusive range [first, last] is a run of elements in a single
+// bank, which Memory can operate on a word at a time. Anything else (the store
+// register, mismatched banks or a backwards range) goes through the iterators
+// one element at a time.
+bool IsContiguous(const IntReferenceIterator& first,
+                  const IntReferenceIterator& last) {
+  return first.memory() && first.memory() == last.memory() &&
+         first.type() == last.type() && first.location() <= last.location();
+}
+
+int RangeSize(const IntReferenceIterator& first,
+              const IntReferenceIterator& last) {
+  return last.location() - first.location() + 1;
+}
+
 // Implement op<1:Mem:00000, 0>, fun setarray(int, intC+).
 //
 // Sets a block of integers, starting with origin, to the given values. values
@@ -51,7 +74,12 @@ struct setarray : public RLOpcode<IntReference_T, Argc_T<IntConstant_T>> {
   void operator()(RLMachine& machine,
                   IntReferenceIterator origin,
                   std::vector<int> values) {
-    copy(values.begin(), values.end(), origin);
+    if (origin.memory()) {
+      origin.memory()->SetIntRange(ToIntMemRef(origin), values.data(),
+                                   values.size());
+    } else {
+      copy(values.begin(), values.end(), origin);
+    }
   }
 };
 
@@ -62,6 +90,12 @@ struct setrng_0 : public RLOpcode<IntReference_T, IntReference_T> {
   void operator()(RLMachine& machine,
                   IntReferenceIterator first,
                   IntReferenceIterator last) {
+    if (IsContiguous(first, last)) {
+      first.memory()->FillIntRange(ToIntMemRef(first), RangeSize(first, last),
+                                   0);
+      return;
+    }
+
     ++last;  // RealLive ranges are inclusive
     fill(first, last, 0);
   }
@@ -76,6 +110,12 @@ struct setrng_1
                   IntReferenceIterator first,
                   IntReferenceIterator last,
                   int value) {
+    if (IsContiguous(first, last)) {
+      first.memory()->FillIntRange(ToIntMemRef(first), RangeSize(first, last),
+                                   value);
+      return;
+    }
+
     ++last;  // RealLive ranges are inclusive
     fill(first, last, value);
   }
@@ -91,6 +131,12 @@ struct cpyrng
                   IntReferenceIterator source,
                   IntReferenceIterator dest,
                   int count) {
+    if (count > 0 && source.memory() && source.memory() == dest.memory()) {
+      source.memory()->CopyIntRange(ToIntMemRef(source), ToIntMemRef(dest),
+                                    count);
+      return;
+    }
+
     std::vector<int> tmpCopy;
     std::copy_n(source, count, std::back_inserter(tmpCopy));
     std::copy(tmpCopy.begin(), tmpCopy.end(), dest);
@@ -181,6 +227,10 @@ struct sum : public RLStoreOpcode<IntReference_T, IntReference_T> {
   int operator()(RLMachine& machine,
                  IntReferenceIterator first,
                  IntReferenceIterator last) {
+    if (IsContiguous(first, last))
+      return first.memory()->SumIntRange(ToIntMemRef(first),
+                                         RangeSize(first, last));
+
     last++;
     return accumulate(first, last, 0);
   }
@@ -197,9 +247,16 @@ struct sums
       IntReferenceIterator>> ranges) {
     int total = 0;
     for (auto it = ranges.cbegin(); it != ranges.cend(); ++it) {
+      IntReferenceIterator first = std::get<0>(*it);
       IntReferenceIterator last = std::get<1>(*it);
+      if (IsContiguous(first, last)) {
+        total += first.memory()->SumIntRange(ToIntMemRef(first),
+                                             RangeSize(first, last));
+        continue;
+      }
+
       ++last;
-      total += accumulate(std::get<0>(*it), last, 0);
+      total += accumulate(first, last, 0);
     }
     return total;
   }
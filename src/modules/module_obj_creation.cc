@@ -37,6 +37,7 @@
 #include "machine/rloperation.h"
 #include "machine/rloperation/default_value.h"
 #include "machine/rloperation/rect_t.h"
+#include "modules/module_grp.h"
 #include "modules/module_obj.h"
 #include "systems/base/colour_filter_object_data.h"
 #include "systems/base/digits_graphics_object.h"
@@ -57,14 +58,13 @@ namespace {
 
 void SetObjectDataToGan(RLMachine& machine,
                         GraphicsObject& obj,
-                        std::string& imgFilename,
+                        const std::string& imgFilename,
                         const std::string& ganFilename) {
   // TODO(erg): This is a hack and probably a source of errors. Figure out what
   // '???' means when used as the first parameter to objOfFileGan.
-  if (imgFilename == "???")
-    imgFilename = ganFilename;
+  const std::string& image = imgFilename == "???" ? ganFilename : imgFilename;
   obj.SetObjectData(
-      new GanGraphicsObjectData(machine.system(), ganFilename, imgFilename));
+      new GanGraphicsObjectData(machine.system(), ganFilename, image));
 }
 
 typedef std::function<void(RLMachine&, GraphicsObject& obj, const string&)>
@@ -73,6 +73,7 @@ typedef std::function<void(RLMachine&, GraphicsObject& obj, const string&)>
 void objOfFileLoader(RLMachine& machine,
                      GraphicsObject& obj,
                      const std::string& val) {
+  PrefetchUpcomingImages(machine);
   obj.SetObjectData(machine.system().graphics().BuildObjOfFile(val));
 }
 
@@ -99,24 +100,24 @@ void objOfDigitsLoader(RLMachine& machine,
   obj.SetObjectData(new DigitsGraphicsObject(machine.system(), value));
 }
 
-struct objGeneric_0 : public RLOpcode<IntConstant_T, StrConstant_T> {
+struct objGeneric_0 : public RLOpcode<IntConstant_T, StrRef_T> {
   DataFunction data_fun_;
   explicit objGeneric_0(const DataFunction& fun) : data_fun_(fun) {}
 
-  void operator()(RLMachine& machine, int buf, std::string filename) {
+  void operator()(RLMachine& machine, int buf, const std::string& filename) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     data_fun_(machine, obj, filename);
   }
 };
 
 struct objGeneric_1
-    : public RLOpcode<IntConstant_T, StrConstant_T, IntConstant_T> {
+    : public RLOpcode<IntConstant_T, StrRef_T, IntConstant_T> {
   DataFunction data_fun_;
   explicit objGeneric_1(const DataFunction& fun) : data_fun_(fun) {}
 
   void operator()(RLMachine& machine,
                   int buf,
-                  std::string filename,
+                  const std::string& filename,
                   int visible) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     data_fun_(machine, obj, filename);
@@ -125,7 +126,7 @@ struct objGeneric_1
 };
 
 struct objGeneric_2 : public RLOpcode<IntConstant_T,
-                                         StrConstant_T,
+                                         StrRef_T,
                                          IntConstant_T,
                                          IntConstant_T,
                                          IntConstant_T> {
@@ -134,7 +135,7 @@ struct objGeneric_2 : public RLOpcode<IntConstant_T,
 
   void operator()(RLMachine& machine,
                   int buf,
-                  std::string filename,
+                  const std::string& filename,
                   int visible,
                   int x,
                   int y) {
@@ -147,7 +148,7 @@ struct objGeneric_2 : public RLOpcode<IntConstant_T,
 };
 
 struct objGeneric_3 : public RLOpcode<IntConstant_T,
-                                         StrConstant_T,
+                                         StrRef_T,
                                          IntConstant_T,
                                          IntConstant_T,
                                          IntConstant_T,
@@ -157,7 +158,7 @@ struct objGeneric_3 : public RLOpcode<IntConstant_T,
 
   void operator()(RLMachine& machine,
                   int buf,
-                  string filename,
+                  const string& filename,
                   int visible,
                   int x,
                   int y,
@@ -172,7 +173,7 @@ struct objGeneric_3 : public RLOpcode<IntConstant_T,
 };
 
 struct objGeneric_4 : public RLOpcode<IntConstant_T,
-                                         StrConstant_T,
+                                         StrRef_T,
                                          IntConstant_T,
                                          IntConstant_T,
                                          IntConstant_T,
@@ -184,7 +185,7 @@ struct objGeneric_4 : public RLOpcode<IntConstant_T,
 
   void operator()(RLMachine& machine,
                   int buf,
-                  string filename,
+                  const string& filename,
                   int visible,
                   int x,
                   int y,
@@ -204,11 +205,11 @@ struct objGeneric_4 : public RLOpcode<IntConstant_T,
 };
 
 struct objOfFileGan_0
-    : public RLOpcode<IntConstant_T, StrConstant_T, StrConstant_T> {
+    : public RLOpcode<IntConstant_T, StrRef_T, StrRef_T> {
   void operator()(RLMachine& machine,
                   int buf,
-                  string imgFilename,
-                  string ganFilename) {
+                  const string& imgFilename,
+                  const string& ganFilename) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     SetObjectDataToGan(machine, obj, imgFilename, ganFilename);
     obj.SetVisible(true);
@@ -216,13 +217,13 @@ struct objOfFileGan_0
 };
 
 struct objOfFileGan_1 : public RLOpcode<IntConstant_T,
-                                           StrConstant_T,
-                                           StrConstant_T,
+                                           StrRef_T,
+                                           StrRef_T,
                                            IntConstant_T> {
   void operator()(RLMachine& machine,
                   int buf,
-                  string imgFilename,
-                  string ganFilename,
+                  const string& imgFilename,
+                  const string& ganFilename,
                   int visible) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     SetObjectDataToGan(machine, obj, imgFilename, ganFilename);
@@ -231,15 +232,15 @@ struct objOfFileGan_1 : public RLOpcode<IntConstant_T,
 };
 
 struct objOfFileGan_2 : public RLOpcode<IntConstant_T,
-                                           StrConstant_T,
-                                           StrConstant_T,
+                                           StrRef_T,
+                                           StrRef_T,
                                            IntConstant_T,
                                            IntConstant_T,
                                            IntConstant_T> {
   void operator()(RLMachine& machine,
                   int buf,
-                  string imgFilename,
-                  string ganFilename,
+                  const string& imgFilename,
+                  const string& ganFilename,
                   int visible,
                   int x,
                   int y) {
@@ -252,16 +253,16 @@ struct objOfFileGan_2 : public RLOpcode<IntConstant_T,
 };
 
 struct objOfFileGan_3 : public RLOpcode<IntConstant_T,
-                                           StrConstant_T,
-                                           StrConstant_T,
+                                           StrRef_T,
+                                           StrRef_T,
                                            IntConstant_T,
                                            IntConstant_T,
                                            IntConstant_T,
                                            IntConstant_T> {
   void operator()(RLMachine& machine,
                   int buf,
-                  string imgFilename,
-                  string ganFilename,
+                  const string& imgFilename,
+                  const string& ganFilename,
                   int visible,
                   int x,
                   int y,
@@ -362,13 +363,13 @@ struct objOfRect_2 : public RLOpcode<IntConstant_T,
 
 struct objOfChild_0 : public RLOpcode<IntConstant_T,
                                          IntConstant_T,
-                                         StrConstant_T,
-                                         StrConstant_T> {
+                                         StrRef_T,
+                                         StrRef_T> {
   void operator()(RLMachine& machine,
                   int buf,
                   int count,
-                  string imgFilename,
-                  string ganFilename) {
+                  const string& imgFilename,
+                  const string& ganFilename) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     obj.SetObjectData(new ParentGraphicsObjectData(count));
     obj.SetVisible(true);
@@ -377,14 +378,14 @@ struct objOfChild_0 : public RLOpcode<IntConstant_T,
 
 struct objOfChild_1 : public RLOpcode<IntConstant_T,
                                          IntConstant_T,
-                                         StrConstant_T,
-                                         StrConstant_T,
+                                         StrRef_T,
+                                         StrRef_T,
                                          IntConstant_T> {
   void operator()(RLMachine& machine,
                   int buf,
                   int count,
-                  string imgFilename,
-                  string ganFilename,
+                  const string& imgFilename,
+                  const string& ganFilename,
                   int visible) {
     GraphicsObject& obj = GetGraphicsObject(machine, this, buf);
     obj.SetObjectData(new ParentGraphicsObjectData(count));
@@ -394,16 +395,16 @@ struct objOfChild_1 : public RLOpcode<IntConstant_T,
 
 struct objOfChild_2 : public RLOpcode<IntConstant_T,
                                          IntConstant_T,
-                                         StrConstant_T,
-                                         StrConstant_T,
+                                         StrRef_T,
+                                         StrRef_T,
                                          IntConstant_T,
                                          IntConstant_T,
                                          IntConstant_T> {
   void operator()(RLMachine& machine,
                   int buf,
                   int count,
-                  string imgFilename,
-                  string ganFilename,
+                  const string& imgFilename,
+                  const string& ganFilename,
                   int visible,
                   int x,
                   int y) {
@@ -87,7 +87,15 @@ int main(int argc, char* argv[]) {
   opts.add_options()("help", "Produce help message")(
       "help-debug", "Print help message for people working on rlvm")(
       "version", "Display version and license information")(
-      "font", po::value<string>(), "Specifies TrueType font to use.");
+      "font", po::value<string>(), "Specifies TrueType font to use.")(
+      "preparse-threads", po::value<int>(),
+      "Parse game scripts ahead of time on this many background threads")(
+      "image-cache-mb", po::value<int>(),
+      "Megabytes of loaded images to keep around for reuse")(
+      "backlog-pages", po::value<int>(),
+      "Number of pages of text to keep for scrolling back")(
+      "backlog-mb", po::value<int>(),
+      "Megabytes of memory the text backlog may use");
 
   po::options_description debugOpts("Debugging Options");
   debugOpts.add_options()(
@@ -216,6 +224,18 @@ int main(int argc, char* argv[]) {
   if (vm.count("font"))
     instance.set_custom_font(vm["font"].as<string>());
 
+  if (vm.count("preparse-threads"))
+    instance.set_preparse_threads(vm["preparse-threads"].as<int>());
+
+  if (vm.count("image-cache-mb"))
+    instance.set_image_cache_megabytes(vm["image-cache-mb"].as<int>());
+
+  if (vm.count("backlog-pages"))
+    instance.set_backlog_pages(vm["backlog-pages"].as<int>());
+
+  if (vm.count("backlog-mb"))
+    instance.set_backlog_megabytes(vm["backlog-mb"].as<int>());
+
   instance.Run(gamerootPath);
 
   return 0;
@@ -29,6 +29,8 @@
 // The code in this file has been modified from the file anm.cc in
 // Jagarl's xkanon project.
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/export.hpp>
@@ -338,9 +340,15 @@ void AnmGraphicsObjectData::save(Archive& ar, unsigned int version) const {
 template void AnmGraphicsObjectData::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void AnmGraphicsObjectData::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void AnmGraphicsObjectData::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void AnmGraphicsObjectData::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
 
 BOOST_CLASS_EXPORT(AnmGraphicsObjectData);
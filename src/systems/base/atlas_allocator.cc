@@ -0,0 +1,97 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/atlas_allocator.h"
+
+// -----------------------------------------------------------------------
+// AtlasAllocator
+// -----------------------------------------------------------------------
+
+AtlasAllocator::AtlasAllocator(const Size& page_size, int padding)
+    : page_size_(page_size), padding_(padding) {}
+
+AtlasAllocator::~AtlasAllocator() {}
+
+bool AtlasAllocator::Allocate(const Size& size, Allocation* allocation) {
+  Size padded(size.width() + padding_, size.height() + padding_);
+  if (size.width() <= 0 || size.height() <= 0 ||
+      padded.width() > page_size_.width() ||
+      padded.height() > page_size_.height())
+    return false;
+
+  Point origin;
+  int page = 0;
+  for (; page < static_cast<int>(pages_.size()); ++page) {
+    if (AllocateOnPage(pages_[page], padded, &origin))
+      break;
+  }
+  if (page == static_cast<int>(pages_.size())) {
+    pages_.emplace_back();
+    AllocateOnPage(pages_.back(), padded, &origin);
+  }
+
+  pages_[page].allocations++;
+  allocation->page = page;
+  allocation->rect = Rect(origin, size);
+  return true;
+}
+
+bool AtlasAllocator::Free(const Allocation& allocation) {
+  Page& page = pages_[allocation.page];
+  if (--page.allocations > 0)
+    return false;
+
+  page.shelves.clear();
+  page.next_y = 0;
+  return true;
+}
+
+bool AtlasAllocator::AllocateOnPage(Page& page,
+                                    const Size& size,
+                                    Point* origin) {
+  Shelf* best = NULL;
+  for (Shelf& shelf : page.shelves) {
+    if (shelf.height >= size.height() &&
+        shelf.next_x + size.width() <= page_size_.width() &&
+        (!best || shelf.height < best->height))
+      best = &shelf;
+  }
+
+  if (!best) {
+    if (page.next_y + size.height() > page_size_.height())
+      return false;
+    Shelf shelf = {page.next_y, size.height(), 0};
+    page.shelves.push_back(shelf);
+    page.next_y += size.height();
+    best = &page.shelves.back();
+  }
+
+  *origin = Point(best->next_x, best->y);
+  best->next_x += size.width();
+  return true;
+}
@@ -0,0 +1,98 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_ATLAS_ALLOCATOR_H_
+#define SRC_SYSTEMS_BASE_ATLAS_ALLOCATOR_H_
+
+#include <vector>
+
+#include "systems/base/rect.h"
+
+// Packs small images into fixed size pages so that they can share one
+// texture. Each page is filled with shelves: rows as tall as the first image
+// placed on them, filled left to right. Space is only given back when a whole
+// page empties, which suits the buttons, window parts and digits that get
+// packed; they tend to be loaded and dropped together.
+//
+// This only does the bookkeeping. The graphics system owns the textures the
+// pages stand for.
+class AtlasAllocator {
+ public:
+  struct Allocation {
+    Allocation() : page(-1) {}
+
+    // Index of the page, counting from 0 in the order they were opened.
+    int page;
+
+    // Where on the page the image goes. Neighbours are at least |padding|
+    // pixels away.
+    Rect rect;
+  };
+
+  AtlasAllocator(const Size& page_size, int padding);
+  ~AtlasAllocator();
+
+  // Finds room for |size|, opening a new page if none of the current ones
+  // have it. Returns false if |size| wouldn't fit on even an empty page.
+  bool Allocate(const Size& size, Allocation* allocation);
+
+  // Returns an allocation. When it was the last one on its page, the page's
+  // space is reset for reuse and this returns true.
+  bool Free(const Allocation& allocation);
+
+  const Size& page_size() const { return page_size_; }
+  int page_count() const { return pages_.size(); }
+
+  // Number of live allocations on |page|.
+  int allocations_on_page(int page) const { return pages_[page].allocations; }
+
+ private:
+  struct Shelf {
+    int y;
+    int height;
+    int next_x;
+  };
+
+  struct Page {
+    Page() : next_y(0), allocations(0) {}
+
+    std::vector<Shelf> shelves;
+    int next_y;
+    int allocations;
+  };
+
+  // Places |size| (already padded) on |page|. Prefers the shortest shelf it
+  // fits on, then a new shelf.
+  bool AllocateOnPage(Page& page, const Size& size, Point* origin);
+
+  Size page_size_;
+  int padding_;
+  std::vector<Page> pages_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_ATLAS_ALLOCATOR_H_
@@ -24,6 +24,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/export.hpp>
@@ -35,6 +37,7 @@
 
 #include "systems/base/colour.h"
 #include "systems/base/colour_filter.h"
+#include "systems/base/draw_list.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_system.h"
 #include "systems/base/system.h"
@@ -54,6 +57,7 @@ ColourFilter* ColourFilterObjectData::GetColourFilter() {
 
 void ColourFilterObjectData::Render(const GraphicsObject& go,
                                     const GraphicsObject* parent,
+                                    DrawList* draw_list,
                                     std::ostream* tree) {
   if (go.width() != 100 || go.height() != 100) {
     static bool printed = false;
@@ -64,7 +68,22 @@ void ColourFilterObjectData::Render(const GraphicsObject& go,
   }
 
   RGBAColour colour = go.colour();
-  GetColourFilter()->Fill(go, screen_rect_, colour);
+  if (draw_list) {
+    // Queued like an image so that it lands on top of what's under it and
+    // counts towards what changed this frame. Draws happen within the frame,
+    // while |go| and we are still around. The fill reads |go|'s alpha when
+    // it draws, so the record carries it (and the fill colour) for fades to
+    // count as damage.
+    DrawRecord record(go, std::shared_ptr<const Surface>(), Rect(),
+                      screen_rect_, go.GetComputedAlpha());
+    record.colour = colour;
+    record.custom_draw = [this, &go, colour]() {
+      GetColourFilter()->Fill(go, screen_rect_, colour);
+    };
+    draw_list->Add(record);
+  } else {
+    GetColourFilter()->Fill(go, screen_rect_, colour);
+  }
 
   if (tree) {
     *tree << "  ColourFilterObjectData" << std::endl
@@ -119,14 +138,20 @@ void ColourFilterObjectData::serialize(Archive& ar, unsigned int version) {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void ColourFilterObjectData::serialize<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void ColourFilterObjectData::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
 template void ColourFilterObjectData::serialize<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version);
+template void ColourFilterObjectData::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 BOOST_CLASS_EXPORT(ColourFilterObjectData);
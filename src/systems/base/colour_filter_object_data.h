@@ -37,6 +37,7 @@
 #include "systems/base/rect.h"
 
 class ColourFilter;
+class DrawList;
 class GraphicsObject;
 class GraphicsSystem;
 
@@ -56,6 +57,7 @@ class ColourFilterObjectData : public GraphicsObjectData {
   // Overridden from GraphicsObjectData:
   virtual void Render(const GraphicsObject& go,
                       const GraphicsObject* parent,
+                      DrawList* draw_list,
                       std::ostream* tree) override;
   virtual int PixelWidth(const GraphicsObject& rendering_properties) override;
   virtual int PixelHeight(const GraphicsObject& rendering_properties) override;
@@ -0,0 +1,68 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/damage_region.h"
+
+namespace {
+
+// Rect::Intersects() counts touching edges; here only shared pixels matter.
+bool overlaps(const Rect& a, const Rect& b) {
+  return a.x() < b.x2() && b.x() < a.x2() && a.y() < b.y2() && b.y() < a.y2();
+}
+
+}  // namespace
+
+DamageRegion::DamageRegion() : full_(false) {}
+
+DamageRegion::~DamageRegion() {}
+
+void DamageRegion::Add(const Rect& rect) {
+  if (full_ || isEmpty(rect))
+    return;
+
+  bounds_ = isEmpty(bounds_) ? rect : bounds_.RectUnion(rect);
+}
+
+void DamageRegion::AddAll() {
+  full_ = true;
+  bounds_ = Rect();
+}
+
+void DamageRegion::Clear() {
+  full_ = false;
+  bounds_ = Rect();
+}
+
+Rect DamageRegion::GetBounds(const Rect& screen) const {
+  if (full_)
+    return screen;
+
+  if (isEmpty(bounds_) || !overlaps(bounds_, screen))
+    return Rect();
+  return bounds_.Intersection(screen);
+}
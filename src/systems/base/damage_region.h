@@ -0,0 +1,67 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_DAMAGE_REGION_H_
+#define SRC_SYSTEMS_BASE_DAMAGE_REGION_H_
+
+#include "systems/base/rect.h"
+
+// The part of the screen that has changed since the last frame was drawn,
+// kept as the bounding rectangle of every change. Both backends clip the
+// redraw to a single scissor box, so tracking the individual rectangles
+// wouldn't save any pixels.
+class DamageRegion {
+ public:
+  DamageRegion();
+  ~DamageRegion();
+
+  // Marks |rect| as changed. Empty rectangles are ignored.
+  void Add(const Rect& rect);
+
+  // Marks everything as changed.
+  void AddAll();
+
+  void Clear();
+
+  bool empty() const { return !full_ && isEmpty(bounds_); }
+  bool is_full() const { return full_; }
+
+  // The smallest rectangle covering every change, clipped to |screen|. This
+  // is |screen| itself when is_full().
+  Rect GetBounds(const Rect& screen) const;
+
+ private:
+  static bool isEmpty(const Rect& rect) {
+    return rect.width() <= 0 || rect.height() <= 0;
+  }
+
+  Rect bounds_;
+  bool full_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_DAMAGE_REGION_H_
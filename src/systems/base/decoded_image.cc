@@ -0,0 +1,114 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/decoded_image.h"
+
+#include <cstdio>
+#include <sstream>
+
+#include "systems/base/system_error.h"
+#include "utilities/exception.h"
+#include "xclannad/file.h"
+
+// -----------------------------------------------------------------------
+// DecodedImage
+// -----------------------------------------------------------------------
+DecodedImage::DecodedImage() : width(0), height(0), has_alpha(false) {}
+
+DecodedImage::~DecodedImage() {}
+
+// -----------------------------------------------------------------------
+
+std::shared_ptr<DecodedImage> DecodeImageFile(
+    const boost::filesystem::path& path) {
+  // Glue code to allow my stuff to work with Jagarl's loader
+  FILE* file = fopen(path.string().c_str(), "rb");
+  if (!file) {
+    std::ostringstream oss;
+    oss << "Could not open file: " << path;
+    throw rlvm::Exception(oss.str());
+  }
+
+  fseek(file, 0, SEEK_END);
+  size_t size = ftell(file);
+  std::unique_ptr<char[]> d(new char[size + 1]);
+  fseek(file, 0, SEEK_SET);
+  fread(d.get(), size, 1, file);
+  fclose(file);
+
+  std::unique_ptr<GRPCONV> conv(
+      GRPCONV::AssignConverter(d.get(), size, "???"));
+  if (conv == 0) {
+    throw SystemError("Failure in GRPCONV.");
+  }
+
+  std::shared_ptr<DecodedImage> image(new DecodedImage);
+  image->width = conv->Width();
+  image->height = conv->Height();
+
+  std::unique_ptr<char[]> mem(
+      new char[image->width * image->height * 4 + 1024]);
+  if (conv->Read(mem.get())) {
+    image->has_alpha = conv->IsMask();
+    if (image->has_alpha) {
+      int len = image->width * image->height;
+      const unsigned int* p = reinterpret_cast<unsigned int*>(mem.get());
+      int i;
+      for (i = 0; i < len; i++) {
+        if ((*p & 0xff000000) != 0xff000000)
+          break;
+        p++;
+      }
+      if (i == len) {
+        image->has_alpha = false;
+      }
+    }
+
+    image->pixels = std::move(mem);
+  }
+
+  // Grab the Type-2 information out of the converter or create one
+  // default region if none exist
+  for (const GRPCONV::REGION& region : conv->region_table) {
+    Surface::GrpRect rect;
+    rect.rect =
+        Rect(Point(region.x1, region.y1), Point(region.x2 + 1, region.y2 + 1));
+    rect.originX = region.origin_x;
+    rect.originY = region.origin_y;
+    image->regions.push_back(rect);
+  }
+  if (image->regions.empty()) {
+    Surface::GrpRect rect;
+    rect.rect = Rect(Point(0, 0), Size(image->width, image->height));
+    rect.originX = 0;
+    rect.originY = 0;
+    image->regions.push_back(rect);
+  }
+
+  return image;
+}
@@ -0,0 +1,64 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_DECODED_IMAGE_H_
+#define SRC_SYSTEMS_BASE_DECODED_IMAGE_H_
+
+#include <boost/filesystem/path.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "systems/base/surface.h"
+
+// An image file decoded into CPU side pixels, before it has been turned into
+// a platform Surface. Produced by DecodeImageFile() on any thread.
+struct DecodedImage {
+  DecodedImage();
+  ~DecodedImage();
+
+  int width;
+  int height;
+
+  // |width| * |height| 32-bit pixels in the order xclannad's GRPCONV writes
+  // them, or NULL if the file header was readable but the pixels weren't.
+  std::unique_ptr<char[]> pixels;
+
+  // Whether any pixel is less than fully opaque.
+  bool has_alpha;
+
+  // The type 2 regions of a g00, or a single region covering the image.
+  std::vector<Surface::GrpRect> regions;
+};
+
+// Reads and decodes the g00/pdt/etc. at |path|. Doesn't touch any graphics
+// state, so it can run on a worker thread. Throws on errors.
+std::shared_ptr<DecodedImage> DecodeImageFile(
+    const boost::filesystem::path& path);
+
+#endif  // SRC_SYSTEMS_BASE_DECODED_IMAGE_H_
@@ -0,0 +1,131 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/decoded_voice_cache.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#include "systems/base/voice_archive.h"
+
+// -----------------------------------------------------------------------
+// DecodedVoiceCache
+// -----------------------------------------------------------------------
+DecodedVoiceCache::DecodedVoiceCache(int capacity)
+    : decoded_cache_(capacity),
+      decoding_id_(-1),
+      shutting_down_(false),
+      hits_(0),
+      misses_(0) {}
+
+DecodedVoiceCache::~DecodedVoiceCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    queue_.clear();
+  }
+  queue_changed_.notify_all();
+
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void DecodedVoiceCache::Prefetch(int id, std::shared_ptr<VoiceSample> sample) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == decoding_id_ || decoded_cache_.exists(id))
+      return;
+    for (const Request& request : queue_) {
+      if (request.first == id)
+        return;
+    }
+
+    queue_.push_back(Request(id, sample));
+    if (!thread_.joinable())
+      thread_ = std::thread(&DecodedVoiceCache::DecodeLoop, this);
+  }
+  queue_changed_.notify_one();
+}
+
+std::unique_ptr<VoiceStream> DecodedVoiceCache::OpenStream(int id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  decoded_.wait(lock, [&] { return decoding_id_ != id; });
+
+  std::shared_ptr<const char> wav = decoded_cache_.fetch(id);
+  if (wav) {
+    hits_++;
+    return VoiceSample::OpenDecodedStream(wav);
+  }
+
+  // The caller is about to decode |id| itself.
+  misses_++;
+  queue_.erase(std::remove_if(queue_.begin(),
+                              queue_.end(),
+                              [&](const Request& r) { return r.first == id; }),
+               queue_.end());
+  return std::unique_ptr<VoiceStream>();
+}
+
+void DecodedVoiceCache::WaitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  decoded_.wait(lock, [&] { return queue_.empty() && decoding_id_ == -1; });
+}
+
+void DecodedVoiceCache::DecodeLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_changed_.wait(lock, [&] { return shutting_down_ || !queue_.empty(); });
+    if (shutting_down_)
+      return;
+
+    Request request = queue_.front();
+    queue_.pop_front();
+    decoding_id_ = request.first;
+
+    // Each VoiceSample has its own file handle, so decoding can run unlocked
+    // alongside playback.
+    lock.unlock();
+    std::shared_ptr<const char> wav;
+    try {
+      int size;
+      wav.reset(request.second->Decode(&size), std::default_delete<char[]>());
+    }
+    catch (std::exception& e) {
+      std::cerr << "Couldn't prefetch voice " << request.first << ": "
+                << e.what() << std::endl;
+    }
+    request.second.reset();
+    lock.lock();
+
+    if (wav)
+      decoded_cache_.insert(request.first, wav);
+    decoding_id_ = -1;
+    decoded_.notify_all();
+  }
+}
@@ -0,0 +1,93 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_DECODED_VOICE_CACHE_H_
+#define SRC_SYSTEMS_BASE_DECODED_VOICE_CACHE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "lru_cache.hpp"
+
+class VoiceSample;
+class VoiceStream;
+
+// Decodes voice samples on a background thread before they're played, and
+// keeps the last |capacity| of them keyed by voice id. The thread is only
+// started once something is prefetched.
+class DecodedVoiceCache {
+ public:
+  explicit DecodedVoiceCache(int capacity);
+  ~DecodedVoiceCache();
+
+  // Queues |sample| to be decoded as |id| unless it already is decoded or
+  // queued.
+  void Prefetch(int id, std::shared_ptr<VoiceSample> sample);
+
+  // Returns a stream over the decoded |id|, waiting if it's being decoded
+  // right now, and counts a hit. Otherwise counts a miss, drops |id| from the
+  // queue and returns NULL.
+  std::unique_ptr<VoiceStream> OpenStream(int id);
+
+  // Blocks until everything queued has been decoded.
+  void WaitUntilIdle();
+
+  int hits() const { return hits_; }
+  int misses() const { return misses_; }
+
+ private:
+  typedef std::pair<int, std::shared_ptr<VoiceSample>> Request;
+
+  void DecodeLoop();
+
+  std::mutex mutex_;
+
+  // Signaled when |queue_| gets a request, or on shutdown.
+  std::condition_variable queue_changed_;
+
+  // Signaled whenever the background thread finishes a decode.
+  std::condition_variable decoded_;
+
+  std::deque<Request> queue_;
+  LRUCache<int, std::shared_ptr<const char>> decoded_cache_;
+
+  // The id the background thread is decoding, or -1.
+  int decoding_id_;
+
+  bool shutting_down_;
+  std::thread thread_;
+
+  int hits_;
+  int misses_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_DECODED_VOICE_CACHE_H_
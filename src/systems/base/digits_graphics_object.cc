@@ -24,6 +24,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/export.hpp>
@@ -168,13 +170,19 @@ BOOST_CLASS_EXPORT(DigitsGraphicsObject);
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void DigitsGraphicsObject::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void DigitsGraphicsObject::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void DigitsGraphicsObject::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void DigitsGraphicsObject::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
@@ -0,0 +1,245 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/draw_list.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "systems/base/damage_region.h"
+#include "systems/base/graphics_object.h"
+#include "systems/base/surface.h"
+
+namespace {
+
+// How many records back Sort() looks for a batch to join. Keeps sorting
+// linear; a frame rarely has more objects in play than this between two
+// draws of the same image anyway.
+const int kMaxLookback = 32;
+
+// Whether |a| and |b| share a pixel; Rect::Intersects() counts touching edges.
+bool sharesPixels(const Rect& a, const Rect& b) {
+  return a.x() < b.x2() && b.x() < a.x2() && a.y() < b.y2() && b.y() < a.y2();
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// DrawRecord
+// -----------------------------------------------------------------------
+
+DrawRecord::DrawRecord()
+    : surface_version(0),
+      alpha(255),
+      composite_mode(0),
+      rotation(0),
+      tint(RGBColour::Black()),
+      colour(RGBAColour::Clear()),
+      light(0),
+      mono(0),
+      invert(0) {}
+
+DrawRecord::DrawRecord(const GraphicsObject& go,
+                       std::shared_ptr<const Surface> surface,
+                       const Rect& src,
+                       const Rect& dst,
+                       int alpha)
+    : surface(surface),
+      surface_version(0),
+      src(src),
+      dst(dst),
+      alpha(alpha),
+      composite_mode(go.composite_mode()),
+      rotation(go.rotation()),
+      rep_origin(go.rep_origin_x(), go.rep_origin_y()),
+      tint(go.tint()),
+      colour(go.colour()),
+      light(go.light()),
+      mono(go.mono()),
+      invert(go.invert()) {}
+
+bool DrawRecord::NeedsShading() const {
+  return light || tint != RGBColour::Black() || colour != RGBAColour::Clear() ||
+         mono || invert;
+}
+
+bool DrawRecord::SameState(const DrawRecord& other) const {
+  if (custom_draw || other.custom_draw)
+    return false;
+  if (composite_mode != other.composite_mode)
+    return false;
+
+  bool shading = NeedsShading();
+  if (shading != other.NeedsShading())
+    return false;
+
+  // Without the shader, alpha is a vertex colour; with it, it's a uniform
+  // like the rest.
+  return !shading ||
+         (alpha == other.alpha && tint == other.tint &&
+          colour == other.colour && light == other.light &&
+          mono == other.mono && invert == other.invert);
+}
+
+bool DrawRecord::SameDraw(const DrawRecord& other) const {
+  return surface == other.surface && surface_version == other.surface_version &&
+         src == other.src && dst == other.dst && alpha == other.alpha &&
+         composite_mode == other.composite_mode && rotation == other.rotation &&
+         rep_origin == other.rep_origin && tint == other.tint &&
+         colour == other.colour && light == other.light &&
+         mono == other.mono && invert == other.invert &&
+         bool(custom_draw) == bool(other.custom_draw);
+}
+
+Rect DrawRecord::Bounds() const {
+  if (rotation % 3600 == 0)
+    return dst;
+
+  // The image turns around a point somewhere in or near |dst|; anything in
+  // reach of it is fair game.
+  int reach =
+      static_cast<int>(std::ceil(std::hypot(dst.width(), dst.height()))) +
+      std::abs(rep_origin.x()) + std::abs(rep_origin.y());
+  return Rect::GRP(dst.x() - reach,
+                   dst.y() - reach,
+                   dst.x2() + reach,
+                   dst.y2() + reach);
+}
+
+// -----------------------------------------------------------------------
+// DrawList
+// -----------------------------------------------------------------------
+
+DrawList::DrawList() : records_submitted_(0), batches_submitted_(0) {}
+
+DrawList::~DrawList() {}
+
+void DrawList::Add(const DrawRecord& record) {
+  records_.push_back(record);
+  if (record.surface)
+    records_.back().surface_version = record.surface->content_version();
+}
+
+void DrawList::Sort() {
+  std::vector<DrawRecord> sorted;
+  std::vector<Rect> bounds;
+  sorted.reserve(records_.size());
+  bounds.reserve(records_.size());
+
+  for (DrawRecord& record : records_) {
+    Rect record_bounds = record.Bounds();
+
+    // Walk back to the nearest record we can batch with, giving up at the
+    // first one we'd have to be drawn under.
+    size_t insert_at = sorted.size();
+    for (size_t i = sorted.size(), looked = 0; i > 0 && looked < kMaxLookback;
+         --i, ++looked) {
+      if (CanBatch(sorted[i - 1], record)) {
+        insert_at = i;
+        break;
+      }
+      if (bounds[i - 1].Intersects(record_bounds))
+        break;
+    }
+
+    sorted.insert(sorted.begin() + insert_at, std::move(record));
+    bounds.insert(bounds.begin() + insert_at, record_bounds);
+  }
+
+  records_.swap(sorted);
+}
+
+std::vector<DrawList::Batch> DrawList::GetBatches() const {
+  std::vector<Batch> batches;
+  size_t begin = 0;
+  for (size_t i = 1; i <= records_.size(); ++i) {
+    if (i == records_.size() || !CanBatch(records_[begin], records_[i])) {
+      batches.emplace_back(begin, i);
+      begin = i;
+    }
+  }
+  return batches;
+}
+
+void DrawList::Flush() {
+  if (records_.empty())
+    return;
+
+  Sort();
+  for (const Batch& batch : GetBatches()) {
+    const DrawRecord& first = records_[batch.first];
+    if (first.custom_draw)
+      first.custom_draw();
+    else
+      SubmitBatch(&first, &records_[0] + batch.second);
+    ++batches_submitted_;
+  }
+  records_submitted_ += records_.size();
+  records_.clear();
+}
+
+void DrawList::Clear() { records_.clear(); }
+
+void DrawList::CollectDamage(DamageRegion* damage) {
+  // Records are compared in queue order. Something appearing part way down
+  // makes everything after it look changed, which redraws more than needed
+  // but never less.
+  size_t count = std::max(records_.size(), last_frame_.size());
+  for (size_t i = 0; i < count; ++i) {
+    if (i >= last_frame_.size()) {
+      damage->Add(records_[i].Bounds());
+    } else if (i >= records_.size()) {
+      damage->Add(last_frame_[i].Bounds());
+    } else if (!records_[i].SameDraw(last_frame_[i])) {
+      damage->Add(last_frame_[i].Bounds());
+      damage->Add(records_[i].Bounds());
+    }
+  }
+
+  last_frame_ = records_;
+}
+
+void DrawList::ClipTo(const Rect& area) {
+  records_.erase(std::remove_if(records_.begin(),
+                                records_.end(),
+                                [&area](const DrawRecord& record) {
+                                  return !sharesPixels(record.Bounds(), area);
+                                }),
+                 records_.end());
+}
+
+bool DrawList::CanBatch(const DrawRecord& a, const DrawRecord& b) const {
+  return a.surface == b.surface && a.SameState(b);
+}
+
+void DrawList::SubmitBatch(const DrawRecord* begin, const DrawRecord* end) {
+  for (; begin != end; ++begin)
+    begin->surface->RenderToScreenAsObject(*begin);
+}
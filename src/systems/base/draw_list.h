@@ -0,0 +1,163 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_DRAW_LIST_H_
+#define SRC_SYSTEMS_BASE_DRAW_LIST_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "systems/base/colour.h"
+#include "systems/base/rect.h"
+
+class DamageRegion;
+class GraphicsObject;
+class Surface;
+
+// Everything needed to draw one object's image to the screen, copied out of
+// the GraphicsObject so that the draw can be deferred, reordered and batched
+// with others.
+struct DrawRecord {
+  DrawRecord();
+
+  // Captures how |go| draws |src| of |surface| to |dst| at |alpha|.
+  DrawRecord(const GraphicsObject& go,
+             std::shared_ptr<const Surface> surface,
+             const Rect& src,
+             const Rect& dst,
+             int alpha);
+
+  // Whether drawing needs the object shader (tint, colour, light, mono or
+  // invert are set).
+  bool NeedsShading() const;
+
+  // Whether |other| draws with the same blending and shader uniforms, so that
+  // both can go in one batch if they also share a texture.
+  bool SameState(const DrawRecord& other) const;
+
+  // Whether this puts exactly the same pixels on the screen as |other| did,
+  // assuming nothing under either changed.
+  bool SameDraw(const DrawRecord& other) const;
+
+  // The part of the screen this may touch, rotation included.
+  Rect Bounds() const;
+
+  std::shared_ptr<const Surface> surface;
+  // surface->content_version() when queued.
+  int surface_version;
+
+  Rect src;
+  Rect dst;
+  int alpha;
+
+  int composite_mode;
+
+  // In tenths of a degree, around the centre of |dst| plus |rep_origin|.
+  int rotation;
+  Point rep_origin;
+
+  RGBColour tint;
+  RGBAColour colour;
+  int light;
+  int mono;
+  int invert;
+
+  // Draws something that isn't an image, in place of drawing |surface|. It
+  // must only touch |dst| and must look the same whenever the rest of the
+  // record does. Never batched.
+  std::function<void()> custom_draw;
+};
+
+// Collects the object draws of a frame so that a graphics backend can submit
+// runs of draws that share a texture and state in one go instead of setting
+// everything up per object.
+//
+// Records may be reordered to bring batchable ones together, but a record is
+// never moved past another that it overlaps, so the screen looks the same as
+// when drawing in order. Anything that draws to the screen itself must
+// Flush() first so that it lands on top of what's been queued.
+class DrawList {
+ public:
+  // A run of records [begin, end) in records() that can be drawn together.
+  typedef std::pair<size_t, size_t> Batch;
+
+  DrawList();
+  virtual ~DrawList();
+
+  void Add(const DrawRecord& record);
+
+  // Reorders the queued records to group batchable ones.
+  void Sort();
+
+  // The runs of batchable records in the current order.
+  std::vector<Batch> GetBatches() const;
+
+  // Sorts and submits everything queued, and empties the list.
+  void Flush();
+
+  // Throws away the queued records without drawing them.
+  void Clear();
+
+  // Adds to |damage| everywhere the queued records draw differently from the
+  // ones queued the last time this was called, and remembers these for next
+  // time. Call before Flush().
+  void CollectDamage(DamageRegion* damage);
+
+  // Drops queued records that don't touch |area|.
+  void ClipTo(const Rect& area);
+
+  const std::vector<DrawRecord>& records() const { return records_; }
+  bool empty() const { return records_.empty(); }
+
+  // Totals since construction, for statistics.
+  int records_submitted() const { return records_submitted_; }
+  int batches_submitted() const { return batches_submitted_; }
+
+ protected:
+  // Whether |a| and |b| can be drawn in one batch. The default requires the
+  // same surface; backends that share textures between surfaces can loosen
+  // that.
+  virtual bool CanBatch(const DrawRecord& a, const DrawRecord& b) const;
+
+  // Draws a run of batchable records. The default draws each through
+  // Surface::RenderToScreenAsObject().
+  virtual void SubmitBatch(const DrawRecord* begin, const DrawRecord* end);
+
+ private:
+  std::vector<DrawRecord> records_;
+
+  // What was queued at the last CollectDamage().
+  std::vector<DrawRecord> last_frame_;
+
+  int records_submitted_;
+  int batches_submitted_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_DRAW_LIST_H_
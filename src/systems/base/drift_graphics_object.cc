@@ -24,6 +24,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/export.hpp>
@@ -33,6 +35,7 @@
 #include <string>
 #include <vector>
 
+#include "systems/base/draw_list.h"
 #include "systems/base/event_system.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_system.h"
@@ -76,6 +79,7 @@ DriftGraphicsObject::~DriftGraphicsObject() {}
 
 void DriftGraphicsObject::Render(const GraphicsObject& go,
                                  const GraphicsObject* parent,
+                                 DrawList* draw_list,
                                  std::ostream* tree) {
   std::shared_ptr<const Surface> surface = CurrentSurface(go);
   if (surface) {
@@ -164,7 +168,18 @@ void DriftGraphicsObject::Render(const GraphicsObject& go,
       if (go.has_clip_rect())
         ClipDestination(go.clip_rect(), src, dest);
 
-      surface->RenderToScreen(src, dest, particle.alpha);
+      if (draw_list) {
+        // Each particle is a plain image draw, so particles batch together
+        // and only where they've been and gone gets redrawn.
+        DrawRecord record;
+        record.surface = surface;
+        record.src = src;
+        record.dst = dest;
+        record.alpha = particle.alpha;
+        draw_list->Add(record);
+      } else {
+        surface->RenderToScreen(src, dest, particle.alpha);
+      }
     }
   }
 }
@@ -226,13 +241,19 @@ BOOST_CLASS_EXPORT(DriftGraphicsObject);
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void DriftGraphicsObject::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void DriftGraphicsObject::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void DriftGraphicsObject::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void DriftGraphicsObject::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
@@ -38,6 +38,7 @@
 #include "systems/base/graphics_object_data.h"
 #include "machine/serialization.h"
 
+class DrawList;
 class GraphicsObject;
 class Surface;
 class System;
@@ -61,6 +62,7 @@ class DriftGraphicsObject : public GraphicsObjectData {
   // Implementation of GraphicsObjectData:
   virtual void Render(const GraphicsObject& go,
                       const GraphicsObject* parent,
+                      DrawList* draw_list,
                       std::ostream* tree) override;
   virtual int PixelWidth(const GraphicsObject& rendering_properties) override;
   virtual int PixelHeight(const GraphicsObject& rendering_properties) override;
@@ -0,0 +1,182 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/glyph_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "systems/base/colour.h"
+
+namespace {
+
+int64_t advanceKey(int size, int codepoint) {
+  return (static_cast<int64_t>(size) << 32) | static_cast<uint32_t>(codepoint);
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// GlyphCache
+// -----------------------------------------------------------------------
+
+GlyphCache::GlyphCache(const Size& page_size, int max_pages)
+    : page_size_(page_size),
+      max_pages_(max_pages),
+      allocator_(page_size, 0),
+      hits_(0),
+      misses_(0) {}
+
+GlyphCache::~GlyphCache() {}
+
+const GlyphCache::Glyph* GlyphCache::Find(const std::string& text,
+                                          int size,
+                                          bool italic) {
+  auto it = glyphs_.find(Key{text, size, italic});
+  if (it == glyphs_.end()) {
+    misses_++;
+    return NULL;
+  }
+
+  hits_++;
+  return &it->second;
+}
+
+const GlyphCache::Glyph* GlyphCache::Insert(const std::string& text,
+                                            int size,
+                                            bool italic,
+                                            const Size& mask_size,
+                                            const uint8_t* coverage,
+                                            int pitch) {
+  Glyph glyph;
+  glyph.size = mask_size;
+
+  int mask_pitch = 0;
+  uint8_t* mask = AllocateMask(mask_size, &mask_pitch);
+  if (!mask) {
+    oversized_.emplace_back(mask_size.width() * mask_size.height());
+    mask = oversized_.back().data();
+    mask_pitch = mask_size.width();
+  }
+
+  for (int y = 0; y < mask_size.height(); ++y) {
+    memcpy(mask + y * mask_pitch, coverage + y * pitch, mask_size.width());
+  }
+  glyph.coverage = mask;
+  glyph.pitch = mask_pitch;
+
+  Glyph& stored = glyphs_[Key{text, size, italic}];
+  stored = glyph;
+  return &stored;
+}
+
+bool GlyphCache::FindAdvance(int size, int codepoint, int* advance) const {
+  auto it = advances_.find(advanceKey(size, codepoint));
+  if (it == advances_.end())
+    return false;
+
+  *advance = it->second;
+  return true;
+}
+
+void GlyphCache::SetAdvance(int size, int codepoint, int advance) {
+  advances_[advanceKey(size, codepoint)] = advance;
+}
+
+void GlyphCache::Clear() {
+  glyphs_.clear();
+  oversized_.clear();
+  pages_.clear();
+  allocator_ = AtlasAllocator(page_size_, 0);
+}
+
+// static
+Rect GlyphCache::Blend(const Glyph& glyph,
+                       const RGBColour& colour,
+                       const Point& origin,
+                       uint32_t* surface,
+                       int surface_pitch,
+                       const Size& surface_size) {
+  Rect area = Rect(origin, glyph.size).Intersection(Rect(Point(0, 0),
+                                                         surface_size));
+  if (area.is_empty())
+    return area;
+
+  const int sR = colour.r(), sG = colour.g(), sB = colour.b();
+  const uint32_t bare_colour = (sR << 16) | (sG << 8) | sB;
+  for (int y = area.y(); y < area.y2(); ++y) {
+    const uint8_t* src = glyph.coverage +
+                         (y - origin.y()) * glyph.pitch +
+                         (area.x() - origin.x());
+    uint32_t* dst = reinterpret_cast<uint32_t*>(
+        reinterpret_cast<char*>(surface) + y * surface_pitch) + area.x();
+    for (int x = 0; x < area.width(); ++x) {
+      // pygame's ALPHA_BLEND(). Uncovered pixels come out unchanged, except
+      // on transparent pixels: TTF_RenderUTF8_Blended() fills the whole box
+      // with the colour, so those take it on with the coverage as alpha.
+      // Written without branches so that it vectorizes.
+      int sA = src[x];
+      uint32_t pixel = dst[x];
+      int dA = pixel >> 24;
+      int dR = (pixel >> 16) & 0xff, dG = (pixel >> 8) & 0xff,
+          dB = pixel & 0xff;
+      dR = ((dR << 8) + (sR - dR) * sA + sR) >> 8;
+      dG = ((dG << 8) + (sG - dG) * sA + sG) >> 8;
+      dB = ((dB << 8) + (sB - dB) * sA + sB) >> 8;
+      dA = sA + dA - ((sA * dA) / 255);
+      uint32_t blended = (uint32_t(dA) << 24) | (dR << 16) | (dG << 8) | dB;
+      uint32_t copied = (uint32_t(sA) << 24) | bare_colour;
+      uint32_t transparent = (pixel >> 24) == 0 ? ~0u : 0u;
+      dst[x] = (copied & transparent) | (blended & ~transparent);
+    }
+  }
+
+  return area;
+}
+
+uint8_t* GlyphCache::AllocateMask(const Size& size, int* pitch) {
+  AtlasAllocator::Allocation allocation;
+  if (!allocator_.Allocate(size, &allocation))
+    return NULL;
+
+  if (allocation.page >= max_pages_) {
+    // Every page is full. Start over rather than tracking which glyphs are
+    // still in use; a page of text only needs a few hundred of them.
+    Clear();
+    allocator_.Allocate(size, &allocation);
+  }
+
+  while (allocation.page >= static_cast<int>(pages_.size())) {
+    pages_.emplace_back(
+        new uint8_t[page_size_.width() * page_size_.height()]);
+  }
+
+  *pitch = page_size_.width();
+  return pages_[allocation.page].get() +
+         allocation.rect.y() * page_size_.width() + allocation.rect.x();
+}
@@ -0,0 +1,144 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_GLYPH_CACHE_H_
+#define SRC_SYSTEMS_BASE_GLYPH_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "systems/base/atlas_allocator.h"
+#include "systems/base/rect.h"
+
+class RGBColour;
+
+// Remembers the glyphs a TextSystem has rasterized so that each character is
+// only drawn by the font renderer once. Glyphs are stored as 8-bit coverage
+// masks, without colour, packed onto a few fixed size atlas pages; the text
+// and shadow colours are applied while blending onto the destination. When
+// the pages fill up, the whole cache is dropped and starts again.
+//
+// Also keeps the advance of each (size, codepoint) for GetCharWidth().
+class GlyphCache {
+ public:
+  struct Glyph {
+    Glyph() : coverage(NULL), pitch(0) {}
+
+    Size size;
+
+    // The top left of the coverage mask, one byte per pixel, with |pitch|
+    // bytes between rows.
+    const uint8_t* coverage;
+    int pitch;
+  };
+
+  // Keeps at most |max_pages| atlas pages of |page_size| bytes.
+  GlyphCache(const Size& page_size, int max_pages);
+  ~GlyphCache();
+
+  // Returns the glyph for |text| at |size|, or NULL if it hasn't been
+  // inserted. Pointers stay valid until the next call to Insert() or Clear().
+  const Glyph* Find(const std::string& text, int size, bool italic);
+
+  // Copies a |mask_size| coverage mask into the cache. |pitch| is the number
+  // of bytes between rows of |coverage|.
+  const Glyph* Insert(const std::string& text,
+                      int size,
+                      bool italic,
+                      const Size& mask_size,
+                      const uint8_t* coverage,
+                      int pitch);
+
+  // Cached advances for GetCharWidth().
+  bool FindAdvance(int size, int codepoint, int* advance) const;
+  void SetAdvance(int size, int codepoint, int advance);
+
+  // Drops every glyph. Advances are kept.
+  void Clear();
+
+  // Colours |glyph| with |colour| and blends it onto a 32-bit ARGB surface of
+  // |surface_size| whose rows are |surface_pitch| bytes apart, with the
+  // glyph's top left corner at |origin|. This gives the same pixels as
+  // pygame_AlphaBlit()ing a TTF_RenderUTF8_Blended() surface of that colour.
+  // Returns the part of the surface that was written to.
+  static Rect Blend(const Glyph& glyph,
+                    const RGBColour& colour,
+                    const Point& origin,
+                    uint32_t* surface,
+                    int surface_pitch,
+                    const Size& surface_size);
+
+  int glyph_count() const { return glyphs_.size(); }
+  int page_count() const { return pages_.size(); }
+  int hits() const { return hits_; }
+  int misses() const { return misses_; }
+
+ private:
+  struct Key {
+    std::string text;
+    int size;
+    bool italic;
+
+    bool operator==(const Key& rhs) const {
+      return size == rhs.size && italic == rhs.italic && text == rhs.text;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<std::string>()(key.text) ^
+             (static_cast<size_t>(key.size) << 1) ^ key.italic;
+    }
+  };
+
+  // Finds room for a mask of |size|, resetting the cache if every page is
+  // full. Returns NULL if it won't fit on a page at all.
+  uint8_t* AllocateMask(const Size& size, int* pitch);
+
+  Size page_size_;
+  int max_pages_;
+
+  AtlasAllocator allocator_;
+  std::vector<std::unique_ptr<uint8_t[]>> pages_;
+
+  // Masks too big for a page get their own buffer.
+  std::deque<std::vector<uint8_t>> oversized_;
+
+  std::unordered_map<Key, Glyph, KeyHash> glyphs_;
+  std::unordered_map<int64_t, int> advances_;
+
+  int hits_;
+  int misses_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_GLYPH_CACHE_H_
@@ -25,6 +25,8 @@
 //
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 
@@ -864,13 +866,14 @@ void GraphicsObject::DeleteObjectMutators() {
 
 void GraphicsObject::Render(int objNum,
                             const GraphicsObject* parent,
+                            DrawList* draw_list,
                             std::ostream* tree) {
   if (object_data_ && visible()) {
     if (tree) {
       *tree << "Object #" << objNum << ":" << std::endl;
     }
 
-    object_data_->Render(*this, parent, tree);
+    object_data_->Render(*this, parent, draw_list, tree);
   }
 }
 
@@ -917,10 +920,16 @@ void GraphicsObject::serialize(Archive& ar, unsigned int version) {
 template void GraphicsObject::serialize<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version);
+template void GraphicsObject::serialize<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version);
 
 template void GraphicsObject::serialize<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void GraphicsObject::serialize<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
 
 // -----------------------------------------------------------------------
 // GraphicsObject::Impl
@@ -1132,16 +1141,22 @@ void GraphicsObject::Impl::serialize(Archive& ar, unsigned int version) {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void GraphicsObject::Impl::serialize<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version);
+template void GraphicsObject::Impl::serialize<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version);
 
 template void GraphicsObject::Impl::serialize<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void GraphicsObject::Impl::serialize<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
 
 // -----------------------------------------------------------------------
 // GraphicsObject::Impl::TextProperties
@@ -1154,16 +1169,22 @@ void GraphicsObject::Impl::TextProperties::serialize(Archive& ar,
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void GraphicsObject::Impl::TextProperties::serialize<
     boost::archive::text_oarchive>(boost::archive::text_oarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::TextProperties::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 template void GraphicsObject::Impl::TextProperties::serialize<
     boost::archive::text_iarchive>(boost::archive::text_iarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::TextProperties::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
 
 // -----------------------------------------------------------------------
 // GraphicsObject::Impl::DirftProperties
@@ -1181,10 +1202,16 @@ void GraphicsObject::Impl::DriftProperties::serialize(Archive& ar,
 template void GraphicsObject::Impl::DriftProperties::serialize<
     boost::archive::text_oarchive>(boost::archive::text_oarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::DriftProperties::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 template void GraphicsObject::Impl::DriftProperties::serialize<
     boost::archive::text_iarchive>(boost::archive::text_iarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::DriftProperties::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
 
 // -----------------------------------------------------------------------
 // GraphicsObject::Impl::DigitProperties
@@ -1200,10 +1227,16 @@ void GraphicsObject::Impl::DigitProperties::serialize(Archive& ar,
 template void GraphicsObject::Impl::DigitProperties::serialize<
     boost::archive::text_oarchive>(boost::archive::text_oarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::DigitProperties::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 template void GraphicsObject::Impl::DigitProperties::serialize<
     boost::archive::text_iarchive>(boost::archive::text_iarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::DigitProperties::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
 
 // -----------------------------------------------------------------------
 // GraphicsObject::Impl::ButtonProperties
@@ -1222,7 +1255,13 @@ void GraphicsObject::Impl::ButtonProperties::serialize(Archive& ar,
 template void GraphicsObject::Impl::ButtonProperties::serialize<
     boost::archive::text_oarchive>(boost::archive::text_oarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::ButtonProperties::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 template void GraphicsObject::Impl::ButtonProperties::serialize<
     boost::archive::text_iarchive>(boost::archive::text_iarchive& ar,
                                    unsigned int version);
+template void GraphicsObject::Impl::ButtonProperties::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
@@ -39,6 +39,7 @@
 #include "systems/base/colour.h"
 #include "systems/base/rect.h"
 
+class DrawList;
 class RLMachine;
 class GraphicsObject;
 class GraphicsObjectSlot;
@@ -193,7 +194,10 @@ class GraphicsObject {
   void SetObjectData(GraphicsObjectData* obj);
 
   // Render!
-  void Render(int objNum, const GraphicsObject* parent, std::ostream* tree);
+  void Render(int objNum,
+              const GraphicsObject* parent,
+              DrawList* draw_list,
+              std::ostream* tree);
 
   // Frees the object data. Corresponds to objFree, but is also invoked by
   // other commands.
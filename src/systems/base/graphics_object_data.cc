@@ -29,6 +29,7 @@
 
 #include <ostream>
 
+#include "systems/base/draw_list.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_object_of_file.h"
 #include "systems/base/surface.h"
@@ -54,6 +55,7 @@ GraphicsObjectData::~GraphicsObjectData() {}
 
 void GraphicsObjectData::Render(const GraphicsObject& go,
                                 const GraphicsObject* parent,
+                                DrawList* draw_list,
                                 std::ostream* tree) {
   std::shared_ptr<const Surface> surface = CurrentSurface(go);
   if (surface) {
@@ -153,7 +155,11 @@ void GraphicsObjectData::Render(const GraphicsObject& go,
     }
 
     // TODO(erg): Do we want to skip this if no alpha?
-    surface->RenderToScreenAsObject(go, src, dst, alpha);
+    DrawRecord record(go, surface, src, dst, alpha);
+    if (draw_list)
+      draw_list->Add(record);
+    else
+      surface->RenderToScreenAsObject(record);
   }
 }
 
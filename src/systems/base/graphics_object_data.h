@@ -34,6 +34,7 @@
 #include <string>
 #include <vector>
 
+class DrawList;
 class GraphicsObject;
 class Point;
 class RLMachine;
@@ -63,8 +64,12 @@ class GraphicsObjectData {
   // afterAnimation() is set to AFTER_NONE.)
   bool animation_finished() const { return animation_finished_; }
 
+  // Draws |go|. Image draws are queued on |draw_list| so they can be batched;
+  // anything drawn straight to the screen must flush it first. With a NULL
+  // |draw_list|, everything is drawn immediately.
   virtual void Render(const GraphicsObject& go,
                       const GraphicsObject* parent,
+                      DrawList* draw_list,
                       std::ostream* tree);
 
   virtual int PixelWidth(const GraphicsObject& rendering_properties) = 0;
@@ -28,13 +28,17 @@
 #include "systems/base/graphics_system.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/vector.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <deque>
+#include <exception>
 #include <iostream>
 #include <iterator>
 #include <list>
@@ -54,6 +58,8 @@
 #include "modules/module_grp.h"
 #include "systems/base/anm_graphics_object_data.h"
 #include "systems/base/cgm_table.h"
+#include "systems/base/decoded_image.h"
+#include "systems/base/draw_list.h"
 #include "systems/base/event_system.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_object_data.h"
@@ -70,6 +76,7 @@
 #include "systems/base/text_system.h"
 #include "utilities/exception.h"
 #include "utilities/lazy_array.h"
+#include "utilities/thread_pool.h"
 
 using boost::iends_with;
 using std::cerr;
@@ -83,6 +90,14 @@ using std::vector;
 
 namespace fs = boost::filesystem;
 
+namespace {
+
+// Budget for loaded image files when __IMAGE_CACHE_MB isn't set: a few dozen
+// full screen CGs with their textures.
+const int kDefaultImageCacheMegabytes = 96;
+
+}  // namespace
+
 // -----------------------------------------------------------------------
 // GraphicsSystem::GraphicsObjectSettings
 // -----------------------------------------------------------------------
@@ -209,6 +224,11 @@ struct GraphicsSystem::GraphicsObjectImpl {
 
 // -----------------------------------------------------------------------
 
+GraphicsSystem::FrameStatistics::FrameStatistics()
+    : frames(0), partial_frames(0), last_frame_pixels(0), total_pixels(0) {}
+
+// -----------------------------------------------------------------------
+
 GraphicsSystem::GraphicsObjectImpl::GraphicsObjectImpl(int size)
     : foreground_objects(size),
       background_objects(size),
@@ -238,7 +258,9 @@ GraphicsSystem::GraphicsSystem(System& system, Gameexe& gameexe)
       system_(system),
       preloaded_hik_scripts_(32),
       preloaded_g00_(256),
-      image_cache_(10) {}
+      surface_cache_(size_t(gameexe("__IMAGE_CACHE_MB")
+                                .ToInt(kDefaultImageCacheMegabytes)) *
+                     1024 * 1024) {}
 
 // -----------------------------------------------------------------------
 
@@ -247,6 +269,22 @@ GraphicsSystem::~GraphicsSystem() {}
 // -----------------------------------------------------------------------
 
 void GraphicsSystem::MarkScreenAsDirty(GraphicsUpdateType type) {
+  // The mouse cursor is drawn over the finished frame, and objects are
+  // compared with the last frame's when drawing, so neither damages anything
+  // here. Everything else could have changed anywhere.
+  if (type != GUT_MOUSE_MOTION && type != GUT_DISPLAY_OBJ)
+    damage_.AddAll();
+
+  RequestScreenUpdate();
+}
+
+void GraphicsSystem::MarkScreenAreaAsDirty(GraphicsUpdateType type,
+                                           const Rect& area) {
+  damage_.Add(area);
+  RequestScreenUpdate();
+}
+
+void GraphicsSystem::RequestScreenUpdate() {
   switch (screen_update_mode()) {
     case SCREENUPDATEMODE_AUTOMATIC:
     case SCREENUPDATEMODE_SEMIAUTOMATIC: {
@@ -270,6 +308,7 @@ void GraphicsSystem::MarkScreenAsDirty(GraphicsUpdateType type) {
 
 void GraphicsSystem::ForceRefresh() {
   screen_needs_refresh_ = true;
+  damage_.AddAll();
 
   if (screen_update_mode_ == SCREENUPDATEMODE_MANUAL) {
     // Note: SDLEventSystem can also set_force_wait(), in the case of automatic
@@ -461,6 +500,7 @@ void GraphicsSystem::ToggleFullscreen() { SetScreenMode(screen_mode() ? 0 : 1);
 
 void GraphicsSystem::ToggleInterfaceHidden() {
   interface_hidden_ = !interface_hidden_;
+  damage_.AddAll();
 }
 
 // -----------------------------------------------------------------------
@@ -473,17 +513,50 @@ const ObjectSettings& GraphicsSystem::GetObjectSettings(const int obj_num) {
 
 void GraphicsSystem::Refresh(std::ostream* tree) {
   BeginFrame();
-  DrawFrame(tree);
+  DrawFrame(tree, true);
   EndFrame();
 }
 
 std::shared_ptr<Surface> GraphicsSystem::RenderToSurface() {
   BeginFrame();
-  DrawFrame(NULL);
+  DrawFrame(NULL, false);
   return EndFrameToSurface();
 }
 
-void GraphicsSystem::DrawFrame(std::ostream* tree) {
+void GraphicsSystem::DrawFrame(std::ostream* tree, bool use_damage) {
+  // Objects are queued before anything is drawn so that comparing them with
+  // the last frame's tells us what they changed.
+  QueueObjects(tree);
+
+  if (use_damage) {
+    // Render trees describe everything, HIK scripts redraw however they like
+    // and final renderers paint over the finished frame every time.
+    if (tree || (hik_renderer_ && background_type_ == BACKGROUND_HIK) ||
+        !final_renderers_.empty())
+      damage_.AddAll();
+    draw_list_->CollectDamage(&damage_);
+
+    Rect area = BeginRedraw(damage_);
+    damage_.Clear();
+
+    int pixels = area.width() > 0 && area.height() > 0
+                     ? area.width() * area.height()
+                     : 0;
+    frame_statistics_.frames++;
+    if (area != screen_rect())
+      frame_statistics_.partial_frames++;
+    frame_statistics_.last_frame_area = area;
+    frame_statistics_.last_frame_pixels = pixels;
+    frame_statistics_.total_pixels += pixels;
+
+    if (pixels == 0) {
+      draw_list_->Clear();
+      return;
+    }
+    if (area != screen_rect())
+      draw_list_->ClipTo(area);
+  }
+
   switch (background_type_) {
     case BACKGROUND_DC0: {
       // Display DC0
@@ -506,7 +579,7 @@ void GraphicsSystem::DrawFrame(std::ostream* tree) {
     }
   }
 
-  RenderObjects(tree);
+  draw_list_->Flush();
 
   // Render text
   if (!is_interface_hidden())
@@ -540,6 +613,9 @@ void GraphicsSystem::ExecuteGraphicsSystem(RLMachine& machine) {
       ForceRefresh();
     }
   }
+
+  if (!pending_images_.empty())
+    FinishDecodedSurfaces();
 }
 
 // -----------------------------------------------------------------------
@@ -551,9 +627,10 @@ void GraphicsSystem::Reset() {
   ClearAllDCs();
 
   preloaded_hik_scripts_.Clear();
-  preloaded_g00_.Clear();
+  ClearAllPreloadedG00();
   hik_renderer_.reset();
   background_type_ = BACKGROUND_DC0;
+  damage_.AddAll();
 
   // Reset the cursor
   show_cursor_from_bytecode_ = true;
@@ -616,28 +693,52 @@ std::shared_ptr<HIKScript> GraphicsSystem::GetHIKScript(
 }
 
 void GraphicsSystem::PreloadG00(int slot, const std::string& name) {
+  ClearPreloadedG00(slot);
+  preloaded_g00_[slot] = name;
+  surface_cache_.Pin(name);
+
   // We first check our implicit cache just in case so we don't load it twice.
-  std::shared_ptr<const Surface> surface = image_cache_.fetch(name);
-  if (!surface)
+  std::shared_ptr<const Surface> surface = surface_cache_.Fetch(name);
+  if (!surface && DecodesImageFiles()) {
+    // Decode in the background; FinishDecodedSurfaces() or the first
+    // GetPreloadedG00() puts it in the cache.
+    PrefetchSurface(name);
+    if (pending_images_.count(name))
+      return;
+  }
+
+  if (!surface) {
     surface = LoadSurfaceFromFile(name);
+    surface_cache_.Insert(name, surface);
+  }
 
   if (surface)
     surface->EnsureUploaded();
-
-  preloaded_g00_[slot] = std::make_pair(name, surface);
 }
 
 void GraphicsSystem::ClearPreloadedG00(int slot) {
-  preloaded_g00_[slot] = std::make_pair("", std::shared_ptr<const Surface>());
+  if (!preloaded_g00_.exists(slot))
+    return;
+
+  std::string& name = preloaded_g00_[slot];
+  if (!name.empty())
+    surface_cache_.Unpin(name);
+  name.clear();
 }
 
-void GraphicsSystem::ClearAllPreloadedG00() { preloaded_g00_.Clear(); }
+void GraphicsSystem::ClearAllPreloadedG00() {
+  for (std::string& name : preloaded_g00_) {
+    if (!name.empty())
+      surface_cache_.Unpin(name);
+  }
+  preloaded_g00_.Clear();
+}
 
 std::shared_ptr<const Surface> GraphicsSystem::GetPreloadedG00(
     const std::string& name) {
-  for (G00ArrayItem& item : preloaded_g00_) {
-    if (item.first == name)
-      return item.second;
+  for (std::string& item : preloaded_g00_) {
+    if (item == name)
+      return FindOrLoadSurface(name);
   }
 
   return std::shared_ptr<const Surface>();
@@ -664,15 +765,84 @@ std::shared_ptr<const Surface> GraphicsSystem::GetSurfaceNamed(
   if (cached_surface)
     return cached_surface;
 
+  return FindOrLoadSurface(short_filename);
+}
+
+void GraphicsSystem::PrefetchSurface(const std::string& short_filename) {
+  if (!DecodesImageFiles() || pending_images_.count(short_filename) ||
+      surface_cache_.Contains(short_filename))
+    return;
+
+  // System::FindFile() isn't thread safe, so only the reading and decoding is
+  // handed to the pool.
+  boost::filesystem::path path =
+      system().FindFile(short_filename, IMAGE_FILETYPES);
+  if (path.empty())
+    return;
+
+  if (!image_decoders_)
+    image_decoders_.reset(new ThreadPool(0));
+  pending_images_[short_filename] =
+      image_decoders_->Post([path]() { return DecodeImageFile(path); });
+}
+
+bool GraphicsSystem::DecodesImageFiles() const { return false; }
+
+std::shared_ptr<const Surface> GraphicsSystem::SurfaceFromDecodedImage(
+    const std::string& short_filename,
+    const DecodedImage& image) {
+  return LoadSurfaceFromFile(short_filename);
+}
+
+std::shared_ptr<const Surface> GraphicsSystem::FindOrLoadSurface(
+    const std::string& short_filename) {
   // First check to see if this surface is already in our internal cache
-  cached_surface = image_cache_.fetch(short_filename);
-  if (cached_surface)
-    return cached_surface;
+  std::shared_ptr<const Surface> surface = surface_cache_.Fetch(short_filename);
+  if (surface)
+    return surface;
+
+  surface = TakePrefetchedSurface(short_filename);
+  if (!surface)
+    surface = LoadSurfaceFromFile(short_filename);
+
+  surface_cache_.Insert(short_filename, surface);
+  return surface;
+}
+
+std::shared_ptr<const Surface> GraphicsSystem::TakePrefetchedSurface(
+    const std::string& short_filename) {
+  PendingImages::iterator it = pending_images_.find(short_filename);
+  if (it == pending_images_.end())
+    return std::shared_ptr<const Surface>();
+
+  std::future<std::shared_ptr<DecodedImage>> decode = std::move(it->second);
+  pending_images_.erase(it);
 
-  std::shared_ptr<const Surface> surface_to_ret =
-      LoadSurfaceFromFile(short_filename);
-  image_cache_.insert(short_filename, surface_to_ret);
-  return surface_to_ret;
+  // Rethrows anything DecodeImageFile() threw, as a synchronous load would.
+  std::shared_ptr<DecodedImage> image = decode.get();
+  return SurfaceFromDecodedImage(short_filename, *image);
+}
+
+void GraphicsSystem::FinishDecodedSurfaces() {
+  std::vector<std::string> finished;
+  for (PendingImages::value_type& pending : pending_images_) {
+    if (pending.second.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready)
+      finished.push_back(pending.first);
+  }
+
+  for (const std::string& name : finished) {
+    std::shared_ptr<const Surface> surface;
+    try {
+      surface = TakePrefetchedSurface(name);
+    }
+    catch (std::exception& e) {
+      // Leave the error for whoever actually asks for the image.
+      continue;
+    }
+    surface->EnsureUploaded();
+    surface_cache_.Insert(name, surface);
+  }
 }
 
 // -----------------------------------------------------------------------
@@ -809,6 +979,17 @@ void GraphicsSystem::ClearAllDCs() {
 // -----------------------------------------------------------------------
 
 void GraphicsSystem::RenderObjects(std::ostream* tree) {
+  QueueObjects(tree);
+  draw_list_->Flush();
+}
+
+DrawList* GraphicsSystem::BuildDrawList() { return new DrawList; }
+
+Rect GraphicsSystem::BeginRedraw(const DamageRegion& damage) {
+  return screen_rect();
+}
+
+void GraphicsSystem::QueueObjects(std::ostream* tree) {
   to_render_.clear();
 
   // Collate all objects that we might want to render.
@@ -834,9 +1015,14 @@ void GraphicsSystem::RenderObjects(std::ostream* tree) {
   // Sort by all the ordering values.
   std::sort(to_render_.begin(), to_render_.end());
 
+  if (!draw_list_)
+    draw_list_.reset(BuildDrawList());
+  // Anything left over is from a frame that threw part way through.
+  draw_list_->Clear();
+
   for (ToRenderVec::iterator it = to_render_.begin(); it != to_render_.end();
        ++it) {
-    get<4>(*it)->Render(get<3>(*it), NULL, tree);
+    get<4>(*it)->Render(get<3>(*it), NULL, draw_list_.get(), tree);
   }
 }
 
@@ -950,6 +1136,12 @@ void GraphicsSystem::load(Archive& ar, unsigned int version) {
 template void GraphicsSystem::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void GraphicsSystem::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
 template void GraphicsSystem::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void GraphicsSystem::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
@@ -33,6 +33,7 @@
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/version.hpp>
 
+#include <future>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -43,14 +44,16 @@
 #include <vector>
 
 #include "systems/base/cgm_table.h"
+#include "systems/base/damage_region.h"
 #include "systems/base/event_listener.h"
 #include "systems/base/rect.h"
+#include "systems/base/surface_cache.h"
 #include "systems/base/tone_curve.h"
 
 #include "utilities/lazy_array.h"
-#include "lru_cache.hpp"
 
 class ColourFilter;
+class DrawList;
 class Gameexe;
 class GraphicsObject;
 class GraphicsObjectData;
@@ -64,6 +67,8 @@ class RLMachine;
 class Size;
 class Surface;
 class System;
+class ThreadPool;
+struct DecodedImage;
 struct ObjectSettings;
 
 template <typename T>
@@ -181,6 +186,7 @@ class GraphicsSystem : public EventListener {
 
   void set_graphics_background(GraphicsBackgroundType t) {
     background_type_ = t;
+    damage_.AddAll();
   }
 
   System& system() { return system_; }
@@ -317,10 +323,33 @@ class GraphicsSystem : public EventListener {
   // various modes.
   virtual void MarkScreenAsDirty(GraphicsUpdateType type);
 
+  // Like MarkScreenAsDirty(), for when only |area| of the screen changed.
+  void MarkScreenAreaAsDirty(GraphicsUpdateType type, const Rect& area);
+
   // Forces a refresh of the screen the next time the graphics system
   // executes.
   virtual void ForceRefresh();
 
+  // What has changed on screen since the last Refresh(). Objects aren't
+  // included until the next frame compares them with the last one's.
+  const DamageRegion& damage() const { return damage_; }
+
+  // How much of the screen Refresh() has been redrawing.
+  struct FrameStatistics {
+    FrameStatistics();
+
+    // Frames drawn with Refresh().
+    int frames;
+    // Of those, frames where less than the whole screen was redrawn.
+    int partial_frames;
+    // The part of the screen the last frame redrew, and its area in pixels.
+    Rect last_frame_area;
+    int last_frame_pixels;
+    // Pixels redrawn over all frames.
+    long long total_pixels;
+  };
+  const FrameStatistics& frame_statistics() const { return frame_statistics_; }
+
   bool screen_needs_refresh() const { return screen_needs_refresh_; }
   void OnScreenRefreshed();
 
@@ -334,7 +363,8 @@ class GraphicsSystem : public EventListener {
   virtual void EndFrame() = 0;
   virtual std::shared_ptr<Surface> EndFrameToSurface() = 0;
 
-  // Performs a full redraw of the screen.
+  // Draws the screen, redrawing only as much of it as the backend needs to
+  // bring the last frame up to date.
   void Refresh(std::ostream* tree);
 
   // Draws the screen (as if refresh() was called), but draw to the returned
@@ -367,6 +397,12 @@ class GraphicsSystem : public EventListener {
   std::shared_ptr<const Surface> GetSurfaceNamed(
       const std::string& short_filename);
 
+  // Starts reading and decoding an image on the image decoding threads, so
+  // that a later GetSurfaceNamed() only has to build and upload the surface.
+  // Does nothing if the image is already loaded or being decoded, can't be
+  // found, or if this system doesn't decode image files.
+  void PrefetchSurface(const std::string& short_filename);
+
   virtual std::shared_ptr<Surface> GetHaikei() = 0;
 
   virtual std::shared_ptr<Surface> GetDC(int dc) = 0;
@@ -375,6 +411,11 @@ class GraphicsSystem : public EventListener {
 
   virtual ColourFilter* BuildColourFiller() = 0;
 
+  // Builds the list that RenderObjects() queues object draws on. Backends
+  // that can batch draws return their own; the default draws each record on
+  // its own.
+  virtual DrawList* BuildDrawList();
+
   // Clears and promotes objects.
   void ClearAndPromoteObjects();
 
@@ -450,12 +491,17 @@ class GraphicsSystem : public EventListener {
       const std::string& name,
       const boost::filesystem::path& file);
 
-  // We have a cache of preloaded g00 files.
+  // We have a cache of preloaded g00 files. Preloaded images live in
+  // |surface_cache_| like everything else, pinned until their slot is
+  // cleared.
   void PreloadG00(int slot, const std::string& name);
   void ClearPreloadedG00(int slot);
   void ClearAllPreloadedG00();
   std::shared_ptr<const Surface> GetPreloadedG00(const std::string& name);
 
+  // The cache of loaded image files, for its statistics.
+  const SurfaceCache& surface_cache() const { return surface_cache_; }
+
  protected:
   typedef std::set<Renderable*> FinalRenderers;
 
@@ -468,13 +514,59 @@ class GraphicsSystem : public EventListener {
 
   void SetScreenSize(const Size& size);
 
-  void DrawFrame(std::ostream* tree);
+  // Draws everything. With |use_damage|, the backend is told what has changed
+  // since the last frame through BeginRedraw(), and only what it redraws is
+  // drawn.
+  void DrawFrame(std::ostream* tree, bool use_damage);
+
+  // Called by Refresh() once the frame's |damage| is known, before anything
+  // is drawn. Returns the part of the screen that will be redrawn; drawing is
+  // skipped outside of it. Backends that can't keep the last frame around
+  // redraw the whole screen, which is the default.
+  virtual Rect BeginRedraw(const DamageRegion& damage);
+
+  // Makes the next Refresh() redraw the whole screen. For backends whose copy
+  // of the last frame was lost or overwritten.
+  void InvalidateLastFrame() { damage_.AddAll(); }
+
+  // Whether LoadSurfaceFromFile() actually decodes image files with
+  // DecodeImageFile(), and so whether PrefetchSurface() should start doing
+  // it early. Defaults to false.
+  virtual bool DecodesImageFiles() const;
+
+  // Turns an image decoded on an image decoding thread into a platform
+  // surface. Only called on the main thread, and only if DecodesImageFiles().
+  // The default ignores |image| and calls LoadSurfaceFromFile().
+  virtual std::shared_ptr<const Surface> SurfaceFromDecodedImage(
+      const std::string& short_filename,
+      const DecodedImage& image);
 
  private:
   // Gets a platform appropriate surface loaded.
   virtual std::shared_ptr<const Surface> LoadSurfaceFromFile(
       const std::string& short_filename) = 0;
 
+  // Returns |short_filename| from |surface_cache_|, or finishes its prefetch,
+  // or loads it now. Whatever isn't cached gets cached.
+  std::shared_ptr<const Surface> FindOrLoadSurface(
+      const std::string& short_filename);
+
+  // If |short_filename| was prefetched, waits for its decode and returns the
+  // built surface. Returns NULL otherwise.
+  std::shared_ptr<const Surface> TakePrefetchedSurface(
+      const std::string& short_filename);
+
+  // Builds and uploads every prefetched image whose decode has finished,
+  // without waiting on the others.
+  void FinishDecodedSurfaces();
+
+  // Schedules a redraw as the screen update mode allows.
+  void RequestScreenUpdate();
+
+  // Queues the draws of all foreground objects that should be shown on
+  // |draw_list_| without drawing them.
+  void QueueObjects(std::ostream* tree);
+
   // Default grp name (used in grp* and rec* functions where filename
   // is '???')
   std::string default_grp_name_;
@@ -495,6 +587,11 @@ class GraphicsSystem : public EventListener {
   // Whether object state has been mutated since the last screen refresh.
   bool object_state_dirty_;
 
+  // What has changed on screen since the last Refresh().
+  DamageRegion damage_;
+
+  FrameStatistics frame_statistics_;
+
   // Whether it is the Graphics system's responsibility to redraw the
   // screen. Some LongOperations temporarily take this responsibility
   // to implement pretty fades and wipes
@@ -568,19 +665,31 @@ class GraphicsSystem : public EventListener {
   typedef LazyArray<HIKArrayItem> HIKScriptList;
   HIKScriptList preloaded_hik_scripts_;
 
-  // Preloaded G00 images.
-  typedef std::pair<std::string, std::shared_ptr<const Surface>> G00ArrayItem;
-  typedef LazyArray<G00ArrayItem> G00ScriptList;
-  G00ScriptList preloaded_g00_;
+  // Names of the preloaded G00 images, by slot. Each one holds a pin in
+  // |surface_cache_|.
+  LazyArray<std::string> preloaded_g00_;
 
-  // LRU cache filled with the last fifteen accessed images.
+  // Loaded image files, within a byte budget set by the __IMAGE_CACHE_MB
+  // Gameexe key (the --image-cache-mb option).
   //
   // This cache's contents are assumed to be immutable.
-  LRUCache<std::string, std::shared_ptr<const Surface>> image_cache_;
+  SurfaceCache surface_cache_;
+
+  // Threads that run DecodeImageFile() for PrefetchSurface(), started on first
+  // use.
+  std::unique_ptr<ThreadPool> image_decoders_;
+
+  // Images being decoded by |image_decoders_|, by short filename.
+  typedef std::map<std::string, std::future<std::shared_ptr<DecodedImage>>>
+      PendingImages;
+  PendingImages pending_images_;
 
   // Possible background script which drives graphics to the screen.
   std::unique_ptr<HIKRenderer> hik_renderer_;
 
+  // Where RenderObjects() queues object draws. Built on first use.
+  std::unique_ptr<DrawList> draw_list_;
+
   // Tuple used in RenderObjects(). Causes about a half megabyte of allocator
   // churn per minute if we try to allocate it every time.
   //
@@ -61,8 +61,10 @@
 #include <boost/filesystem/path.hpp>
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <vector>
 
@@ -143,6 +145,134 @@ uint8_t koe_ad_trans_tbl[256] = {
 
 }  // namespace
 
+// -----------------------------------------------------------------------
+// KOEPACVoiceStream
+// -----------------------------------------------------------------------
+
+// Decodes one 0x400 sample block of a KOEPAC sample at a time. The
+// compressed data is small, so it's all read up front.
+class KOEPACVoiceStream : public VoiceStream {
+ public:
+  KOEPACVoiceStream(FILE* stream, int offset, int length, int rate);
+
+  virtual int rate() const override { return rate_; }
+  virtual int channels() const override { return 2; }
+  virtual int Read(char* buffer, int length) override;
+
+  // Size of one decoded block: 0x400 stereo 16-bit samples.
+  static const int kBlockSize = 0x1000;
+
+ private:
+  // Decodes the next block into |block_|.
+  void DecodeBlock();
+
+  std::unique_ptr<char[]> table_;
+  std::unique_ptr<uint8_t[]> src_;
+  uint8_t* src_pos_;
+  int length_;
+  int rate_;
+  int next_block_;
+
+  char block_[kBlockSize];
+  int block_pos_;
+};
+
+KOEPACVoiceStream::KOEPACVoiceStream(FILE* stream,
+                                     int offset,
+                                     int length,
+                                     int rate)
+    : table_(new char[length * 2]),
+      length_(length),
+      rate_(rate),
+      next_block_(0),
+      block_pos_(kBlockSize) {
+  // avg32 の声データ展開
+  fseek(stream, offset, 0);
+  fread(table_.get(), 2, length_, stream);
+
+  int all_len = 0;
+  for (int i = 0; i < length_; i++)
+    all_len += read_little_endian_short(table_.get() + i * 2);
+
+  // データ読み込み
+  src_.reset(new uint8_t[all_len]);
+  fread(src_.get(), 1, all_len, stream);
+  src_pos_ = src_.get();
+}
+
+int KOEPACVoiceStream::Read(char* buffer, int length) {
+  int written = 0;
+  while (written < length) {
+    if (block_pos_ == kBlockSize) {
+      if (next_block_ == length_)
+        break;
+      DecodeBlock();
+    }
+
+    int count = std::min(length - written, kBlockSize - block_pos_);
+    memcpy(buffer + written, block_ + block_pos_, count);
+    block_pos_ += count;
+    written += count;
+  }
+
+  return written;
+}
+
+void KOEPACVoiceStream::DecodeBlock() {
+  // This function has been mildly adapted from decode_koe in xclannad, and
+  // now expands a single block per call.
+  uint8_t* src = src_pos_;
+  uint16_t* dest = reinterpret_cast<uint16_t*>(block_);
+  memset(block_, 0, kBlockSize);
+
+  // 展開
+  int slen = read_little_endian_short(table_.get() + next_block_ * 2);
+  if (slen == 0) {  // do nothing
+  } else if (slen == 0x400) {  // table 変換
+    for (int j = 0; j < 0x400; j++) {
+      write_little_endian_short((char*)(dest + 0), koe_8bit_trans_tbl[*src]);
+      write_little_endian_short((char*)(dest + 1), koe_8bit_trans_tbl[*src]);
+      dest += 2;
+      src++;
+    }
+  } else {  // DPCM
+    uint8_t d = 0;
+    uint16_t o2;
+    for (int j = 0, k = 0; j < slen && k < 0x800; j++) {
+      uint8_t s = src[j];
+      if ((s + 1) & 0x0f) {
+        d -= koe_ad_trans_tbl[s & 0x0f];
+      } else {
+        uint8_t s2;
+        s >>= 4;
+        s &= 0x0f;
+        s2 = s;
+        s = src[++j];
+        s2 |= (s << 4) & 0xf0;
+        d -= koe_ad_trans_tbl[s2];
+      }
+      o2 = koe_8bit_trans_tbl[d];
+      write_little_endian_short((char*)(dest + k), o2);
+      write_little_endian_short((char*)(dest + k + 1), o2);
+      k += 2;
+      s >>= 4;
+      if ((s + 1) & 0x0f) {
+        d -= koe_ad_trans_tbl[s & 0x0f];
+      } else {
+        d -= koe_ad_trans_tbl[src[++j]];
+      }
+      o2 = koe_8bit_trans_tbl[d];
+      write_little_endian_short((char*)(dest + k), o2);
+      write_little_endian_short((char*)(dest + k + 1), o2);
+      k += 2;
+    }
+  }
+
+  src_pos_ += slen;
+  next_block_++;
+  block_pos_ = 0;
+}
+
 // -----------------------------------------------------------------------
 // KOEPACVoiceSample
 // -----------------------------------------------------------------------
@@ -160,6 +290,7 @@ class KOEPACVoiceSample : public VoiceSample {
   }
 
   virtual char* Decode(int* size) override;
+  virtual std::unique_ptr<VoiceStream> OpenStream() override;
 
  private:
   FILE* stream_;
@@ -169,84 +300,19 @@ class KOEPACVoiceSample : public VoiceSample {
 };
 
 char* KOEPACVoiceSample::Decode(int* dest_len) {
-  // This function has been mildly adapted from decode_koe in xclannad. I have
-  // modified types so that it works on 64-bit systems and changed malloc()s to
-  // new[]s, as the consumer of decode() will delete [] the returned pointer.
-
-  // avg32 の声データ展開
-  std::unique_ptr<char[]> table(new char[length_ * 2]);
-  fseek(stream_, offset_, 0);
-  fread(table.get(), 2, length_, stream_);
-
-  int all_len = 0;
-  for (int i = 0; i < length_; i++)
-    all_len += read_little_endian_short(table.get() + i * 2);
-
-  // データ読み込み
-  uint8_t* src_orig = new uint8_t[all_len];
-  uint16_t* dest_orig = new uint16_t[length_ * 0x1000 + 0x2c];
-
-  if (src_orig == NULL || dest_orig == NULL)
-    return NULL;
-  uint8_t* src = src_orig;
-  fread(src, 1, all_len, stream_);
-  *dest_len = length_ * 0x400 * 4;
-  const char* header = MakeWavHeader(rate_, 2, 2, *dest_len);
-  memcpy(dest_orig, header, 0x2c);
-  uint16_t* dest = dest_orig + 0x2c;
-
-  // 展開
-  for (int i = 0; i < length_; i++) {
-    int slen = read_little_endian_short(table.get() + i * 2);
-    if (slen == 0) {  // do nothing
-      memset(dest, 0, 0x1000);
-      dest += 0x800;
-      src += 0;
-    } else if (slen == 0x400) {  // table 変換
-      for (int j = 0; j < 0x400; j++) {
-        write_little_endian_short((char*)(dest + 0), koe_8bit_trans_tbl[*src]);
-        write_little_endian_short((char*)(dest + 1), koe_8bit_trans_tbl[*src]);
-        dest += 2;
-        src++;
-      }
-    } else {  // DPCM
-      uint8_t d = 0;
-      uint16_t o2;
-      for (int j = 0, k = 0; j < slen && k < 0x800; j++) {
-        uint8_t s = src[j];
-        if ((s + 1) & 0x0f) {
-          d -= koe_ad_trans_tbl[s & 0x0f];
-        } else {
-          uint8_t s2;
-          s >>= 4;
-          s &= 0x0f;
-          s2 = s;
-          s = src[++j];
-          s2 |= (s << 4) & 0xf0;
-          d -= koe_ad_trans_tbl[s2];
-        }
-        o2 = koe_8bit_trans_tbl[d];
-        write_little_endian_short((char*)(dest + k), o2);
-        write_little_endian_short((char*)(dest + k + 1), o2);
-        k += 2;
-        s >>= 4;
-        if ((s + 1) & 0x0f) {
-          d -= koe_ad_trans_tbl[s & 0x0f];
-        } else {
-          d -= koe_ad_trans_tbl[src[++j]];
-        }
-        o2 = koe_8bit_trans_tbl[d];
-        write_little_endian_short((char*)(dest + k), o2);
-        write_little_endian_short((char*)(dest + k + 1), o2);
-        k += 2;
-      }
-      dest += 0x800;
-      src += slen;
-    }
-  }
-  delete[] src_orig;
+  // The consumer of decode() will delete [] the returned pointer.
+  KOEPACVoiceStream stream(stream_, offset_, length_, rate_);
+  *dest_len = length_ * KOEPACVoiceStream::kBlockSize;
+
+  char* data = new char[WAV_HEADER_SIZE + *dest_len];
+  MakeWavHeader(data, rate_, 2, 2, WAV_HEADER_SIZE + *dest_len);
+  stream.Read(data + WAV_HEADER_SIZE, *dest_len);
+  return data;
+}
 
-  return (char*)dest_orig;
+std::unique_ptr<VoiceStream> KOEPACVoiceSample::OpenStream() {
+  return std::unique_ptr<VoiceStream>(
+      new KOEPACVoiceStream(stream_, offset_, length_, rate_));
 }
 
 // -----------------------------------------------------------------------
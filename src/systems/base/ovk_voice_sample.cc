@@ -61,6 +61,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <sstream>
 
@@ -113,6 +114,50 @@ std::string oggErrorCodeToString(int code) {
 
 }  // namespace
 
+// -----------------------------------------------------------------------
+// OVKVoiceStream
+// -----------------------------------------------------------------------
+
+// Runs ov_read() as PCM is asked for. Keeps the sample alive since vorbisfile
+// reads through it.
+class OVKVoiceStream : public VoiceStream {
+ public:
+  explicit OVKVoiceStream(std::shared_ptr<OVKVoiceSample> sample)
+      : sample_(sample) {
+    sample_->OpenVorbisFile(&vf_);
+    vorbis_info* vinfo = ov_info(&vf_, 0);
+    rate_ = vinfo->rate;
+    channels_ = vinfo->channels;
+  }
+
+  virtual ~OVKVoiceStream() { ov_clear(&vf_); }
+
+  virtual int rate() const override { return rate_; }
+  virtual int channels() const override { return channels_; }
+
+  virtual int Read(char* buffer, int length) override {
+    int written = 0;
+    while (written < length) {
+      long r = ov_read(&vf_, buffer + written, length - written, 0, 2, 1, 0);
+      if (r == OV_HOLE)
+        continue;
+      if (r <= 0)
+        break;
+      written += r;
+    }
+    return written;
+  }
+
+ private:
+  std::shared_ptr<OVKVoiceSample> sample_;
+  OggVorbis_File vf_;
+  int rate_;
+  int channels_;
+};
+
+// -----------------------------------------------------------------------
+// OVKVoiceSample
+// -----------------------------------------------------------------------
 OVKVoiceSample::OVKVoiceSample(fs::path file)
     : stream_(std::fopen(file.native().c_str(), "rb")), offset_(0), length_(0) {
   std::fseek(stream_, 0, SEEK_END);
@@ -130,8 +175,7 @@ OVKVoiceSample::~OVKVoiceSample() {
     fclose(stream_);
 }
 
-char* OVKVoiceSample::Decode(int* size) {
-  // This function has been mildly adapted from decode_koe_ogg in xclannad.
+void OVKVoiceSample::OpenVorbisFile(OggVorbis_File* vf) {
   fseek(stream_, offset_, 0);
 
   ov_callbacks callback;
@@ -140,14 +184,20 @@ char* OVKVoiceSample::Decode(int* size) {
   callback.close_func = NULL;
   callback.tell_func = (long int (*)(void*))ogg_tellfunc;  // NOLINT
 
-  OggVorbis_File vf;
-  int r = ov_open_callbacks(this, &vf, NULL, 0, callback);
+  int r = ov_open_callbacks(this, vf, NULL, 0, callback);
   if (r != 0) {
     ostringstream oss;
     oss << "Ogg stream error in OVKVoiceSample::decode: "
         << oggErrorCodeToString(r);
     throw std::runtime_error(oss.str());
   }
+}
+
+char* OVKVoiceSample::Decode(int* size) {
+  // This function has been mildly adapted from decode_koe_ogg in xclannad.
+  OggVorbis_File vf;
+  OpenVorbisFile(&vf);
+  int r;
 
   vorbis_info* vinfo = ov_info(&vf, 0);
   int rate = vinfo->rate;
@@ -181,8 +231,7 @@ char* OVKVoiceSample::Decode(int* size) {
     ov_clear(&vf);
 
     *size = buffer_size;
-    const char* header = MakeWavHeader(rate, channels, 2, buffer_pos);
-    memcpy(buffer, header, WAV_HEADER_SIZE);
+    MakeWavHeader(buffer, rate, channels, 2, buffer_pos);
   }
   catch (...) {
     delete[] buffer;
@@ -192,6 +241,11 @@ char* OVKVoiceSample::Decode(int* size) {
   return buffer;
 }
 
+std::unique_ptr<VoiceStream> OVKVoiceSample::OpenStream() {
+  return std::unique_ptr<VoiceStream>(new OVKVoiceStream(
+      std::static_pointer_cast<OVKVoiceSample>(shared_from_this())));
+}
+
 size_t OVKVoiceSample::ogg_readfunc(void* ptr,
                                     size_t size,
                                     size_t nmemb,
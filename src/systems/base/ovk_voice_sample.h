@@ -30,6 +30,8 @@
 #include <boost/filesystem/path.hpp>
 #include <vorbis/vorbisfile.h>
 
+#include <memory>
+
 #include "systems/base/voice_archive.h"
 
 class OVKVoiceSample : public VoiceSample {
@@ -43,8 +45,14 @@ class OVKVoiceSample : public VoiceSample {
 
   // Overridden from VoiceSample:
   virtual char* Decode(int* size) override;
+  virtual std::unique_ptr<VoiceStream> OpenStream() override;
 
  private:
+  friend class OVKVoiceStream;
+
+  // Opens |vf| on this sample's slice of the file. Throws on error.
+  void OpenVorbisFile(OggVorbis_File* vf);
+
   static size_t ogg_readfunc(void* ptr,
                              size_t size,
                              size_t nmemb,
@@ -24,6 +24,8 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/export.hpp>
@@ -55,11 +57,12 @@ LazyArray<GraphicsObject>& ParentGraphicsObjectData::objects() {
 
 void ParentGraphicsObjectData::Render(const GraphicsObject& go,
                                       const GraphicsObject* parent,
+                                      DrawList* draw_list,
                                       std::ostream* tree) {
   AllocatedLazyArrayIterator<GraphicsObject> it = objects_.begin();
   AllocatedLazyArrayIterator<GraphicsObject> end = objects_.end();
   for (; it != end; ++it) {
-    it->Render(it.pos(), &go, tree);
+    it->Render(it.pos(), &go, draw_list, tree);
   }
 }
 
@@ -116,14 +119,20 @@ void ParentGraphicsObjectData::serialize(Archive& ar, unsigned int version) {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void ParentGraphicsObjectData::serialize<
     boost::archive::text_iarchive>(boost::archive::text_iarchive& ar,
                                    unsigned int version);
+template void ParentGraphicsObjectData::serialize<
+    boost::archive::binary_iarchive>(boost::archive::binary_iarchive& ar,
+                                     unsigned int version);
 template void ParentGraphicsObjectData::serialize<
     boost::archive::text_oarchive>(boost::archive::text_oarchive& ar,
                                    unsigned int version);
+template void ParentGraphicsObjectData::serialize<
+    boost::archive::binary_oarchive>(boost::archive::binary_oarchive& ar,
+                                     unsigned int version);
 
 BOOST_CLASS_EXPORT(ParentGraphicsObjectData);
@@ -34,6 +34,7 @@
 #include "systems/base/graphics_object_data.h"
 #include "utilities/lazy_array.h"
 
+class DrawList;
 class GraphicsObject;
 
 // A GraphicsObjectData implementation which owns a full set of graphics
@@ -50,6 +51,7 @@ class ParentGraphicsObjectData : public GraphicsObjectData {
 
   virtual void Render(const GraphicsObject& go,
                       const GraphicsObject* parent,
+                      DrawList* draw_list,
                       std::ostream* tree) override;
   virtual int PixelWidth(const GraphicsObject& rendering_properties) override;
   virtual int PixelHeight(const GraphicsObject& rendering_properties) override;
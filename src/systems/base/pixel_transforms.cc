@@ -0,0 +1,302 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/pixel_transforms.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RLVM_PIXEL_KERNELS_AVX2 1
+#endif
+
+#include <cstdlib>
+
+#include "systems/base/colour.h"
+
+namespace {
+
+const uint32_t kColourMask = 0x00ffffff;
+
+// -----------------------------------------------------------------------
+// Scalar
+// -----------------------------------------------------------------------
+
+void invertScalar(uint32_t* pixels, int count) {
+  for (int i = 0; i < count; ++i)
+    pixels[i] ^= kColourMask;
+}
+
+inline uint32_t monoPixel(uint32_t pixel) {
+  uint32_t r = (pixel >> 16) & 0xff;
+  uint32_t g = (pixel >> 8) & 0xff;
+  uint32_t b = pixel & 0xff;
+  uint32_t gray = (30 * r + 59 * g + 11 * b) / 100;
+  return (pixel & ~kColourMask) | (gray << 16) | (gray << 8) | gray;
+}
+
+void monoScalar(uint32_t* pixels, int count) {
+  for (int i = 0; i < count; ++i)
+    pixels[i] = monoPixel(pixels[i]);
+}
+
+// -----------------------------------------------------------------------
+// SSE2
+// -----------------------------------------------------------------------
+
+#if defined(__SSE2__)
+
+void invertSSE2(uint32_t* pixels, int count) {
+  const __m128i mask = _mm_set1_epi32(kColourMask);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), mask));
+  }
+  invertScalar(pixels + i, count - i);
+}
+
+// The gray of two pixels unpacked to 16-bit lanes, in both 32-bit halves of
+// each pixel.
+inline __m128i graySums(__m128i pixels16) {
+  // Blue, green, red and alpha weights, in memory order.
+  const __m128i weights = _mm_setr_epi16(11, 59, 30, 0, 11, 59, 30, 0);
+  __m128i pairs = _mm_madd_epi16(pixels16, weights);
+  return _mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, 0xb1));
+}
+
+void monoSSE2(uint32_t* pixels, int count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(~kColourMask);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(pixels + i);
+    __m128i in = _mm_loadu_si128(p);
+    __m128i sums = _mm_packs_epi32(graySums(_mm_unpacklo_epi8(in, zero)),
+                                   graySums(_mm_unpackhi_epi8(in, zero)));
+    // Sums are at most 25500, where (x * 5243) >> 19 is exactly x / 100.
+    __m128i gray = _mm_srli_epi16(_mm_mulhi_epu16(sums, _mm_set1_epi16(5243)),
+                                  3);
+    // Each pixel is now gray | gray << 16; spread it over all four bytes.
+    gray = _mm_or_si128(gray, _mm_slli_epi32(gray, 8));
+    _mm_storeu_si128(p,
+                     _mm_or_si128(_mm_andnot_si128(alpha_mask, gray),
+                                  _mm_and_si128(alpha_mask, in)));
+  }
+  monoScalar(pixels + i, count - i);
+}
+
+#endif  // defined(__SSE2__)
+
+// -----------------------------------------------------------------------
+// AVX2
+// -----------------------------------------------------------------------
+
+#if defined(RLVM_PIXEL_KERNELS_AVX2)
+
+// The same as the SSE2 versions, eight pixels at a time. Built for AVX2
+// whatever the compiler flags say and only called when the CPU has it.
+__attribute__((target("avx2"))) void invertAVX2(uint32_t* pixels,
+                                                int count) {
+  const __m256i mask = _mm256_set1_epi32(kColourMask);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+    _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), mask));
+  }
+  invertScalar(pixels + i, count - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i graySumsAVX2(
+    __m256i pixels16) {
+  const __m256i weights = _mm256_setr_epi16(
+      11, 59, 30, 0, 11, 59, 30, 0, 11, 59, 30, 0, 11, 59, 30, 0);
+  __m256i pairs = _mm256_madd_epi16(pixels16, weights);
+  return _mm256_add_epi32(pairs, _mm256_shuffle_epi32(pairs, 0xb1));
+}
+
+__attribute__((target("avx2"))) void monoAVX2(uint32_t* pixels, int count) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i alpha_mask = _mm256_set1_epi32(~kColourMask);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i* p = reinterpret_cast<__m256i*>(pixels + i);
+    __m256i in = _mm256_loadu_si256(p);
+    // Unpacking and packing both stay within 128-bit lanes, so the pixels
+    // come back out in order.
+    __m256i sums =
+        _mm256_packs_epi32(graySumsAVX2(_mm256_unpacklo_epi8(in, zero)),
+                           graySumsAVX2(_mm256_unpackhi_epi8(in, zero)));
+    __m256i gray = _mm256_srli_epi16(
+        _mm256_mulhi_epu16(sums, _mm256_set1_epi16(5243)), 3);
+    gray = _mm256_or_si256(gray, _mm256_slli_epi32(gray, 8));
+    _mm256_storeu_si256(p,
+                        _mm256_or_si256(_mm256_andnot_si256(alpha_mask, gray),
+                                        _mm256_and_si256(alpha_mask, in)));
+  }
+  monoScalar(pixels + i, count - i);
+}
+
+#endif  // defined(RLVM_PIXEL_KERNELS_AVX2)
+
+// -----------------------------------------------------------------------
+
+struct Kernels {
+  PixelKernelLevel level;
+  void (*invert)(uint32_t*, int);
+  void (*mono)(uint32_t*, int);
+};
+
+Kernels kernelsFor(PixelKernelLevel level) {
+  switch (level) {
+#if defined(RLVM_PIXEL_KERNELS_AVX2)
+    case PIXEL_KERNELS_AVX2: {
+      Kernels kernels = {PIXEL_KERNELS_AVX2, &invertAVX2, &monoAVX2};
+      return kernels;
+    }
+#endif
+#if defined(__SSE2__)
+    case PIXEL_KERNELS_SSE2: {
+      Kernels kernels = {PIXEL_KERNELS_SSE2, &invertSSE2, &monoSSE2};
+      return kernels;
+    }
+#endif
+    default: {
+      Kernels kernels = {PIXEL_KERNELS_SCALAR, &invertScalar, &monoScalar};
+      return kernels;
+    }
+  }
+}
+
+PixelKernelLevel detectBestLevel() {
+#if defined(RLVM_PIXEL_KERNELS_AVX2)
+  if (__builtin_cpu_supports("avx2"))
+    return PIXEL_KERNELS_AVX2;
+#endif
+#if defined(__SSE2__)
+  return PIXEL_KERNELS_SSE2;
+#else
+  return PIXEL_KERNELS_SCALAR;
+#endif
+}
+
+Kernels& currentKernels() {
+  static Kernels kernels = kernelsFor(GetBestPixelKernelLevel());
+  return kernels;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+
+PixelKernelLevel GetBestPixelKernelLevel() {
+  static const PixelKernelLevel best = detectBestLevel();
+  return best;
+}
+
+PixelKernelLevel GetPixelKernelLevel() { return currentKernels().level; }
+
+void SetPixelKernelLevel(PixelKernelLevel level) {
+  if (level > GetBestPixelKernelLevel())
+    level = GetBestPixelKernelLevel();
+  // Levels this build has no code for fall through to scalar in
+  // kernelsFor(); step down through the others first.
+  Kernels kernels = kernelsFor(level);
+  while (kernels.level != level && level > PIXEL_KERNELS_SCALAR) {
+    level = static_cast<PixelKernelLevel>(level - 1);
+    kernels = kernelsFor(level);
+  }
+  currentKernels() = kernels;
+}
+
+const char* GetPixelKernelLevelName(PixelKernelLevel level) {
+  switch (level) {
+    case PIXEL_KERNELS_SCALAR:
+      return "scalar";
+    case PIXEL_KERNELS_SSE2:
+      return "sse2";
+    case PIXEL_KERNELS_AVX2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+void InvertPixels(uint32_t* pixels, int count) {
+  currentKernels().invert(pixels, count);
+}
+
+void MonoPixels(uint32_t* pixels, int count) {
+  currentKernels().mono(pixels, count);
+}
+
+void MapPixels(uint32_t* pixels,
+               int count,
+               const unsigned char* red,
+               const unsigned char* green,
+               const unsigned char* blue) {
+  for (int i = 0; i < count; ++i) {
+    uint32_t pixel = pixels[i];
+    pixels[i] = (pixel & ~kColourMask) |
+                (uint32_t(red[(pixel >> 16) & 0xff]) << 16) |
+                (uint32_t(green[(pixel >> 8) & 0xff]) << 8) |
+                uint32_t(blue[pixel & 0xff]);
+  }
+}
+
+void ToneCurvePixels(uint32_t* pixels, int count, const ToneCurveRGBMap& map) {
+  MapPixels(pixels, count, map[0].data(), map[1].data(), map[2].data());
+}
+
+ToneCurveRGBMap BuildApplyColourMap(const RGBColour& colour) {
+  // The float arithmetic is what surfaces have always used per pixel; doing
+  // it once per value keeps the results identical.
+  auto compose = [](int in_colour, int surface_colour) -> int {
+    if (in_colour > 0) {
+      return 255 -
+             ((static_cast<float>((255 - in_colour) * (255 - surface_colour)) /
+               (255 * 255)) *
+              255);
+    } else if (in_colour < 0) {
+      return (static_cast<float>(abs(in_colour) * surface_colour) /
+              (255 * 255)) *
+             255;
+    } else {
+      return surface_colour;
+    }
+  };
+
+  ToneCurveRGBMap map;
+  for (int value = 0; value < 256; ++value) {
+    map[0][value] = compose(colour.r(), value);
+    map[1][value] = compose(colour.g(), value);
+    map[2][value] = compose(colour.b(), value);
+  }
+  return map;
+}
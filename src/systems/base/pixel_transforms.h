@@ -0,0 +1,88 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_PIXEL_TRANSFORMS_H_
+#define SRC_SYSTEMS_BASE_PIXEL_TRANSFORMS_H_
+
+#include <cstdint>
+
+#include "systems/base/tone_curve.h"
+
+class RGBColour;
+
+// Kernels behind Surface::Invert(), Mono(), ToneCurve() and ApplyColour().
+// Each works on a run of |count| 32-bit pixels laid out as 0xAARRGGBB and
+// leaves alpha alone.
+//
+// Invert and mono have SIMD versions; which one runs is picked the first
+// time they're used from what the CPU supports. The lookup table kernels are
+// plain loops, since there's no fast way to do byte lookups in SIMD
+// registers.
+
+// The instruction sets the kernels come in, from slowest to fastest.
+enum PixelKernelLevel {
+  PIXEL_KERNELS_SCALAR,
+  PIXEL_KERNELS_SSE2,
+  PIXEL_KERNELS_AVX2
+};
+
+// The fastest level that this build and CPU support.
+PixelKernelLevel GetBestPixelKernelLevel();
+
+// The level in use. Defaults to GetBestPixelKernelLevel().
+PixelKernelLevel GetPixelKernelLevel();
+
+// Switches to |level|, or to the best supported level below it. For tests and
+// benchmarks that compare levels.
+void SetPixelKernelLevel(PixelKernelLevel level);
+
+const char* GetPixelKernelLevelName(PixelKernelLevel level);
+
+// Replaces each colour with 255 minus itself.
+void InvertPixels(uint32_t* pixels, int count);
+
+// Replaces each colour with (30 * r + 59 * g + 11 * b) / 100, which is
+// exactly what the old floating point 0.3/0.59/0.11 sum truncated to.
+void MonoPixels(uint32_t* pixels, int count);
+
+// Replaces each colour channel with its entry in |red|, |green| or |blue|.
+void MapPixels(uint32_t* pixels,
+               int count,
+               const unsigned char* red,
+               const unsigned char* green,
+               const unsigned char* blue);
+
+// MapPixels() through a tone curve.
+void ToneCurvePixels(uint32_t* pixels, int count, const ToneCurveRGBMap& map);
+
+// Builds the lookup tables that make MapPixels() do Surface::ApplyColour():
+// positive channels of |colour| lighten towards white, negative ones darken
+// towards black.
+ToneCurveRGBMap BuildApplyColourMap(const RGBColour& colour);
+
+#endif  // SRC_SYSTEMS_BASE_PIXEL_TRANSFORMS_H_
@@ -25,6 +25,8 @@
 //
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 
@@ -375,6 +377,11 @@ void SoundSystem::KoePlay(int id, int charid) {
   }
 }
 
+void SoundSystem::KoePrefetch(int id) {
+  if (is_koe_enabled() && !system_.ShouldFastForward())
+    voice_cache_.Prefetch(id);
+}
+
 void SoundSystem::Reset() {
   // empty
 }
@@ -423,13 +430,19 @@ void SoundSystem::save(Archive& ar, unsigned int version) const {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void SoundSystem::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void SoundSystem::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void SoundSystem::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void SoundSystem::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
@@ -31,7 +31,7 @@
 
 // -----------------------------------------------------------------------
 
-Surface::Surface() {}
+Surface::Surface() : content_version_(0) {}
 
 // -----------------------------------------------------------------------
 
@@ -43,6 +43,15 @@ Rect Surface::GetRect() const { return Rect(Point(0, 0), GetSize()); }
 
 // -----------------------------------------------------------------------
 
+size_t Surface::GetMemoryUsage() const {
+  Size size = GetSize();
+  if (size.width() <= 0 || size.height() <= 0)
+    return 0;
+  return size_t(size.width()) * size.height() * 4;
+}
+
+// -----------------------------------------------------------------------
+
 void Surface::Dump() {
   throw rlvm::Exception("Unimplemented function Surface::Dump()");
 }
@@ -36,6 +36,7 @@
 class RGBColour;
 class RGBAColour;
 class GraphicsObject;
+struct DrawRecord;
 struct GraphicsObjectOverride;
 
 // Abstract surface used in rlvm. Various systems graphics systems should
@@ -84,6 +85,15 @@ class Surface : public std::enable_shared_from_this<Surface> {
   virtual Size GetSize() const = 0;
   Rect GetRect() const;
 
+  // Changes whenever the pixels do, so that drawing code can tell whether
+  // an image looks the same as the last time it was drawn.
+  int content_version() const { return content_version_; }
+
+  // Bytes this surface holds, counting both its pixels in main memory and any
+  // copies uploaded to the graphics card. Defaults to 32-bit pixels in main
+  // memory only.
+  virtual size_t GetMemoryUsage() const;
+
   virtual void Dump();
 
   // Blits to another surface
@@ -106,10 +116,8 @@ class Surface : public std::enable_shared_from_this<Surface> {
                               const Rect& dst,
                               const int opacity[4]) const = 0;
 
-  virtual void RenderToScreenAsObject(const GraphicsObject& rp,
-                                      const Rect& src,
-                                      const Rect& dst,
-                                      int alpha) const = 0;
+  // Draws an object's image as described by |record|, whose surface is us.
+  virtual void RenderToScreenAsObject(const DrawRecord& record) const = 0;
 
   virtual int GetNumPatterns() const;
   virtual const GrpRect& GetPattern(int patt_no) const;
@@ -122,6 +130,13 @@ class Surface : public std::enable_shared_from_this<Surface> {
                                                      int b) const;
 
   virtual Surface* Clone() const = 0;
+
+ protected:
+  // Subclasses call this whenever they change their pixels.
+  void MarkContentChanged() { ++content_version_; }
+
+ private:
+  int content_version_;
 };
 
 #endif  // SRC_SYSTEMS_BASE_SURFACE_H_
@@ -0,0 +1,154 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/base/surface_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+#include "systems/base/surface.h"
+
+namespace {
+
+// What loading an image costs beyond its size, in bytes of decoding: opening
+// the file, parsing the header and creating the texture. This is what keeps
+// lots of small buttons from being evicted to make room for one more CG.
+const double kLoadOverheadBytes = 256 * 1024;
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// SurfaceCache
+// -----------------------------------------------------------------------
+
+SurfaceCache::SurfaceCache(size_t byte_budget)
+    : byte_budget_(byte_budget),
+      clock_(0),
+      uses_(0),
+      hits_(0),
+      misses_(0),
+      evictions_(0) {}
+
+SurfaceCache::~SurfaceCache() {}
+
+std::shared_ptr<const Surface> SurfaceCache::Fetch(const std::string& name) {
+  auto it = entries_.find(name);
+  if (it == entries_.end()) {
+    misses_++;
+    return std::shared_ptr<const Surface>();
+  }
+
+  hits_++;
+  Touch(it->second);
+  return it->second.surface;
+}
+
+bool SurfaceCache::Contains(const std::string& name) const {
+  return entries_.find(name) != entries_.end();
+}
+
+void SurfaceCache::Insert(const std::string& name,
+                          std::shared_ptr<const Surface> surface) {
+  if (!surface)
+    return;
+
+  Entry& entry = entries_[name];
+  entry.surface = surface;
+  Touch(entry);
+  Trim();
+}
+
+void SurfaceCache::Pin(const std::string& name) { pins_[name]++; }
+
+void SurfaceCache::Unpin(const std::string& name) {
+  auto it = pins_.find(name);
+  if (it == pins_.end())
+    return;
+
+  if (--it->second == 0) {
+    pins_.erase(it);
+    Trim();
+  }
+}
+
+void SurfaceCache::EvictAll() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (IsEvictable(it->first, it->second)) {
+      it = entries_.erase(it);
+      evictions_++;
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SurfaceCache::set_byte_budget(size_t byte_budget) {
+  byte_budget_ = byte_budget;
+  Trim();
+}
+
+size_t SurfaceCache::bytes() const {
+  size_t total = 0;
+  for (const auto& entry : entries_)
+    total += entry.second.surface->GetMemoryUsage();
+  return total;
+}
+
+void SurfaceCache::Touch(Entry& entry) {
+  double bytes = std::max<size_t>(entry.surface->GetMemoryUsage(), 1);
+  entry.priority = clock_ + (bytes + kLoadOverheadBytes) / bytes;
+  entry.last_use = uses_++;
+}
+
+bool SurfaceCache::IsEvictable(const std::string& name,
+                               const Entry& entry) const {
+  return pins_.find(name) == pins_.end() && entry.surface.use_count() == 1;
+}
+
+void SurfaceCache::Trim() {
+  size_t total = bytes();
+  while (total > byte_budget_) {
+    auto victim = entries_.end();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (!IsEvictable(it->first, it->second))
+        continue;
+      if (victim == entries_.end() ||
+          std::tie(it->second.priority, it->second.last_use) <
+              std::tie(victim->second.priority, victim->second.last_use))
+        victim = it;
+    }
+    if (victim == entries_.end())
+      return;
+
+    clock_ = victim->second.priority;
+    total -= victim->second.surface->GetMemoryUsage();
+    entries_.erase(victim);
+    evictions_++;
+  }
+}
@@ -0,0 +1,116 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_BASE_SURFACE_CACHE_H_
+#define SRC_SYSTEMS_BASE_SURFACE_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+class Surface;
+
+// Keeps loaded image files around by name within a budget of bytes, counted
+// with Surface::GetMemoryUsage() so that a full screen CG costs what it
+// actually takes in main and texture memory.
+//
+// Eviction is GreedyDual-Size: each entry's priority is the cache's clock
+// plus the cost of reloading it per byte it frees, refreshed on every use.
+// The cheapest entry goes first (the least recently used of equals) and the
+// clock advances to its priority, so entries that haven't been touched in a
+// while age out no matter how cheap they are. Pinned names (the script's
+// preloaded images) and surfaces still referenced outside the cache are never
+// evicted, since dropping them frees nothing.
+class SurfaceCache {
+ public:
+  explicit SurfaceCache(size_t byte_budget);
+  ~SurfaceCache();
+
+  // Returns the surface cached as |name|, or NULL. Counts a hit or a miss.
+  std::shared_ptr<const Surface> Fetch(const std::string& name);
+
+  // Whether |name| is cached. Doesn't count towards the statistics.
+  bool Contains(const std::string& name) const;
+
+  // Caches |surface| as |name| and evicts until the cache is back within
+  // budget. Does nothing with a NULL |surface|.
+  void Insert(const std::string& name, std::shared_ptr<const Surface> surface);
+
+  // Keeps |name| from being evicted until a matching Unpin(). |name| doesn't
+  // need to be cached yet. Pins nest.
+  void Pin(const std::string& name);
+  void Unpin(const std::string& name);
+
+  // Drops every entry that isn't pinned or in use, e.g. under memory
+  // pressure.
+  void EvictAll();
+
+  size_t byte_budget() const { return byte_budget_; }
+  void set_byte_budget(size_t byte_budget);
+
+  // Bytes held by the cached surfaces right now. Surfaces grow when they're
+  // uploaded, so this is measured rather than remembered.
+  size_t bytes() const;
+  size_t size() const { return entries_.size(); }
+
+  int hits() const { return hits_; }
+  int misses() const { return misses_; }
+  int evictions() const { return evictions_; }
+
+ private:
+  struct Entry {
+    std::shared_ptr<const Surface> surface;
+    double priority;
+
+    // When this was last touched; breaks ties in |priority| towards LRU.
+    int last_use;
+  };
+
+  // Gives |entry| a fresh priority from the current clock.
+  void Touch(Entry& entry);
+
+  // Whether evicting |entry| named |name| would free anything.
+  bool IsEvictable(const std::string& name, const Entry& entry) const;
+
+  // Evicts the lowest priority entries until within budget or out of
+  // evictable entries.
+  void Trim();
+
+  size_t byte_budget_;
+  double clock_;
+  int uses_;
+
+  std::map<std::string, Entry> entries_;
+  std::map<std::string, int> pins_;
+
+  int hits_;
+  int misses_;
+  int evictions_;
+};
+
+#endif  // SRC_SYSTEMS_BASE_SURFACE_CACHE_H_
@@ -92,6 +92,9 @@ class TextKeyCursor {
   // The last time current_frame_ was incremented in ticks
   unsigned int last_time_frame_incremented_;
 
+  // Where the cursor was last drawn, so that animating it only redraws that.
+  Rect last_rendered_rect_;
+
   System& system_;
 };
 
@@ -27,8 +27,11 @@
 
 #include "systems/base/text_page.h"
 
-#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "libreallive/gameexe.h"
 #include "machine/rlmachine.h"
@@ -36,16 +39,10 @@
 #include "systems/base/text_system.h"
 #include "systems/base/text_window.h"
 #include "utf8cpp/utf8.h"
-#include "utilities/exception.h"
 #include "utilities/string_utilities.h"
 
-using std::bind;
-using std::ref;
-using std::placeholders::_1;
-using std::placeholders::_2;
-
 // Represents the various commands.
-enum CommandType {
+enum CommandType : uint8_t {
   TYPE_CHARACTERS,
   TYPE_NAME,
   TYPE_KOE_MARKER,
@@ -66,235 +63,40 @@ enum CommandType {
   TYPE_NEXT_CHAR_IS_ITALIC,
 };
 
-// Storage for each command.
+// Storage for each command. Commands are kept by value in one vector, so
+// they must stay small and trivially copyable; any strings they carry are
+// stored in the page's |text_| and referenced by position.
 struct TextPage::Command {
-  explicit Command(CommandType type);
-  Command(CommandType type, int one);
-  Command(CommandType type, const std::string& one);
-  Command(CommandType type, const std::string& one, const std::string& two);
-  Command(CommandType type, const std::string& one, int two);
-  Command(const Command& rhs);
-  ~Command();
-
-  enum CommandType command;
-  union {
-    // TYPE_CHARACTERS
-    std::string characters;
-
-    // TYPE_NAME
-    struct {
-      std::string name;
-      std::string next_char;
-    } name;
-
-    // TYPE_KOE_MARKER
-    int koe_id;
-
-    // TYPE_FONT_COLOUR
-    int font_colour;
-
-    // TYPE_FONT_SIZE
-    int font_size;
-
-    // TYPE_RUBY_END
-    std::string ruby_text;
-
-    // TYPE_SET_INSERTION_X
-    int set_insertion_x;
-
-    // TYPE_SET_INSERTION_Y
-    int set_insertion_y;
-
-    // TYPE_OFFSET_INSERTION_X
-    int offset_insertion_x;
-
-    // TYPE_OFFSET_INSERTION_Y
-    int offset_insertion_y;
-
-    // TYPE_FACE_OPEN
-    struct {
-      std::string filename;
-      int index;
-    } face_open;
-
-    // TYPE_FACE_CLOSE
-    int face_close;
-
-    // For the empty types:
-    // TYPE_HARD_BREAK
-    // TYPE_SET_INDENTATION
-    // TYPE_RESET_INDENTATION
-    // TYPE_DEFAULT_FONT_SIZE
-    // TYPE_RUBY_BEGIN
-    int empty;
-  };
+  explicit Command(CommandType type, int value = 0)
+      : command(type), offset(0), length(0), value(value) {}
+
+  CommandType command;
+
+  // TYPE_CHARACTERS, TYPE_NAME, TYPE_RUBY_END and TYPE_FACE_OPEN: the bytes
+  // of |text_| holding the string.
+  int offset;
+  int length;
+
+  // TYPE_NAME: the length of the next character, which is stored right
+  // after the name.
+  // TYPE_FACE_OPEN: the face slot.
+  // TYPE_KOE_MARKER, TYPE_FONT_COLOUR, TYPE_FONT_SIZE, TYPE_SET_INSERTION_*,
+  // TYPE_OFFSET_INSERTION_* and TYPE_FACE_CLOSE: the argument.
+  int value;
 };
 
-TextPage::Command::Command(CommandType type)
-    : command(type) {
-  switch (type) {
-    case TYPE_HARD_BREAK:
-    case TYPE_SET_INDENTATION:
-    case TYPE_RESET_INDENTATION:
-    case TYPE_DEFAULT_FONT_SIZE:
-    case TYPE_RUBY_BEGIN:
-    case TYPE_NEXT_CHAR_IS_ITALIC:
-      empty = 0;
-      break;
-    case TYPE_CHARACTERS:
-      new (&characters) std::string;
-      break;
-    default:
-      throw rlvm::Exception("Incorrect arity");
-  }
-}
-
-TextPage::Command::Command(CommandType type, int one)
-    : command(type) {
-  switch (type) {
-    case TYPE_KOE_MARKER:
-      koe_id = one;
-      break;
-    case TYPE_FONT_COLOUR:
-      font_colour = one;
-      break;
-    case TYPE_FONT_SIZE:
-      font_size = one;
-      break;
-    case TYPE_SET_INSERTION_X:
-      set_insertion_x = one;
-      break;
-    case TYPE_SET_INSERTION_Y:
-      set_insertion_y = one;
-      break;
-    case TYPE_OFFSET_INSERTION_X:
-      offset_insertion_x = one;
-      break;
-    case TYPE_OFFSET_INSERTION_Y:
-      offset_insertion_y = one;
-      break;
-    case TYPE_FACE_CLOSE:
-      face_close = one;
-      break;
-    default:
-      throw rlvm::Exception("Incorrect arity");
-  }
-}
-
-TextPage::Command::Command(CommandType type, const std::string& one)
-    : command(type) {
-  switch (type) {
-    case TYPE_RUBY_END:
-      new (&ruby_text) std::string(one);
-      break;
-    default:
-      throw rlvm::Exception("Incorrect arity");
-  }
-}
-
-TextPage::Command::Command(CommandType type,
-                           const std::string& one,
-                           const std::string& two)
-    : command(type) {
-  switch (type) {
-    case TYPE_NAME:
-      new (&name.name) std::string(one);
-      new (&name.next_char) std::string(two);
-      break;
-    default:
-      throw rlvm::Exception("Incorrect arity");
-  }
-}
-
-TextPage::Command::Command(CommandType type,
-                           const std::string& one,
-                           int two)
-    : command(type) {
-  switch (type) {
-    case TYPE_FACE_OPEN:
-      new (&face_open.filename) std::string(one);
-      face_open.index = two;
-      break;
-    default:
-      throw rlvm::Exception("Incorrect arity");
-  }
-}
-
-TextPage::Command::Command(const Command& rhs)
-    : command(rhs.command) {
-  switch (rhs.command) {
-    case TYPE_HARD_BREAK:
-    case TYPE_SET_INDENTATION:
-    case TYPE_RESET_INDENTATION:
-    case TYPE_DEFAULT_FONT_SIZE:
-    case TYPE_RUBY_BEGIN:
-    case TYPE_NEXT_CHAR_IS_ITALIC:
-      empty = 0;
-      break;
-    case TYPE_KOE_MARKER:
-      koe_id = rhs.koe_id;
-      break;
-    case TYPE_FONT_COLOUR:
-      font_colour = rhs.font_colour;
-      break;
-    case TYPE_FONT_SIZE:
-      font_size = rhs.font_size;
-      break;
-    case TYPE_SET_INSERTION_X:
-      set_insertion_x = rhs.set_insertion_x;
-      break;
-    case TYPE_SET_INSERTION_Y:
-      set_insertion_y = rhs.set_insertion_y;
-      break;
-    case TYPE_OFFSET_INSERTION_X:
-      offset_insertion_x = rhs.offset_insertion_x;
-      break;
-    case TYPE_OFFSET_INSERTION_Y:
-      offset_insertion_y = rhs.offset_insertion_y;
-      break;
-    case TYPE_FACE_CLOSE:
-      face_close = rhs.face_close;
-      break;
-    case TYPE_CHARACTERS:
-      new (&characters) std::string(rhs.characters);
-      break;
-    case TYPE_RUBY_END:
-      new (&ruby_text) std::string(rhs.ruby_text);
-      break;
-    case TYPE_NAME:
-      new (&name.name) std::string(rhs.name.name);
-      new (&name.next_char) std::string(rhs.name.next_char);
-      break;
-    case TYPE_FACE_OPEN:
-      command = TYPE_FACE_OPEN;
-      new (&face_open.filename) std::string(rhs.face_open.filename);
-      face_open.index = rhs.face_open.index;
-      break;
-  }
-}
+struct TextPage::RunLayout {
+  // The bytes of |text_| the command covered when it was laid out. Characters
+  // are appended to the last command while its page is still current.
+  int length;
 
-TextPage::Command::~Command() {
-  // Needed to get around a quirk of the language
-  using string_type = std::string;
+  // The window's state before and after the characters were laid out.
+  TextWindow::LayoutState before;
+  TextWindow::LayoutState after;
 
-  switch (command) {
-    case TYPE_CHARACTERS:
-      characters.~string_type();
-      break;
-    case TYPE_RUBY_END:
-      ruby_text.~string_type();
-      break;
-    case TYPE_NAME:
-      name.name.~string_type();
-      name.next_char.~string_type();
-      break;
-    case TYPE_FACE_OPEN:
-      face_open.filename.~string_type();
-      break;
-    default:
-      break;
-  }
-}
+  // One entry per character that fit in the window, in order.
+  std::vector<TextWindow::GlyphPlacement> glyphs;
+};
 
 // -----------------------------------------------------------------------
 // TextPage
@@ -323,9 +125,13 @@ void TextPage::Replay(bool is_active_page) {
     }
   }
 
-  for_each(elements_to_replay_.begin(),
-           elements_to_replay_.end(),
-           [&](Command& c) { RunTextPageCommand(c, is_active_page); });
+  size_t run = 0;
+  for (const Command& command : elements_to_replay_) {
+    if (command.command == TYPE_CHARACTERS)
+      ReplayCharacters(command, run++);
+    else
+      RunTextPageCommand(command, is_active_page);
+  }
 }
 
 // ------------------------------------------------- [ Public operations ]
@@ -336,10 +142,15 @@ bool TextPage::Character(const string& current, const string& rest) {
   if (rendered) {
     if (elements_to_replay_.size() == 0 ||
         elements_to_replay_.back().command != TYPE_CHARACTERS) {
-      elements_to_replay_.emplace_back(TYPE_CHARACTERS);
+      Command command(TYPE_CHARACTERS);
+      command.offset = text_.size();
+      elements_to_replay_.push_back(command);
     }
 
-    elements_to_replay_.back().characters.append(current);
+    // Nothing else can have been stored since this run started, so it ends at
+    // the end of |text_|.
+    text_.append(current);
+    elements_to_replay_.back().length += current.size();
 
     number_of_chars_on_page_++;
   }
@@ -348,7 +159,10 @@ bool TextPage::Character(const string& current, const string& rest) {
 }
 
 void TextPage::Name(const string& name, const string& next_char) {
-  AddAction(Command(TYPE_NAME, name, next_char));
+  Command command(TYPE_NAME, next_char.size());
+  StoreString(&command, name);
+  text_.append(next_char);
+  AddAction(command);
   number_of_chars_on_page_++;
 }
 
@@ -385,7 +199,9 @@ void TextPage::MarkRubyBegin() {
 }
 
 void TextPage::DisplayRubyText(const std::string& utf8str) {
-  AddAction(Command(TYPE_RUBY_END, utf8str));
+  Command command(TYPE_RUBY_END);
+  StoreString(&command, utf8str);
+  AddAction(command);
 }
 
 void TextPage::SetInsertionPointX(int x) {
@@ -405,7 +221,9 @@ void TextPage::Offset_insertion_point_y(int offset) {
 }
 
 void TextPage::FaceOpen(const std::string& filename, int index) {
-  AddAction(Command(TYPE_FACE_OPEN, filename, index));
+  Command command(TYPE_FACE_OPEN, index);
+  StoreString(&command, filename);
+  AddAction(command);
 }
 
 void TextPage::FaceClose(int index) {
@@ -416,10 +234,25 @@ void TextPage::NextCharIsItalic() {
   AddAction(Command(TYPE_NEXT_CHAR_IS_ITALIC));
 }
 
+size_t TextPage::memory_usage() const {
+  size_t bytes = sizeof(TextPage) + text_.capacity() +
+                 elements_to_replay_.capacity() * sizeof(Command) +
+                 run_layouts_.capacity() * sizeof(RunLayout);
+  for (const RunLayout& layout : run_layouts_)
+    bytes += layout.glyphs.capacity() * sizeof(TextWindow::GlyphPlacement);
+  return bytes;
+}
+
 bool TextPage::IsFull() const {
   return system_->text().GetTextWindow(window_num_)->IsFull();
 }
 
+void TextPage::StoreString(Command* command, const std::string& str) {
+  command->offset = text_.size();
+  command->length = str.size();
+  text_.append(str);
+}
+
 void TextPage::AddAction(const Command& command) {
   RunTextPageCommand(command, true);
   elements_to_replay_.push_back(command);
@@ -429,6 +262,48 @@ bool TextPage::CharacterImpl(const string& c, const string& rest) {
   return system_->text().GetTextWindow(window_num_)->DisplayCharacter(c, rest);
 }
 
+void TextPage::ReplayCharacters(const Command& command, size_t run) {
+  if (!command.length)
+    return;
+
+  std::shared_ptr<TextWindow> window =
+      system_->text().GetTextWindow(window_num_);
+
+  if (run < run_layouts_.size()) {
+    const RunLayout& layout = run_layouts_[run];
+    if (layout.length == command.length &&
+        layout.before == window->layout_state()) {
+      std::string::const_iterator cur = text_.begin() + command.offset;
+      std::string::const_iterator end = cur + command.length;
+      for (const TextWindow::GlyphPlacement& glyph : layout.glyphs) {
+        std::string::const_iterator start = cur;
+        utf8::next(cur, end);
+        window->DisplayPlacedCharacter(std::string(start, cur), glyph);
+      }
+      window->set_layout_state(layout.after);
+      return;
+    }
+  }
+
+  RunLayout layout;
+  layout.length = command.length;
+  layout.before = window->layout_state();
+  PrintTextToFunction(
+      [&](const std::string& c, const std::string& rest) {
+        bool rendered = window->DisplayCharacter(c, rest);
+        if (rendered)
+          layout.glyphs.push_back(window->last_placement());
+        return rendered;
+      },
+      text_.substr(command.offset, command.length),
+      "");
+  layout.after = window->layout_state();
+
+  if (run >= run_layouts_.size())
+    run_layouts_.resize(run + 1);
+  run_layouts_[run] = std::move(layout);
+}
+
 void TextPage::RunTextPageCommand(const Command& command,
                                   bool is_active_page) {
   std::shared_ptr<TextWindow> window =
@@ -436,19 +311,17 @@ void TextPage::RunTextPageCommand(const Command& command,
 
   switch (command.command) {
     case TYPE_CHARACTERS:
-      if (command.characters.size()) {
-        PrintTextToFunction(
-            bind(&TextPage::CharacterImpl, ref(*this), _1, _2),
-            command.characters,
-            "");
-      }
+      // Character() draws these as they arrive, and Replay() hands them to
+      // ReplayCharacters().
       break;
     case TYPE_NAME:
-      window->SetName(command.name.name, command.name.next_char);
+      window->SetName(
+          text_.substr(command.offset, command.length),
+          text_.substr(command.offset + command.length, command.value));
       break;
     case TYPE_KOE_MARKER:
       if (!is_active_page)
-        window->KoeMarker(command.koe_id);
+        window->KoeMarker(command.value);
       break;
     case TYPE_HARD_BREAK:
       window->HardBrake();
@@ -462,40 +335,41 @@ void TextPage::RunTextPageCommand(const Command& command,
     case TYPE_FONT_COLOUR:
       if (is_active_page) {
         window->SetFontColor(
-            system_->gameexe()("COLOR_TABLE", command.font_colour));
+            system_->gameexe()("COLOR_TABLE", command.value));
       }
       break;
     case TYPE_DEFAULT_FONT_SIZE:
       window->set_font_size_to_default();
       break;
     case TYPE_FONT_SIZE:
-      window->set_font_size_in_pixels(command.font_size);
+      window->set_font_size_in_pixels(command.value);
       break;
     case TYPE_RUBY_BEGIN:
       window->MarkRubyBegin();
       in_ruby_gloss_ = true;
       break;
     case TYPE_RUBY_END:
-      window->DisplayRubyText(command.ruby_text);
+      window->DisplayRubyText(text_.substr(command.offset, command.length));
       in_ruby_gloss_ = false;
       break;
     case TYPE_SET_INSERTION_X:
-      window->set_insertion_point_x(command.set_insertion_x);
+      window->set_insertion_point_x(command.value);
       break;
     case TYPE_SET_INSERTION_Y:
-      window->set_insertion_point_y(command.set_insertion_y);
+      window->set_insertion_point_y(command.value);
       break;
     case TYPE_OFFSET_INSERTION_X:
-      window->offset_insertion_point_x(command.offset_insertion_x);
+      window->offset_insertion_point_x(command.value);
       break;
     case TYPE_OFFSET_INSERTION_Y:
-      window->offset_insertion_point_y(command.offset_insertion_y);
+      window->offset_insertion_point_y(command.value);
       break;
     case TYPE_FACE_OPEN:
-      window->FaceOpen(command.face_open.filename, command.face_open.index);
+      window->FaceOpen(text_.substr(command.offset, command.length),
+                       command.value);
       break;
     case TYPE_FACE_CLOSE:
-      window->FaceClose(command.face_close);
+      window->FaceClose(command.value);
       break;
     case TYPE_NEXT_CHAR_IS_ITALIC:
       window->NextCharIsItalic();
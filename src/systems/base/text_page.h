@@ -29,6 +29,7 @@
 #define SRC_SYSTEMS_BASE_TEXT_PAGE_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <vector>
@@ -120,16 +121,30 @@ class TextPage {
   // to implement implicit pauses when a page is full.
   bool IsFull() const;
 
+  // Bytes of memory held by this page, for budgeting the backlog.
+  size_t memory_usage() const;
+
  private:
   // Storage for an individual command.
   struct Command;
 
+  // Where each character of a TYPE_CHARACTERS command was drawn.
+  struct RunLayout;
+
+  // Appends |str| to |text_| and points |command| at it.
+  void StoreString(Command* command, const std::string& str);
+
   // Executes |command| and then adds it to |elements_to_replay_|.
   void AddAction(const Command& command);
 
   // Performs textout.
   bool CharacterImpl(const std::string& c, const std::string& rest);
 
+  // Replays the |run|th TYPE_CHARACTERS command on this page. The first
+  // replay lays the characters out and records where they went; later
+  // replays that start from the same window state draw them there again.
+  void ReplayCharacters(const Command& command, size_t run);
+
   // Actually performs the command in most cases.
   void RunTextPageCommand(const Command& command,
                           bool is_active_page);
@@ -146,8 +161,18 @@ class TextPage {
   // called.
   bool in_ruby_gloss_;
 
+  // Every string the commands below refer to, UTF-8, back to back. Keeping
+  // them in one buffer makes copying a page into the backlog two allocations
+  // no matter how much is on it.
+  std::string text_;
+
   // A list of the text elements to replay on this page.
   std::vector<Command> elements_to_replay_;
+
+  // The layout of each TYPE_CHARACTERS command in |elements_to_replay_|, in
+  // order, filled in as the page is replayed. Only pages that are scrolled
+  // back to pay for this.
+  std::vector<RunLayout> run_layouts_;
 };
 
 #endif  // SRC_SYSTEMS_BASE_TEXT_PAGE_H_
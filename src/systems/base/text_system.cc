@@ -25,12 +25,15 @@
 //
 // -----------------------------------------------------------------------
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 
 #include "systems/base/text_system.h"
 
 #include <algorithm>
+#include <limits>
 #include <map>
 #include <sstream>
 #include <string>
@@ -59,7 +62,30 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
-const unsigned int MAX_PAGE_HISTORY = 100;
+namespace {
+
+// Backlog limits when __BACKLOG_PAGES and __BACKLOG_MB aren't set. A page
+// holds a few hundred bytes of text, so the page count is normally what
+// stops the backlog growing.
+const int kDefaultBacklogPages = 100;
+const int kDefaultBacklogMegabytes = 4;
+
+// Reads a backlog limit from |key|. Missing, zero or negative values fall back
+// to |default_value|, so the backlog always holds at least one page and one
+// megabyte.
+int GetBacklogLimit(Gameexe& gexe, const std::string& key, int default_value) {
+  int value = gexe(key).ToInt(default_value);
+  return value > 0 ? value : default_value;
+}
+
+size_t PageSetMemoryUsage(const TextSystem::PageSet& set) {
+  size_t bytes = 0;
+  for (const std::pair<const int, TextPage>& page : set)
+    bytes += page.second.memory_usage();
+  return bytes;
+}
+
+}  // namespace
 
 const int FULLWIDTH_NUMBER_SIGN = 0xFF03;
 const int FULLWIDTH_A = 0xFF21;
@@ -102,6 +128,14 @@ TextSystem::TextSystem(System& system, Gameexe& gexe)
       active_window_(0),
       is_reading_backlog_(false),
       current_pageset_(),
+      max_backlog_pages_(
+          GetBacklogLimit(gexe, "__BACKLOG_PAGES", kDefaultBacklogPages)),
+      max_backlog_bytes_(
+          std::min<size_t>(
+              GetBacklogLimit(gexe, "__BACKLOG_MB", kDefaultBacklogMegabytes),
+              std::numeric_limits<size_t>::max() / (1024 * 1024)) *
+          1024 * 1024),
+      backlog_bytes_(0),
       in_pause_state_(false),
       // #WINDOW_*_USE
       move_use_(false),
@@ -271,8 +305,22 @@ void TextSystem::CheckAndSetBool(Gameexe& gexe,
 }
 
 void TextSystem::ExpireOldPages() {
-  while (previous_page_sets_.size() > MAX_PAGE_HISTORY)
+  while (!previous_page_sets_.empty() &&
+         (previous_page_sets_.size() > max_backlog_pages_ ||
+          (backlog_bytes_ > max_backlog_bytes_ &&
+           previous_page_sets_.size() > 1))) {
+    if (previous_page_it_ == previous_page_sets_.begin())
+      previous_page_it_ = std::next(previous_page_it_);
+
+    backlog_bytes_ -= PageSetMemoryUsage(previous_page_sets_.front());
     previous_page_sets_.pop_front();
+  }
+}
+
+void TextSystem::SetBacklogLimits(size_t max_pages, size_t max_bytes) {
+  max_backlog_pages_ = max_pages;
+  max_backlog_bytes_ = max_bytes;
+  ExpireOldPages();
 }
 
 bool TextSystem::MouseButtonStateChanged(MouseButton mouse_button,
@@ -312,6 +360,7 @@ void TextSystem::Snapshot() {
 
   if (!all_empty) {
     previous_page_sets_.push_back(current_pageset_);
+    backlog_bytes_ += PageSetMemoryUsage(previous_page_sets_.back());
     ExpireOldPages();
   }
 }
@@ -370,6 +419,11 @@ void TextSystem::ForwardPage() {
 }
 
 void TextSystem::ReplayPageSet(PageSet& set, bool is_current_page) {
+  // Replaying a page records its layout. Count it, so that the next
+  // Snapshot() expires pages against what the backlog really holds.
+  bool in_backlog = &set != &current_pageset_;
+  size_t bytes_before = in_backlog ? PageSetMemoryUsage(set) : 0;
+
   for (PageSet::iterator it = set.begin(); it != set.end(); ++it) {
     try {
       it->second.Replay(is_current_page);
@@ -382,6 +436,9 @@ void TextSystem::ReplayPageSet(PageSet& set, bool is_current_page) {
       // the main loop.
     }
   }
+
+  if (in_backlog)
+    backlog_bytes_ = backlog_bytes_ - bytes_before + PageSetMemoryUsage(set);
 }
 
 bool TextSystem::IsReadingBacklog() const { return is_reading_backlog_; }
@@ -794,6 +851,7 @@ void TextSystem::Reset() {
   current_pageset_.clear();
   previous_page_sets_.clear();
   previous_page_it_ = previous_page_sets_.end();
+  backlog_bytes_ = 0;
 
   window_visual_override_.clear();
   text_window_.clear();
@@ -848,16 +906,22 @@ void TextSystem::save(Archive& ar, unsigned int version) const {
 
 // -----------------------------------------------------------------------
 
-// Explicit instantiations for text archives (since we hide the
+// Explicit instantiations for text and binary archives (since we hide the
 // implementation)
 
 template void TextSystem::save<boost::archive::text_oarchive>(
     boost::archive::text_oarchive& ar,
     unsigned int version) const;
+template void TextSystem::save<boost::archive::binary_oarchive>(
+    boost::archive::binary_oarchive& ar,
+    unsigned int version) const;
 
 template void TextSystem::load<boost::archive::text_iarchive>(
     boost::archive::text_iarchive& ar,
     unsigned int version);
+template void TextSystem::load<boost::archive::binary_iarchive>(
+    boost::archive::binary_iarchive& ar,
+    unsigned int version);
 
 // -----------------------------------------------------------------------
 
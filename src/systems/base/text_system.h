@@ -139,6 +139,15 @@ class TextSystem : public EventListener {
 
   void ReplayPageSet(PageSet& set, bool is_current_page);
 
+  // Caps the backlog at |max_pages| page sets and at roughly |max_bytes| of
+  // memory, dropping the oldest pages first. The most recent page is kept
+  // even if it alone is over |max_bytes|.
+  void SetBacklogLimits(size_t max_pages, size_t max_bytes);
+  size_t backlog_page_count() const { return previous_page_sets_.size(); }
+  size_t backlog_bytes() const { return backlog_bytes_; }
+  size_t max_backlog_pages() const { return max_backlog_pages_; }
+  size_t max_backlog_bytes() const { return max_backlog_bytes_; }
+
   bool IsReadingBacklog() const;
   void StopReadingBacklog();
 
@@ -274,8 +283,8 @@ class TextSystem : public EventListener {
 
   void CheckAndSetBool(Gameexe& gexe, const std::string& key, bool& out);
 
-  // Reduces the number of page snapshots in previous_page_sets_ down to a
-  // manageable constant number.
+  // Drops the oldest page snapshots in previous_page_sets_ until the backlog
+  // is within the limits set by SetBacklogLimits().
   void ExpireOldPages();
 
   // TextPage will call our internals since it actually does most of
@@ -326,6 +335,14 @@ class TextSystem : public EventListener {
   // being rendered.
   std::list<PageSet>::iterator previous_page_it_;
 
+  // Limits on previous_page_sets_. Default to the __BACKLOG_PAGES and
+  // __BACKLOG_MB Gameexe keys.
+  size_t max_backlog_pages_;
+  size_t max_backlog_bytes_;
+
+  // Memory held by previous_page_sets_.
+  size_t backlog_bytes_;
+
   // Whether we are in a state where the interpreter is pause()d.
   bool in_pause_state_;
 
@@ -31,6 +31,7 @@
 #include <iomanip>
 #include <ostream>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -105,6 +106,7 @@ TextWindow::TextWindow(System& system, int window_num)
       is_visible_(0),
       in_selection_mode_(0),
       next_char_italic_(false),
+      last_placement_(),
       system_(system),
       text_system_(system.text()) {
   Gameexe& gexe = system.gameexe();
@@ -553,13 +555,19 @@ bool TextWindow::DisplayCharacter(const std::string& current,
 
     // If the width of this glyph plus the spacing will put us over the
     // edge of the window, then line increment.
-    if (MustLineBreak(cur_codepoint, rest)) {
+    bool line_break = MustLineBreak(cur_codepoint, rest);
+    if (line_break) {
       HardBrake();
 
       if (IsFull())
         return false;
     }
 
+    last_placement_.x = text_insertion_point_x_;
+    last_placement_.y = text_insertion_point_y_;
+    last_placement_.line_break = line_break;
+    last_placement_.italic = next_char_italic_;
+
     RGBColour shadow = RGBAColour::Black().rgb();
     text_system_.RenderGlyphOnto(current,
                                  font_size_in_pixels(),
@@ -674,6 +682,79 @@ bool TextWindow::IsFull() const {
   return current_line_number_ >= y_window_size_in_chars_;
 }
 
+bool TextWindow::LayoutState::operator==(const LayoutState& rhs) const {
+  return std::tie(insertion_point_x, insertion_point_y, wrapping_point_x,
+                  line_number, indentation_in_pixels, indentation_in_chars,
+                  last_token_was_name, next_char_italic, font_size_in_pixels,
+                  default_font_size_in_pixels, ruby_size,
+                  x_window_size_in_chars, y_window_size_in_chars, x_spacing,
+                  y_spacing, name_mod) ==
+         std::tie(rhs.insertion_point_x, rhs.insertion_point_y,
+                  rhs.wrapping_point_x, rhs.line_number,
+                  rhs.indentation_in_pixels, rhs.indentation_in_chars,
+                  rhs.last_token_was_name, rhs.next_char_italic,
+                  rhs.font_size_in_pixels, rhs.default_font_size_in_pixels,
+                  rhs.ruby_size, rhs.x_window_size_in_chars,
+                  rhs.y_window_size_in_chars, rhs.x_spacing, rhs.y_spacing,
+                  rhs.name_mod);
+}
+
+TextWindow::LayoutState TextWindow::layout_state() const {
+  LayoutState state;
+  state.insertion_point_x = text_insertion_point_x_;
+  state.insertion_point_y = text_insertion_point_y_;
+  state.wrapping_point_x = text_wrapping_point_x_;
+  state.line_number = current_line_number_;
+  state.indentation_in_pixels = current_indentation_in_pixels_;
+  state.indentation_in_chars = current_indentation_in_chars_;
+  state.last_token_was_name = last_token_was_name_;
+  state.next_char_italic = next_char_italic_;
+  state.font_size_in_pixels = font_size_in_pixels_;
+  state.default_font_size_in_pixels = default_font_size_in_pixels_;
+  state.ruby_size = ruby_size_;
+  state.x_window_size_in_chars = x_window_size_in_chars_;
+  state.y_window_size_in_chars = y_window_size_in_chars_;
+  state.x_spacing = x_spacing_;
+  state.y_spacing = y_spacing_;
+  state.name_mod = name_mod_;
+  return state;
+}
+
+void TextWindow::set_layout_state(const LayoutState& state) {
+  text_insertion_point_x_ = state.insertion_point_x;
+  text_insertion_point_y_ = state.insertion_point_y;
+  text_wrapping_point_x_ = state.wrapping_point_x;
+  current_line_number_ = state.line_number;
+  current_indentation_in_pixels_ = state.indentation_in_pixels;
+  current_indentation_in_chars_ = state.indentation_in_chars;
+  last_token_was_name_ = state.last_token_was_name;
+  next_char_italic_ = state.next_char_italic;
+}
+
+void TextWindow::DisplayPlacedCharacter(const std::string& current,
+                                        const GlyphPlacement& placement) {
+  set_is_visible(true);
+
+  // Line breaks are replayed for subclasses that track them; the glyph
+  // itself goes where it went before regardless.
+  if (placement.line_break)
+    HardBrake();
+
+  RGBColour shadow = RGBAColour::Black().rgb();
+  text_system_.RenderGlyphOnto(current,
+                               font_size_in_pixels(),
+                               placement.italic,
+                               font_colour_,
+                               &shadow,
+                               placement.x,
+                               placement.y,
+                               GetTextSurface());
+
+  if (ruby_begin_point_ == -1) {
+    system_.graphics().MarkScreenAsDirty(GUT_TEXTSYS);
+  }
+}
+
 void TextWindow::KoeMarker(int id) {
   if (!koe_replay_info_) {
     koe_replay_info_.reset(new KoeReplayInfo);
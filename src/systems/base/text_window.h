@@ -217,6 +217,45 @@ class TextWindow {
   // Returns whether another character can be placed on the screen.
   bool IsFull() const;
 
+  // Everything DisplayCharacter() reads or changes when laying out text. Two
+  // runs of the same characters that start from equal states are laid out
+  // identically.
+  struct LayoutState {
+    int insertion_point_x, insertion_point_y;
+    int wrapping_point_x;
+    int line_number;
+    int indentation_in_pixels, indentation_in_chars;
+    bool last_token_was_name;
+    bool next_char_italic;
+
+    // Not changed by laying out text; only compared.
+    int font_size_in_pixels, default_font_size_in_pixels, ruby_size;
+    int x_window_size_in_chars, y_window_size_in_chars;
+    int x_spacing, y_spacing;
+    int name_mod;
+
+    bool operator==(const LayoutState& rhs) const;
+    bool operator!=(const LayoutState& rhs) const { return !(*this == rhs); }
+  };
+  LayoutState layout_state() const;
+
+  // Restores the parts of |state| that laying out text changes.
+  void set_layout_state(const LayoutState& state);
+
+  // Where the last character passed to DisplayCharacter() was drawn.
+  struct GlyphPlacement {
+    int x, y;
+    bool line_break;
+    bool italic;
+  };
+  const GlyphPlacement& last_placement() const { return last_placement_; }
+
+  // Draws |current| where DisplayCharacter() once put it, without laying it
+  // out again. The insertion point isn't advanced; callers replaying a run of
+  // characters restore the state the run ended in with set_layout_state().
+  virtual void DisplayPlacedCharacter(const std::string& current,
+                                      const GlyphPlacement& placement);
+
   // Sets (and displays, if appropriate) the name of the current speaker.
   virtual void SetName(const std::string& utf8name,
                        const std::string& next_char);
@@ -401,6 +440,8 @@ class TextWindow {
 
   bool next_char_italic_;
 
+  GlyphPlacement last_placement_;
+
   // Callback function for when item is selected; usually will call a
   // specific method on Select_LongOperation
   std::function<void(int)> selection_callback_;
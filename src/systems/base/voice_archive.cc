@@ -56,16 +56,68 @@ unsigned char orig_header[0x2c] = {
     0x00, 0x00, 0x00, 0x00  /* +28 filesize - 0x2c */
 };
 
+// Streams the WAV data a VoiceSample::Decode() returned.
+class DecodedVoiceStream : public VoiceStream {
+ public:
+  explicit DecodedVoiceStream(std::shared_ptr<const char> data)
+      : data_(data),
+        rate_(read_little_endian_int(data.get() + 0x18)),
+        channels_(data.get()[0x16]),
+        length_(read_little_endian_int(data.get() + 0x28)),
+        pos_(0) {}
+
+  virtual int rate() const override { return rate_; }
+  virtual int channels() const override { return channels_; }
+
+  virtual int Read(char* buffer, int length) override {
+    length = std::min(length, length_ - pos_);
+    memcpy(buffer, data_.get() + WAV_HEADER_SIZE + pos_, length);
+    pos_ += length;
+    return length;
+  }
+
+ private:
+  std::shared_ptr<const char> data_;
+  int rate_;
+  int channels_;
+  int length_;
+  int pos_;
+};
+
 }  // namespace
 
+// -----------------------------------------------------------------------
+// VoiceStream
+// -----------------------------------------------------------------------
+VoiceStream::~VoiceStream() {}
+
 // -----------------------------------------------------------------------
 // VoiceSample
 // -----------------------------------------------------------------------
 VoiceSample::~VoiceSample() {}
 
+std::unique_ptr<VoiceStream> VoiceSample::OpenStream() {
+  int size;
+  char* data = Decode(&size);
+  if (!data)
+    throw rlvm::Exception("Couldn't decode voice sample");
+
+  return OpenDecodedStream(
+      std::shared_ptr<const char>(data, std::default_delete<char[]>()));
+}
+
+// static
+std::unique_ptr<VoiceStream> VoiceSample::OpenDecodedStream(
+    std::shared_ptr<const char> wav) {
+  return std::unique_ptr<VoiceStream>(new DecodedVoiceStream(wav));
+}
+
 // static
-const char* VoiceSample::MakeWavHeader(int rate, int ch, int bps, int size) {
-  static char header[0x2c];
+void VoiceSample::MakeWavHeader(char* header,
+                                int rate,
+                                int ch,
+                                int bps,
+                                int size) {
   memcpy(header, (const char*)orig_header, 0x2c);
   write_little_endian_int(header + 0x04, size - 8);
   write_little_endian_int(header + 0x28, size - 0x2c);
@@ -74,7 +126,6 @@ const char* VoiceSample::MakeWavHeader(int rate, int ch, int bps, int size) {
   header[0x16] = ch;
   header[0x20] = ch * bps;
   header[0x22] = bps * 8;
-  return header;
 }
 
 // -----------------------------------------------------------------------
@@ -36,16 +36,42 @@ class VoiceArchive;
 
 const int WAV_HEADER_SIZE = 0x2c;
 
+// PCM from a voice sample that is decoded as it's read, so playback can start
+// as soon as the first block is ready.
+class VoiceStream {
+ public:
+  virtual ~VoiceStream();
+
+  virtual int rate() const = 0;
+  virtual int channels() const = 0;
+
+  // Writes up to |length| bytes of interleaved, signed 16-bit little endian
+  // samples to |buffer|. Returns the number of bytes written; zero once the
+  // sample is exhausted.
+  virtual int Read(char* buffer, int length) = 0;
+};
+
 // A Reference to an individual voice sample in a voice archive (independent of
 // the voice archive type).
-class VoiceSample {
+class VoiceSample : public std::enable_shared_from_this<VoiceSample> {
  public:
   virtual ~VoiceSample();
 
   // Returns waveform data, putting the size of the buffer in |size|.
   virtual char* Decode(int* size) = 0;
 
-  static const char* MakeWavHeader(int rate, int ch, int bps, int size);
+  // Returns a stream of this sample's PCM. Formats that can't be decoded
+  // incrementally get the default, which Decode()s everything up front.
+  virtual std::unique_ptr<VoiceStream> OpenStream();
+
+  // Returns a stream over |wav|, a buffer returned by Decode().
+  static std::unique_ptr<VoiceStream> OpenDecodedStream(
+      std::shared_ptr<const char> wav);
+
+  // Writes a WAV_HEADER_SIZE byte header for |size| bytes of WAV, header
+  // included, into |header|. Samples are decoded on the prefetch thread too,
+  // so this doesn't share a buffer between callers.
+  static void MakeWavHeader(char* header, int rate, int ch, int bps, int size);
 };
 
 // Abstract representation of an archive on disk with a bunch of voice samples
@@ -49,7 +49,7 @@ using std::string;
 namespace fs = boost::filesystem;
 
 VoiceCache::VoiceCache(SoundSystem& sound_system)
-    : sound_system_(sound_system), file_cache_(7) {}
+    : sound_system_(sound_system), file_cache_(7), decoded_cache_(16) {}
 
 VoiceCache::~VoiceCache() {}
 
@@ -80,6 +80,36 @@ std::shared_ptr<VoiceSample> VoiceCache::Find(int id) {
   }
 }
 
+void VoiceCache::Prefetch(int id) {
+  // Only the decode runs on the background thread; finding the sample touches
+  // |file_cache_| and System::FindFile(), which aren't thread safe.
+  std::shared_ptr<VoiceSample> sample;
+  try {
+    sample = Find(id);
+  }
+  catch (rlvm::Exception& e) {
+    return;
+  }
+
+  if (sample)
+    decoded_cache_.Prefetch(id, sample);
+}
+
+std::unique_ptr<VoiceStream> VoiceCache::OpenStream(int id) {
+  std::unique_ptr<VoiceStream> stream = decoded_cache_.OpenStream(id);
+  if (stream)
+    return stream;
+
+  std::shared_ptr<VoiceSample> sample = Find(id);
+  if (!sample) {
+    std::ostringstream oss;
+    oss << "No sample for " << id;
+    throw rlvm::Exception(oss.str());
+  }
+
+  return sample->OpenStream();
+}
+
 std::shared_ptr<VoiceArchive> VoiceCache::FindArchive(int file_no) const {
   std::ostringstream oss;
   oss << "z" << std::setw(4) << std::setfill('0') << file_no;
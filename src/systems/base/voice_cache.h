@@ -30,10 +30,12 @@
 #include <memory>
 
 #include "lru_cache.hpp"
+#include "systems/base/decoded_voice_cache.h"
 
 class SoundSystem;
 class VoiceArchive;
 class VoiceSample;
+class VoiceStream;
 
 class VoiceCache {
  public:
@@ -42,6 +44,16 @@ class VoiceCache {
 
   std::shared_ptr<VoiceSample> Find(int id);
 
+  // Starts decoding |id| in the background so that OpenStream() doesn't have
+  // to. Ids that don't exist are ignored.
+  void Prefetch(int id);
+
+  // Returns a stream of |id|, using the prefetched decode when there is one.
+  std::unique_ptr<VoiceStream> OpenStream(int id);
+
+  // The prefetched voices, which count how often OpenStream() hit them.
+  DecodedVoiceCache& decoded_cache() { return decoded_cache_; }
+
  private:
   // Searches for a file archive of voices.
   std::shared_ptr<VoiceArchive> FindArchive(int file_no) const;
@@ -54,6 +66,9 @@ class VoiceCache {
 
   // A mapping between a file id number and the underlying file object.
   LRUCache<int, std::shared_ptr<VoiceArchive>> file_cache_;
+
+  // Voices decoded ahead of time by Prefetch().
+  DecodedVoiceCache decoded_cache_;
 };  // class VoiceCache
 
 #endif  // SRC_SYSTEMS_BASE_VOICE_CACHE_H_
@@ -38,8 +38,10 @@ SDLColourFilter::SDLColourFilter()
     : texture_width_(0), texture_height_(0), back_texture_id_(0) {}
 
 SDLColourFilter::~SDLColourFilter() {
-  if (back_texture_id_)
+  if (back_texture_id_) {
     glDeleteTextures(1, &back_texture_id_);
+    Texture::ForgetBoundTexture();
+  }
 }
 
 void SDLColourFilter::Fill(const GraphicsObject& go,
@@ -48,7 +50,7 @@ void SDLColourFilter::Fill(const GraphicsObject& go,
   if (GLEW_ARB_fragment_shader && GLEW_ARB_multitexture) {
     if (back_texture_id_ == 0) {
       glGenTextures(1, &back_texture_id_);
-      glBindTexture(GL_TEXTURE_2D, back_texture_id_);
+      Texture::BindTexture(back_texture_id_);
       DebugShowGLErrors();
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -69,7 +71,7 @@ void SDLColourFilter::Fill(const GraphicsObject& go,
 
     // Copy the current value of the region where we're going to render
     // to a texture for input to the shader
-    glBindTexture(GL_TEXTURE_2D, back_texture_id_);
+    Texture::BindTexture(back_texture_id_);
     int ystart =
         int(Texture::ScreenHeight() - screen_rect.y() - screen_rect.height());
     int idx1 = screen_rect.x();
@@ -90,6 +92,7 @@ void SDLColourFilter::Fill(const GraphicsObject& go,
     float thisy2 = float(screen_rect.height()) / texture_height_;
 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    Texture::CountDrawCall();
     glBegin(GL_QUADS);
     {
       glTexCoord2f(thisx1, thisy2);
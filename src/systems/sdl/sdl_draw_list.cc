@@ -0,0 +1,84 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "GL/glew.h"
+
+#include "systems/sdl/sdl_draw_list.h"
+
+#include <vector>
+
+#include "systems/sdl/sdl_surface.h"
+#include "systems/sdl/texture.h"
+
+SDLDrawList::SDLDrawList() {}
+
+SDLDrawList::~SDLDrawList() {}
+
+bool SDLDrawList::CanBatch(const DrawRecord& a, const DrawRecord& b) const {
+  if (!a.SameState(b))
+    return false;
+  if (a.surface == b.surface)
+    return true;
+
+  Texture* a_texture = GetBatchTexture(a);
+  Texture* b_texture = GetBatchTexture(b);
+  return a_texture && b_texture &&
+         a_texture->textureId() == b_texture->textureId();
+}
+
+void SDLDrawList::SubmitBatch(const DrawRecord* begin, const DrawRecord* end) {
+  // Look everything up first; uploading isn't allowed inside glBegin().
+  std::vector<Texture*> textures;
+  for (const DrawRecord* record = begin; record != end; ++record) {
+    Texture* texture = GetBatchTexture(*record);
+    if (!texture) {
+      // Split images bind a texture per piece; draw them one by one.
+      DrawList::SubmitBatch(begin, end);
+      return;
+    }
+    textures.push_back(texture);
+  }
+
+  Texture::BindTexture(textures.front()->textureId());
+  Texture::BeginObjectBatch(*begin);
+
+  Texture::CountDrawCall();
+  glBegin(GL_QUADS);
+  for (size_t i = 0; i < textures.size(); ++i)
+    textures[i]->AddObjectQuad(begin[i]);
+  glEnd();
+
+  Texture::EndObjectBatch(*begin);
+}
+
+// static
+Texture* SDLDrawList::GetBatchTexture(const DrawRecord& record) {
+  const SDLSurface* surface =
+      dynamic_cast<const SDLSurface*>(record.surface.get());
+  return surface ? surface->GetBatchTexture() : NULL;
+}
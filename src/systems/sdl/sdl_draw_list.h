@@ -0,0 +1,57 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SDL_SDL_DRAW_LIST_H_
+#define SRC_SYSTEMS_SDL_SDL_DRAW_LIST_H_
+
+#include "systems/base/draw_list.h"
+
+class Texture;
+
+// Submits each run of object draws that share a texture and state as a
+// single glBegin()/glEnd() with one bind and one shader setup. Surfaces in
+// the same atlas page share a texture, so different images can batch.
+class SDLDrawList : public DrawList {
+ public:
+  SDLDrawList();
+  virtual ~SDLDrawList();
+
+ protected:
+  // DrawList:
+  virtual bool CanBatch(const DrawRecord& a,
+                        const DrawRecord& b) const override;
+  virtual void SubmitBatch(const DrawRecord* begin,
+                           const DrawRecord* end) override;
+
+ private:
+  // The single texture |record|'s surface is in, or NULL if it's split over
+  // several or isn't an SDLSurface.
+  static Texture* GetBatchTexture(const DrawRecord& record);
+};
+
+#endif  // SRC_SYSTEMS_SDL_SDL_DRAW_LIST_H_
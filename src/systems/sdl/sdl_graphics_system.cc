@@ -40,7 +40,6 @@
 #include <boost/algorithm/string.hpp>
 
 #include <algorithm>
-#include <cstdio>
 #include <set>
 #include <sstream>
 #include <string>
@@ -51,6 +50,7 @@
 #include "machine/rlmachine.h"
 #include "systems/base/cgm_table.h"
 #include "systems/base/colour.h"
+#include "systems/base/decoded_image.h"
 #include "systems/base/event_system.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/mouse_cursor.h"
@@ -60,17 +60,18 @@
 #include "systems/base/text_system.h"
 #include "systems/base/tone_curve.h"
 #include "systems/sdl/sdl_colour_filter.h"
+#include "systems/sdl/sdl_draw_list.h"
 #include "systems/sdl/sdl_event_system.h"
 #include "systems/sdl/sdl_render_to_texture_surface.h"
 #include "systems/sdl/sdl_surface.h"
 #include "systems/sdl/sdl_utils.h"
 #include "systems/sdl/shaders.h"
 #include "systems/sdl/texture.h"
+#include "systems/sdl/texture_atlas.h"
 #include "utilities/exception.h"
 #include "utilities/graphics.h"
 #include "utilities/lazy_array.h"
 #include "utilities/string_utilities.h"
-#include "xclannad/file.h"
 
 // -----------------------------------------------------------------------
 // Private Interface
@@ -83,6 +84,10 @@ void SDLGraphicsSystem::SetCursor(int cursor) {
 }
 
 void SDLGraphicsSystem::BeginFrame() {
+  // Other renderers bind textures without telling us.
+  Texture::ForgetBoundTexture();
+  Texture::ResetCounters();
+
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   DebugShowGLErrors();
@@ -119,34 +124,86 @@ void SDLGraphicsSystem::MarkScreenAsDirty(GraphicsUpdateType type) {
     GraphicsSystem::MarkScreenAsDirty(type);
 }
 
+Rect SDLGraphicsSystem::BeginRedraw(const DamageRegion& damage) {
+  drawing_refresh_ = true;
+  redraw_area_ = screen_rect();
+
+  // BeginFrame() has cleared the screen. Unless everything changed anyway,
+  // put the last frame back and only redraw what's different. Shaking moves
+  // everything, so it always redraws.
+  if (!screen_contents_texture_valid_ || damage.is_full() ||
+      GetScreenOrigin() != Point(0, 0))
+    return redraw_area_;
+
+  DrawLastFrame();
+
+  redraw_area_ = damage.GetBounds(screen_rect());
+  if (redraw_area_.width() > 0 && redraw_area_.height() > 0) {
+    // The scissor box is in window coordinates, which start at the bottom.
+    glScissor(redraw_area_.x(),
+              screen_size().height() - redraw_area_.y2(),
+              redraw_area_.width(),
+              redraw_area_.height());
+    glEnable(GL_SCISSOR_TEST);
+  }
+
+  return redraw_area_;
+}
+
 void SDLGraphicsSystem::EndFrame() {
+  glDisable(GL_SCISSOR_TEST);
+
   FinalRenderers::iterator it = renderer_begin();
   FinalRenderers::iterator end = renderer_end();
   for (; it != end; ++it) {
     (*it)->Render(NULL);
   }
-
-  if (screen_update_mode() == SCREENUPDATEMODE_MANUAL) {
-    // Copy the area behind the cursor to the temporary buffer (drivers differ:
-    // the contents of the back buffer is undefined after SDL_GL_SwapBuffers()
-    // and I've just been lucky that the Intel i810 and whatever my Mac machine
-    // has have been doing things that way.)
-    glBindTexture(GL_TEXTURE_2D, screen_contents_texture_);
-    glCopyTexSubImage2D(GL_TEXTURE_2D,
-                        0,
-                        0,
-                        0,
-                        0,
-                        0,
-                        screen_size().width(),
-                        screen_size().height());
+  Texture::ForgetBoundTexture();
+
+  // Copy the frame, minus the cursor, to the temporary buffer (drivers
+  // differ: the contents of the back buffer is undefined after
+  // SDL_GL_SwapBuffers() and I've just been lucky that the Intel i810 and
+  // whatever my Mac machine has have been doing things that way.)
+  if (drawing_refresh_) {
+    // Outside of |redraw_area_| the screen is what we copied last time.
+    if (redraw_area_.width() > 0 && redraw_area_.height() > 0) {
+      int y = screen_size().height() - redraw_area_.y2();
+      Texture::BindTexture(screen_contents_texture_);
+      glCopyTexSubImage2D(GL_TEXTURE_2D,
+                          0,
+                          redraw_area_.x(),
+                          y,
+                          redraw_area_.x(),
+                          y,
+                          redraw_area_.width(),
+                          redraw_area_.height());
+    }
     screen_contents_texture_valid_ = true;
   } else {
-    screen_contents_texture_valid_ = false;
+    // Someone other than Refresh() drew this frame, so the copy no longer
+    // matches what Refresh() last drew.
+    InvalidateLastFrame();
+
+    if (screen_update_mode() == SCREENUPDATEMODE_MANUAL) {
+      Texture::BindTexture(screen_contents_texture_);
+      glCopyTexSubImage2D(GL_TEXTURE_2D,
+                          0,
+                          0,
+                          0,
+                          0,
+                          0,
+                          screen_size().width(),
+                          screen_size().height());
+      screen_contents_texture_valid_ = true;
+    }
   }
+  drawing_refresh_ = false;
 
   DrawCursor();
 
+  last_frame_draw_calls_ = Texture::draw_calls();
+  last_frame_texture_binds_ = Texture::texture_binds();
+
   // Swap the buffers
   glFlush();
   SDL_GL_SwapBuffers();
@@ -154,35 +211,10 @@ void SDLGraphicsSystem::EndFrame() {
 }
 
 void SDLGraphicsSystem::RedrawLastFrame() {
-  // We won't redraw the screen between when the DrawManual() command is issued
-  // by the bytecode and the first refresh() is called since we need a valid
-  // copy of the screen to work with and we only snapshot the screen during
-  // DrawManual() mode.
+  // We won't redraw the screen until the first frame has been drawn since we
+  // need a valid copy of the screen to work with.
   if (screen_contents_texture_valid_) {
-    // Redraw the screen
-    glBindTexture(GL_TEXTURE_2D, screen_contents_texture_);
-    glBegin(GL_QUADS);
-    {
-      int dx1 = 0;
-      int dx2 = screen_size().width();
-      int dy1 = 0;
-      int dy2 = screen_size().height();
-
-      float x_cord = dx2 / float(screen_tex_width_);
-      float y_cord = dy2 / float(screen_tex_height_);
-
-      glColor4ub(255, 255, 255, 255);
-      glTexCoord2f(0, y_cord);
-      glVertex2i(dx1, dy1);
-      glTexCoord2f(x_cord, y_cord);
-      glVertex2i(dx2, dy1);
-      glTexCoord2f(x_cord, 0);
-      glVertex2i(dx2, dy2);
-      glTexCoord2f(0, 0);
-      glVertex2i(dx1, dy2);
-    }
-    glEnd();
-
+    DrawLastFrame();
     DrawCursor();
 
     glFlush();
@@ -193,6 +225,32 @@ void SDLGraphicsSystem::RedrawLastFrame() {
   }
 }
 
+void SDLGraphicsSystem::DrawLastFrame() {
+  Texture::BindTexture(screen_contents_texture_);
+  Texture::CountDrawCall();
+  glBegin(GL_QUADS);
+  {
+    int dx1 = 0;
+    int dx2 = screen_size().width();
+    int dy1 = 0;
+    int dy2 = screen_size().height();
+
+    float x_cord = dx2 / float(screen_tex_width_);
+    float y_cord = dy2 / float(screen_tex_height_);
+
+    glColor4ub(255, 255, 255, 255);
+    glTexCoord2f(0, y_cord);
+    glVertex2i(dx1, dy1);
+    glTexCoord2f(x_cord, y_cord);
+    glVertex2i(dx2, dy1);
+    glTexCoord2f(x_cord, 0);
+    glVertex2i(dx2, dy2);
+    glTexCoord2f(0, 0);
+    glVertex2i(dx1, dy2);
+  }
+  glEnd();
+}
+
 void SDLGraphicsSystem::DrawCursor() {
   if (ShouldUseCustomCursor()) {
     std::shared_ptr<MouseCursor> cursor;
@@ -223,7 +281,10 @@ SDLGraphicsSystem::SDLGraphicsSystem(System& system, Gameexe& gameexe)
       last_line_number_(0),
       screen_contents_texture_valid_(false),
       screen_tex_width_(0),
-      screen_tex_height_(0) {
+      screen_tex_height_(0),
+      drawing_refresh_(false),
+      last_frame_draw_calls_(0),
+      last_frame_texture_binds_(0) {
   haikei_.reset(new SDLSurface(this));
   for (int i = 0; i < 16; ++i)
     display_contexts_[i].reset(new SDLSurface(this));
@@ -237,6 +298,7 @@ SDLGraphicsSystem::SDLGraphicsSystem(System& system, Gameexe& gameexe)
   caption_title_ = cp932toUTF8(cp932caption, name_enc);
 
   SetupVideo();
+  texture_atlas_.reset(new TextureAtlas);
 
   // Now we allocate the first two display contexts with equal size to
   // the display
@@ -350,7 +412,8 @@ void SDLGraphicsSystem::SetupVideo() {
   // Create a small 32x32 texture for storing what's behind the mouse
   // cursor.
   glGenTextures(1, &screen_contents_texture_);
-  glBindTexture(GL_TEXTURE_2D, screen_contents_texture_);
+  screen_contents_texture_valid_ = false;
+  Texture::BindTexture(screen_contents_texture_);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   screen_tex_width_ = SafeSize(screen_size().width());
@@ -365,6 +428,9 @@ void SDLGraphicsSystem::SetupVideo() {
                GL_UNSIGNED_BYTE,
                NULL);
 
+  // We may have a new context; nothing we knew about is bound in it.
+  Texture::ForgetBoundTexture();
+
   ShowGLErrors();
 }
 
@@ -387,8 +453,10 @@ void SDLGraphicsSystem::ExecuteGraphicsSystem(RLMachine& machine) {
   if ((current_time - time_of_last_titlebar_update_) > 60) {
     time_of_last_titlebar_update_ = current_time;
 
+    // The frame statistics change without the line changing.
     if (machine.SceneNumber() != last_seen_number_ ||
-        machine.line_number() != last_line_number_) {
+        machine.line_number() != last_line_number_ ||
+        display_data_in_titlebar_) {
       last_seen_number_ = machine.SceneNumber();
       last_line_number_ = machine.line_number();
       SetWindowTitle();
@@ -408,7 +476,9 @@ void SDLGraphicsSystem::SetWindowTitle() {
 
   if (display_data_in_titlebar_) {
     oss << " - (SEEN" << last_seen_number_ << ")(Line " << last_line_number_
-        << ")";
+        << ")(" << last_frame_draw_calls_ << " draws, "
+        << last_frame_texture_binds_ << " binds, "
+        << frame_statistics().last_frame_pixels << " pixels redrawn)";
   }
 
   // PulseAudio allocates a string each time we set the title. Make sure we
@@ -424,6 +494,7 @@ void SDLGraphicsSystem::Observe(NotificationType type,
                                 const NotificationSource& source,
                                 const NotificationDetails& details) {
   Shaders::Reset();
+  texture_atlas_->Reset();
 }
 
 void SDLGraphicsSystem::SetWindowSubtitle(const std::string& cp932str,
@@ -558,17 +629,6 @@ static SDL_Surface* newSurfaceFromRGBAData(int w,
   return surf;
 }
 
-// Helper function for load_surface_from_file; invoked in a stl loop.
-static SDLSurface::GrpRect xclannadRegionToGrpRect(
-    const GRPCONV::REGION& region) {
-  SDLSurface::GrpRect rect;
-  rect.rect =
-      Rect(Point(region.x1, region.y1), Point(region.x2 + 1, region.y2 + 1));
-  rect.originX = region.origin_x;
-  rect.originY = region.origin_y;
-  return rect;
-}
-
 std::shared_ptr<const Surface> SDLGraphicsSystem::LoadSurfaceFromFile(
     const std::string& short_filename) {
   boost::filesystem::path filename =
@@ -579,67 +639,24 @@ std::shared_ptr<const Surface> SDLGraphicsSystem::LoadSurfaceFromFile(
     throw rlvm::Exception(oss.str());
   }
 
-  // Glue code to allow my stuff to work with Jagarl's loader
-  FILE* file = fopen(filename.string().c_str(), "rb");
-  if (!file) {
-    std::ostringstream oss;
-    oss << "Could not open file: " << filename;
-    throw rlvm::Exception(oss.str());
-  }
+  return SurfaceFromDecodedImage(short_filename, *DecodeImageFile(filename));
+}
 
-  fseek(file, 0, SEEK_END);
-  size_t size = ftell(file);
-  std::unique_ptr<char[]> d(new char[size + 1]);
-  fseek(file, 0, SEEK_SET);
-  fread(d.get(), size, 1, file);
-  fclose(file);
-
-  std::unique_ptr<GRPCONV> conv(
-      GRPCONV::AssignConverter(d.get(), size, "???"));
-  if (conv == 0) {
-    throw SystemError("Failure in GRPCONV.");
-  }
-  // do not free until SDL_FreeSurface() is called on the surface using it
-  char* mem = (char*)malloc(conv->Width() * conv->Height() * 4 + 1024);
-  SDL_Surface* s = 0;
-  if (conv->Read(mem)) {
-    MaskType is_mask = conv->IsMask() ? ALPHA_MASK : NO_MASK;
-    if (is_mask == ALPHA_MASK) {
-      int len = conv->Width() * conv->Height();
-      unsigned int* d = (unsigned int*)mem;
-      int i;
-      for (i = 0; i < len; i++) {
-        if ((*d & 0xff000000) != 0xff000000)
-          break;
-        d++;
-      }
-      if (i == len) {
-        is_mask = NO_MASK;
-      }
-    }
+bool SDLGraphicsSystem::DecodesImageFiles() const { return true; }
 
-    s = newSurfaceFromRGBAData(conv->Width(), conv->Height(), mem, is_mask);
-  }
-  free(mem);
-
-  // Grab the Type-2 information out of the converter or create one
-  // default region if none exist
-  std::vector<SDLSurface::GrpRect> region_table;
-  if (conv->region_table.size()) {
-    std::transform(conv->region_table.begin(),
-                   conv->region_table.end(),
-                   std::back_inserter(region_table),
-                   xclannadRegionToGrpRect);
-  } else {
-    SDLSurface::GrpRect rect;
-    rect.rect = Rect(Point(0, 0), Size(conv->Width(), conv->Height()));
-    rect.originX = 0;
-    rect.originY = 0;
-    region_table.push_back(rect);
+std::shared_ptr<const Surface> SDLGraphicsSystem::SurfaceFromDecodedImage(
+    const std::string& short_filename,
+    const DecodedImage& image) {
+  SDL_Surface* s = 0;
+  if (image.pixels) {
+    s = newSurfaceFromRGBAData(image.width,
+                               image.height,
+                               image.pixels.get(),
+                               image.has_alpha ? ALPHA_MASK : NO_MASK);
   }
 
   std::shared_ptr<Surface> surface_to_ret(
-      new SDLSurface(this, s, region_table));
+      new SDLSurface(this, s, image.regions));
   // handle tone curve effect loading
   if (short_filename.find("?") != short_filename.npos) {
     std::string effect_no_str =
@@ -655,7 +672,7 @@ std::shared_ptr<const Surface> SDLGraphicsSystem::LoadSurfaceFromFile(
     }
     surface_to_ret.get()->ToneCurve(
         globals().tone_curves.GetEffect(effect_no / 10 - 1),
-        Rect(Point(0, 0), Size(conv->Width(), conv->Height())));
+        Rect(Point(0, 0), Size(image.width, image.height)));
   }
 
   return surface_to_ret;
@@ -687,6 +704,8 @@ ColourFilter* SDLGraphicsSystem::BuildColourFiller() {
   return new SDLColourFilter();
 }
 
+DrawList* SDLGraphicsSystem::BuildDrawList() { return new SDLDrawList; }
+
 void SDLGraphicsSystem::Reset() {
   last_seen_number_ = 0;
   last_line_number_ = 0;
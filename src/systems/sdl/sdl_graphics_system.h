@@ -46,6 +46,7 @@ class SDLGraphicsSystem;
 class SDLSurface;
 class System;
 class Texture;
+class TextureAtlas;
 
 // -----------------------------------------------------------------------
 
@@ -82,11 +83,22 @@ class SDLGraphicsSystem : public GraphicsSystem, public NotificationObserver {
   virtual std::shared_ptr<const Surface> LoadSurfaceFromFile(
       const std::string& short_filename) override;
 
+  virtual bool DecodesImageFiles() const override;
+  virtual std::shared_ptr<const Surface> SurfaceFromDecodedImage(
+      const std::string& short_filename,
+      const DecodedImage& image) override;
+
   virtual std::shared_ptr<Surface> GetHaikei() override;
   virtual std::shared_ptr<Surface> GetDC(int dc) override;
   virtual std::shared_ptr<Surface> BuildSurface(const Size& size) override;
 
   virtual ColourFilter* BuildColourFiller() override;
+  virtual DrawList* BuildDrawList() override;
+
+  // Shared pages that small surfaces upload into.
+  const std::shared_ptr<TextureAtlas>& texture_atlas() const {
+    return texture_atlas_;
+  }
 
   // -----------------------------------------------------------------------
 
@@ -102,6 +114,12 @@ class SDLGraphicsSystem : public GraphicsSystem, public NotificationObserver {
  private:
   void SetupVideo();
 
+  // Starts from the last frame and limits drawing to what |damage| covers.
+  virtual Rect BeginRedraw(const DamageRegion& damage) override;
+
+  // Draws |screen_contents_texture_| over the whole screen.
+  void DrawLastFrame();
+
   // Makes sure that a passed in dc number is valid.
   //
   // @exception Error Throws when dc is greater then the maximum.
@@ -146,9 +164,10 @@ class SDLGraphicsSystem : public GraphicsSystem, public NotificationObserver {
   // memory leak in PulseAudio.
   std::string currently_set_title_;
 
-  // Texture used to store the contents of the screen while in DrawManual()
-  // mode. The stored image is then used if we need to redraw in the
-  // intervening time (expose events, mouse cursor moves, etc).
+  // Texture used to store the contents of the screen after each frame. Each
+  // Refresh() starts from it and only redraws what changed, and in
+  // DrawManual() mode it is used if we need to redraw in the intervening time
+  // (expose events, mouse cursor moves, etc).
   GLuint screen_contents_texture_;
 
   // Whether |screen_contents_texture_| is valid to use.
@@ -160,6 +179,17 @@ class SDLGraphicsSystem : public GraphicsSystem, public NotificationObserver {
   int screen_tex_width_;
   int screen_tex_height_;
 
+  // Set by BeginRedraw() when the frame being drawn is a Refresh(), to the
+  // part of the screen it redraws.
+  bool drawing_refresh_;
+  Rect redraw_area_;
+
+  std::shared_ptr<TextureAtlas> texture_atlas_;
+
+  // Draws and texture binds made by the last frame, for the titlebar.
+  int last_frame_draw_calls_;
+  int last_frame_texture_binds_;
+
   NotificationRegistrar registrar_;
 };
 
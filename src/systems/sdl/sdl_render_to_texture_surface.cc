@@ -91,10 +91,8 @@ void SDLRenderToTextureSurface::RenderToScreenAsColorMask(
       "unimplemented");
 }
 
-void SDLRenderToTextureSurface::RenderToScreenAsObject(const GraphicsObject& rp,
-                                                       const Rect& src,
-                                                       const Rect& dst,
-                                                       int alpha) const {
+void SDLRenderToTextureSurface::RenderToScreenAsObject(
+    const DrawRecord& record) const {
   throw rlvm::Exception(
       "SDLRenderToTextureSurface::render_to_screen_as_object unimplemented");
 }
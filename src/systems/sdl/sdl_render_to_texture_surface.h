@@ -66,10 +66,8 @@ class SDLRenderToTextureSurface : public Surface, public NotificationObserver {
                                          const RGBAColour& rgba,
                                          int filter) const override;
 
-  virtual void RenderToScreenAsObject(const GraphicsObject& rp,
-                                      const Rect& src,
-                                      const Rect& dst,
-                                      int alpha) const override;
+  virtual void RenderToScreenAsObject(
+      const DrawRecord& record) const override;
 
   virtual void Fill(const RGBAColour& colour) override;
   virtual void Fill(const RGBAColour& colour, const Rect& rect) override;
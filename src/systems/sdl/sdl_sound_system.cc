@@ -31,14 +31,17 @@
 #include <SDL/SDL_mixer.h>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "systems/base/system.h"
 #include "systems/base/system_error.h"
 #include "systems/base/voice_archive.h"
 #include "systems/sdl/sdl_music.h"
 #include "systems/sdl/sdl_sound_chunk.h"
+#include "systems/sdl/sdl_voice_stream.h"
 #include "utilities/exception.h"
 
 namespace fs = boost::filesystem;
@@ -86,11 +89,6 @@ SDLSoundSystem::SDLSoundChunkPtr SDLSoundSystem::GetSoundChunk(
   return sample;
 }
 
-SDLSoundSystem::SDLSoundChunkPtr SDLSoundSystem::BuildKoeChunk(char* data,
-                                                               int length) {
-  return SDLSoundChunkPtr(new SDLSoundChunk(data, length));
-}
-
 void SDLSoundSystem::WavPlayImpl(const std::string& wav_file,
                                  const int channel,
                                  bool loop) {
@@ -386,20 +384,9 @@ void SDLSoundSystem::KoePlayImpl(int id) {
     return;
   }
 
-  // Get the VoiceSample.
-  std::shared_ptr<VoiceSample> sample = voice_cache_.Find(id);
-  if (!sample) {
-    std::ostringstream oss;
-    oss << "No sample for " << id;
-    throw std::runtime_error(oss.str());
-  }
-
-  int length;
-  char* data = sample->Decode(&length);
-
-  SDLSoundChunkPtr koe = BuildKoeChunk(data, length);
+  std::unique_ptr<VoiceStream> stream = voice_cache_.OpenStream(id);
   SetChannelVolumeImpl(KOE_CHANNEL);
-  koe->PlayChunkOn(KOE_CHANNEL, 0);
+  SDLVoiceStream::PlayOn(KOE_CHANNEL, std::move(stream));
 }
 
 void SDLSoundSystem::Reset() {
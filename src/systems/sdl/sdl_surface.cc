@@ -28,6 +28,7 @@
 #include "systems/sdl/sdl_surface.h"
 
 #include <SDL/SDL.h>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -37,143 +38,81 @@
 #include "systems/base/colour.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_object_data.h"
+#include "systems/base/pixel_transforms.h"
 #include "systems/base/system_error.h"
 #include "systems/sdl/sdl_graphics_system.h"
 #include "systems/sdl/sdl_utils.h"
 #include "systems/sdl/texture.h"
+#include "systems/sdl/texture_atlas.h"
 #include "utilities/graphics.h"
 
-namespace {
-
-// An interface to TransformSurface that maps one color to another.
-class ColourTransformer {
- public:
-  virtual ~ColourTransformer() {}
-  virtual SDL_Color operator()(const SDL_Color& colour) const = 0;
-};
-
-class ToneCurveColourTransformer : public ColourTransformer {
- public:
-  explicit ToneCurveColourTransformer(const ToneCurveRGBMap m) : colormap(m) {}
-  virtual SDL_Color operator()(const SDL_Color& colour) const {
-    SDL_Color out = {colormap[0][colour.r], colormap[1][colour.g],
-                     colormap[2][colour.b], 0};
-    return out;
-  }
-
- private:
-  ToneCurveRGBMap colormap;
-};
-
-class InvertColourTransformer : public ColourTransformer {
- public:
-  virtual SDL_Color operator()(const SDL_Color& colour) const {
-    SDL_Color out = {255 - colour.r, 255 - colour.g, 255 - colour.b, 0};
-    return out;
-  }
-};
-
-class MonoColourTransformer : public ColourTransformer {
- public:
-  virtual SDL_Color operator()(const SDL_Color& colour) const {
-    float grayscale = 0.3 * colour.r + 0.59 * colour.g + 0.11 * colour.b;
-    Clamp(grayscale, 0, 255);
-    SDL_Color out = {grayscale, grayscale, grayscale, 0};
-    return out;
-  }
-};
-
-class ApplyColourTransformer : public ColourTransformer {
- public:
-  explicit ApplyColourTransformer(const RGBColour& colour) : colour_(colour) {}
-
-  int compose(int in_colour, int surface_colour) const {
-    if (in_colour > 0) {
-      return 255 -
-             ((static_cast<float>((255 - in_colour) * (255 - surface_colour)) /
-               (255 * 255)) *
-              255);
-    } else if (in_colour < 0) {
-      return (static_cast<float>(abs(in_colour) * surface_colour) /
-              (255 * 255)) *
-             255;
-    } else {
-      return surface_colour;
-    }
-  }
-
-  virtual SDL_Color operator()(const SDL_Color& colour) const {
-    SDL_Color out = {
-        compose(colour_.r(), colour.r), compose(colour_.g(), colour.g),
-        compose(colour_.b(), colour.b), 0};
-    return out;
-  }
+// Note to self: These describe the byte order IN THE RAW G00 DATA!
+// These should NOT be switched to native byte order.
+#define DefaultRmask 0xff0000
+#define DefaultGmask 0xff00
+#define DefaultBmask 0xff
+#define DefaultAmask 0xff000000
+#define DefaultBpp 32
 
- private:
-  RGBColour colour_;
-};
+namespace {
 
-// Applies a |transformer| to every pixel in |area| in the surface |surface|.
+// Runs |kernel|, one of the pixel_transforms.h functions, over every pixel in
+// |area| of |surface|.
 void TransformSurface(SDLSurface* our_surface,
                       const Rect& area,
-                      const ColourTransformer& transformer) {
+                      const std::function<void(uint32_t*, int)>& kernel) {
   SDL_Surface* surface = our_surface->rawSurface();
-  SDL_Color colour;
-  Uint32 col = 0;
-
-  // determine position
-  char* p_position = (char*)surface->pixels;
-
-  // offset by y
-  p_position += (surface->pitch * area.y());
+  Rect clipped = area.Intersection(our_surface->GetRect());
+  SDL_PixelFormat* format = surface->format;
 
   SDL_LockSurface(surface);
   {
-    for (int y = 0; y < area.height(); ++y) {
-      // advance forward x
-      p_position += (surface->format->BytesPerPixel * area.x());
-
-      for (int x = 0; x < area.width(); ++x) {
-        // copy pixel data
-        memcpy(&col, p_position, surface->format->BytesPerPixel);
-
-        // Before someone tries to simplify the following four lines,
-        // remember that sizeof(int) != sizeof(Uint8).
-        Uint8 alpha;
-        SDL_GetRGBA(
-            col, surface->format, &colour.r, &colour.g, &colour.b, &alpha);
-        SDL_Color out = transformer(colour);
-        Uint32 out_colour =
-            SDL_MapRGBA(surface->format, out.r, out.g, out.b, alpha);
-
-        memcpy(p_position, &out_colour, surface->format->BytesPerPixel);
-
-        p_position += surface->format->BytesPerPixel;
+    if (format->BytesPerPixel == 4 && format->Rmask == DefaultRmask &&
+        format->Gmask == DefaultGmask && format->Bmask == DefaultBmask) {
+      // Our own pixel format, which the kernels work on in place a row at a
+      // time.
+      for (int y = clipped.y(); y < clipped.y2(); ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(
+            static_cast<char*>(surface->pixels) + surface->pitch * y);
+        kernel(row + clipped.x(), clipped.width());
+      }
+    } else {
+      // Anything else goes through SDL a pixel at a time.
+      for (int y = clipped.y(); y < clipped.y2(); ++y) {
+        char* p_position = static_cast<char*>(surface->pixels) +
+                           surface->pitch * y +
+                           format->BytesPerPixel * clipped.x();
+        for (int x = 0; x < clipped.width(); ++x) {
+          Uint32 col = 0;
+          memcpy(&col, p_position, format->BytesPerPixel);
+
+          Uint8 r, g, b, a;
+          SDL_GetRGBA(col, format, &r, &g, &b, &a);
+          uint32_t pixel = (uint32_t(a) << 24) | (uint32_t(r) << 16) |
+                           (uint32_t(g) << 8) | uint32_t(b);
+          kernel(&pixel, 1);
+          Uint32 out_colour = SDL_MapRGBA(format,
+                                          (pixel >> 16) & 0xff,
+                                          (pixel >> 8) & 0xff,
+                                          pixel & 0xff,
+                                          a);
+
+          memcpy(p_position, &out_colour, format->BytesPerPixel);
+          p_position += format->BytesPerPixel;
+        }
       }
-
-      // advance forward image_width - area.width() - x
-      int advance = surface->w - area.x() - area.width();
-      p_position += (surface->format->BytesPerPixel * advance);
     }
   }
   SDL_UnlockSurface(surface);
 
   // If we are the main screen, then we want to update the screen
-  our_surface->markWrittenTo(our_surface->GetRect());
+  our_surface->markWrittenTo(area);
 }
 
 }  // namespace
 
 // -----------------------------------------------------------------------
 
-// Note to self: These describe the byte order IN THE RAW G00 DATA!
-// These should NOT be switched to native byte order.
-#define DefaultRmask 0xff0000
-#define DefaultGmask 0xff00
-#define DefaultBmask 0xff
-#define DefaultAmask 0xff000000
-#define DefaultBpp 32
-
 SDL_Surface* buildNewSurface(const Size& size) {
   // Create an empty surface
   SDL_Surface* tmp = SDL_CreateRGBSurface(SDL_SWSURFACE | SDL_SRCALPHA,
@@ -205,7 +144,8 @@ SDLSurface::TextureRecord::TextureRecord(SDL_Surface* surface,
                                          int h,
                                          unsigned int bytes_per_pixel,
                                          int byte_order,
-                                         int byte_type)
+                                         int byte_type,
+                                         std::shared_ptr<AtlasRegion> region)
     : texture(new Texture(surface,
                           x,
                           y,
@@ -213,7 +153,8 @@ SDLSurface::TextureRecord::TextureRecord(SDL_Surface* surface,
                           h,
                           bytes_per_pixel,
                           byte_order,
-                          byte_type)),
+                          byte_type,
+                          region)),
       x_(x),
       y_(y),
       w_(w),
@@ -226,30 +167,21 @@ SDLSurface::TextureRecord::TextureRecord(SDL_Surface* surface,
 
 void SDLSurface::TextureRecord::reupload(SDL_Surface* surface,
                                          const Rect& dirty) {
-  if (texture) {
-    Rect i = Rect::REC(x_, y_, w_, h_).Intersection(dirty);
-    if (!i.is_empty()) {
-      texture->reupload(surface,
-                        i.x() - x_,
-                        i.y() - y_,
-                        i.x(),
-                        i.y(),
-                        i.width(),
-                        i.height(),
-                        bytes_per_pixel_,
-                        byte_order_,
-                        byte_type_);
-    }
-  } else {
-    texture.reset(new Texture(
-        surface, x_, y_, w_, h_, bytes_per_pixel_, byte_order_, byte_type_));
+  Rect i = Rect::REC(x_, y_, w_, h_).Intersection(dirty);
+  if (!i.is_empty()) {
+    texture->reupload(surface,
+                      i.x() - x_,
+                      i.y() - y_,
+                      i.x(),
+                      i.y(),
+                      i.width(),
+                      i.height(),
+                      bytes_per_pixel_,
+                      byte_order_,
+                      byte_type_);
   }
 }
 
-// -----------------------------------------------------------------------
-
-void SDLSurface::TextureRecord::forceUnload() { texture.reset(); }
-
 // -----------------------------------------------------------------------
 // SDLSurface
 // -----------------------------------------------------------------------
@@ -346,6 +278,19 @@ Size SDLSurface::GetSize() const {
 
 // -----------------------------------------------------------------------
 
+size_t SDLSurface::GetMemoryUsage() const {
+  size_t bytes = 0;
+  if (surface_)
+    bytes += size_t(surface_->pitch) * surface_->h;
+  for (const TextureRecord& record : textures_) {
+    if (record.texture)
+      bytes += record.texture->memory_usage();
+  }
+  return bytes;
+}
+
+// -----------------------------------------------------------------------
+
 void SDLSurface::Dump() {
   static int count = 0;
   std::ostringstream ss;
@@ -534,6 +479,15 @@ void SDLSurface::uploadTextureIfNeeded() const {
       x_pieces = segmentPicture(surface_->w);
       y_pieces = segmentPicture(surface_->h);
 
+      // Small images that fit in one texture share a page of the atlas
+      // instead, so that drawing lots of them doesn't rebind textures.
+      std::shared_ptr<AtlasRegion> region;
+      if (x_pieces.size() == 1 && y_pieces.size() == 1 && !is_dc0_ &&
+          graphics_system_ && graphics_system_->texture_atlas()) {
+        region = graphics_system_->texture_atlas()->Allocate(
+            GetSize(), bytes_per_pixel, byte_order, byte_type);
+      }
+
       int x_offset = 0;
       for (std::vector<int>::const_iterator it = x_pieces.begin();
            it != x_pieces.end();
@@ -549,7 +503,8 @@ void SDLSurface::uploadTextureIfNeeded() const {
                                  *jt,
                                  bytes_per_pixel,
                                  byte_order,
-                                 byte_type);
+                                 byte_type,
+                                 region);
 
           y_offset += *jt;
         }
@@ -613,21 +568,25 @@ void SDLSurface::RenderToScreen(const Rect& src,
 
 // -----------------------------------------------------------------------
 
-void SDLSurface::RenderToScreenAsObject(const GraphicsObject& rp,
-                                        const Rect& src,
-                                        const Rect& dst,
-                                        int alpha) const {
+void SDLSurface::RenderToScreenAsObject(const DrawRecord& record) const {
   uploadTextureIfNeeded();
 
   for (std::vector<TextureRecord>::iterator it = textures_.begin();
        it != textures_.end();
        ++it) {
-    it->texture->RenderToScreenAsObject(rp, *this, src, dst, alpha);
+    it->texture->RenderToScreenAsObject(record);
   }
 }
 
 // -----------------------------------------------------------------------
 
+Texture* SDLSurface::GetBatchTexture() const {
+  uploadTextureIfNeeded();
+  return textures_.size() == 1 ? textures_.front().texture.get() : NULL;
+}
+
+// -----------------------------------------------------------------------
+
 void SDLSurface::Fill(const RGBAColour& colour) {
   // Fill the entire surface with the incoming colour
   Uint32 sdl_colour = MapRGBA(surface_->format, colour);
@@ -658,29 +617,30 @@ void SDLSurface::Fill(const RGBAColour& colour, const Rect& area) {
 // -----------------------------------------------------------------------
 
 void SDLSurface::Invert(const Rect& rect) {
-  InvertColourTransformer inverter;
-  TransformSurface(this, rect, inverter);
+  TransformSurface(this, rect, &InvertPixels);
 }
 
 // -----------------------------------------------------------------------
 
 void SDLSurface::Mono(const Rect& rect) {
-  MonoColourTransformer mono;
-  TransformSurface(this, rect, mono);
+  TransformSurface(this, rect, &MonoPixels);
 }
 
 // -----------------------------------------------------------------------
 
 void SDLSurface::ToneCurve(const ToneCurveRGBMap effect, const Rect& area) {
-  ToneCurveColourTransformer tc(effect);
-  TransformSurface(this, area, tc);
+  TransformSurface(this, area, [&](uint32_t* pixels, int count) {
+    ToneCurvePixels(pixels, count, effect);
+  });
 }
 
 // -----------------------------------------------------------------------
 
 void SDLSurface::ApplyColour(const RGBColour& colour, const Rect& area) {
-  ApplyColourTransformer apply(colour);
-  TransformSurface(this, area, apply);
+  ToneCurveRGBMap map = BuildApplyColourMap(colour);
+  TransformSurface(this, area, [&](uint32_t* pixels, int count) {
+    ToneCurvePixels(pixels, count, map);
+  });
 }
 
 // -----------------------------------------------------------------------
@@ -815,10 +775,12 @@ std::shared_ptr<Surface> SDLSurface::ClipAsColorMask(const Rect& clip_rect,
 // -----------------------------------------------------------------------
 
 void SDLSurface::markWrittenTo(const Rect& written_rect) {
-  // If we are marked as dc0, alert the SDLGraphicsSystem.
+  // If we are marked as dc0, alert the SDLGraphicsSystem. DC0 is drawn to
+  // the screen one to one, so only what we wrote needs redrawing.
   if (is_dc0_ && graphics_system_) {
-    graphics_system_->MarkScreenAsDirty(GUT_DRAW_DC0);
+    graphics_system_->MarkScreenAreaAsDirty(GUT_DRAW_DC0, written_rect);
   }
+  MarkContentChanged();
 
   // Mark that the texture needs reuploading
   dirty_rectangle_ = dirty_rectangle_.RectUnion(written_rect);
@@ -829,12 +791,9 @@ void SDLSurface::Observe(NotificationType type,
                          const NotificationSource& source,
                          const NotificationDetails& details) {
   if (surface_) {
-    // Force unloading of all OpenGL resources
-    for (std::vector<TextureRecord>::iterator it = textures_.begin();
-         it != textures_.end();
-         ++it) {
-      it->forceUnload();
-    }
+    // Force unloading of all OpenGL resources; they're rebuilt from scratch,
+    // atlas regions included, on the next upload.
+    textures_.clear();
 
     dirty_rectangle_ = GetRect();
   }
@@ -36,10 +36,12 @@
 #include "systems/base/tone_curve.h"
 
 struct SDL_Surface;
+class AtlasRegion;
 class Texture;
 class GraphicsSystem;
 class SDLGraphicsSystem;
 class GraphicsObject;
+struct DrawRecord;
 
 // Helper function. Used throughout the SDL system.
 SDL_Surface* buildNewSurface(const Size& size);
@@ -114,10 +116,12 @@ class SDLSurface : public Surface, public NotificationObserver {
                               const int opacity[4]) const override;
 
   // Used internally; not exposed to the general graphics system
-  virtual void RenderToScreenAsObject(const GraphicsObject& rp,
-                                      const Rect& src,
-                                      const Rect& dst,
-                                      int alpha) const override;
+  virtual void RenderToScreenAsObject(
+      const DrawRecord& record) const override;
+
+  // Returns our texture, uploading it if needed, when the whole image is in
+  // one so that its draws can be batched. NULL if it's split up.
+  Texture* GetBatchTexture() const;
 
   virtual int GetNumPatterns() const override;
 
@@ -127,6 +131,7 @@ class SDLSurface : public Surface, public NotificationObserver {
   // -----------------------------------------------------------------------
 
   virtual Size GetSize() const override;
+  virtual size_t GetMemoryUsage() const override;
 
   virtual void Fill(const RGBAColour& colour) override;
   virtual void Fill(const RGBAColour& colour, const Rect& area) override;
@@ -170,16 +175,13 @@ class SDLSurface : public Surface, public NotificationObserver {
                   int h,
                   unsigned int bytes_per_pixel,
                   int byte_order,
-                  int byte_type);
+                  int byte_type,
+                  std::shared_ptr<AtlasRegion> region);
 
     // Reuploads this current piece of surface from the supplied
     // surface without allocating a new texture.
     void reupload(SDL_Surface* surface, const Rect& dirty);
 
-    // Clears |texture|. Called before a switch between windowed and
-    // fullscreen mode, so that we aren't holding stale references.
-    void forceUnload();
-
     // The actual texture.
     std::shared_ptr<Texture> texture;
 
@@ -29,6 +29,7 @@
 
 #include <SDL/SDL_ttf.h>
 
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -47,8 +48,19 @@
 #include "utilities/find_font_file.h"
 #include "libreallive/gameexe.h"
 
+namespace {
+
+// Four 512x512 pages of coverage hold well over a thousand glyphs at the
+// usual font sizes, which is more than a scene's worth of text.
+const int kGlyphPageSize = 512;
+const int kMaxGlyphPages = 4;
+
+}  // namespace
+
 SDLTextSystem::SDLTextSystem(SDLSystem& system, Gameexe& gameexe)
-    : TextSystem(system, gameexe), sdl_system_(system) {
+    : TextSystem(system, gameexe),
+      glyph_cache_(Size(kGlyphPageSize, kGlyphPageSize), kMaxGlyphPages),
+      sdl_system_(system) {
   if (TTF_Init() == -1) {
     std::ostringstream oss;
     oss << "Error initializing SDL_ttf: " << TTF_GetError();
@@ -83,19 +95,9 @@ Size SDLTextSystem::RenderGlyphOnto(
     const std::shared_ptr<Surface>& destination) {
   SDLSurface* sdl_surface = static_cast<SDLSurface*>(destination.get());
 
-  std::shared_ptr<TTF_Font> font = GetFontOfSize(font_size);
-
-  if (italic) {
-    TTF_SetFontStyle(font.get(), TTF_STYLE_ITALIC);
-  }
-
-  SDL_Color sdl_colour;
-  RGBColourToSDLColor(font_colour, &sdl_colour);
-  std::shared_ptr<SDL_Surface> character(
-      TTF_RenderUTF8_Blended(font.get(), current.c_str(), sdl_colour),
-      SDL_FreeSurface);
-
-  if (character == NULL) {
+  const GlyphCache::Glyph* glyph =
+      FindOrRenderGlyph(current, font_size, italic);
+  if (glyph == NULL) {
     // Bug during Kyou's path. The string is printed "". Regression in parser?
     std::cerr << "WARNING. TTF_RenderUTF8_Blended didn't render the "
               << "character \"" << current << "\". Hopefully continuing..."
@@ -103,40 +105,24 @@ Size SDLTextSystem::RenderGlyphOnto(
     return Size(0, 0);
   }
 
-  std::shared_ptr<SDL_Surface> shadow;
-  if (shadow_colour && sdl_system_.text().font_shadow()) {
-    SDL_Color sdl_shadow_colour;
-    RGBColourToSDLColor(*shadow_colour, &sdl_shadow_colour);
-
-    shadow.reset(
-        TTF_RenderUTF8_Blended(font.get(), current.c_str(), sdl_shadow_colour),
-        SDL_FreeSurface);
-  }
-
-  if (italic) {
-    TTF_SetFontStyle(font.get(), TTF_STYLE_NORMAL);
-  }
-
   Point insertion(insertion_point_x, insertion_point_y);
 
-  if (shadow) {
-    Size offset(shadow->w, shadow->h);
-    sdl_surface->blitFROMSurface(shadow.get(),
-                                 Rect(Point(0, 0), offset),
-                                 Rect(insertion + Point(2, 2), offset),
-                                 255);
-  }
+  if (shadow_colour && sdl_system_.text().font_shadow())
+    BlendGlyph(*glyph, *shadow_colour, insertion + Point(2, 2), sdl_surface);
 
-  Size size(character->w, character->h);
-  sdl_surface->blitFROMSurface(
-      character.get(), Rect(Point(0, 0), size), Rect(insertion, size), 255);
-  return size;
+  BlendGlyph(*glyph, font_colour, insertion, sdl_surface);
+  return glyph->size;
 }
 
 int SDLTextSystem::GetCharWidth(int size, uint16_t codepoint) {
+  int advance;
+  if (glyph_cache_.FindAdvance(size, codepoint, &advance))
+    return advance;
+
   std::shared_ptr<TTF_Font> font = GetFontOfSize(size);
-  int minx, maxx, miny, maxy, advance;
+  int minx, maxx, miny, maxy;
   TTF_GlyphMetrics(font.get(), codepoint, &minx, &maxx, &miny, &maxy, &advance);
+  glyph_cache_.SetAdvance(size, codepoint, advance);
   return advance;
 }
 
@@ -176,3 +162,102 @@ std::shared_ptr<TTF_Font> SDLTextSystem::GetFontOfSize(int size) {
 bool SDLTextSystem::FontIsMonospaced() {
   return is_monospace_ ? *is_monospace_ : false;
 }
+
+const GlyphCache::Glyph* SDLTextSystem::FindOrRenderGlyph(
+    const std::string& current,
+    int font_size,
+    bool italic) {
+  const GlyphCache::Glyph* glyph =
+      glyph_cache_.Find(current, font_size, italic);
+  if (glyph)
+    return glyph;
+
+  std::shared_ptr<TTF_Font> font = GetFontOfSize(font_size);
+
+  if (italic) {
+    TTF_SetFontStyle(font.get(), TTF_STYLE_ITALIC);
+  }
+
+  // Render in white; only the alpha channel is kept, and the colour is put
+  // back on in BlendGlyph().
+  SDL_Color white;
+  RGBColourToSDLColor(RGBColour::White(), &white);
+  std::shared_ptr<SDL_Surface> character(
+      TTF_RenderUTF8_Blended(font.get(), current.c_str(), white),
+      SDL_FreeSurface);
+
+  if (italic) {
+    TTF_SetFontStyle(font.get(), TTF_STYLE_NORMAL);
+  }
+
+  if (character == NULL)
+    return NULL;
+
+  Size size(character->w, character->h);
+  std::vector<uint8_t> coverage(size.width() * size.height());
+  SDL_PixelFormat* format = character->format;
+  SDL_LockSurface(character.get());
+  {
+    for (int y = 0; y < size.height(); ++y) {
+      const char* p_position =
+          static_cast<char*>(character->pixels) + character->pitch * y;
+      for (int x = 0; x < size.width(); ++x) {
+        Uint32 pixel = 0;
+        memcpy(&pixel, p_position, format->BytesPerPixel);
+        coverage[y * size.width() + x] =
+            (pixel & format->Amask) >> format->Ashift;
+        p_position += format->BytesPerPixel;
+      }
+    }
+  }
+  SDL_UnlockSurface(character.get());
+
+  return glyph_cache_.Insert(
+      current, font_size, italic, size, coverage.data(), size.width());
+}
+
+void SDLTextSystem::BlendGlyph(const GlyphCache::Glyph& glyph,
+                               const RGBColour& colour,
+                               const Point& origin,
+                               SDLSurface* surface) {
+  if (glyph.size.width() <= 0 || glyph.size.height() <= 0)
+    return;
+
+  SDL_Surface* raw = surface->rawSurface();
+  SDL_PixelFormat* format = raw->format;
+  Rect dst(origin, glyph.size);
+
+  if (format->BytesPerPixel == 4 && format->Rmask == 0xff0000 &&
+      format->Gmask == 0xff00 && format->Bmask == 0xff &&
+      format->Amask == 0xff000000) {
+    SDL_LockSurface(raw);
+    GlyphCache::Blend(glyph,
+                      colour,
+                      origin,
+                      static_cast<uint32_t*>(raw->pixels),
+                      raw->pitch,
+                      Size(raw->w, raw->h));
+    SDL_UnlockSurface(raw);
+    surface->markWrittenTo(dst);
+  } else {
+    // Some other pixel format. Colour the glyph into a surface of its own
+    // and let pygame blend that, like we used to with SDL_ttf's output.
+    int width = glyph.size.width();
+    std::vector<uint32_t> pixels(width * glyph.size.height(), 0);
+    GlyphCache::Blend(
+        glyph, colour, Point(0, 0), pixels.data(), width * 4, glyph.size);
+
+    SDL_Surface* coloured = SDL_CreateRGBSurfaceFrom(pixels.data(),
+                                                     width,
+                                                     glyph.size.height(),
+                                                     32,
+                                                     width * 4,
+                                                     0xff0000,
+                                                     0xff00,
+                                                     0xff,
+                                                     0xff000000);
+    surface->blitFROMSurface(
+        coloured, Rect(Point(0, 0), glyph.size), dst, 255);
+    SDL_FreeSurface(coloured);
+  }
+}
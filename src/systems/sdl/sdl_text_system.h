@@ -33,10 +33,12 @@
 #include <map>
 #include <string>
 
+#include "systems/base/glyph_cache.h"
 #include "systems/base/text_system.h"
 
 class Point;
 class RLMachine;
+class SDLSurface;
 class SDLSystem;
 class SDLTextWindow;
 class TextWindow;
@@ -63,10 +65,26 @@ class SDLTextSystem : public TextSystem {
   std::shared_ptr<TTF_Font> GetFontOfSize(int size);
 
  private:
+  // Returns the cached coverage mask for |current|, rendering it with SDL_ttf
+  // first if this is the first time it's been drawn. Returns NULL if SDL_ttf
+  // can't render it.
+  const GlyphCache::Glyph* FindOrRenderGlyph(const std::string& current,
+                                             int font_size,
+                                             bool italic);
+
+  // Blends |glyph| in |colour| onto |surface| at |origin|.
+  void BlendGlyph(const GlyphCache::Glyph& glyph,
+                  const RGBColour& colour,
+                  const Point& origin,
+                  SDLSurface* surface);
+
   // Font storage.
   typedef std::map<int, std::shared_ptr<TTF_Font>> FontSizeMap;
   FontSizeMap map_;
 
+  // Every glyph drawn so far, shared by RenderGlyphOnto() and GetCharWidth().
+  GlyphCache glyph_cache_;
+
   SDLSystem& sdl_system_;
 
   std::unique_ptr<bool> is_monospace_;
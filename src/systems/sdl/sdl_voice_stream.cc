@@ -0,0 +1,126 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/sdl/sdl_voice_stream.h"
+
+#include <SDL/SDL_mixer.h>
+
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "systems/base/voice_archive.h"
+#include "systems/sdl/sdl_audio_locker.h"
+#include "xclannad/wavfile.h"
+
+namespace {
+
+// Zeroes that are looped on the voice channel for MixVoice() to write over.
+Uint8 s_silence[4096];
+
+Mix_Chunk* SilentChunk() {
+  static Mix_Chunk* chunk = Mix_QuickLoad_RAW(s_silence, sizeof(s_silence));
+  return chunk;
+}
+
+// Adapts a VoiceStream to xclannad's reader interface so that
+// WAVFILE::MakeConverter() can resample it to the mixer's format.
+struct VoiceStreamFILE : WAVFILE {
+  explicit VoiceStreamFILE(std::unique_ptr<VoiceStream> stream)
+      : stream(std::move(stream)) {
+    wavinfo.SamplingRate = this->stream->rate();
+    wavinfo.Channels = this->stream->channels();
+    wavinfo.DataBits = 16;
+  }
+
+  int Read(char* buf, int blksize, int blklen) {
+    int read = stream->Read(buf, blksize * blklen);
+    return read ? read / blksize : -1;
+  }
+
+  // Voices are never looped.
+  void Seek(int count) {}
+
+  std::unique_ptr<VoiceStream> stream;
+};
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// SDLVoiceStream
+// -----------------------------------------------------------------------
+
+// static
+void SDLVoiceStream::PlayOn(int channel, std::unique_ptr<VoiceStream> stream) {
+  Mix_HaltChannel(channel);
+
+  SDLVoiceStream* voice = new SDLVoiceStream(std::move(stream));
+  SDLAudioLocker locker;
+  if (!Mix_RegisterEffect(channel, &MixVoice, &VoiceDone, voice)) {
+    delete voice;
+    return;
+  }
+
+  if (Mix_PlayChannel(channel, SilentChunk(), -1) == -1) {
+    // Unregistering calls VoiceDone(), which deletes |voice|.
+    Mix_UnregisterEffect(channel, &MixVoice);
+  }
+}
+
+SDLVoiceStream::SDLVoiceStream(std::unique_ptr<VoiceStream> stream)
+    : file_(WAVFILE::MakeConverter(new VoiceStreamFILE(std::move(stream)))),
+      finished_(false) {}
+
+SDLVoiceStream::~SDLVoiceStream() {}
+
+// static
+void SDLVoiceStream::MixVoice(int channel, void* stream, int len, void* udata) {
+  // Inside an SDL_LockAudio() section set up by SDL_Mixer! Don't lock here!
+  SDLVoiceStream* voice = static_cast<SDLVoiceStream*>(udata);
+  Uint8* out = static_cast<Uint8*>(stream);
+
+  int count = 0;
+  if (!voice->finished_) {
+    count = voice->file_->Read(reinterpret_cast<char*>(out), 4, len / 4);
+    if (count < 0)
+      count = 0;
+  }
+
+  if (count != len / 4) {
+    memset(out + count * 4, 0, len - count * 4);
+    if (!voice->finished_) {
+      voice->finished_ = true;
+      Mix_ExpireChannel(channel, 1);
+    }
+  }
+}
+
+// static
+void SDLVoiceStream::VoiceDone(int channel, void* udata) {
+  delete static_cast<SDLVoiceStream*>(udata);
+}
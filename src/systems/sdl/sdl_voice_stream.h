@@ -0,0 +1,67 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SDL_SDL_VOICE_STREAM_H_
+#define SRC_SYSTEMS_SDL_SDL_VOICE_STREAM_H_
+
+#include <memory>
+
+class VoiceStream;
+struct WAVFILE;
+
+// Plays a VoiceStream on a mixer channel, decoding it as the mixer asks for
+// more audio instead of all at once up front.
+//
+// Mix_HookMusic() is already taken by SDLMusic, so this plays a looping chunk
+// of silence on the channel and fills each buffer from the stream in a
+// channel effect. The channel is expired once the stream runs dry, so
+// Mix_Playing() and the channel volume behave as they do for chunks. An
+// SDLVoiceStream owns itself; it is deleted when the channel stops.
+class SDLVoiceStream {
+ public:
+  // Halts |channel| and starts playing |stream| on it.
+  static void PlayOn(int channel, std::unique_ptr<VoiceStream> stream);
+
+ private:
+  explicit SDLVoiceStream(std::unique_ptr<VoiceStream> stream);
+  ~SDLVoiceStream();
+
+  // Channel effect that replaces the silence in |stream| with voice data.
+  static void MixVoice(int channel, void* stream, int len, void* udata);
+
+  // Called by SDL_mixer when the channel is halted or expires.
+  static void VoiceDone(int channel, void* udata);
+
+  // |stream_| resampled to the mixer's format. (See xclannad's wavfile.h.)
+  std::unique_ptr<WAVFILE> file_;
+
+  // Set once |file_| has been exhausted.
+  bool finished_;
+};
+
+#endif  // SRC_SYSTEMS_SDL_SDL_VOICE_STREAM_H_
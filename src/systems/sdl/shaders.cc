@@ -30,6 +30,7 @@
 #include <iostream>
 #endif
 
+#include "systems/base/draw_list.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/system_error.h"
 #include "systems/sdl/sdl_utils.h"
@@ -194,24 +195,39 @@ GLint Shaders::GetObjectUniformImage() {
 }
 
 void Shaders::loadObjectUniformFromGraphicsObject(const GraphicsObject& go) {
-  RGBAColour colour = go.colour();
+  loadObjectUniforms(
+      go.colour(), go.tint(), go.light(), go.mono(), go.invert());
+}
+
+void Shaders::loadObjectUniformFromDrawRecord(const DrawRecord& record) {
+  loadObjectUniforms(record.colour,
+                     record.tint,
+                     record.light,
+                     record.mono,
+                     record.invert);
+}
+
+void Shaders::loadObjectUniforms(const RGBAColour& colour,
+                                 const RGBColour& tint,
+                                 int light,
+                                 int mono,
+                                 int invert) {
   glUniform4fARB(Shaders::GetObjectUniformColour(),
                  colour.r_float(),
                  colour.g_float(),
                  colour.b_float(),
                  colour.a_float());
 
-  RGBColour tint = go.tint();
   glUniform3fARB(Shaders::GetObjectUniformTint(),
                  tint.r_float(),
                  tint.g_float(),
                  tint.b_float());
 
-  glUniform1fARB(Shaders::GetObjectUniformLight(), go.light() / 255.0f);
+  glUniform1fARB(Shaders::GetObjectUniformLight(), light / 255.0f);
 
-  glUniform1fARB(Shaders::GetObjectUniformMono(), go.mono() / 255.0f);
+  glUniform1fARB(Shaders::GetObjectUniformMono(), mono / 255.0f);
 
-  glUniform1fARB(Shaders::GetObjectUniformInvert(), go.invert() / 255.0f);
+  glUniform1fARB(Shaders::GetObjectUniformInvert(), invert / 255.0f);
 }
 
 GLint Shaders::GetObjectUniformColour() {
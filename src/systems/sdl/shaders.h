@@ -30,6 +30,9 @@
 #include <SDL/SDL_opengl.h>
 
 class GraphicsObject;
+class RGBAColour;
+class RGBColour;
+struct DrawRecord;
 
 // Static state about shaders. We just leak them.
 class Shaders {
@@ -54,6 +57,7 @@ class Shaders {
   // Set the colour/tint/light/mono/invert properties from |go|. (Individual
   // setters also exposed.)
   static void loadObjectUniformFromGraphicsObject(const GraphicsObject& go);
+  static void loadObjectUniformFromDrawRecord(const DrawRecord& record);
   static GLint GetObjectUniformColour();
   static GLint GetObjectUniformTint();
   static GLint GetObjectUniformLight();
@@ -65,6 +69,12 @@ class Shaders {
   // object.
   static void buildShader(const char* shader, GLuint* program_object);
 
+  static void loadObjectUniforms(const RGBAColour& colour,
+                                 const RGBColour& tint,
+                                 int light,
+                                 int mono,
+                                 int invert);
+
   static GLuint color_mask_program_object_id_;
   static GLuint color_mask_shader_object_id_;
   static GLint color_mask_current_values_;
@@ -41,6 +41,7 @@
 
 #include "pygame/alphablit.h"
 #include "systems/base/colour.h"
+#include "systems/base/draw_list.h"
 #include "systems/base/graphics_object.h"
 #include "systems/base/graphics_object_data.h"
 #include "systems/base/system_error.h"
@@ -49,6 +50,7 @@
 #include "systems/sdl/sdl_utils.h"
 #include "systems/sdl/shaders.h"
 #include "systems/sdl/texture.h"
+#include "systems/sdl/texture_atlas.h"
 
 unsigned int Texture::s_screen_width = 0;
 unsigned int Texture::s_screen_height = 0;
@@ -56,6 +58,11 @@ unsigned int Texture::s_screen_height = 0;
 unsigned int Texture::s_upload_buffer_size = 0;
 std::unique_ptr<char[]> Texture::s_upload_buffer;
 
+GLuint Texture::s_bound_texture = 0;
+
+int Texture::s_draw_calls = 0;
+int Texture::s_texture_binds = 0;
+
 // -----------------------------------------------------------------------
 
 void Texture::SetScreenSize(const Size& s) {
@@ -65,6 +72,21 @@ void Texture::SetScreenSize(const Size& s) {
 
 int Texture::ScreenHeight() { return s_screen_height; }
 
+void Texture::BindTexture(GLuint texture_id) {
+  if (texture_id != s_bound_texture) {
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    s_bound_texture = texture_id;
+    ++s_texture_binds;
+  }
+}
+
+void Texture::ForgetBoundTexture() { s_bound_texture = 0; }
+
+void Texture::ResetCounters() {
+  s_draw_calls = 0;
+  s_texture_binds = 0;
+}
+
 // -----------------------------------------------------------------------
 // Texture
 // -----------------------------------------------------------------------
@@ -75,7 +97,8 @@ Texture::Texture(SDL_Surface* surface,
                  int h,
                  unsigned int bytes_per_pixel,
                  int byte_order,
-                 int byte_type)
+                 int byte_type,
+                 std::shared_ptr<AtlasRegion> region)
     : x_offset_(x),
       y_offset_(y),
       logical_width_(w),
@@ -84,60 +107,26 @@ Texture::Texture(SDL_Surface* surface,
       total_height_(surface->h),
       texture_width_(SafeSize(logical_width_)),
       texture_height_(SafeSize(logical_height_)),
+      atlas_x_(0),
+      atlas_y_(0),
+      region_(region),
       back_texture_id_(0),
       is_upside_down_(false) {
-  glGenTextures(1, &texture_id_);
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
-  DebugShowGLErrors();
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  if (w == total_width_ && h == total_height_) {
-    SDL_LockSurface(surface);
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 bytes_per_pixel,
-                 texture_width_,
-                 texture_height_,
-                 0,
-                 byte_order,
-                 byte_type,
-                 NULL);
-    DebugShowGLErrors();
-
-    glTexSubImage2D(GL_TEXTURE_2D,
-                    0,
-                    0,
-                    0,
-                    surface->w,
-                    surface->h,
-                    byte_order,
-                    byte_type,
-                    surface->pixels);
-    DebugShowGLErrors();
-
-    SDL_UnlockSurface(surface);
+  if (region_) {
+    // The page already exists; we only fill in our piece of it.
+    texture_id_ = region_->texture_id();
+    texture_width_ = region_->page_size().width();
+    texture_height_ = region_->page_size().height();
+    atlas_x_ = region_->rect().x();
+    atlas_y_ = region_->rect().y();
   } else {
-    // Cut out the current piece
-    char* pixel_data = uploadBuffer(surface->format->BytesPerPixel * w * h);
-    char* cur_dst_ptr = pixel_data;
-
-    SDL_LockSurface(surface);
-    {
-      char* cur_src_ptr = (char*)surface->pixels;
-      cur_src_ptr += surface->pitch * y;
-
-      int row_start = surface->format->BytesPerPixel * x;
-      int subrow_size = surface->format->BytesPerPixel * w;
-      for (int current_row = 0; current_row < h; ++current_row) {
-        memcpy(cur_dst_ptr, cur_src_ptr + row_start, subrow_size);
-        cur_dst_ptr += subrow_size;
-        cur_src_ptr += surface->pitch;
-      }
-    }
-    SDL_UnlockSurface(surface);
+    glGenTextures(1, &texture_id_);
+    BindTexture(texture_id_);
+    DebugShowGLErrors();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     glTexImage2D(GL_TEXTURE_2D,
                  0,
@@ -149,11 +138,10 @@ Texture::Texture(SDL_Surface* surface,
                  byte_type,
                  NULL);
     DebugShowGLErrors();
-
-    glTexSubImage2D(
-        GL_TEXTURE_2D, 0, 0, 0, w, h, byte_order, byte_type, pixel_data);
-    DebugShowGLErrors();
   }
+
+  reupload(
+      surface, 0, 0, x, y, w, h, bytes_per_pixel, byte_order, byte_type);
 }
 
 // -----------------------------------------------------------------------
@@ -168,10 +156,12 @@ Texture::Texture(render_to_texture, int width, int height)
       texture_width_(0),
       texture_height_(0),
       texture_id_(0),
+      atlas_x_(0),
+      atlas_y_(0),
       back_texture_id_(0),
       is_upside_down_(true) {
   glGenTextures(1, &texture_id_);
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
   DebugShowGLErrors();
   //  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   //  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_REPEAT);
@@ -201,11 +191,16 @@ Texture::Texture(render_to_texture, int width, int height)
 // -----------------------------------------------------------------------
 
 Texture::~Texture() {
-  glDeleteTextures(1, &texture_id_);
+  // Atlas pages belong to the atlas; |region_| hands our space back.
+  if (!region_)
+    glDeleteTextures(1, &texture_id_);
 
   if (back_texture_id_)
     glDeleteTextures(1, &back_texture_id_);
 
+  // A deleted id can be handed out again by glGenTextures().
+  ForgetBoundTexture();
+
   DebugShowGLErrors();
 }
 
@@ -232,15 +227,15 @@ void Texture::reupload(SDL_Surface* surface,
                        unsigned int bytes_per_pixel,
                        int byte_order,
                        int byte_type) {
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
 
   if (w == total_width_ && h == total_height_) {
     SDL_LockSurface(surface);
 
     glTexSubImage2D(GL_TEXTURE_2D,
                     0,
-                    0,
-                    0,
+                    atlas_x_,
+                    atlas_y_,
                     surface->w,
                     surface->h,
                     byte_order,
@@ -271,8 +266,8 @@ void Texture::reupload(SDL_Surface* surface,
 
     glTexSubImage2D(GL_TEXTURE_2D,
                     0,
-                    offset_x,
-                    offset_y,
+                    atlas_x_ + offset_x,
+                    atlas_y_ + offset_y,
                     w,
                     h,
                     byte_order,
@@ -312,19 +307,20 @@ void Texture::RenderToScreen(const Rect& src, const Rect& dst, int opacity) {
 
   // For the time being, we are dumb and assume that it's one texture
 
-  float thisx1 = float(x1) / texture_width_;
-  float thisy1 = float(y1) / texture_height_;
-  float thisx2 = float(x2) / texture_width_;
-  float thisy2 = float(y2) / texture_height_;
+  float thisx1 = TexCoordX(x1);
+  float thisy1 = TexCoordY(y1);
+  float thisx2 = TexCoordX(x2);
+  float thisy2 = TexCoordY(y2);
 
   if (is_upside_down_) {
-    thisy1 = float(logical_height_ - y1) / texture_height_;
-    thisy2 = float(logical_height_ - y2) / texture_height_;
+    thisy1 = TexCoordY(logical_height_ - y1);
+    thisy2 = TexCoordY(logical_height_ - y2);
   }
 
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
 
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  CountDrawCall();
   glBegin(GL_QUADS);
   {
     glColor4ub(255, 255, 255, opacity);
@@ -371,14 +367,28 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
   if (!filterCoords(x1, y1, x2, y2, fdx1, fdy1, fdx2, fdy2))
     return;
 
-  float thisx1 = float(x1) / texture_width_;
-  float thisy1 = float(y1) / texture_height_;
-  float thisx2 = float(x2) / texture_width_;
-  float thisy2 = float(y2) / texture_height_;
+  float thisx1 = TexCoordX(x1);
+  float thisy1 = TexCoordY(y1);
+  float thisx2 = TexCoordX(x2);
+  float thisy2 = TexCoordY(y2);
+
+  if (is_upside_down_) {
+    thisy1 = TexCoordY(logical_height_ - y1);
+    thisy2 = TexCoordY(logical_height_ - y2);
+  }
+
+  // The back texture only holds the screen behind this image, so it's sized
+  // and addressed as if we had a texture of our own even when we're atlased.
+  int back_width = SafeSize(logical_width_);
+  int back_height = SafeSize(logical_height_);
+  float backx1 = float(x1) / back_width;
+  float backy1 = float(y1) / back_height;
+  float backx2 = float(x2) / back_width;
+  float backy2 = float(y2) / back_height;
 
   if (is_upside_down_) {
-    thisy1 = float(logical_height_ - y1) / texture_height_;
-    thisy2 = float(logical_height_ - y2) / texture_height_;
+    backy1 = float(logical_height_ - y1) / back_height;
+    backy2 = float(logical_height_ - y2) / back_height;
   }
 
   // If we haven't already, allocate video memory for the back
@@ -388,7 +398,7 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
   // text box? Does it matter?
   if (back_texture_id_ == 0) {
     glGenTextures(1, &back_texture_id_);
-    glBindTexture(GL_TEXTURE_2D, back_texture_id_);
+    BindTexture(back_texture_id_);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
@@ -396,8 +406,8 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
     glTexImage2D(GL_TEXTURE_2D,
                  0,
                  GL_RGBA,
-                 texture_width_,
-                 texture_height_,
+                 back_width,
+                 back_height,
                  0,
                  GL_RGB,
                  GL_UNSIGNED_BYTE,
@@ -407,11 +417,11 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
 
   // Copy the current value of the region where we're going to render
   // to a texture for input to the shader
-  glBindTexture(GL_TEXTURE_2D, back_texture_id_);
+  BindTexture(back_texture_id_);
   int ystart = int(s_screen_height - fdy1 - (fdy2 - fdy1));
   int idx1 = int(fdx1);
   glCopyTexSubImage2D(
-      GL_TEXTURE_2D, 0, 0, 0, idx1, ystart, texture_width_, texture_height_);
+      GL_TEXTURE_2D, 0, 0, 0, idx1, ystart, back_width, back_height);
   DebugShowGLErrors();
 
   glUseProgramObjectARB(Shaders::getColorMaskProgram());
@@ -420,7 +430,7 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
   // texture "current_values" in the above shader program.
   glActiveTextureARB(GL_TEXTURE0_ARB);
   glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, back_texture_id_);
+  BindTexture(back_texture_id_);
   glUniform1iARB(Shaders::getColorMaskUniformCurrentValues(), 0);
 
   // Put the mask in texture slot one and set this to be the
@@ -432,19 +442,20 @@ void Texture::render_to_screen_as_colour_mask_subtractive_glsl(
 
   glDisable(GL_BLEND);
 
+  CountDrawCall();
   glBegin(GL_QUADS);
   {
     glColorRGBA(rgba);
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, thisx1, thisy2);
+    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, backx1, backy2);
     glMultiTexCoord2fARB(GL_TEXTURE1_ARB, thisx1, thisy1);
     glVertex2i(fdx1, fdy1);
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, thisx2, thisy2);
+    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, backx2, backy2);
     glMultiTexCoord2fARB(GL_TEXTURE1_ARB, thisx2, thisy1);
     glVertex2i(fdx2, fdy1);
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, thisx2, thisy1);
+    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, backx2, backy1);
     glMultiTexCoord2fARB(GL_TEXTURE1_ARB, thisx2, thisy2);
     glVertex2i(fdx2, fdy2);
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, thisx1, thisy1);
+    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, backx1, backy1);
     glMultiTexCoord2fARB(GL_TEXTURE1_ARB, thisx1, thisy2);
     glVertex2i(fdx1, fdy2);
   }
@@ -476,18 +487,18 @@ void Texture::render_to_screen_as_colour_mask_subtractive_fallback(
   if (!filterCoords(x1, y1, x2, y2, fdx1, fdy1, fdx2, fdy2))
     return;
 
-  float thisx1 = float(x1) / texture_width_;
-  float thisy1 = float(y1) / texture_height_;
-  float thisx2 = float(x2) / texture_width_;
-  float thisy2 = float(y2) / texture_height_;
+  float thisx1 = TexCoordX(x1);
+  float thisy1 = TexCoordY(y1);
+  float thisx2 = TexCoordX(x2);
+  float thisy2 = TexCoordY(y2);
 
   if (is_upside_down_) {
-    thisy1 = float(logical_height_ - y1) / texture_height_;
-    thisy2 = float(logical_height_ - y2) / texture_height_;
+    thisy1 = TexCoordY(logical_height_ - y1);
+    thisy2 = TexCoordY(logical_height_ - y2);
   }
 
   // First draw the mask
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
 
   /// SERIOUS WTF: gl_blend_func_separate causes a segmentation fault
   /// under the current i810 driver for linux.
@@ -495,6 +506,7 @@ void Texture::render_to_screen_as_colour_mask_subtractive_fallback(
   //                      GL_SRC_COLOR, GL_ONE_MINUS_SRC_ALPHA);
   glBlendFunc(GL_SRC_ALPHA_SATURATE, GL_ONE_MINUS_SRC_ALPHA);
 
+  CountDrawCall();
   glBegin(GL_QUADS);
   {
     glColorRGBA(rgba);
@@ -522,30 +534,31 @@ void Texture::render_to_screen_as_colour_mask_additive(const Rect& src,
   if (!filterCoords(x1, y1, x2, y2, fdx1, fdy1, fdx2, fdy2))
     return;
 
-  float thisx1 = float(x1) / texture_width_;
-  float thisy1 = float(y1) / texture_height_;
-  float thisx2 = float(x2) / texture_width_;
-  float thisy2 = float(y2) / texture_height_;
+  float thisx1 = TexCoordX(x1);
+  float thisy1 = TexCoordY(y1);
+  float thisx2 = TexCoordX(x2);
+  float thisy2 = TexCoordY(y2);
 
   if (is_upside_down_) {
-    thisy1 = float(logical_height_ - y1) / texture_height_;
-    thisy2 = float(logical_height_ - y2) / texture_height_;
+    thisy1 = TexCoordY(logical_height_ - y1);
+    thisy2 = TexCoordY(logical_height_ - y2);
   }
 
   // First draw the mask
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  CountDrawCall();
   glBegin(GL_QUADS);
   {
     glColorRGBA(rgba);
-    glTexCoord2i(thisx1, thisy1);
+    glTexCoord2f(thisx1, thisy1);
     glVertex2f(fdx1, fdy1);
-    glTexCoord2i(thisx2, thisy1);
+    glTexCoord2f(thisx2, thisy1);
     glVertex2f(fdx2, fdy1);
-    glTexCoord2i(thisx2, thisy2);
+    glTexCoord2f(thisx2, thisy2);
     glVertex2f(fdx2, fdy2);
-    glTexCoord2i(thisx1, thisy2);
+    glTexCoord2f(thisx1, thisy2);
     glVertex2f(fdx1, fdy2);
   }
   glEnd();
@@ -564,12 +577,12 @@ void Texture::RenderToScreen(const Rect& src,
   if (!filterCoords(x1, y1, x2, y2, fdx1, fdy1, fdx2, fdy2))
     return;
 
-  float thisx1 = float(x1) / texture_width_;
-  float thisy1 = float(y1) / texture_height_;
-  float thisx2 = float(x2) / texture_width_;
-  float thisy2 = float(y2) / texture_height_;
+  float thisx1 = TexCoordX(x1);
+  float thisy1 = TexCoordY(y1);
+  float thisx2 = TexCoordX(x2);
+  float thisy2 = TexCoordY(y2);
 
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  BindTexture(texture_id_);
 
   // Blend when we have less opacity
   if (std::find_if(opacity, opacity + 4, [](int o) { return o < 255; }) !=
@@ -577,6 +590,7 @@ void Texture::RenderToScreen(const Rect& src,
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   }
 
+  CountDrawCall();
   glBegin(GL_QUADS);
   {
     glColor4ub(255, 255, 255, opacity[0]);
@@ -598,125 +612,141 @@ void Texture::RenderToScreen(const Rect& src,
 
 // -----------------------------------------------------------------------
 
-void Texture::RenderToScreenAsObject(const GraphicsObject& go,
-                                     const SDLSurface& surface,
-                                     const Rect& srcRect,
-                                     const Rect& dstRect,
-                                     int alpha) {
-  // This all needs to be pushed up out of the rendering code and down into
-  // either GraphicsObject or the individual GraphicsObjectData subclasses.
-
-  // TODO(erg): Temporary hack while I wait to convert all of this machinery to
-  // Rects.
-  int xSrc1 = srcRect.x();
-  int ySrc1 = srcRect.y();
-  int xSrc2 = srcRect.x2();
-  int ySrc2 = srcRect.y2();
-
-  int fdx1 = dstRect.x(), fdy1 = dstRect.y(), fdx2 = dstRect.x2(),
-      fdy2 = dstRect.y2();
-  if (!filterCoords(xSrc1, ySrc1, xSrc2, ySrc2, fdx1, fdy1, fdx2, fdy2)) {
-    return;
-  }
+namespace {
 
-  // Convert the pixel coordinates into [0,1) texture coordinates
-  float thisx1 = float(xSrc1) / texture_width_;
-  float thisy1 = float(ySrc1) / texture_height_;
-  float thisx2 = float(xSrc2) / texture_width_;
-  float thisy2 = float(ySrc2) / texture_height_;
+// Whether |record| is drawn through the object shader rather than plain
+// vertex colours.
+bool UsesObjectShader(const DrawRecord& record) {
+  return record.NeedsShading() && GLEW_ARB_fragment_shader &&
+         GLEW_ARB_multitexture;
+}
 
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+}  // namespace
 
-  glPushMatrix();
-  {
-    // Translate to where the object starts.
-    glTranslatef(fdx1, fdy1, 0);
-
-    int width = fdx2 - fdx1;
-    int height = fdy2 - fdy1;
-
-    // Rotate the texture around the point (origin + position + reporigin)
-    float x_rep = (width / 2.0f) + go.rep_origin_x();
-    float y_rep = (height / 2.0f) + go.rep_origin_y();
-
-    glTranslatef(x_rep, y_rep, 0);
-    glRotatef(float(go.rotation()) / 10, 0, 0, 1);
-    glTranslatef(-x_rep, -y_rep, 0);
-
-    // RealLive has its own complex shading/tinting system which we implement
-    // in a shader if available. It's costly enough that we make sure we need
-    // to use it.
-    bool using_shader = false;
-    if ((go.light() || go.tint() != RGBColour::Black() ||
-         go.colour() != RGBAColour::Clear() || go.mono() || go.invert()) &&
-        GLEW_ARB_fragment_shader && GLEW_ARB_multitexture) {
-      // Image
-      glActiveTexture(GL_TEXTURE0_ARB);
-      glEnable(GL_TEXTURE_2D);
-      glBindTexture(GL_TEXTURE_2D, texture_id_);
-      glUseProgramObjectARB(Shaders::GetObjectProgram());
-      glUniform1iARB(Shaders::GetObjectUniformImage(), 0);
-
-      // Colour/Tint/Etc.
-      Shaders::loadObjectUniformFromGraphicsObject(go);
-
-      // Alpha.
-      glUniform1fARB(Shaders::GetObjectUniformAlpha(), alpha / 255.0f);
-
-      // Our final blending color has to be all white here.
-      using_shader = true;
-    } else {
-      // The shader takes care of the alpha for us, so we need to specify when
-      // not using it.
-      glColor4ub(255, 255, 255, alpha);
-    }
+// static
+void Texture::BeginObjectBatch(const DrawRecord& state) {
+  // RealLive has its own complex shading/tinting system which we implement
+  // in a shader if available. It's costly enough that we make sure we need
+  // to use it.
+  if (UsesObjectShader(state)) {
+    glActiveTexture(GL_TEXTURE0_ARB);
+    glEnable(GL_TEXTURE_2D);
+    glUseProgramObjectARB(Shaders::GetObjectProgram());
+    glUniform1iARB(Shaders::GetObjectUniformImage(), 0);
 
-    // Make this so that when we have composite 1, we're doing a pure
-    // additive blend, (ignoring the alpha channel?)
-    switch (go.composite_mode()) {
-      case 0:
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        break;
-      case 1:
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-        break;
-      case 2: {
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-        glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
-        break;
-      }
-      default: {
-        std::ostringstream oss;
-        oss << "Invalid composite_mode in render: " << go.composite_mode();
-        throw SystemError(oss.str());
-      }
-    }
+    // Colour/Tint/Etc.
+    Shaders::loadObjectUniformFromDrawRecord(state);
 
-    glBegin(GL_QUADS);
-    {
-      glTexCoord2f(thisx1, thisy1);
-      glVertex2i(0, 0);
-      glTexCoord2f(thisx2, thisy1);
-      glVertex2i(width, 0);
-      glTexCoord2f(thisx2, thisy2);
-      glVertex2i(width, height);
-      glTexCoord2f(thisx1, thisy2);
-      glVertex2i(0, height);
-    }
-    glEnd();
+    // Alpha.
+    glUniform1fARB(Shaders::GetObjectUniformAlpha(), state.alpha / 255.0f);
+  }
 
-    if (using_shader) {
-      glUseProgramObjectARB(0);
+  // Make this so that when we have composite 1, we're doing a pure
+  // additive blend, (ignoring the alpha channel?)
+  switch (state.composite_mode) {
+    case 0:
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+    case 1:
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+      break;
+    case 2: {
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+      glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+      break;
+    }
+    default: {
+      std::ostringstream oss;
+      oss << "Invalid composite_mode in render: " << state.composite_mode;
+      throw SystemError(oss.str());
     }
+  }
+}
 
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_ONE, GL_ZERO);
+// static
+void Texture::EndObjectBatch(const DrawRecord& state) {
+  if (UsesObjectShader(state)) {
+    glUseProgramObjectARB(0);
   }
-  glPopMatrix();
+
+  glBlendEquation(GL_FUNC_ADD);
+  glBlendFunc(GL_ONE, GL_ZERO);
 
   DebugShowGLErrors();
 }
 
+void Texture::AddObjectQuad(const DrawRecord& record) {
+  int xSrc1 = record.src.x();
+  int ySrc1 = record.src.y();
+  int xSrc2 = record.src.x2();
+  int ySrc2 = record.src.y2();
+
+  int fdx1 = record.dst.x(), fdy1 = record.dst.y(), fdx2 = record.dst.x2(),
+      fdy2 = record.dst.y2();
+  if (!filterCoords(xSrc1, ySrc1, xSrc2, ySrc2, fdx1, fdy1, fdx2, fdy2)) {
+    return;
+  }
+
+  // Convert the pixel coordinates into [0,1) texture coordinates
+  float thisx1 = TexCoordX(xSrc1);
+  float thisy1 = TexCoordY(ySrc1);
+  float thisx2 = TexCoordX(xSrc2);
+  float thisy2 = TexCoordY(ySrc2);
+
+  // The shader takes care of the alpha for us, so we need to specify when
+  // not using it.
+  if (!UsesObjectShader(record))
+    glColor4ub(255, 255, 255, record.alpha);
+
+  if (record.rotation % 3600 == 0) {
+    glTexCoord2f(thisx1, thisy1);
+    glVertex2i(fdx1, fdy1);
+    glTexCoord2f(thisx2, thisy1);
+    glVertex2i(fdx2, fdy1);
+    glTexCoord2f(thisx2, thisy2);
+    glVertex2i(fdx2, fdy2);
+    glTexCoord2f(thisx1, thisy2);
+    glVertex2i(fdx1, fdy2);
+    return;
+  }
+
+  // Rotate the corners around the point (origin + position + reporigin)
+  // here instead of through the modelview matrix, which can't change inside
+  // a batch.
+  float x_rep = fdx1 + (fdx2 - fdx1) / 2.0f + record.rep_origin.x();
+  float y_rep = fdy1 + (fdy2 - fdy1) / 2.0f + record.rep_origin.y();
+  float radians = record.rotation / 10.0f * 3.14159265f / 180.0f;
+  float cos_r = std::cos(radians);
+  float sin_r = std::sin(radians);
+  auto vertex = [&](int x, int y) {
+    float dx = x - x_rep;
+    float dy = y - y_rep;
+    glVertex2f(x_rep + dx * cos_r - dy * sin_r,
+               y_rep + dx * sin_r + dy * cos_r);
+  };
+
+  glTexCoord2f(thisx1, thisy1);
+  vertex(fdx1, fdy1);
+  glTexCoord2f(thisx2, thisy1);
+  vertex(fdx2, fdy1);
+  glTexCoord2f(thisx2, thisy2);
+  vertex(fdx2, fdy2);
+  glTexCoord2f(thisx1, thisy2);
+  vertex(fdx1, fdy2);
+}
+
+void Texture::RenderToScreenAsObject(const DrawRecord& record) {
+  BindTexture(texture_id_);
+  BeginObjectBatch(record);
+
+  CountDrawCall();
+  glBegin(GL_QUADS);
+  AddObjectQuad(record);
+  glEnd();
+
+  EndObjectBatch(record);
+}
+
 // -----------------------------------------------------------------------
 
 static float our_round(float r) {
@@ -34,6 +34,8 @@
 #include <string>
 
 struct SDL_Surface;
+class AtlasRegion;
+struct DrawRecord;
 class SDLSurface;
 class GraphicsObject;
 
@@ -50,7 +52,25 @@ class Texture {
 
   static int ScreenHeight();
 
+  // Binds |texture_id| to texture unit 0 unless it already is. Everything
+  // that binds on unit 0 should go through here so the cache stays right.
+  static void BindTexture(GLuint texture_id);
+
+  // Call after something may have bound a texture behind our back (other
+  // renderers, deleting textures, a new GL context).
+  static void ForgetBoundTexture();
+
+  // Counts one glBegin()/glEnd() pair.
+  static void CountDrawCall() { ++s_draw_calls; }
+
+  // Draws and real texture binds since the last ResetCounters().
+  static int draw_calls() { return s_draw_calls; }
+  static int texture_binds() { return s_texture_binds; }
+  static void ResetCounters();
+
  public:
+  // When |region| is set, the image is uploaded into that piece of a shared
+  // atlas page instead of a texture of its own.
   Texture(SDL_Surface* surface,
           int x,
           int y,
@@ -58,7 +78,8 @@ class Texture {
           int h,
           unsigned int bytes_per_pixel,
           int byte_order,
-          int byte_type);
+          int byte_type,
+          std::shared_ptr<AtlasRegion> region = std::shared_ptr<AtlasRegion>());
   Texture(render_to_texture, int screen_width, int screen_height);
   ~Texture();
 
@@ -80,11 +101,26 @@ class Texture {
   int height() { return logical_height_; }
   GLuint textureId() { return texture_id_; }
 
-  void RenderToScreenAsObject(const GraphicsObject& go,
-                              const SDLSurface& surface,
-                              const Rect& srcRect,
-                              const Rect& dstRect,
-                              int alpha);
+  // Bytes of texture memory this holds; the backing texture is padded to a
+  // size the card accepts. An atlased image only counts its own piece.
+  size_t memory_usage() const {
+    if (region_)
+      return size_t(logical_width_) * logical_height_ * 4;
+    return size_t(texture_width_) * texture_height_ * 4;
+  }
+
+  // Sets up blending and the object shader for drawing records that share
+  // |state|'s DrawRecord::SameState(), and puts them back afterwards. The
+  // texture must already be bound.
+  static void BeginObjectBatch(const DrawRecord& state);
+  static void EndObjectBatch(const DrawRecord& state);
+
+  // Emits our part of |record| as one quad. Only valid between glBegin() and
+  // glEnd() in a batch set up by BeginObjectBatch().
+  void AddObjectQuad(const DrawRecord& record);
+
+  // Draws our part of |record| on its own.
+  void RenderToScreenAsObject(const DrawRecord& record);
 
   void RenderToScreen(const Rect& src, const Rect& dst, int opacity);
 
@@ -103,6 +139,14 @@ class Texture {
   // large enough.
   static char* uploadBuffer(unsigned int size);
 
+  // Converts a pixel coordinate in our image to a texture coordinate.
+  float TexCoordX(int x) const {
+    return float(atlas_x_ + x) / texture_width_;
+  }
+  float TexCoordY(int y) const {
+    return float(atlas_y_ + y) / texture_height_;
+  }
+
   void render_to_screen_as_colour_mask_subtractive_glsl(const Rect& src,
                                                         const Rect& dst,
                                                         const RGBAColour& rgba);
@@ -137,6 +181,15 @@ class Texture {
 
   GLuint texture_id_;
 
+  // Where our image starts in |texture_id_|; nonzero only for atlased
+  // images, where |texture_width_| and |texture_height_| are the page's.
+  int atlas_x_;
+  int atlas_y_;
+
+  // Our piece of an atlas page, if we have one. We don't own |texture_id_|
+  // when this is set.
+  std::shared_ptr<AtlasRegion> region_;
+
   GLuint back_texture_id_;
 
   // Is this texture upside down? (Because it's a screenshot, etc.)
@@ -152,6 +205,12 @@ class Texture {
   // To prevent new-ing in a loop, save the dynamically allocated
   // buffer used to upload data into.
   static std::unique_ptr<char[]> s_upload_buffer;
+
+  // The texture last bound to unit 0 through BindTexture(), or 0 if unknown.
+  static GLuint s_bound_texture;
+
+  static int s_draw_calls;
+  static int s_texture_binds;
 };
 
 #endif  // SRC_SYSTEMS_SDL_TEXTURE_H_
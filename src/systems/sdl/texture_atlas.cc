@@ -0,0 +1,194 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "GL/glew.h"
+
+#include "systems/sdl/texture_atlas.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "systems/sdl/sdl_utils.h"
+#include "systems/sdl/texture.h"
+
+namespace {
+
+// Pages are square and a power of two, so they're safe on any card.
+const int kPageSize = 1024;
+
+// Transparent pixels between images so that linear filtering at an image's
+// edge doesn't pick up its neighbour.
+const int kPadding = 1;
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// AtlasRegion
+// -----------------------------------------------------------------------
+
+AtlasRegion::AtlasRegion(std::shared_ptr<TextureAtlas> atlas,
+                         int format,
+                         const AtlasAllocator::Allocation& allocation)
+    : atlas_(atlas), format_(format), allocation_(allocation) {}
+
+AtlasRegion::~AtlasRegion() { atlas_->Free(format_, allocation_); }
+
+GLuint AtlasRegion::texture_id() const {
+  return atlas_->formats_[format_]->pages[allocation_.page];
+}
+
+const Size& AtlasRegion::page_size() const { return atlas_->page_size_; }
+
+// -----------------------------------------------------------------------
+// TextureAtlas::Format
+// -----------------------------------------------------------------------
+
+TextureAtlas::Format::Format(unsigned int bytes_per_pixel,
+                             int byte_order,
+                             int byte_type,
+                             const Size& page_size)
+    : bytes_per_pixel(bytes_per_pixel),
+      byte_order(byte_order),
+      byte_type(byte_type),
+      allocator(page_size, kPadding) {}
+
+// -----------------------------------------------------------------------
+// TextureAtlas
+// -----------------------------------------------------------------------
+
+// static
+const int TextureAtlas::kMaxImageSize;
+
+TextureAtlas::TextureAtlas() {
+  int size = std::min(kPageSize, GetMaxTextureSize());
+  page_size_ = Size(size, size);
+}
+
+TextureAtlas::~TextureAtlas() {
+  for (std::unique_ptr<Format>& format : formats_) {
+    for (GLuint page : format->pages) {
+      if (page)
+        glDeleteTextures(1, &page);
+    }
+  }
+  Texture::ForgetBoundTexture();
+}
+
+std::shared_ptr<AtlasRegion> TextureAtlas::Allocate(
+    const Size& size,
+    unsigned int bytes_per_pixel,
+    int byte_order,
+    int byte_type) {
+  if (size.width() > kMaxImageSize || size.height() > kMaxImageSize)
+    return std::shared_ptr<AtlasRegion>();
+
+  int index = 0;
+  for (; index < static_cast<int>(formats_.size()); ++index) {
+    const Format& format = *formats_[index];
+    if (format.bytes_per_pixel == bytes_per_pixel &&
+        format.byte_order == byte_order && format.byte_type == byte_type)
+      break;
+  }
+  if (index == static_cast<int>(formats_.size())) {
+    formats_.emplace_back(
+        new Format(bytes_per_pixel, byte_order, byte_type, page_size_));
+  }
+
+  Format& format = *formats_[index];
+  AtlasAllocator::Allocation allocation;
+  if (!format.allocator.Allocate(size, &allocation))
+    return std::shared_ptr<AtlasRegion>();
+
+  if (allocation.page >= static_cast<int>(format.pages.size()))
+    format.pages.resize(allocation.page + 1, 0);
+  if (!format.pages[allocation.page])
+    ClearPage(format, allocation.page);
+
+  return std::shared_ptr<AtlasRegion>(
+      new AtlasRegion(shared_from_this(), index, allocation));
+}
+
+void TextureAtlas::Reset() {
+  for (std::unique_ptr<Format>& format : formats_)
+    std::fill(format->pages.begin(), format->pages.end(), 0);
+  Texture::ForgetBoundTexture();
+}
+
+int TextureAtlas::page_count() const {
+  int count = 0;
+  for (const std::unique_ptr<Format>& format : formats_) {
+    count += std::count_if(format->pages.begin(), format->pages.end(),
+                           [](GLuint page) { return page != 0; });
+  }
+  return count;
+}
+
+void TextureAtlas::Free(int index, const AtlasAllocator::Allocation& allocation) {
+  Format& format = *formats_[index];
+  // Clear an emptied page so that the padding around whatever is packed
+  // next is transparent again.
+  if (format.allocator.Free(allocation) && format.pages[allocation.page])
+    ClearPage(format, allocation.page);
+}
+
+void TextureAtlas::ClearPage(Format& format, int page) {
+  std::vector<char> clear(
+      page_size_.width() * page_size_.height() * format.bytes_per_pixel, 0);
+
+  GLuint& texture_id = format.pages[page];
+  if (!texture_id) {
+    glGenTextures(1, &texture_id);
+    Texture::BindTexture(texture_id);
+    DebugShowGLErrors();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 format.bytes_per_pixel,
+                 page_size_.width(),
+                 page_size_.height(),
+                 0,
+                 format.byte_order,
+                 format.byte_type,
+                 clear.data());
+  } else {
+    Texture::BindTexture(texture_id);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    0,
+                    0,
+                    page_size_.width(),
+                    page_size_.height(),
+                    format.byte_order,
+                    format.byte_type,
+                    clear.data());
+  }
+  DebugShowGLErrors();
+}
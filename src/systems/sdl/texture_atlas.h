@@ -0,0 +1,126 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SDL_TEXTURE_ATLAS_H_
+#define SRC_SYSTEMS_SDL_TEXTURE_ATLAS_H_
+
+#include <SDL/SDL_opengl.h>
+
+#include <memory>
+#include <vector>
+
+#include "systems/base/atlas_allocator.h"
+#include "systems/base/rect.h"
+
+class TextureAtlas;
+
+// The piece of an atlas page that one Texture draws from. Gives its space
+// back when destroyed.
+class AtlasRegion {
+ public:
+  ~AtlasRegion();
+
+  // The page's texture.
+  GLuint texture_id() const;
+
+  // Where the image is on the page.
+  const Rect& rect() const { return allocation_.rect; }
+
+  const Size& page_size() const;
+
+ private:
+  friend class TextureAtlas;
+
+  AtlasRegion(std::shared_ptr<TextureAtlas> atlas,
+              int format,
+              const AtlasAllocator::Allocation& allocation);
+
+  std::shared_ptr<TextureAtlas> atlas_;
+  int format_;
+  AtlasAllocator::Allocation allocation_;
+};
+
+// Shares a few large textures between all the small surfaces (buttons,
+// window parts, digits, cursor frames) so that drawing a screen full of them
+// doesn't rebind a texture for every quad. There's one set of pages per
+// upload format, since a texture has one format.
+//
+// Owned through a shared_ptr by SDLGraphicsSystem; regions keep it alive.
+class TextureAtlas : public std::enable_shared_from_this<TextureAtlas> {
+ public:
+  // Images wider or taller than this get textures of their own.
+  static const int kMaxImageSize = 256;
+
+  TextureAtlas();
+  ~TextureAtlas();
+
+  // Returns room for an image of |size| uploaded as |bytes_per_pixel|,
+  // |byte_order|, |byte_type|, or NULL if it's too big to share a page.
+  std::shared_ptr<AtlasRegion> Allocate(const Size& size,
+                                        unsigned int bytes_per_pixel,
+                                        int byte_order,
+                                        int byte_type);
+
+  // Forgets the page textures; called when the GL context has been recreated
+  // and they no longer exist. Pages are remade when next allocated from.
+  void Reset();
+
+  // Number of page textures in use, for debugging output.
+  int page_count() const;
+
+ private:
+  friend class AtlasRegion;
+
+  struct Format {
+    Format(unsigned int bytes_per_pixel,
+           int byte_order,
+           int byte_type,
+           const Size& page_size);
+
+    unsigned int bytes_per_pixel;
+    int byte_order;
+    int byte_type;
+    AtlasAllocator allocator;
+
+    // Texture of each of |allocator|'s pages, or 0 if it has to be created.
+    std::vector<GLuint> pages;
+  };
+
+  // Returns the space of |allocation| to |format|'s allocator, clearing the
+  // page if that emptied it.
+  void Free(int format, const AtlasAllocator::Allocation& allocation);
+
+  // Fills page |page| of |format| with transparent black, creating its texture
+  // first if needed.
+  void ClearPage(Format& format, int page);
+
+  Size page_size_;
+  std::vector<std::unique_ptr<Format>> formats_;
+};
+
+#endif  // SRC_SYSTEMS_SDL_TEXTURE_ATLAS_H_
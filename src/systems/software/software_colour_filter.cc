@@ -0,0 +1,73 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/software/software_colour_filter.h"
+
+#include <algorithm>
+
+#include "systems/base/colour.h"
+#include "systems/base/graphics_object.h"
+#include "systems/software/software_graphics_system.h"
+
+SoftwareColourFilter::SoftwareColourFilter(SoftwareGraphicsSystem* system)
+    : graphics_system_(system) {}
+
+SoftwareColourFilter::~SoftwareColourFilter() {}
+
+void SoftwareColourFilter::Fill(const GraphicsObject& go,
+                                const Rect& screen_rect,
+                                const RGBAColour& colour) {
+  PixelBuffer screen = graphics_system_->framebuffer();
+  Rect area = screen_rect.Intersection(screen.rect());
+  if (area.is_empty())
+    return;
+
+  // Copy the current value of the region where we're going to render so we
+  // can shade it on the way back.
+  back_buffer_.resize(area.width() * area.height());
+  for (int y = 0; y < area.height(); ++y) {
+    const uint32_t* row = screen.row(area.y() + y) + area.x();
+    std::transform(row,
+                   row + area.width(),
+                   back_buffer_.begin() + y * area.width(),
+                   [](uint32_t pixel) { return pixel | 0xff000000; });
+  }
+
+  RasterOp op;
+  op.src = Rect(Point(0, 0), area.size());
+  op.dst = area;
+  op.alpha = go.GetComputedAlpha();
+  op.shade = true;
+  op.colour = go.colour();
+  op.tint = go.tint();
+  op.light = go.light();
+  op.mono = go.mono();
+  op.invert = go.invert();
+  graphics_system_->DrawToScreen(
+      PixelBuffer(back_buffer_.data(), area.width(), area.height()), op);
+}
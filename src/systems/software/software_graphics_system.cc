@@ -0,0 +1,340 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/software/software_graphics_system.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libreallive/gameexe.h"
+#include "systems/base/colour.h"
+#include "systems/base/damage_region.h"
+#include "systems/base/decoded_image.h"
+#include "systems/base/renderable.h"
+#include "systems/base/system.h"
+#include "systems/software/software_colour_filter.h"
+#include "systems/software/software_surface.h"
+#include "utilities/exception.h"
+#include "utilities/graphics.h"
+
+// -----------------------------------------------------------------------
+// SoftwareGraphicsSystem
+// -----------------------------------------------------------------------
+
+SoftwareGraphicsSystem::SoftwareGraphicsSystem(System& system,
+                                               Gameexe& gameexe)
+    : GraphicsSystem(system, gameexe),
+      last_frame_valid_(false),
+      drawing_refresh_(false) {
+  haikei_.reset(new SoftwareSurface(this));
+  for (int i = 0; i < 16; ++i)
+    display_contexts_[i].reset(new SoftwareSurface(this));
+
+  SetScreenSize(GetScreenSize(gameexe));
+
+  size_t pixels = screen_size().width() * screen_size().height();
+  framebuffer_.assign(pixels, MakePixel(0, 0, 0, 255));
+  last_frame_.assign(pixels, MakePixel(0, 0, 0, 255));
+  clip_ = screen_rect();
+
+  // Now we allocate the first two display contexts with equal size to
+  // the display
+  display_contexts_[0]->Allocate(screen_size(), true);
+  display_contexts_[1]->Allocate(screen_size());
+}
+
+SoftwareGraphicsSystem::~SoftwareGraphicsSystem() {}
+
+PixelBuffer SoftwareGraphicsSystem::framebuffer() const {
+  return PixelBuffer(const_cast<uint32_t*>(framebuffer_.data()),
+                     screen_size().width(),
+                     screen_size().height());
+}
+
+void SoftwareGraphicsSystem::DrawToScreen(const PixelBuffer& image,
+                                          RasterOp op) {
+  op.dst = Rect(op.dst.origin() + origin_, op.dst.size());
+  Rasterize(image, op, framebuffer(), clip_);
+}
+
+void SoftwareGraphicsSystem::DrawColourMaskToScreen(const PixelBuffer& mask,
+                                                    const Rect& src,
+                                                    const Rect& dst,
+                                                    const RGBAColour& colour,
+                                                    int filter) {
+  RasterizeColourMask(mask,
+                      src,
+                      Rect(dst.origin() + origin_, dst.size()),
+                      colour,
+                      filter,
+                      framebuffer(),
+                      clip_);
+}
+
+void SoftwareGraphicsSystem::BeginFrame() {
+  std::fill(framebuffer_.begin(), framebuffer_.end(), MakePixel(0, 0, 0, 255));
+  clip_ = screen_rect();
+
+  // Full screen shaking moves where the origin is.
+  origin_ = GetScreenOrigin();
+}
+
+Rect SoftwareGraphicsSystem::BeginRedraw(const DamageRegion& damage) {
+  drawing_refresh_ = true;
+  redraw_area_ = screen_rect();
+
+  // BeginFrame() has cleared the screen. Unless everything changed anyway,
+  // put the last frame back and only redraw what's different. Shaking moves
+  // everything, so it always redraws.
+  if (!last_frame_valid_ || damage.is_full() || origin_ != Point(0, 0))
+    return redraw_area_;
+
+  framebuffer_ = last_frame_;
+
+  redraw_area_ = damage.GetBounds(screen_rect());
+  clip_ = redraw_area_;
+  return redraw_area_;
+}
+
+void SoftwareGraphicsSystem::EndFrame() {
+  clip_ = screen_rect();
+
+  FinalRenderers::iterator it = renderer_begin();
+  FinalRenderers::iterator end = renderer_end();
+  for (; it != end; ++it) {
+    (*it)->Render(NULL);
+  }
+
+  if (drawing_refresh_) {
+    // Outside of |redraw_area_| the frame is what we copied last time.
+    CopyScreenArea(framebuffer_, &last_frame_, redraw_area_);
+    last_frame_valid_ = true;
+  } else {
+    // Someone other than Refresh() drew this frame, so the copy no longer
+    // matches what Refresh() last drew.
+    InvalidateLastFrame();
+
+    if (screen_update_mode() == SCREENUPDATEMODE_MANUAL) {
+      last_frame_ = framebuffer_;
+      last_frame_valid_ = true;
+    }
+  }
+  drawing_refresh_ = false;
+}
+
+std::shared_ptr<Surface> SoftwareGraphicsSystem::EndFrameToSurface() {
+  // The frame is opaque, whatever alpha the images drawn onto it had.
+  std::vector<uint32_t> pixels(framebuffer_);
+  for (uint32_t& pixel : pixels)
+    pixel |= 0xff000000;
+
+  return std::shared_ptr<Surface>(
+      new SoftwareSurface(this,
+                          screen_size(),
+                          std::move(pixels),
+                          std::vector<Surface::GrpRect>()));
+}
+
+void SoftwareGraphicsSystem::ExecuteGraphicsSystem(RLMachine& machine) {
+  if (is_responsible_for_update() && screen_needs_refresh()) {
+    Refresh(NULL);
+    OnScreenRefreshed();
+  }
+
+  GraphicsSystem::ExecuteGraphicsSystem(machine);
+}
+
+void SoftwareGraphicsSystem::AllocateDC(int dc, Size size) {
+  if (dc >= 16) {
+    std::ostringstream ss;
+    ss << "Invalid DC number \"" << dc
+       << "\" in SoftwareGraphicsSystem::allocate_dc";
+    throw rlvm::Exception(ss.str());
+  }
+
+  // We can't reallocate the screen!
+  if (dc == 0)
+    throw rlvm::Exception("Attempting to reallocate DC 0!");
+
+  // DC 1 is a special case and must always be at least the size of
+  // the screen.
+  if (dc == 1) {
+    Size dc0_size = display_contexts_[0]->GetSize();
+    if (size.width() < dc0_size.width())
+      size.set_width(dc0_size.width());
+    if (size.height() < dc0_size.height())
+      size.set_height(dc0_size.height());
+  }
+
+  // Allocate a new obj.
+  display_contexts_[dc]->Allocate(size);
+}
+
+void SoftwareGraphicsSystem::SetMinimumSizeForDC(int dc, Size size) {
+  if (display_contexts_[dc] == NULL || !display_contexts_[dc]->allocated()) {
+    AllocateDC(dc, size);
+  } else {
+    Size current = display_contexts_[dc]->GetSize();
+    if (current.width() < size.width() || current.height() < size.height()) {
+      // Make a new surface of the maximum size.
+      Size maxSize = current.SizeUnion(size);
+
+      std::shared_ptr<SoftwareSurface> newdc(new SoftwareSurface(this));
+      newdc->Allocate(maxSize);
+
+      display_contexts_[dc]->BlitToSurface(
+          *newdc, display_contexts_[dc]->GetRect(),
+          display_contexts_[dc]->GetRect());
+
+      display_contexts_[dc] = newdc;
+    }
+  }
+}
+
+void SoftwareGraphicsSystem::FreeDC(int dc) {
+  if (dc == 0) {
+    throw rlvm::Exception("Attempt to deallocate DC[0]");
+  } else if (dc == 1) {
+    // DC[1] never gets freed; it only gets blanked
+    GetDC(1)->Fill(RGBAColour::Black());
+  } else {
+    display_contexts_[dc]->Deallocate();
+  }
+}
+
+std::shared_ptr<const Surface> SoftwareGraphicsSystem::LoadSurfaceFromFile(
+    const std::string& short_filename) {
+  boost::filesystem::path filename =
+      system().FindFile(short_filename, IMAGE_FILETYPES);
+  if (filename.empty()) {
+    std::ostringstream oss;
+    oss << "Could not find image file \"" << short_filename << "\".";
+    throw rlvm::Exception(oss.str());
+  }
+
+  return SurfaceFromDecodedImage(short_filename, *DecodeImageFile(filename));
+}
+
+bool SoftwareGraphicsSystem::DecodesImageFiles() const { return true; }
+
+std::shared_ptr<const Surface> SoftwareGraphicsSystem::SurfaceFromDecodedImage(
+    const std::string& short_filename,
+    const DecodedImage& image) {
+  // The decoders write native endian ARGB, which is what we draw with.
+  Size size;
+  std::vector<uint32_t> pixels;
+  if (image.pixels) {
+    size = Size(image.width, image.height);
+    pixels.resize(image.width * image.height);
+    std::memcpy(
+        pixels.data(), image.pixels.get(), pixels.size() * sizeof(uint32_t));
+    if (!image.has_alpha) {
+      for (uint32_t& pixel : pixels)
+        pixel |= 0xff000000;
+    }
+  }
+
+  std::shared_ptr<Surface> surface_to_ret(
+      new SoftwareSurface(this, size, std::move(pixels), image.regions));
+  // handle tone curve effect loading
+  if (short_filename.find("?") != short_filename.npos) {
+    std::string effect_no_str =
+        short_filename.substr(short_filename.find("?") + 1);
+    int effect_no = std::stoi(effect_no_str);
+    // the effect number is an index that goes from 10 to GetEffectCount() * 10,
+    // so keep that in mind here
+    if ((effect_no / 10) > globals().tone_curves.GetEffectCount() ||
+        effect_no < 10) {
+      std::ostringstream oss;
+      oss << "Tone curve index " << effect_no << " is invalid.";
+      throw rlvm::Exception(oss.str());
+    }
+    surface_to_ret->ToneCurve(
+        globals().tone_curves.GetEffect(effect_no / 10 - 1),
+        Rect(Point(0, 0), Size(image.width, image.height)));
+  }
+
+  return surface_to_ret;
+}
+
+std::shared_ptr<Surface> SoftwareGraphicsSystem::GetHaikei() {
+  if (!haikei_->allocated())
+    haikei_->Allocate(screen_size(), true);
+
+  return haikei_;
+}
+
+std::shared_ptr<Surface> SoftwareGraphicsSystem::GetDC(int dc) {
+  VerifySurfaceExists(dc, "SoftwareGraphicsSystem::get_dc");
+
+  // If requesting a DC that doesn't exist, allocate it first.
+  if (!display_contexts_[dc]->allocated())
+    AllocateDC(dc, display_contexts_[0]->GetSize());
+
+  return display_contexts_[dc];
+}
+
+std::shared_ptr<Surface> SoftwareGraphicsSystem::BuildSurface(
+    const Size& size) {
+  return std::shared_ptr<Surface>(new SoftwareSurface(this, size));
+}
+
+ColourFilter* SoftwareGraphicsSystem::BuildColourFiller() {
+  return new SoftwareColourFilter(this);
+}
+
+void SoftwareGraphicsSystem::CopyScreenArea(const std::vector<uint32_t>& from,
+                                            std::vector<uint32_t>* to,
+                                            const Rect& area) {
+  Rect clipped = area.Intersection(screen_rect());
+  int width = screen_size().width();
+  for (int y = clipped.y(); y < clipped.y2(); ++y) {
+    size_t offset = y * width + clipped.x();
+    std::copy(from.begin() + offset,
+              from.begin() + offset + clipped.width(),
+              to->begin() + offset);
+  }
+}
+
+void SoftwareGraphicsSystem::VerifySurfaceExists(int dc,
+                                                 const std::string& caller) {
+  if (dc >= 16) {
+    std::ostringstream ss;
+    ss << "Invalid DC number (" << dc << ") in " << caller;
+    throw rlvm::Exception(ss.str());
+  }
+
+  if (display_contexts_[dc] == NULL) {
+    std::ostringstream ss;
+    ss << "Parameter DC[" << dc << "] not allocated in " << caller;
+    throw rlvm::Exception(ss.str());
+  }
+}
@@ -0,0 +1,132 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SOFTWARE_SOFTWARE_GRAPHICS_SYSTEM_H_
+#define SRC_SYSTEMS_SOFTWARE_SOFTWARE_GRAPHICS_SYSTEM_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "systems/base/graphics_system.h"
+#include "systems/software/software_rasterizer.h"
+
+class Gameexe;
+class SoftwareSurface;
+class System;
+
+// Implements screen output without a graphics card: every frame is
+// composited into a framebuffer in main memory by the software rasterizer.
+// Useful wherever there's no OpenGL, and for checking what a frame actually
+// looks like, since RenderToSurface() returns real pixels.
+//
+// There is no window; the finished frame is available from framebuffer().
+class SoftwareGraphicsSystem : public GraphicsSystem {
+ public:
+  SoftwareGraphicsSystem(System& system, Gameexe& gameexe);
+  ~SoftwareGraphicsSystem();
+
+  // The last finished frame, screen_size() big.
+  PixelBuffer framebuffer() const;
+
+  // Draws |op| from |image| into the frame being built, moved by the shaking
+  // offset and limited to what's being redrawn.
+  void DrawToScreen(const PixelBuffer& image, RasterOp op);
+
+  // Like DrawToScreen(), for Surface::RenderToScreenAsColorMask().
+  void DrawColourMaskToScreen(const PixelBuffer& mask,
+                              const Rect& src,
+                              const Rect& dst,
+                              const RGBAColour& colour,
+                              int filter);
+
+  virtual void BeginFrame() override;
+  virtual void EndFrame() override;
+  virtual std::shared_ptr<Surface> EndFrameToSurface() override;
+
+  virtual void ExecuteGraphicsSystem(RLMachine& machine) override;
+
+  virtual void AllocateDC(int dc, Size size) override;
+  virtual void SetMinimumSizeForDC(int dc, Size size) override;
+  virtual void FreeDC(int dc) override;
+
+  virtual std::shared_ptr<const Surface> LoadSurfaceFromFile(
+      const std::string& short_filename) override;
+
+  virtual bool DecodesImageFiles() const override;
+  virtual std::shared_ptr<const Surface> SurfaceFromDecodedImage(
+      const std::string& short_filename,
+      const DecodedImage& image) override;
+
+  virtual std::shared_ptr<Surface> GetHaikei() override;
+  virtual std::shared_ptr<Surface> GetDC(int dc) override;
+  virtual std::shared_ptr<Surface> BuildSurface(const Size& size) override;
+
+  virtual ColourFilter* BuildColourFiller() override;
+
+ private:
+  // Starts from the last frame and limits drawing to what |damage| covers.
+  virtual Rect BeginRedraw(const DamageRegion& damage) override;
+
+  // Copies |area| of |from| to |to|, both screen_size() big.
+  void CopyScreenArea(const std::vector<uint32_t>& from,
+                      std::vector<uint32_t>* to,
+                      const Rect& area);
+
+  // Makes sure that a passed in dc number is valid.
+  //
+  // @exception Error Throws when dc is greater then the maximum.
+  // @exception Error Throws when dc is unallocated.
+  void VerifySurfaceExists(int dc, const std::string& caller);
+
+  std::shared_ptr<SoftwareSurface> haikei_;
+
+  // Our actual display contexts.
+  std::shared_ptr<SoftwareSurface> display_contexts_[16];
+
+  // The frame being built, which is also the last finished one between
+  // frames.
+  std::vector<uint32_t> framebuffer_;
+
+  // What Refresh() last drew, so that the next Refresh() only has to redraw
+  // what changed.
+  std::vector<uint32_t> last_frame_;
+  bool last_frame_valid_;
+
+  // Where drawing is allowed this frame, and how far the screen is shaken.
+  Rect clip_;
+  Point origin_;
+
+  // Whether the current frame is being drawn by Refresh(), and the part of
+  // the screen it redraws.
+  bool drawing_refresh_;
+  Rect redraw_area_;
+};
+
+#endif  // SRC_SYSTEMS_SOFTWARE_SOFTWARE_GRAPHICS_SYSTEM_H_
@@ -0,0 +1,523 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/software/software_rasterizer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// t / 255, rounded to nearest, for t in [0, 255 * 255]. Exact, and cheap
+// enough to do per channel.
+inline int div255(int t) { return (t + 128 + ((t + 128) >> 8)) >> 8; }
+
+inline int clampByte(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+
+inline int alphaOf(uint32_t p) { return p >> 24; }
+inline int redOf(uint32_t p) { return (p >> 16) & 0xff; }
+inline int greenOf(uint32_t p) { return (p >> 8) & 0xff; }
+inline int blueOf(uint32_t p) { return p & 0xff; }
+
+// The object shader's tinter(), in bytes: positive values lighten towards
+// white, negative ones scale towards black.
+inline int tinter(int pixel, int tint) {
+  if (tint > 0)
+    return pixel + div255(tint * (255 - pixel));
+  else if (tint < 0)
+    return div255(pixel * std::min(-tint, 255));
+  return pixel;
+}
+
+inline int mix(int from, int to, int amount) {
+  return div255(from * (255 - amount) + to * amount);
+}
+
+// Runs the object shader over |count| pixels.
+void shadeSpan(const RasterOp& op, uint32_t* row, int count) {
+  int colour_alpha = op.colour.a();
+  int mono = clampByte(op.mono);
+  int invert = clampByte(op.invert);
+  int light = std::max(-255, std::min(255, op.light));
+
+  for (int i = 0; i < count; ++i) {
+    uint32_t p = row[i];
+    int a = alphaOf(p);
+    if (a == 0)
+      continue;
+    int r = redOf(p), g = greenOf(p), b = blueOf(p);
+
+    if (colour_alpha) {
+      r = mix(r, op.colour.r(), colour_alpha);
+      g = mix(g, op.colour.g(), colour_alpha);
+      b = mix(b, op.colour.b(), colour_alpha);
+    }
+
+    if (mono) {
+      // NTSC grayscale
+      int gray = (r * 299 + g * 587 + b * 114 + 500) / 1000;
+      r = mix(r, gray, mono);
+      g = mix(g, gray, mono);
+      b = mix(b, gray, mono);
+    }
+
+    if (invert) {
+      r = mix(r, 255 - r, invert);
+      g = mix(g, 255 - g, invert);
+      b = mix(b, 255 - b, invert);
+    }
+
+    r = tinter(tinter(r, light), op.tint.r());
+    g = tinter(tinter(g, light), op.tint.g());
+    b = tinter(tinter(b, light), op.tint.b());
+
+    row[i] = MakePixel(r, g, b, a);
+  }
+}
+
+void scaleAlphaSpan(int alpha, uint32_t* row, int count) {
+  if (alpha >= 255)
+    return;
+  for (int i = 0; i < count; ++i) {
+    uint32_t p = row[i];
+    row[i] = (p & 0xffffff) | (uint32_t(div255(alphaOf(p) * alpha)) << 24);
+  }
+}
+
+// Works out which image pixel lands on each target pixel of |area|.
+class Sampler {
+ public:
+  Sampler(const PixelBuffer& image,
+          const Rect& src,
+          const Rect& dst,
+          int rotation,
+          const Point& rotation_origin,
+          const Rect& area)
+      : image_(image), src_(src), dst_(dst), area_(area), rotated_(false) {
+    if (rotation % 3600 != 0) {
+      rotated_ = true;
+      double radians = rotation / 10.0 * 3.14159265358979 / 180.0;
+      cos_ = std::cos(radians);
+      sin_ = std::sin(radians);
+      centre_x_ = dst.x() + dst.width() / 2.0 + rotation_origin.x();
+      centre_y_ = dst.y() + dst.height() / 2.0 + rotation_origin.y();
+    } else {
+      // Unturned images map whole columns at once.
+      src_x_.resize(area.width());
+      for (int i = 0; i < area.width(); ++i)
+        src_x_[i] = SourceX(area.x() + i);
+    }
+  }
+
+  // Fills |out| with the image pixels that land on row |y| of the area, and
+  // transparent black where none do.
+  void SampleRow(int y, uint32_t* out) const {
+    int count = area_.width();
+    if (!rotated_) {
+      int sy = SourceY(y);
+      if (sy < 0) {
+        std::fill(out, out + count, 0);
+        return;
+      }
+      const uint32_t* line = image_.row(sy);
+      for (int i = 0; i < count; ++i)
+        out[i] = src_x_[i] < 0 ? 0 : line[src_x_[i]];
+      return;
+    }
+
+    // Turn the centre of each target pixel back to where it came from.
+    double py = y + 0.5 - centre_y_;
+    for (int i = 0; i < count; ++i) {
+      double px = area_.x() + i + 0.5 - centre_x_;
+      double ux = cos_ * px + sin_ * py + centre_x_ - dst_.x();
+      double uy = -sin_ * px + cos_ * py + centre_y_ - dst_.y();
+      out[i] = 0;
+      if (ux < 0 || uy < 0 || ux >= dst_.width() || uy >= dst_.height())
+        continue;
+      int sx = src_.x() + static_cast<int>(ux * src_.width() / dst_.width());
+      int sy = src_.y() + static_cast<int>(uy * src_.height() / dst_.height());
+      if (sx >= 0 && sy >= 0 && sx < image_.width && sy < image_.height)
+        out[i] = image_.row(sy)[sx];
+    }
+  }
+
+  // The part of the target a turned |dst| may cover.
+  static Rect RotatedBounds(const Rect& dst,
+                            int rotation,
+                            const Point& rotation_origin) {
+    double radians = rotation / 10.0 * 3.14159265358979 / 180.0;
+    double c = std::cos(radians), s = std::sin(radians);
+    double cx = dst.x() + dst.width() / 2.0 + rotation_origin.x();
+    double cy = dst.y() + dst.height() / 2.0 + rotation_origin.y();
+    double xs[] = {double(dst.x()), double(dst.x2())};
+    double ys[] = {double(dst.y()), double(dst.y2())};
+    double x1 = 1e9, y1 = 1e9, x2 = -1e9, y2 = -1e9;
+    for (double x : xs) {
+      for (double y : ys) {
+        double rx = cx + (x - cx) * c - (y - cy) * s;
+        double ry = cy + (x - cx) * s + (y - cy) * c;
+        x1 = std::min(x1, rx);
+        x2 = std::max(x2, rx);
+        y1 = std::min(y1, ry);
+        y2 = std::max(y2, ry);
+      }
+    }
+    return Rect::GRP(static_cast<int>(std::floor(x1)),
+                     static_cast<int>(std::floor(y1)),
+                     static_cast<int>(std::ceil(x2)),
+                     static_cast<int>(std::ceil(y2)));
+  }
+
+ private:
+  // Samples the middle of each target pixel, in integers so that scaled
+  // images come out the same everywhere. -1 when off the image.
+  int SourceX(int x) const {
+    int sx = src_.x() +
+             static_cast<int>((int64_t(2 * (x - dst_.x()) + 1) * src_.width()) /
+                              (2 * int64_t(dst_.width())));
+    return sx >= 0 && sx < image_.width ? sx : -1;
+  }
+
+  int SourceY(int y) const {
+    int sy = src_.y() +
+             static_cast<int>((int64_t(2 * (y - dst_.y()) + 1) *
+                               src_.height()) /
+                              (2 * int64_t(dst_.height())));
+    return sy >= 0 && sy < image_.height ? sy : -1;
+  }
+
+  const PixelBuffer& image_;
+  Rect src_;
+  Rect dst_;
+  Rect area_;
+
+  bool rotated_;
+  std::vector<int> src_x_;
+  double cos_, sin_, centre_x_, centre_y_;
+};
+
+bool isEmpty(const Rect& rect) {
+  return rect.width() <= 0 || rect.height() <= 0;
+}
+
+// The intersection of |a| and |b|, or an empty rect when they don't share
+// a pixel.
+Rect overlap(const Rect& a, const Rect& b) {
+  Rect r = Rect::GRP(std::max(a.x(), b.x()),
+                     std::max(a.y(), b.y()),
+                     std::min(a.x2(), b.x2()),
+                     std::min(a.y2(), b.y2()));
+  return isEmpty(r) ? Rect() : r;
+}
+
+// Interpolates the corner alphas of |op| at target pixel (x, y).
+int cornerAlpha(const RasterOp& op, int x, int y) {
+  int64_t w = 2 * int64_t(op.dst.width());
+  int64_t h = 2 * int64_t(op.dst.height());
+  int64_t u = 2 * int64_t(x - op.dst.x()) + 1;
+  int64_t v = 2 * int64_t(y - op.dst.y()) + 1;
+  const int* c = op.corner_alpha;
+  int64_t top = c[0] * (w - u) + c[1] * u;
+  int64_t bottom = c[3] * (w - u) + c[2] * u;
+  int64_t total = top * (h - v) + bottom * v;
+  return static_cast<int>((total + w * h / 2) / (w * h));
+}
+
+// -----------------------------------------------------------------------
+
+void blendNormalScalar(const uint32_t* src, uint32_t* dst, int count) {
+  for (int i = 0; i < count; ++i) {
+    uint32_t s = src[i];
+    int a = alphaOf(s);
+    if (a == 0)
+      continue;
+    uint32_t d = dst[i];
+    if (a == 255) {
+      dst[i] = (s & 0xffffff) | (d & 0xff000000);
+      continue;
+    }
+    int inv = 255 - a;
+    dst[i] = (d & 0xff000000) |
+             (div255(redOf(s) * a + redOf(d) * inv) << 16) |
+             (div255(greenOf(s) * a + greenOf(d) * inv) << 8) |
+             div255(blueOf(s) * a + blueOf(d) * inv);
+  }
+}
+
+void blendAddScalar(const uint32_t* src, uint32_t* dst, int count) {
+  for (int i = 0; i < count; ++i) {
+    uint32_t s = src[i];
+    int a = alphaOf(s);
+    if (a == 0)
+      continue;
+    uint32_t d = dst[i];
+    dst[i] = (d & 0xff000000) |
+             (std::min(255, redOf(d) + div255(redOf(s) * a)) << 16) |
+             (std::min(255, greenOf(d) + div255(greenOf(s) * a)) << 8) |
+             std::min(255, blueOf(d) + div255(blueOf(s) * a));
+  }
+}
+
+void blendSubtractScalar(const uint32_t* src, uint32_t* dst, int count) {
+  for (int i = 0; i < count; ++i) {
+    uint32_t s = src[i];
+    int a = alphaOf(s);
+    if (a == 0)
+      continue;
+    uint32_t d = dst[i];
+    dst[i] = (d & 0xff000000) |
+             (std::max(0, redOf(d) - div255(redOf(s) * a)) << 16) |
+             (std::max(0, greenOf(d) - div255(greenOf(s) * a)) << 8) |
+             std::max(0, blueOf(d) - div255(blueOf(s) * a));
+  }
+}
+
+#if defined(__SSE2__)
+
+// div255() on eight 16-bit lanes.
+inline __m128i div255x8(__m128i t) {
+  __m128i rounded = _mm_add_epi16(t, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(rounded, _mm_srli_epi16(rounded, 8)), 8);
+}
+
+// Copies each pixel's alpha lane over its four lanes.
+inline __m128i broadcastAlpha(__m128i pixels16) {
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels16, 0xff), 0xff);
+}
+
+// Does four pixels at a time and leaves the rest to |scalar|. The 16-bit
+// arithmetic matches div255() exactly, so both halves agree.
+void blendNormalSSE2(const uint32_t* src, uint32_t* dst, int count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max = _mm_set1_epi16(255);
+  const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+    __m128i s_lo = _mm_unpacklo_epi8(s, zero);
+    __m128i s_hi = _mm_unpackhi_epi8(s, zero);
+    __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+    __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+    __m128i a_lo = broadcastAlpha(s_lo);
+    __m128i a_hi = broadcastAlpha(s_hi);
+
+    __m128i lo = div255x8(
+        _mm_add_epi16(_mm_mullo_epi16(s_lo, a_lo),
+                      _mm_mullo_epi16(d_lo, _mm_sub_epi16(max, a_lo))));
+    __m128i hi = div255x8(
+        _mm_add_epi16(_mm_mullo_epi16(s_hi, a_hi),
+                      _mm_mullo_epi16(d_hi, _mm_sub_epi16(max, a_hi))));
+
+    __m128i blended = _mm_packus_epi16(lo, hi);
+    blended = _mm_or_si128(_mm_andnot_si128(alpha_mask, blended),
+                           _mm_and_si128(alpha_mask, d));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blended);
+  }
+  blendNormalScalar(src + i, dst + i, count - i);
+}
+
+// The image's colour scaled by its alpha, with the alpha lanes zeroed, so
+// that it can be added to or subtracted from the target with saturation.
+inline __m128i weightedColour(__m128i s) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i s_lo = _mm_unpacklo_epi8(s, zero);
+  __m128i s_hi = _mm_unpackhi_epi8(s, zero);
+  __m128i lo = div255x8(_mm_mullo_epi16(s_lo, broadcastAlpha(s_lo)));
+  __m128i hi = div255x8(_mm_mullo_epi16(s_hi, broadcastAlpha(s_hi)));
+  return _mm_andnot_si128(_mm_set1_epi32(0xff000000),
+                          _mm_packus_epi16(lo, hi));
+}
+
+void blendAddSSE2(const uint32_t* src, uint32_t* dst, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_adds_epu8(d, weightedColour(s)));
+  }
+  blendAddScalar(src + i, dst + i, count - i);
+}
+
+void blendSubtractSSE2(const uint32_t* src, uint32_t* dst, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_subs_epu8(d, weightedColour(s)));
+  }
+  blendSubtractScalar(src + i, dst + i, count - i);
+}
+
+#endif  // defined(__SSE2__)
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// RasterOp
+// -----------------------------------------------------------------------
+
+RasterOp::RasterOp()
+    : mode(BLEND_NORMAL),
+      alpha(255),
+      use_corner_alpha(false),
+      rotation(0),
+      shade(false),
+      colour(RGBAColour::Clear()),
+      tint(RGBColour::Black()),
+      light(0),
+      mono(0),
+      invert(0) {
+  std::fill(corner_alpha, corner_alpha + 4, 255);
+}
+
+// -----------------------------------------------------------------------
+
+void Rasterize(const PixelBuffer& image,
+               const RasterOp& op,
+               const PixelBuffer& target,
+               const Rect& clip) {
+  if (isEmpty(op.src) || isEmpty(op.dst))
+    return;
+
+  bool rotated = op.rotation % 3600 != 0;
+  Rect bounds = rotated ? Sampler::RotatedBounds(
+                              op.dst, op.rotation, op.rotation_origin)
+                        : op.dst;
+  Rect area = overlap(overlap(bounds, clip), target.rect());
+  if (isEmpty(area))
+    return;
+
+  Sampler sampler(
+      image, op.src, op.dst, op.rotation, op.rotation_origin, area);
+  std::vector<uint32_t> row(area.width());
+  int count = area.width();
+  for (int y = area.y(); y < area.y2(); ++y) {
+    sampler.SampleRow(y, &row[0]);
+
+    if (op.shade)
+      shadeSpan(op, &row[0], count);
+
+    if (op.use_corner_alpha) {
+      for (int i = 0; i < count; ++i) {
+        int alpha = cornerAlpha(op, area.x() + i, y);
+        row[i] = (row[i] & 0xffffff) |
+                 (uint32_t(div255(alphaOf(row[i]) * alpha)) << 24);
+      }
+    } else {
+      scaleAlphaSpan(op.alpha, &row[0], count);
+    }
+
+    BlendSpan(op.mode, &row[0], target.row(y) + area.x(), count);
+  }
+}
+
+void RasterizeColourMask(const PixelBuffer& mask,
+                         const Rect& src,
+                         const Rect& dst,
+                         const RGBAColour& colour,
+                         int filter,
+                         const PixelBuffer& target,
+                         const Rect& clip) {
+  if (isEmpty(src) || isEmpty(dst))
+    return;
+  Rect area = overlap(overlap(dst, clip), target.rect());
+  if (isEmpty(area))
+    return;
+
+  Sampler sampler(mask, src, dst, 0, Point(), area);
+  std::vector<uint32_t> row(area.width());
+  int count = area.width();
+  for (int y = area.y(); y < area.y2(); ++y) {
+    sampler.SampleRow(y, &row[0]);
+    uint32_t* out = target.row(y) + area.x();
+
+    if (filter == 0) {
+      // Take the mask's strength off of what's there, then add that much of
+      // the colour.
+      for (int i = 0; i < count; ++i) {
+        int m = div255(alphaOf(row[i]) * colour.a());
+        if (m == 0)
+          continue;
+        uint32_t d = out[i];
+        out[i] = (d & 0xff000000) |
+                 (clampByte(redOf(d) - m + div255(colour.r() * m)) << 16) |
+                 (clampByte(greenOf(d) - m + div255(colour.g() * m)) << 8) |
+                 clampByte(blueOf(d) - m + div255(colour.b() * m));
+      }
+    } else {
+      // Masks only carry alpha, so the colour is drawn as is.
+      for (int i = 0; i < count; ++i) {
+        row[i] = MakePixel(colour.r(),
+                           colour.g(),
+                           colour.b(),
+                           div255(alphaOf(row[i]) * colour.a()));
+      }
+      BlendSpan(BLEND_NORMAL, &row[0], out, count);
+    }
+  }
+}
+
+void BlendSpan(BlendMode mode, const uint32_t* src, uint32_t* dst, int count) {
+  switch (mode) {
+    case BLEND_REPLACE:
+      std::memcpy(dst, src, count * sizeof(uint32_t));
+      break;
+#if defined(__SSE2__)
+    case BLEND_NORMAL:
+      blendNormalSSE2(src, dst, count);
+      break;
+    case BLEND_ADD:
+      blendAddSSE2(src, dst, count);
+      break;
+    case BLEND_SUBTRACT:
+      blendSubtractSSE2(src, dst, count);
+      break;
+#else
+    case BLEND_NORMAL:
+      blendNormalScalar(src, dst, count);
+      break;
+    case BLEND_ADD:
+      blendAddScalar(src, dst, count);
+      break;
+    case BLEND_SUBTRACT:
+      blendSubtractScalar(src, dst, count);
+      break;
+#endif
+  }
+}
@@ -0,0 +1,130 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SOFTWARE_SOFTWARE_RASTERIZER_H_
+#define SRC_SYSTEMS_SOFTWARE_SOFTWARE_RASTERIZER_H_
+
+#include <cstdint>
+
+#include "systems/base/colour.h"
+#include "systems/base/rect.h"
+
+// A block of 32-bit pixels with alpha in the top byte, then red, green and
+// blue; the layout DecodeImageFile() produces. Doesn't own |pixels|.
+struct PixelBuffer {
+  PixelBuffer() : pixels(NULL), width(0), height(0) {}
+  PixelBuffer(uint32_t* pixels, int width, int height)
+      : pixels(pixels), width(width), height(height) {}
+
+  uint32_t* row(int y) const { return pixels + y * width; }
+  Rect rect() const { return Rect(0, 0, Size(width, height)); }
+
+  uint32_t* pixels;
+  int width;
+  int height;
+};
+
+inline uint32_t MakePixel(int r, int g, int b, int a) {
+  return (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) |
+         uint32_t(b);
+}
+
+// How an image is combined with what's already in the target.
+enum BlendMode {
+  // Copies the image, alpha included.
+  BLEND_REPLACE,
+  // Alpha blends the image over the target.
+  BLEND_NORMAL,
+  // Adds the image, weighted by its alpha.
+  BLEND_ADD,
+  // Subtracts the image, weighted by its alpha.
+  BLEND_SUBTRACT
+};
+
+// Describes one image draw, mirroring what the OpenGL backend can do with a
+// textured quad and the object shader.
+struct RasterOp {
+  RasterOp();
+
+  // |src| in the image is stretched over |dst| in the target, nearest
+  // neighbour.
+  Rect src;
+  Rect dst;
+
+  BlendMode mode;
+
+  // Multiplied into the image's alpha.
+  int alpha;
+
+  // When set, the alpha at each corner of |dst| instead of |alpha|, in the
+  // order top left, top right, bottom right, bottom left, and blended
+  // between them.
+  bool use_corner_alpha;
+  int corner_alpha[4];
+
+  // In tenths of a degree, around the centre of |dst| plus
+  // |rotation_origin|. Parts of the target the turned image doesn't cover
+  // are left alone, so rotation needs a mode other than BLEND_REPLACE.
+  int rotation;
+  Point rotation_origin;
+
+  // Applies the object shader: |colour| is mixed in by its alpha, then mono,
+  // invert, light and tint are applied, in that order, before alpha.
+  bool shade;
+  RGBAColour colour;
+  RGBColour tint;
+  int light;
+  int mono;
+  int invert;
+};
+
+// Draws |op| from |image| into |target|, touching nothing outside |clip|.
+// |image| is only read.
+void Rasterize(const PixelBuffer& image,
+               const RasterOp& op,
+               const PixelBuffer& target,
+               const Rect& clip);
+
+// Draws |colour| through the alpha of |src| in |mask|, stretched over |dst|,
+// the way text window backgrounds are drawn. Filter 0 darkens what's under
+// the mask before adding the colour to it; any other filter alpha blends
+// the colour.
+void RasterizeColourMask(const PixelBuffer& mask,
+                         const Rect& src,
+                         const Rect& dst,
+                         const RGBAColour& colour,
+                         int filter,
+                         const PixelBuffer& target,
+                         const Rect& clip);
+
+// Combines |count| pixels of |src|, whose alpha is final, into |dst| with
+// |mode|. Every mode but BLEND_REPLACE leaves |dst|'s alpha alone. Uses SSE2
+// where available, with results identical to the plain version.
+void BlendSpan(BlendMode mode, const uint32_t* src, uint32_t* dst, int count);
+
+#endif  // SRC_SYSTEMS_SOFTWARE_SOFTWARE_RASTERIZER_H_
@@ -0,0 +1,313 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "systems/software/software_surface.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "systems/base/colour.h"
+#include "systems/base/draw_list.h"
+#include "systems/base/graphics_system.h"
+#include "systems/base/pixel_transforms.h"
+#include "systems/base/system_error.h"
+#include "systems/software/software_graphics_system.h"
+
+namespace {
+
+// The part of |area| inside |size|.
+Rect clipToSize(const Rect& area, const Size& size) {
+  return area.Intersection(Rect(Point(0, 0), size));
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// SoftwareSurface
+// -----------------------------------------------------------------------
+
+SoftwareSurface::SoftwareSurface(SoftwareGraphicsSystem* system)
+    : graphics_system_(system), is_dc0_(false) {}
+
+SoftwareSurface::SoftwareSurface(SoftwareGraphicsSystem* system,
+                                 const Size& size)
+    : graphics_system_(system), is_dc0_(false) {
+  Allocate(size);
+  BuildRegionTable(size);
+}
+
+SoftwareSurface::SoftwareSurface(SoftwareGraphicsSystem* system,
+                                 const Size& size,
+                                 std::vector<uint32_t> pixels,
+                                 const std::vector<GrpRect>& region_table)
+    : graphics_system_(system),
+      size_(size),
+      pixels_(std::move(pixels)),
+      region_table_(region_table),
+      is_dc0_(false) {
+  if (region_table_.empty())
+    BuildRegionTable(size);
+}
+
+SoftwareSurface::~SoftwareSurface() {}
+
+void SoftwareSurface::Allocate(const Size& size) {
+  size_ = size;
+  pixels_.assign(size.width() * size.height(), 0);
+  Fill(RGBAColour::Black());
+}
+
+void SoftwareSurface::Allocate(const Size& size, bool is_dc0) {
+  is_dc0_ = is_dc0;
+  Allocate(size);
+}
+
+void SoftwareSurface::Deallocate() {
+  size_ = Size();
+  std::vector<uint32_t>().swap(pixels_);
+}
+
+PixelBuffer SoftwareSurface::buffer() const {
+  // The rasterizer never writes through a buffer it only reads from.
+  return PixelBuffer(const_cast<uint32_t*>(pixels_.data()),
+                     size_.width(),
+                     size_.height());
+}
+
+uint32_t SoftwareSurface::GetPixel(const Point& pos) const {
+  return pixels_[pos.y() * size_.width() + pos.x()];
+}
+
+void SoftwareSurface::Fill(const RGBAColour& colour) {
+  Fill(colour, GetRect());
+}
+
+void SoftwareSurface::Fill(const RGBAColour& colour, const Rect& area) {
+  Rect clipped = clipToSize(area, size_);
+  uint32_t pixel = MakePixel(colour.r(), colour.g(), colour.b(), colour.a());
+  for (int y = clipped.y(); y < clipped.y2(); ++y) {
+    uint32_t* row = buffer().row(y);
+    std::fill(row + clipped.x(), row + clipped.x2(), pixel);
+  }
+
+  MarkWrittenTo(area);
+}
+
+void SoftwareSurface::ToneCurve(const ToneCurveRGBMap effect,
+                                const Rect& area) {
+  TransformPixels(area, [&](uint32_t* pixels, int count) {
+    ToneCurvePixels(pixels, count, effect);
+  });
+}
+
+void SoftwareSurface::Invert(const Rect& area) {
+  TransformPixels(area, &InvertPixels);
+}
+
+void SoftwareSurface::Mono(const Rect& area) {
+  TransformPixels(area, &MonoPixels);
+}
+
+void SoftwareSurface::ApplyColour(const RGBColour& colour, const Rect& area) {
+  ToneCurveRGBMap map = BuildApplyColourMap(colour);
+  TransformPixels(area, [&](uint32_t* pixels, int count) {
+    ToneCurvePixels(pixels, count, map);
+  });
+}
+
+Size SoftwareSurface::GetSize() const { return size_; }
+
+size_t SoftwareSurface::GetMemoryUsage() const {
+  return pixels_.size() * sizeof(uint32_t);
+}
+
+void SoftwareSurface::BlitToSurface(Surface& dest_surface,
+                                    const Rect& src,
+                                    const Rect& dst,
+                                    int alpha,
+                                    bool use_src_alpha) const {
+  SoftwareSurface& software_dest = dynamic_cast<SoftwareSurface&>(dest_surface);
+
+  RasterOp op;
+  op.src = src;
+  op.dst = dst;
+  if (use_src_alpha) {
+    op.alpha = alpha;
+  } else {
+    op.mode = BLEND_REPLACE;
+  }
+  Rasterize(buffer(), op, software_dest.buffer(), software_dest.GetRect());
+
+  software_dest.MarkWrittenTo(dst);
+}
+
+void SoftwareSurface::RenderToScreen(const Rect& src,
+                                     const Rect& dst,
+                                     int alpha) const {
+  RasterOp op;
+  op.src = src;
+  op.dst = dst;
+  op.alpha = alpha;
+  graphics_system_->DrawToScreen(buffer(), op);
+}
+
+void SoftwareSurface::RenderToScreenAsColorMask(const Rect& src,
+                                                const Rect& dst,
+                                                const RGBAColour& colour,
+                                                int filter) const {
+  graphics_system_->DrawColourMaskToScreen(buffer(), src, dst, colour, filter);
+}
+
+void SoftwareSurface::RenderToScreen(const Rect& src,
+                                     const Rect& dst,
+                                     const int opacity[4]) const {
+  RasterOp op;
+  op.src = src;
+  op.dst = dst;
+  // Blend only when we have less opacity.
+  if (std::all_of(opacity, opacity + 4, [](int o) { return o >= 255; })) {
+    op.mode = BLEND_REPLACE;
+  } else {
+    op.use_corner_alpha = true;
+    std::copy(opacity, opacity + 4, op.corner_alpha);
+  }
+  graphics_system_->DrawToScreen(buffer(), op);
+}
+
+void SoftwareSurface::RenderToScreenAsObject(const DrawRecord& record) const {
+  RasterOp op;
+  op.src = record.src;
+  op.dst = record.dst;
+  op.alpha = record.alpha;
+
+  switch (record.composite_mode) {
+    case 0:
+      op.mode = BLEND_NORMAL;
+      break;
+    case 1:
+      op.mode = BLEND_ADD;
+      break;
+    case 2:
+      op.mode = BLEND_SUBTRACT;
+      break;
+    default: {
+      std::ostringstream oss;
+      oss << "Invalid composite_mode in render: " << record.composite_mode;
+      throw SystemError(oss.str());
+    }
+  }
+
+  op.rotation = record.rotation;
+  op.rotation_origin = record.rep_origin;
+
+  if (record.NeedsShading()) {
+    op.shade = true;
+    op.colour = record.colour;
+    op.tint = record.tint;
+    op.light = record.light;
+    op.mono = record.mono;
+    op.invert = record.invert;
+  }
+
+  graphics_system_->DrawToScreen(buffer(), op);
+}
+
+int SoftwareSurface::GetNumPatterns() const { return region_table_.size(); }
+
+const Surface::GrpRect& SoftwareSurface::GetPattern(int patt_no) const {
+  if (static_cast<size_t>(patt_no) < region_table_.size())
+    return region_table_[patt_no];
+  else
+    return region_table_[0];
+}
+
+void SoftwareSurface::GetDCPixel(const Point& pos,
+                                 int& r,
+                                 int& g,
+                                 int& b) const {
+  uint32_t pixel = GetPixel(pos);
+  r = (pixel >> 16) & 0xff;
+  g = (pixel >> 8) & 0xff;
+  b = pixel & 0xff;
+}
+
+std::shared_ptr<Surface> SoftwareSurface::ClipAsColorMask(const Rect& clip_rect,
+                                                          int r,
+                                                          int g,
+                                                          int b) const {
+  // Everything but the key colour becomes opaque.
+  Rect clipped = clipToSize(clip_rect, size_);
+  std::vector<uint32_t> pixels(clip_rect.width() * clip_rect.height(), 0);
+  uint32_t key = MakePixel(r, g, b, 0);
+  for (int y = clipped.y(); y < clipped.y2(); ++y) {
+    const uint32_t* in = buffer().row(y);
+    uint32_t* out = &pixels[(y - clip_rect.y()) * clip_rect.width()];
+    for (int x = clipped.x(); x < clipped.x2(); ++x) {
+      uint32_t colour = in[x] & 0xffffff;
+      out[x - clip_rect.x()] = colour == key ? colour : colour | 0xff000000;
+    }
+  }
+
+  return std::shared_ptr<Surface>(
+      new SoftwareSurface(graphics_system_,
+                          clip_rect.size(),
+                          std::move(pixels),
+                          std::vector<GrpRect>()));
+}
+
+Surface* SoftwareSurface::Clone() const {
+  return new SoftwareSurface(graphics_system_, size_, pixels_, region_table_);
+}
+
+template <typename Kernel>
+void SoftwareSurface::TransformPixels(const Rect& area, Kernel kernel) {
+  Rect clipped = clipToSize(area, size_);
+  for (int y = clipped.y(); y < clipped.y2(); ++y)
+    kernel(buffer().row(y) + clipped.x(), clipped.width());
+
+  MarkWrittenTo(area);
+}
+
+void SoftwareSurface::MarkWrittenTo(const Rect& written_rect) {
+  // DC0 is drawn to the screen one to one, so only what we wrote needs
+  // redrawing.
+  if (is_dc0_ && graphics_system_)
+    graphics_system_->MarkScreenAreaAsDirty(GUT_DRAW_DC0, written_rect);
+
+  MarkContentChanged();
+}
+
+void SoftwareSurface::BuildRegionTable(const Size& size) {
+  GrpRect rect;
+  rect.rect = Rect(Point(0, 0), size);
+  rect.originX = 0;
+  rect.originY = 0;
+  region_table_.push_back(rect);
+}
@@ -0,0 +1,130 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_SYSTEMS_SOFTWARE_SOFTWARE_SURFACE_H_
+#define SRC_SYSTEMS_SOFTWARE_SOFTWARE_SURFACE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "systems/base/surface.h"
+#include "systems/software/software_rasterizer.h"
+
+class SoftwareGraphicsSystem;
+
+// A Surface whose pixels live in main memory and are drawn to the screen by
+// SoftwareGraphicsSystem's rasterizer instead of a graphics card.
+class SoftwareSurface : public Surface {
+ public:
+  explicit SoftwareSurface(SoftwareGraphicsSystem* system);
+
+  // Surface of |size|, filled with black.
+  SoftwareSurface(SoftwareGraphicsSystem* system, const Size& size);
+
+  // Surface that takes |pixels|, |size| wide and high, cut up as described by
+  // |region_table|.
+  SoftwareSurface(SoftwareGraphicsSystem* system,
+                  const Size& size,
+                  std::vector<uint32_t> pixels,
+                  const std::vector<GrpRect>& region_table);
+  virtual ~SoftwareSurface();
+
+  void Allocate(const Size& size);
+  void Allocate(const Size& size, bool is_dc0);
+  void Deallocate();
+
+  // Whether we have any pixels.
+  bool allocated() const { return !pixels_.empty(); }
+
+  // Our pixels, for the rasterizer.
+  PixelBuffer buffer() const;
+
+  // The pixel at |pos|, alpha included.
+  uint32_t GetPixel(const Point& pos) const;
+
+  // Overridden from Surface:
+  virtual void Fill(const RGBAColour& colour) override;
+  virtual void Fill(const RGBAColour& colour, const Rect& area) override;
+  virtual void ToneCurve(const ToneCurveRGBMap effect,
+                         const Rect& area) override;
+  virtual void Invert(const Rect& area) override;
+  virtual void Mono(const Rect& area) override;
+  virtual void ApplyColour(const RGBColour& colour, const Rect& area) override;
+  virtual Size GetSize() const override;
+  virtual size_t GetMemoryUsage() const override;
+  virtual void BlitToSurface(Surface& dest_surface,
+                             const Rect& src,
+                             const Rect& dst,
+                             int alpha = 255,
+                             bool use_src_alpha = true) const override;
+  virtual void RenderToScreen(const Rect& src,
+                              const Rect& dst,
+                              int alpha = 255) const override;
+  virtual void RenderToScreenAsColorMask(const Rect& src,
+                                         const Rect& dst,
+                                         const RGBAColour& colour,
+                                         int filter) const override;
+  virtual void RenderToScreen(const Rect& src,
+                              const Rect& dst,
+                              const int opacity[4]) const override;
+  virtual void RenderToScreenAsObject(const DrawRecord& record) const override;
+  virtual int GetNumPatterns() const override;
+  virtual const GrpRect& GetPattern(int patt_no) const override;
+  virtual void GetDCPixel(const Point& pos, int& r, int& g, int& b) const
+      override;
+  virtual std::shared_ptr<Surface> ClipAsColorMask(const Rect& clip_rect,
+                                                   int r,
+                                                   int g,
+                                                   int b) const override;
+  virtual Surface* Clone() const override;
+
+ private:
+  // Runs |kernel|, one of the pixel_transforms.h functions, over each row of
+  // |area|.
+  template <typename Kernel>
+  void TransformPixels(const Rect& area, Kernel kernel);
+
+  // Called after each change to our pixels. Tells the graphics system when
+  // we're DC0.
+  void MarkWrittenTo(const Rect& written_rect);
+
+  void BuildRegionTable(const Size& size);
+
+  SoftwareGraphicsSystem* graphics_system_;
+
+  Size size_;
+  std::vector<uint32_t> pixels_;
+
+  std::vector<GrpRect> region_table_;
+
+  // Whether this surface is DC0 and needs special treatment.
+  bool is_dc0_;
+};
+
+#endif  // SRC_SYSTEMS_SOFTWARE_SOFTWARE_SURFACE_H_
@@ -0,0 +1,77 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "utilities/thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int thread_count) : shutting_down_(false) {
+  if (thread_count <= 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 0; i < thread_count; ++i)
+    threads_.emplace_back(&ThreadPool::Run, this);
+}
+
+ThreadPool::~ThreadPool() {
+  std::deque<std::function<void()>> dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    dropped.swap(tasks_);
+  }
+  task_posted_.notify_all();
+
+  for (std::thread& thread : threads_)
+    thread.join();
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  task_posted_.notify_one();
+}
+
+void ThreadPool::Run() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_posted_.wait(lock, [&] { return shutting_down_ || !tasks_.empty(); });
+      if (shutting_down_)
+        return;
+
+      task = tasks_.front();
+      tasks_.pop_front();
+    }
+
+    task();
+  }
+}
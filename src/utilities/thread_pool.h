@@ -0,0 +1,80 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#ifndef SRC_UTILITIES_THREAD_POOL_H_
+#define SRC_UTILITIES_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of worker threads that run posted tasks in the order they were
+// posted.
+class ThreadPool {
+ public:
+  // Starts |thread_count| threads, or one per core if it's zero.
+  explicit ThreadPool(int thread_count);
+
+  // Drops the tasks that haven't started (their futures report a broken
+  // promise) and waits for the running ones to finish.
+  ~ThreadPool();
+
+  // Runs |task| on one of the threads. Exceptions it throws are passed on
+  // through the returned future.
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> Post(F task) {
+    typedef typename std::result_of<F()>::type Result;
+    std::shared_ptr<std::packaged_task<Result()>> packaged =
+        std::make_shared<std::packaged_task<Result()>>(task);
+    std::future<Result> future = packaged->get_future();
+    Enqueue([packaged]() { (*packaged)(); });
+    return future;
+  }
+
+  size_t size() const { return threads_.size(); }
+
+ private:
+  void Enqueue(std::function<void()> task);
+
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable task_posted_;
+  std::deque<std::function<void()>> tasks_;
+  bool shutting_down_;
+
+  std::vector<std::thread> threads_;
+};
+
+#endif  // SRC_UTILITIES_THREAD_POOL_H_
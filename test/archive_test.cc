@@ -0,0 +1,90 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "libreallive/archive.h"
+#include "libreallive/intmemref.h"
+#include "machine/rlmachine.h"
+#include "modules/module_jmp.h"
+#include "test_system/test_system.h"
+
+#include "test_utils.h"
+
+using libreallive::Archive;
+using libreallive::IntMemRef;
+
+// Every first access to a scenario parses it on the calling thread when
+// background parsing is off.
+TEST(ArchiveTest, CountsBlockingLoads) {
+  Archive arc(locateTestCase("Module_Sys_SEEN/SceneNum.TXT"));
+  EXPECT_EQ(0, arc.blocking_scenario_loads());
+
+  ASSERT_TRUE(arc.GetScenario(1));
+  EXPECT_EQ(1, arc.blocking_scenario_loads());
+  ASSERT_TRUE(arc.GetScenario(1));
+  EXPECT_EQ(1, arc.blocking_scenario_loads());
+  ASSERT_TRUE(arc.GetScenario(248));
+  EXPECT_EQ(2, arc.blocking_scenario_loads());
+
+  EXPECT_EQ(NULL, arc.GetScenario(2));
+  EXPECT_EQ(2, arc.blocking_scenario_loads());
+}
+
+// Scenarios handed over from the background threads behave exactly like ones
+// parsed on demand, and none of them has to be waited for once the threads
+// are done.
+TEST(ArchiveTest, BackgroundParsing) {
+  Archive arc(locateTestCase("Module_Sys_SEEN/SceneNum.TXT"));
+  arc.StartBackgroundParsing(2);
+  arc.WaitForBackgroundParsing();
+
+  for (int scenario : {1, 248, 639}) {
+    libreallive::Scenario* scene = arc.GetScenario(scenario);
+    ASSERT_TRUE(scene);
+    EXPECT_EQ(scenario, scene->scene_number());
+    EXPECT_EQ(scene, arc.GetScenario(scenario));
+  }
+  EXPECT_EQ(0, arc.blocking_scenario_loads());
+  EXPECT_EQ(NULL, arc.GetScenario(2));
+}
+
+// Runs the farcall test with its callee parsed in the background.
+TEST(ArchiveTest, FarcallIntoBackgroundParsedScenario) {
+  Archive arc(locateTestCase("Module_Jmp_SEEN/farcallTest_0.TXT"));
+  TestSystem system;
+  RLMachine rlmachine(system, arc);
+  rlmachine.AttachModule(new JmpModule);
+  arc.StartBackgroundParsing(1);
+
+  rlmachine.SetIntValue(IntMemRef('B', 0), 2);
+  rlmachine.ExecuteUntilHalted();
+
+  EXPECT_EQ(1, rlmachine.GetIntValue(IntMemRef('A', 0)));
+  EXPECT_EQ(2, rlmachine.GetIntValue(IntMemRef('A', 1)));
+  EXPECT_EQ(1, rlmachine.GetIntValue(IntMemRef('A', 2)));
+}
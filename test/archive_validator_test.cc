@@ -0,0 +1,101 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <vector>
+
+#include "libreallive/archive.h"
+#include "machine/archive_validator.h"
+#include "machine/rlmachine.h"
+#include "modules/module_jmp.h"
+#include "modules/module_str.h"
+#include "test_system/test_system.h"
+
+#include "test_utils.h"
+
+namespace {
+
+size_t CountUnimplemented(const ScenarioValidation& result) {
+  size_t count = 0;
+  for (auto const& entry : result.unimplemented)
+    count += entry.second;
+  return count;
+}
+
+}  // namespace
+
+TEST(ArchiveValidatorTest, ResolvesEveryCommand) {
+  libreallive::Archive arc(locateTestCase("Module_Jmp_SEEN/fibonacci.TXT"));
+  TestSystem system;
+  RLMachine rlmachine(system, arc);
+  rlmachine.AttachModule(new JmpModule);
+  rlmachine.AttachModule(new StrModule);
+
+  std::vector<ScenarioValidation> results = ValidateArchive(rlmachine, arc, 2);
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(1, results[0].scenario);
+  EXPECT_FALSE(results[0].parse_failed);
+  EXPECT_LT(0u, results[0].commands);
+  EXPECT_LT(results[0].commands, results[0].elements);
+  EXPECT_EQ(0u, CountUnimplemented(results[0]));
+  EXPECT_EQ(0u, results[0].bad_parameters);
+
+  std::ostringstream oss;
+  PrintArchiveValidation(oss, results);
+  EXPECT_NE(std::string::npos, oss.str().find("No undefined opcodes called!"));
+}
+
+TEST(ArchiveValidatorTest, CountsCommandsWithoutModules) {
+  libreallive::Archive arc(locateTestCase("Module_Jmp_SEEN/fibonacci.TXT"));
+  TestSystem system;
+  RLMachine rlmachine(system, arc);
+
+  std::vector<ScenarioValidation> results = ValidateArchive(rlmachine, arc, 1);
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(results[0].commands, CountUnimplemented(results[0]));
+}
+
+TEST(ArchiveValidatorTest, ThreadsAgreeWithSerialRun) {
+  libreallive::Archive arc(locateTestCase("Module_Jmp_SEEN/farcallTest_0.TXT"));
+  TestSystem system;
+  RLMachine rlmachine(system, arc);
+  rlmachine.AttachModule(new JmpModule);
+
+  std::vector<ScenarioValidation> serial = ValidateArchive(rlmachine, arc, 1);
+  std::vector<ScenarioValidation> threaded =
+      ValidateArchive(rlmachine, arc, 4);
+  ASSERT_EQ(2u, serial.size());
+  ASSERT_EQ(serial.size(), threaded.size());
+  for (size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_EQ(serial[i].scenario, threaded[i].scenario);
+    EXPECT_EQ(serial[i].elements, threaded[i].elements);
+    EXPECT_EQ(serial[i].commands, threaded[i].commands);
+    EXPECT_EQ(CountUnimplemented(serial[i]), CountUnimplemented(threaded[i]));
+  }
+}
@@ -0,0 +1,91 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "systems/base/atlas_allocator.h"
+
+TEST(AtlasAllocatorTest, PacksShelvesLeftToRight) {
+  AtlasAllocator atlas(Size(256, 256), 1);
+  AtlasAllocator::Allocation a, b, c;
+  ASSERT_TRUE(atlas.Allocate(Size(100, 20), &a));
+  ASSERT_TRUE(atlas.Allocate(Size(100, 10), &b));
+  ASSERT_TRUE(atlas.Allocate(Size(100, 10), &c));
+
+  EXPECT_EQ(Rect::REC(0, 0, 100, 20), a.rect);
+  EXPECT_EQ(Rect::REC(101, 0, 100, 10), b.rect);
+  // The first shelf is full, so the next one starts under its tallest image.
+  EXPECT_EQ(Rect::REC(0, 21, 100, 10), c.rect);
+  EXPECT_EQ(1, atlas.page_count());
+  EXPECT_EQ(3, atlas.allocations_on_page(0));
+}
+
+TEST(AtlasAllocatorTest, PrefersTheShortestShelfThatFits) {
+  AtlasAllocator atlas(Size(256, 256), 0);
+  AtlasAllocator::Allocation wide, strip, small, tall;
+  atlas.Allocate(Size(200, 64), &wide);
+  atlas.Allocate(Size(100, 16), &strip);
+  ASSERT_TRUE(atlas.Allocate(Size(40, 16), &small));
+  ASSERT_TRUE(atlas.Allocate(Size(40, 32), &tall));
+
+  EXPECT_EQ(Rect::REC(0, 64, 100, 16), strip.rect);
+  EXPECT_EQ(Rect::REC(100, 64, 40, 16), small.rect);
+  EXPECT_EQ(Rect::REC(200, 0, 40, 32), tall.rect);
+}
+
+TEST(AtlasAllocatorTest, OpensPagesAndRefusesOversizedImages) {
+  AtlasAllocator atlas(Size(64, 64), 0);
+  AtlasAllocator::Allocation allocation;
+  EXPECT_FALSE(atlas.Allocate(Size(65, 1), &allocation));
+  EXPECT_FALSE(atlas.Allocate(Size(0, 10), &allocation));
+  EXPECT_EQ(0, atlas.page_count());
+
+  std::vector<AtlasAllocator::Allocation> quarters(5);
+  for (AtlasAllocator::Allocation& quarter : quarters)
+    ASSERT_TRUE(atlas.Allocate(Size(32, 32), &quarter));
+  EXPECT_EQ(2, atlas.page_count());
+  EXPECT_EQ(1, quarters[4].page);
+  EXPECT_EQ(Rect::REC(0, 0, 32, 32), quarters[4].rect);
+}
+
+TEST(AtlasAllocatorTest, ReusesAPageOnceItEmpties) {
+  AtlasAllocator atlas(Size(64, 64), 0);
+  AtlasAllocator::Allocation a, b;
+  atlas.Allocate(Size(64, 32), &a);
+  atlas.Allocate(Size(64, 32), &b);
+
+  EXPECT_FALSE(atlas.Free(a));
+  EXPECT_TRUE(atlas.Free(b));
+  EXPECT_EQ(0, atlas.allocations_on_page(0));
+
+  ASSERT_TRUE(atlas.Allocate(Size(64, 64), &a));
+  EXPECT_EQ(0, a.page);
+  EXPECT_EQ(1, atlas.page_count());
+}
@@ -0,0 +1,212 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "systems/base/text_page.h"
+#include "systems/base/text_system.h"
+#include "systems/base/text_window.h"
+#include "test_system/test_system.h"
+#include "test_system/test_text_window.h"
+#include "test_utils.h"
+#include "utilities/string_utilities.h"
+
+namespace {
+
+const int kPages = 1000;
+const int kLines = 3;
+const int kLineLength = 16;
+
+// One line of a page: kanji with the odd kana, different on every page.
+std::string MakeLine(int page, int line) {
+  std::wstring text;
+  for (int i = 0; i < kLineLength; ++i) {
+    int n = page * 131 + line * 17 + i * 7;
+    text.push_back(i % 5 == 4 ? 0x3042 + (n % 40) : 0x4e00 + (n % 2000));
+  }
+  return UnicodeToUTF8(text);
+}
+
+// Writes a page the way a script does: a name, then indented lines of text,
+// one character at a time.
+void WritePage(TextSystem& text, int page) {
+  TextPage& current = text.GetCurrentPage();
+  current.Name("\xe6\x9c\x8b\xe4\xb9\x9f", "\xe3\x80\x8c");
+  current.SetIndentation();
+  for (int line = 0; line < kLines; ++line) {
+    if (line)
+      current.HardBrake();
+    PrintTextToFunction([&](const std::string& c, const std::string& rest) {
+                          return current.Character(c, rest);
+                        },
+                        MakeLine(page, line),
+                        "");
+  }
+}
+
+std::string ExpectedContents(int page) {
+  std::string contents;
+  for (int line = 0; line < kLines; ++line) {
+    if (line)
+      contents += "\n";
+    contents += MakeLine(page, line);
+  }
+  return contents;
+}
+
+// How each page was stored before: one object per command, each owning its
+// strings.
+struct PerCommandStorage {
+  int command;
+  std::string one;
+  std::string two;
+  int value;
+};
+
+std::vector<PerCommandStorage> PerCommandPage(int page) {
+  std::vector<PerCommandStorage> commands;
+  commands.push_back({1, "\xe6\x9c\x8b\xe4\xb9\x9f", "\xe3\x80\x8c", 0});
+  commands.push_back({4, "", "", 0});
+  for (int line = 0; line < kLines; ++line) {
+    if (line)
+      commands.push_back({3, "", "", 0});
+    commands.push_back({0, MakeLine(page, line), "", 0});
+  }
+  return commands;
+}
+
+}  // namespace
+
+// Fills the backlog with 1000 pages and scrolls through all of them.
+RLVM_BENCHMARK(Backlog) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  TextSystem& text = system.text();
+  text.SetBacklogLimits(kPages, 64 * 1024 * 1024);
+  text.set_active_window(0);
+
+  std::vector<TextPage> pages;
+  size_t snapshot_allocations = 0;
+  for (int page = 0; page < kPages; ++page) {
+    WritePage(text, page);
+    pages.push_back(text.GetCurrentPage());
+
+    size_t before = Benchmark::allocations();
+    text.Snapshot();
+    snapshot_allocations += Benchmark::allocations() - before;
+
+    text.GetTextWindow(0)->ClearWin();
+    text.NewPageOnWindow(0);
+  }
+  if (text.backlog_page_count() != kPages) {
+    bench.Fail("the backlog didn't keep every page");
+    return;
+  }
+
+  std::vector<std::vector<PerCommandStorage>> per_command_pages;
+  size_t per_command_bytes = 0;
+  for (int page = 0; page < kPages; ++page) {
+    per_command_pages.push_back(PerCommandPage(page));
+    const std::vector<PerCommandStorage>& commands = per_command_pages.back();
+    per_command_bytes += sizeof(TextPage) +
+                         commands.capacity() * sizeof(PerCommandStorage);
+    for (const PerCommandStorage& command : commands) {
+      if (command.one.size() >= sizeof(std::string))
+        per_command_bytes += command.one.capacity() + 1;
+      if (command.two.size() >= sizeof(std::string))
+        per_command_bytes += command.two.capacity() + 1;
+    }
+  }
+
+  bench.Report("backlog", text.backlog_bytes(), "bytes");
+  bench.Report("backlog, one object per command", per_command_bytes, "bytes");
+  bench.Report("allocations per snapshot",
+               double(snapshot_allocations) / kPages,
+               "");
+
+  bench.Time("copy 1000 pages", [&]() {
+    std::vector<TextPage> copy(pages);
+  });
+  bench.Time("copy 1000 pages, one object per command", [&]() {
+    std::vector<std::vector<PerCommandStorage>> copy(per_command_pages);
+  });
+
+  TestTextWindow& window =
+      dynamic_cast<TestTextWindow&>(*text.GetTextWindow(0));
+  bench.Time("scroll back and forth through 1000 pages", [&]() {
+    for (int page = 0; page < kPages; ++page)
+      text.BackPage();
+    for (int page = 0; page < kPages; ++page)
+      text.ForwardPage();
+  });
+
+  for (int page = 0; page < kPages; ++page)
+    text.BackPage();
+  // The name may be printed in the window too, depending on NAME_MOD.
+  std::string contents = window.current_contents();
+  std::string expected = ExpectedContents(0);
+  if (contents.size() < expected.size() ||
+      contents.compare(contents.size() - expected.size(),
+                       expected.size(),
+                       expected) != 0) {
+    bench.Fail("the oldest page didn't replay as it was written");
+  }
+  text.StopReadingBacklog();
+  bench.Report("backlog after scrolling through it", text.backlog_bytes(),
+               "bytes");
+
+  // Replay the copies in |pages| directly, so the time is all in replaying.
+  // Every page has recorded its layout once the first pass is done.
+  bench.Time("replay 1000 pages", [&]() {
+    for (TextPage& page : pages) {
+      window.ClearWin();
+      page.Replay(false);
+    }
+  });
+  window.ClearWin();
+  pages[0].Replay(false);
+  std::string recorded = window.current_contents();
+
+  // Starting every other page one pixel lower makes each replay miss the
+  // layout recorded by the one before it, so every page is laid out again.
+  int pass = 0;
+  bench.Time("replay 1000 pages, laying each one out", [&]() {
+    for (int page = 0; page < kPages; ++page) {
+      window.ClearWin();
+      window.set_insertion_point_y((page + pass) % 2);
+      pages[page].Replay(false);
+    }
+    ++pass;
+  });
+  window.ClearWin();
+  window.set_insertion_point_y(2);
+  pages[0].Replay(false);
+  if (window.current_contents() != recorded)
+    bench.Fail("replaying a recorded layout didn't match laying it out");
+}
@@ -0,0 +1,158 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "benchmarks/benchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// How long each Time() call keeps repeating its body.
+const double kMinimumSeconds = 0.5;
+
+std::atomic<size_t> g_allocations(0);
+std::atomic<size_t> g_allocated_bytes(0);
+
+std::vector<std::pair<const char*, Benchmark::Function>>& Registry() {
+  static std::vector<std::pair<const char*, Benchmark::Function>> registry;
+  return registry;
+}
+
+}  // namespace
+
+// Counts every allocation in the benchmark binary so that benchmarks can
+// report how many a code path makes. The array forms forward to these.
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* memory = std::malloc(size ? size : 1);
+  if (!memory)
+    throw std::bad_alloc();
+  return memory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+Benchmark::Benchmark(const std::string& name) : name_(name), failed_(false) {}
+
+Benchmark::~Benchmark() {}
+
+double Benchmark::Time(const std::string& label,
+                       const std::function<void()>& body,
+                       size_t bytes) {
+  typedef std::chrono::steady_clock clock;
+
+  // One untimed run to warm caches and lazily built state.
+  body();
+
+  long iterations = 0;
+  double elapsed = 0;
+  clock::time_point start = clock::now();
+  do {
+    body();
+    ++iterations;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < kMinimumSeconds);
+
+  double per_iteration = elapsed / iterations;
+  std::cout << "  " << std::left << std::setw(40) << label << std::right
+            << std::setw(12) << std::fixed << std::setprecision(3)
+            << per_iteration * 1e6 << " us/iter";
+  if (bytes) {
+    std::cout << std::setw(12) << std::setprecision(1)
+              << (bytes / per_iteration) / (1024.0 * 1024.0) << " MB/s";
+  }
+  std::cout << std::endl;
+  return per_iteration;
+}
+
+void Benchmark::Report(const std::string& label,
+                       double value,
+                       const std::string& unit) {
+  std::cout << "  " << std::left << std::setw(40) << label << std::right
+            << std::setw(12) << std::fixed << std::setprecision(2) << value
+            << " " << unit << std::endl;
+}
+
+void Benchmark::Fail(const std::string& reason) {
+  std::cout << "  FAILED: " << reason << std::endl;
+  failed_ = true;
+}
+
+// static
+size_t Benchmark::allocations() {
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+// static
+size_t Benchmark::allocated_bytes() {
+  return g_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+// static
+void Benchmark::Register(const char* name, Function function) {
+  Registry().emplace_back(name, function);
+}
+
+// static
+int Benchmark::RunAll(const std::string& filter) {
+  int failures = 0;
+  for (auto& entry : Registry()) {
+    if (std::string(entry.first).find(filter) == std::string::npos)
+      continue;
+
+    std::cout << "[ " << entry.first << " ]" << std::endl;
+    Benchmark bench(entry.first);
+    try {
+      entry.second(bench);
+    } catch (std::exception& e) {
+      bench.Fail(e.what());
+    }
+
+    if (bench.failed())
+      failures++;
+  }
+
+  return failures;
+}
@@ -0,0 +1,91 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#ifndef TEST_BENCHMARKS_BENCHMARK_H_
+#define TEST_BENCHMARKS_BENCHMARK_H_
+
+#include <functional>
+#include <string>
+
+// A small timing harness for rlvm_benchmarks. Each benchmark is a function
+// registered with RLVM_BENCHMARK(); it times the code it cares about with
+// Time() and prints whatever extra counters it has with Report().
+class Benchmark {
+ public:
+  typedef void (*Function)(Benchmark& bench);
+
+  explicit Benchmark(const std::string& name);
+  ~Benchmark();
+
+  // Runs |body| repeatedly for at least a fixed slice of wall time and prints
+  // the mean time per iteration. When |bytes| is non-zero, also prints the
+  // throughput of |bytes| processed per iteration. Returns the mean seconds
+  // per iteration.
+  double Time(const std::string& label,
+              const std::function<void()>& body,
+              size_t bytes = 0);
+
+  // Prints a named counter alongside the timings.
+  void Report(const std::string& label, double value, const std::string& unit);
+
+  // Marks the benchmark as failed, e.g. when an optimized path doesn't
+  // produce the same output as the code it replaces.
+  void Fail(const std::string& reason);
+
+  // Number of calls to the global operator new, and the bytes they asked for,
+  // since the program started. Take the difference around the code being
+  // measured.
+  static size_t allocations();
+  static size_t allocated_bytes();
+
+  const std::string& name() const { return name_; }
+  bool failed() const { return failed_; }
+
+  // Registers a benchmark; called through RLVM_BENCHMARK.
+  static void Register(const char* name, Function function);
+
+  // Runs every registered benchmark whose name contains |filter|. Returns the
+  // number of failures.
+  static int RunAll(const std::string& filter);
+
+ private:
+  std::string name_;
+  bool failed_;
+};
+
+struct BenchmarkRegistrar {
+  BenchmarkRegistrar(const char* name, Benchmark::Function function) {
+    Benchmark::Register(name, function);
+  }
+};
+
+#define RLVM_BENCHMARK(name)                                        \
+  static void name(Benchmark& bench);                               \
+  static BenchmarkRegistrar name##_registrar(#name, &name);         \
+  static void name(Benchmark& bench)
+
+#endif  // TEST_BENCHMARKS_BENCHMARK_H_
@@ -0,0 +1,200 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <forward_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/bytecode.h"
+#include "libreallive/compression.h"
+#include "libreallive/scenario.h"
+#include "test_utils.h"
+
+using libreallive::BytecodeElement;
+using libreallive::BytecodeList;
+using libreallive::ConstructionData;
+using libreallive::read_i32;
+namespace compression = libreallive::compression;
+
+namespace {
+
+// The decompressed bytecode of one scenario and its kidoku table.
+struct Bytecode {
+  std::vector<char> data;
+  std::vector<unsigned long> kidoku_table;
+};
+
+// The layout elements had before BytecodeList: one heap allocation per
+// element, chained in a singly linked list.
+typedef std::forward_list<std::unique_ptr<BytecodeElement>> HeapList;
+
+void ParseIntoList(const Bytecode& bytecode, BytecodeList& list) {
+  ConstructionData cdata(0, &list);
+  size_t pos = 0;
+  const char* stream = bytecode.data.data();
+  const char* end = stream + bytecode.data.size();
+  cdata.kidoku_table = bytecode.kidoku_table;
+  while (pos < bytecode.data.size()) {
+    cdata.offsets[pos] = list.size();
+    size_t l = BytecodeElement::Read(stream, end, cdata)->GetBytecodeLength();
+    if (l <= 0)
+      l = 1;
+    stream += l;
+    pos += l;
+  }
+  for (BytecodeElement* element : list)
+    element->SetPointers(cdata);
+}
+
+void ParseIntoHeap(const Bytecode& bytecode, HeapList& elements) {
+  ConstructionData cdata(0);
+  size_t pos = 0;
+  size_t index = 0;
+  const char* stream = bytecode.data.data();
+  const char* end = stream + bytecode.data.size();
+  cdata.kidoku_table = bytecode.kidoku_table;
+  HeapList::iterator it = elements.before_begin();
+  while (pos < bytecode.data.size()) {
+    cdata.offsets[pos] = index++;
+    it = elements.emplace_after(
+        it, BytecodeElement::Read(stream, end, cdata));
+    size_t l = (*it)->GetBytecodeLength();
+    if (l <= 0)
+      l = 1;
+    stream += l;
+    pos += l;
+  }
+  for (auto& element : elements)
+    element->SetPointers(cdata);
+}
+
+}  // namespace
+
+// Parses every scenario in the test fixtures into a BytecodeList and into one
+// heap allocation per element, then walks both the way the interpreter loop
+// does.
+RLVM_BENCHMARK(BytecodeLayout) {
+  std::vector<Bytecode> scripts;
+  size_t total_bytes = 0;
+  for (const std::string& path : locateAllTestScenarios()) {
+    libreallive::Archive archive(path);
+    for (auto it = archive.begin(); it != archive.end(); ++it) {
+      const char* data = it->second.data;
+      libreallive::Header header(data, it->second.length);
+
+      Bytecode bytecode;
+      const size_t kidoku_offs = read_i32(data + 0x08);
+      const size_t kidoku_length = read_i32(data + 0x0c);
+      for (size_t i = 0; i < kidoku_length; ++i)
+        bytecode.kidoku_table.push_back(read_i32(data + kidoku_offs + i * 4));
+
+      bytecode.data.resize(read_i32(data + 0x24));
+      compression::Decompress(
+          data + read_i32(data + 0x20), read_i32(data + 0x28),
+          bytecode.data.data(), bytecode.data.size(),
+          header.use_xor_2_ ? compression::little_busters_ex_xor_mask : NULL);
+      total_bytes += bytecode.data.size();
+      scripts.push_back(std::move(bytecode));
+    }
+  }
+
+  bench.Report("scenarios", scripts.size(), "");
+  bench.Report("bytecode", total_bytes, "bytes");
+
+  // Allocation counts for one parse of every scenario.
+  {
+    size_t elements = 0;
+    size_t allocations = Benchmark::allocations();
+    size_t bytes = Benchmark::allocated_bytes();
+    {
+      std::vector<HeapList> heap(scripts.size());
+      for (size_t i = 0; i < scripts.size(); ++i)
+        ParseIntoHeap(scripts[i], heap[i]);
+    }
+    bench.Report("per element: allocations",
+                 Benchmark::allocations() - allocations, "");
+    bench.Report("per element: allocated",
+                 Benchmark::allocated_bytes() - bytes, "bytes");
+
+    allocations = Benchmark::allocations();
+    bytes = Benchmark::allocated_bytes();
+    {
+      std::vector<BytecodeList> lists(scripts.size());
+      for (size_t i = 0; i < scripts.size(); ++i) {
+        ParseIntoList(scripts[i], lists[i]);
+        elements += lists[i].size();
+      }
+    }
+    bench.Report("BytecodeList: allocations",
+                 Benchmark::allocations() - allocations, "");
+    bench.Report("BytecodeList: allocated",
+                 Benchmark::allocated_bytes() - bytes, "bytes");
+    bench.Report("elements", elements, "");
+  }
+
+  bench.Time("parse, per element", [&]() {
+    for (const Bytecode& bytecode : scripts) {
+      HeapList heap;
+      ParseIntoHeap(bytecode, heap);
+    }
+  }, total_bytes);
+  bench.Time("parse, BytecodeList", [&]() {
+    for (const Bytecode& bytecode : scripts) {
+      BytecodeList list;
+      ParseIntoList(bytecode, list);
+    }
+  }, total_bytes);
+
+  std::vector<HeapList> heap(scripts.size());
+  std::vector<BytecodeList> lists(scripts.size());
+  for (size_t i = 0; i < scripts.size(); ++i) {
+    ParseIntoHeap(scripts[i], heap[i]);
+    ParseIntoList(scripts[i], lists[i]);
+  }
+
+  size_t heap_length = 0, list_length = 0;
+  bench.Time("walk, per element", [&]() {
+    heap_length = 0;
+    for (const HeapList& elements : heap) {
+      for (auto const& element : elements)
+        heap_length += element->GetBytecodeLength();
+    }
+  }, total_bytes);
+  bench.Time("walk, BytecodeList", [&]() {
+    list_length = 0;
+    for (const BytecodeList& list : lists) {
+      for (const BytecodeElement* element : list)
+        list_length += element->GetBytecodeLength();
+    }
+  }, total_bytes);
+
+  if (heap_length != list_length)
+    bench.Fail("The two layouts disagree on the length of the bytecode");
+}
@@ -0,0 +1,103 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/compression.h"
+#include "test_utils.h"
+
+using libreallive::read_i32;
+namespace compression = libreallive::compression;
+
+namespace {
+
+struct CompressedBlock {
+  const char* data;
+  size_t length;
+  size_t uncompressed_length;
+};
+
+}  // namespace
+
+// Decompresses the bytecode of every scenario in the test fixtures, checking
+// the output against the reference decoder before timing both.
+RLVM_BENCHMARK(SeenDecompression) {
+  std::vector<std::unique_ptr<libreallive::Archive>> archives;
+  std::vector<CompressedBlock> blocks;
+  size_t total_bytes = 0;
+  for (const std::string& path : locateAllTestScenarios()) {
+    archives.emplace_back(new libreallive::Archive(path));
+    for (auto it = archives.back()->begin(); it != archives.back()->end();
+         ++it) {
+      const char* data = it->second.data;
+      CompressedBlock block = {data + read_i32(data + 0x20),
+                               size_t(read_i32(data + 0x28)),
+                               size_t(read_i32(data + 0x24))};
+      blocks.push_back(block);
+      total_bytes += block.uncompressed_length;
+    }
+  }
+
+  bench.Report("scenarios", blocks.size(), "");
+  bench.Report("uncompressed bytecode", total_bytes, "bytes");
+
+  const compression::XorKey* key = compression::little_busters_ex_xor_mask;
+  for (const CompressedBlock& block : blocks) {
+    std::vector<char> fast(block.uncompressed_length);
+    std::vector<char> reference(block.uncompressed_length);
+    compression::Decompress(block.data, block.length, fast.data(),
+                            fast.size(), key);
+    compression::ReferenceDecompress(block.data, block.length,
+                                     reference.data(), reference.size(), key);
+    if (fast != reference) {
+      bench.Fail("Decompress() output differs from ReferenceDecompress()");
+      return;
+    }
+  }
+
+  std::vector<char> output;
+  for (const CompressedBlock& block : blocks)
+    output.resize(std::max(output.size(), block.uncompressed_length));
+
+  bench.Time("ReferenceDecompress", [&]() {
+    for (const CompressedBlock& block : blocks) {
+      compression::ReferenceDecompress(block.data, block.length, output.data(),
+                                       block.uncompressed_length, key);
+    }
+  }, total_bytes);
+  bench.Time("Decompress", [&]() {
+    for (const CompressedBlock& block : blocks) {
+      compression::Decompress(block.data, block.length, output.data(),
+                              block.uncompressed_length, key);
+    }
+  }, total_bytes);
+}
@@ -0,0 +1,161 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <string>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/compression.h"
+#include "libreallive/defs.h"
+#include "libreallive/intmemref.h"
+#include "machine/rlmachine.h"
+#include "modules/module_jmp.h"
+#include "modules/module_mem.h"
+#include "test_system/test_system.h"
+#include "test_utils.h"
+
+namespace fs = boost::filesystem;
+
+using libreallive::append_i32;
+using libreallive::insert_i32;
+
+namespace {
+
+// The synthetic scenario runs kLoopBody commands, kLoopCount times.
+const int kLoopBody = 1000;
+const int kLoopCount = 1000;
+
+// The bytecode for intA[index].
+std::string IntAReference(int index) {
+  std::string out("$\x00[$\xff", 5);
+  append_i32(out, index);
+  out.push_back(']');
+  return out;
+}
+
+std::string IntConstant(int value) {
+  std::string out("$\xff");
+  append_i32(out, value);
+  return out;
+}
+
+// The header of a command; see CommandElement.
+std::string Command(int modtype, int module, int opcode, int argc,
+                    int overload) {
+  std::string out(8, '\0');
+  out[0] = '#';
+  out[1] = modtype;
+  out[2] = module;
+  libreallive::insert_i16(out, 3, opcode);
+  libreallive::insert_i16(out, 5, argc);
+  out[7] = overload;
+  return out;
+}
+
+// Builds:
+//
+//   @top
+//   setarray(intA[i % 100], i)   // kLoopBody times
+//   intB[0] += 1
+//   goto_unless(intB[0] >= kLoopCount) @top
+std::string BuildBytecode() {
+  std::string bytecode;
+  for (int i = 0; i < kLoopBody; ++i) {
+    bytecode += Command(1, 11, 0, 2, 0) + "(" + IntAReference(i % 100) +
+                IntConstant(i) + ")";
+  }
+
+  std::string counter("$\x01[$\xff", 5);
+  append_i32(counter, 0);
+  counter.push_back(']');
+  bytecode += counter + "\\\x14" + IntConstant(1);
+
+  bytecode += Command(0, 1, 2, 1, 0) + "(" + counter + "\\\x2c" +
+              IntConstant(kLoopCount) + ")";
+  append_i32(bytecode, 0);
+  return bytecode;
+}
+
+// Writes an archive holding |bytecode| as SEEN0001.
+void WriteArchive(const fs::path& path, const std::string& bytecode) {
+  const int kHeaderSize = 0x1d0;
+  std::string block = CompressLiterals(bytecode.data(), bytecode.size());
+
+  std::string scenario(kHeaderSize, '\0');
+  insert_i32(scenario, 0x00, kHeaderSize);
+  insert_i32(scenario, 0x04, 10002);
+  insert_i32(scenario, 0x08, kHeaderSize);  // empty kidoku table
+  insert_i32(scenario, 0x14, kHeaderSize);  // no dramatis personae
+  insert_i32(scenario, 0x20, kHeaderSize);
+  insert_i32(scenario, 0x24, bytecode.size());
+  insert_i32(scenario, 0x28, block.size());
+  scenario += block;
+
+  const int kTableSize = 10000 * 8;
+  std::string archive(kTableSize, '\0');
+  insert_i32(archive, 8, kTableSize);
+  insert_i32(archive, 12, scenario.size());
+  archive += scenario;
+
+  fs::ofstream file(path, std::ios::binary);
+  file.write(archive.data(), archive.size());
+}
+
+}  // namespace
+
+// Runs a synthetic SEEN of a million commands through RLMachine on the null
+// test system.
+RLVM_BENCHMARK(CommandDispatch) {
+  fs::path dir = fs::temp_directory_path() / fs::unique_path("rlvm-%%%%%%%%");
+  fs::create_directories(dir);
+  WriteArchive(dir / "SEEN.TXT", BuildBytecode());
+
+  {
+    TestSystem system;
+    libreallive::Archive arc((dir / "SEEN.TXT").string());
+    const double commands = double(kLoopBody + 2) * kLoopCount;
+    bench.Report("commands", commands, "");
+
+    int counter = 0;
+    double seconds = bench.Time("ExecuteUntilHalted", [&]() {
+      RLMachine machine(system, arc);
+      machine.AttachModule(new JmpModule);
+      machine.AttachModule(new MemModule);
+      machine.ExecuteUntilHalted();
+      counter = machine.GetIntValue(libreallive::IntMemRef('B', 0));
+    });
+    bench.Report("dispatch rate", commands / seconds / 1e6, "M commands/s");
+
+    if (counter != kLoopCount)
+      bench.Fail("The synthetic scenario didn't run to completion");
+  }
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,104 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/bytecode.h"
+#include "libreallive/expression_program.h"
+#include "libreallive/scenario.h"
+#include "machine/rlmachine.h"
+#include "test_system/test_system.h"
+#include "test_utils.h"
+
+using libreallive::BytecodeElement;
+using libreallive::ExpressionElement;
+
+namespace {
+
+const char* kExpressionScenarios[] = {
+  "basicOperators",
+  "comparisonOperators",
+  "logicalOperators",
+  "previousErrors"
+};
+
+}  // namespace
+
+// Evaluates every compilable expression statement in the ExpressionTest_SEEN
+// fixtures, through the ExpressionPiece tree and through the compiled
+// program.
+RLVM_BENCHMARK(ExpressionEvaluation) {
+  TestSystem system;
+  for (const char* name : kExpressionScenarios) {
+    libreallive::Archive arc(
+        locateTestCase(std::string("ExpressionTest_SEEN/") + name + ".TXT"));
+    RLMachine machine(system, arc);
+
+    std::vector<const ExpressionElement*> expressions;
+    size_t nodes = 0;
+    for (auto it = arc.begin(); it != arc.end(); ++it) {
+      for (const BytecodeElement* element : *arc.GetScenario(it->first)) {
+        const ExpressionElement* expression =
+            dynamic_cast<const ExpressionElement*>(element);
+        if (!expression || expression->CompiledExpression().empty())
+          continue;
+
+        // Leave out anything that faults on this machine's memory.
+        try {
+          expression->ParsedExpression().GetIntegerValue(machine);
+          expression->CompiledExpression().Evaluate(machine);
+        } catch (std::exception& e) {
+          continue;
+        }
+        expressions.push_back(expression);
+        nodes += expression->CompiledExpression().size();
+      }
+    }
+
+    bench.Report(std::string(name) + ": expressions", expressions.size(), "");
+    bench.Report(std::string(name) + ": program words", nodes, "");
+    if (expressions.empty())
+      continue;
+
+    bench.Time(std::string(name) + ": tree", [&]() {
+      for (int i = 0; i < 100; ++i) {
+        for (const ExpressionElement* expression : expressions)
+          expression->ParsedExpression().GetIntegerValue(machine);
+      }
+    });
+    bench.Time(std::string(name) + ": compiled", [&]() {
+      for (int i = 0; i < 100; ++i) {
+        for (const ExpressionElement* expression : expressions)
+          expression->CompiledExpression().Evaluate(machine);
+      }
+    });
+  }
+}
@@ -0,0 +1,218 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "systems/base/colour.h"
+#include "systems/base/glyph_cache.h"
+#include "utilities/string_utilities.h"
+
+namespace {
+
+// CLANNAD's text window: four lines of 23 full width characters in a 25 pixel
+// font, drawn with a shadow onto the window's own surface.
+const int kFontSize = 25;
+const int kLineLength = 23;
+const int kLines = 4;
+const int kScreenWidth = 16 + kLineLength * kFontSize;
+const int kScreenHeight = 16 + kLines * (kFontSize + 4);
+
+// Stands in for FreeType, which the benchmarks don't link against. Gives each
+// character a deterministic, mostly empty coverage mask of the size SDL_ttf
+// produces for full width characters.
+std::vector<uint8_t> RasterizeMask(wchar_t codepoint, Size* size) {
+  *size = Size(kFontSize, kFontSize + 1);
+  std::vector<uint8_t> mask(size->width() * size->height());
+  uint32_t seed = codepoint;
+  for (uint8_t& coverage : mask) {
+    seed = seed * 1103515245 + 12345;
+    int value = (seed >> 16) & 0x1ff;
+    coverage = value < 256 ? 0 : value - 256;
+  }
+  return mask;
+}
+
+// -----------------------------------------------------------------------
+// The path the cache replaces
+// -----------------------------------------------------------------------
+
+// Like TTF_RenderUTF8_Blended(): a new surface, filled with |colour|, with
+// the coverage as alpha.
+std::vector<uint32_t> RenderBlended(wchar_t codepoint,
+                                    const RGBColour& colour,
+                                    Size* size) {
+  std::vector<uint8_t> mask = RasterizeMask(codepoint, size);
+  uint32_t bare_colour = (colour.r() << 16) | (colour.g() << 8) | colour.b();
+  std::vector<uint32_t> surface(mask.size());
+  for (size_t i = 0; i < mask.size(); ++i)
+    surface[i] = (uint32_t(mask[i]) << 24) | bare_colour;
+  return surface;
+}
+
+// pygame_AlphaBlit() of |src| onto the window at (|x|, |y|), which is always
+// inside it here.
+void AlphaBlit(const std::vector<uint32_t>& src,
+               const Size& size,
+               std::vector<uint32_t>& screen,
+               int x,
+               int y) {
+  for (int row = 0; row < size.height(); ++row) {
+    for (int column = 0; column < size.width(); ++column) {
+      uint32_t s = src[row * size.width() + column];
+      uint32_t& d = screen[(y + row) * kScreenWidth + x + column];
+      int sA = s >> 24, sR = (s >> 16) & 0xff, sG = (s >> 8) & 0xff,
+          sB = s & 0xff;
+      int dA = d >> 24, dR = (d >> 16) & 0xff, dG = (d >> 8) & 0xff,
+          dB = d & 0xff;
+      if (dA) {
+        dR = ((dR << 8) + (sR - dR) * sA + sR) >> 8;
+        dG = ((dG << 8) + (sG - dG) * sA + sG) >> 8;
+        dB = ((dB << 8) + (sB - dB) * sA + sB) >> 8;
+        dA = sA + dA - ((sA * dA) / 255);
+      } else {
+        dR = sR;
+        dG = sG;
+        dB = sB;
+        dA = sA;
+      }
+      d = (uint32_t(dA) << 24) | (dR << 16) | (dG << 8) | dB;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------
+
+// A page of text. Picks from a small vocabulary so characters repeat about
+// as often as they do in a real script.
+std::vector<wchar_t> MakePage() {
+  std::vector<wchar_t> vocabulary;
+  for (wchar_t kanji = 0x4e00; vocabulary.size() < 40; kanji += 97)
+    vocabulary.push_back(kanji);
+  for (wchar_t kana = 0x3042; kana < 0x304a; kana += 2)
+    vocabulary.push_back(kana);
+
+  std::vector<wchar_t> page;
+  uint32_t seed = 1;
+  for (int i = 0; i < kLineLength * kLines; ++i) {
+    seed = seed * 1103515245 + 12345;
+    page.push_back(vocabulary[(seed >> 16) % vocabulary.size()]);
+  }
+  return page;
+}
+
+Point PositionOf(int index) {
+  return Point(8 + (index % kLineLength) * kFontSize,
+               8 + (index / kLineLength) * (kFontSize + 4));
+}
+
+}  // namespace
+
+RLVM_BENCHMARK(KanjiPage) {
+  const std::vector<wchar_t> page = MakePage();
+  std::vector<std::string> utf8;
+  for (wchar_t codepoint : page)
+    utf8.push_back(UnicodeToUTF8(std::wstring(1, codepoint)));
+
+  const RGBColour text_colour = RGBColour::White();
+  const RGBColour shadow_colour(16, 16, 16);
+  std::vector<uint32_t> reference, cached;
+
+  auto render_uncached = [&]() {
+    reference.assign(kScreenWidth * kScreenHeight, 0);
+    for (size_t i = 0; i < page.size(); ++i) {
+      Point at = PositionOf(i);
+      Size size;
+      std::vector<uint32_t> shadow =
+          RenderBlended(page[i], shadow_colour, &size);
+      std::vector<uint32_t> character =
+          RenderBlended(page[i], text_colour, &size);
+      AlphaBlit(shadow, size, reference, at.x() + 2, at.y() + 2);
+      AlphaBlit(character, size, reference, at.x(), at.y());
+    }
+  };
+
+  GlyphCache cache(Size(512, 512), 4);
+  auto render_cached = [&]() {
+    cached.assign(kScreenWidth * kScreenHeight, 0);
+    for (size_t i = 0; i < page.size(); ++i) {
+      const GlyphCache::Glyph* glyph =
+          cache.Find(utf8[i], kFontSize, false);
+      if (!glyph) {
+        Size size;
+        std::vector<uint8_t> mask = RasterizeMask(page[i], &size);
+        glyph = cache.Insert(
+            utf8[i], kFontSize, false, size, mask.data(), size.width());
+      }
+
+      Point at = PositionOf(i);
+      GlyphCache::Blend(*glyph,
+                        shadow_colour,
+                        at + Point(2, 2),
+                        cached.data(),
+                        kScreenWidth * 4,
+                        Size(kScreenWidth, kScreenHeight));
+      GlyphCache::Blend(*glyph,
+                        text_colour,
+                        at,
+                        cached.data(),
+                        kScreenWidth * 4,
+                        Size(kScreenWidth, kScreenHeight));
+    }
+  };
+
+  render_uncached();
+  render_cached();
+  if (cached != reference) {
+    bench.Fail("the glyph cache draws a different page than SDL_ttf would");
+    return;
+  }
+
+  bench.Report("glyphs per page", page.size(), "");
+  bench.Report("distinct glyphs", cache.glyph_count(), "");
+
+  bench.Time("page, rendering every glyph", render_uncached);
+  bench.Time("page, cold glyph cache", [&]() {
+    cache.Clear();
+    render_cached();
+  });
+  bench.Time("page, warm glyph cache (backlog replay)", render_cached);
+
+  size_t before = Benchmark::allocations();
+  render_uncached();
+  bench.Report("rendering every glyph: allocations",
+               Benchmark::allocations() - before,
+               "");
+  before = Benchmark::allocations();
+  render_cached();
+  bench.Report("warm glyph cache: allocations",
+               Benchmark::allocations() - before,
+               "");
+}
@@ -0,0 +1,521 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "test_utils.h"
+#include "xclannad/endian.hpp"
+#include "xclannad/file.h"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const int kWidth = 800;
+const int kHeight = 600;
+
+// -----------------------------------------------------------------------
+// Encoder for the synthetic images
+// -----------------------------------------------------------------------
+
+// Describes one of the LZ variants in xclannad/file.cc. Lengths and distances
+// are in units, which are a pixel or a byte depending on the format.
+struct LzFormat {
+  int unit_size;      // Bytes per unit of decoded output.
+  int literal_size;   // Bytes a literal unit takes in the compressed stream.
+  int min_length, max_length, max_distance;
+  bool reversed_flags;
+  int (*encode)(int distance, int length);
+};
+
+int EncodePdt(int distance, int length) {
+  return ((distance - 1) << 4) | (length - 1);
+}
+int EncodeG00Type0(int distance, int length) {
+  return (distance << 4) | (length - 1);
+}
+int EncodeScn2k(int distance, int length) {
+  return (distance << 4) | (length - 2);
+}
+int EncodeMask(int distance, int length) {
+  return ((distance - 1) << 8) | (length - 2);
+}
+
+const LzFormat kPdtFormat = {4, 3, 2, 16, 4096, false, &EncodePdt};
+const LzFormat kG00Type0Format = {3, 3, 2, 16, 4095, true, &EncodeG00Type0};
+const LzFormat kScn2kFormat = {1, 1, 2, 17, 4095, true, &EncodeScn2k};
+const LzFormat kMaskFormat = {1, 1, 2, 257, 256, false, &EncodeMask};
+
+// Greedy compressor that only tries back references to the previous unit,
+// the previous pixel and the previous row, which is enough to give the
+// decoder the mix of literals and runs that real CGs have.
+std::string LzCompress(const LzFormat& format,
+                       const std::vector<char>& input,
+                       const std::vector<int>& candidates) {
+  const int unit = format.unit_size;
+  const int units = input.size() / unit;
+  std::string out;
+  int pos = 0;
+  while (pos < units) {
+    size_t flag_pos = out.size();
+    out.push_back(0);
+    int flag = 0;
+    for (int item = 0; item < 8 && pos < units; ++item) {
+      int best_length = 0, best_distance = 0;
+      for (int distance : candidates) {
+        if (distance > pos || distance > format.max_distance)
+          continue;
+        int length = 0;
+        while (length < format.max_length && pos + length < units &&
+               memcmp(&input[(pos + length) * unit],
+                      &input[(pos + length - distance) * unit], unit) == 0)
+          ++length;
+        if (length > best_length) {
+          best_length = length;
+          best_distance = distance;
+        }
+      }
+
+      if (best_length >= format.min_length) {
+        int token = format.encode(best_distance, best_length);
+        out.push_back(char(token & 0xff));
+        out.push_back(char((token >> 8) & 0xff));
+        pos += best_length;
+      } else {
+        flag |= format.reversed_flags ? (1 << item) : (0x80 >> item);
+        out.append(&input[pos * unit], format.literal_size);
+        pos++;
+      }
+    }
+    out[flag_pos] = char(flag);
+  }
+  return out;
+}
+
+void AppendInt(std::string& out, int value) {
+  char buf[4];
+  write_little_endian_int(buf, value);
+  out.append(buf, 4);
+}
+
+void AppendShort(std::string& out, int value) {
+  char buf[2];
+  write_little_endian_short(buf, value);
+  out.append(buf, 2);
+}
+
+void AppendZeros(std::string& out, int count) { out.append(count, '\0'); }
+
+// -----------------------------------------------------------------------
+// Synthetic CG
+// -----------------------------------------------------------------------
+
+// A banded gradient with noisy patches and an elliptical alpha mask with a
+// soft edge: flat enough to compress, busy enough to need literals.
+struct Pixel {
+  unsigned char b, g, r, a;
+};
+
+std::vector<Pixel> MakeCg() {
+  std::vector<Pixel> pixels(kWidth * kHeight);
+  unsigned int seed = 12345;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      Pixel& p = pixels[y * kWidth + x];
+      p.r = (x * 255 / kWidth) & 0xf8;
+      p.g = (y * 255 / kHeight) & 0xf8;
+      p.b = ((x + y) / 4) & 0xf0;
+      if ((x / 64 + y / 64) % 3 == 0) {
+        seed = seed * 1103515245 + 12345;
+        p.r ^= (seed >> 16) & 0x07;
+        p.g ^= (seed >> 20) & 0x07;
+      }
+
+      int dx = x - kWidth / 2, dy = y - kHeight / 2;
+      int d = dx * dx * 9 + dy * dy * 16;
+      int edge = 9 * 16 * 280 * 280 / 16;
+      if (d < edge)
+        p.a = 255;
+      else if (d < edge + edge / 8)
+        p.a = 255 - (d - edge) * 255 / (edge / 8);
+      else
+        p.a = 0;
+    }
+  }
+  return pixels;
+}
+
+std::string MakeG00Type0(const std::vector<Pixel>& cg) {
+  std::vector<char> rgb;
+  for (const Pixel& p : cg) {
+    rgb.push_back(p.b);
+    rgb.push_back(p.g);
+    rgb.push_back(p.r);
+  }
+  std::string compressed = LzCompress(kG00Type0Format, rgb, {1, kWidth});
+  std::string file(1, '\0');
+  AppendShort(file, kWidth);
+  AppendShort(file, kHeight);
+  AppendInt(file, compressed.size() + 8);
+  AppendInt(file, rgb.size());
+  return file + compressed;
+}
+
+std::string MakeG00Type1(const std::vector<Pixel>& cg) {
+  std::vector<char> data;
+  data.push_back(char(256 & 0xff));
+  data.push_back(char(256 >> 8));
+  for (int i = 0; i < 256; ++i) {
+    char entry[4];
+    write_little_endian_int(entry, 0xff000000 | (i * 0x010101));
+    data.insert(data.end(), entry, entry + 4);
+  }
+  for (const Pixel& p : cg)
+    data.push_back(char((p.r + p.g + p.b) / 3));
+  std::string compressed = LzCompress(kScn2kFormat, data, {1, kWidth});
+  std::string file(1, '\1');
+  AppendShort(file, kWidth);
+  AppendShort(file, kHeight);
+  AppendInt(file, compressed.size() + 8);
+  AppendInt(file, data.size() - 1);
+  return file + compressed;
+}
+
+std::string MakeG00Type2(const std::vector<Pixel>& cg) {
+  // One region holding one part that covers the whole image.
+  std::string data;
+  AppendInt(data, 1);
+  AppendInt(data, 12);
+  AppendInt(data, 0x74 + 0x5c + kWidth * kHeight * 4);
+  AppendZeros(data, 0x74);
+  std::string part;
+  AppendShort(part, 0);
+  AppendShort(part, 0);
+  AppendShort(part, 0);
+  AppendShort(part, kWidth);
+  AppendShort(part, kHeight);
+  AppendZeros(part, 0x5c - part.size());
+  data += part;
+  data.append(reinterpret_cast<const char*>(cg.data()), cg.size() * 4);
+
+  std::vector<char> input(data.begin(), data.end());
+  std::string compressed =
+      LzCompress(kScn2kFormat, input, {1, 4, kWidth * 4});
+
+  std::string file(1, '\2');
+  AppendShort(file, kWidth);
+  AppendShort(file, kHeight);
+  AppendInt(file, 1);
+  AppendInt(file, 0);
+  AppendInt(file, 0);
+  AppendInt(file, kWidth - 1);
+  AppendInt(file, kHeight - 1);
+  AppendInt(file, 0);
+  AppendInt(file, 0);
+  AppendInt(file, compressed.size() + 8);
+  AppendInt(file, input.size());
+  return file + compressed;
+}
+
+std::string MakePdt10(const std::vector<Pixel>& cg) {
+  std::vector<char> color, mask;
+  for (const Pixel& p : cg) {
+    color.push_back(p.b);
+    color.push_back(p.g);
+    color.push_back(p.r);
+    color.push_back(0);
+    mask.push_back(p.a);
+  }
+  std::string compressed_color = LzCompress(kPdtFormat, color, {1, kWidth});
+  std::string compressed_mask = LzCompress(kMaskFormat, mask, {1});
+
+  int mask_pt = 0x20 + compressed_color.size();
+  std::string file("PDT10\0\0\0", 8);
+  AppendInt(file, mask_pt + compressed_mask.size());
+  AppendInt(file, kWidth);
+  AppendInt(file, kHeight);
+  AppendZeros(file, 8);
+  AppendInt(file, mask_pt);
+  return file + compressed_color + compressed_mask;
+}
+
+// -----------------------------------------------------------------------
+// Reference decoders
+// -----------------------------------------------------------------------
+
+// The decoders as they were before they were vectorized: one unit at a time,
+// through the out of line endian helpers, with a separate copy pass.
+template <class Extract, int kDataSize>
+void ReferenceLzExtract(const char* src,
+                        const char* srcend,
+                        char* dest,
+                        char* destend) {
+  static const int bitrev[256] = {
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+      R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+  };
+  while (dest < destend && src < srcend) {
+    int flag = int(*(unsigned char*)src++);
+    if (Extract::kReversed)
+      flag = bitrev[flag];
+    for (int i = 0; i < 8 && dest < destend && src < srcend; i++) {
+      if (flag & 0x80) {
+        Extract::Copy1Pixel(src, dest);
+      } else {
+        int data, size;
+        Extract::ExtractData(src, data, size);
+        char* p_dest = dest - data * kDataSize;
+        for (int k = 0; k < size * kDataSize; k++) {
+          p_dest[data * kDataSize] = *p_dest;
+          p_dest++;
+        }
+        dest += size * kDataSize;
+      }
+      flag <<= 1;
+    }
+  }
+}
+
+struct ReferencePdt {
+  static const bool kReversed = false;
+  static void ExtractData(const char*& src, int& data, int& size) {
+    data = read_little_endian_short(src) & 0xffff;
+    size = (data & 0x0f) + 1;
+    data = (data >> 4) + 1;
+    src += 2;
+  }
+  static void Copy1Pixel(const char*& src, char*& dest) {
+    *(int*)dest = read_little_endian_int(src);
+    dest[3] = 0;
+    src += 3;
+    dest += 4;
+  }
+};
+
+struct ReferenceG00Type0 {
+  static const bool kReversed = true;
+  static void ExtractData(const char*& src, int& data, int& size) {
+    data = read_little_endian_short(src) & 0xffff;
+    size = ((data & 0x0f) + 1) * 3;
+    data = (data >> 4) * 3;
+    src += 2;
+  }
+  static void Copy1Pixel(const char*& src, char*& dest) {
+    *(int*)dest = *(const int*)src;
+    src += 3;
+    dest += 3;
+  }
+};
+
+struct ReferenceScn2k {
+  static const bool kReversed = true;
+  static void ExtractData(const char*& src, int& data, int& size) {
+    data = read_little_endian_short(src) & 0xffff;
+    size = (data & 0x0f) + 2;
+    data = (data >> 4);
+    src += 2;
+  }
+  static void Copy1Pixel(const char*& src, char*& dest) { *dest++ = *src++; }
+};
+
+struct ReferenceMask {
+  static const bool kReversed = false;
+  static void ExtractData(const char*& src, int& data, int& size) {
+    int d = read_little_endian_short(src) & 0xffff;
+    size = (d & 0xff) + 2;
+    data = (d >> 8) + 1;
+    src += 2;
+  }
+  static void Copy1Pixel(const char*& src, char*& dest) { *dest++ = *src++; }
+};
+
+void ReferenceRead(const std::string& file, int width, int height,
+                   char* image) {
+  const char* data = file.data();
+  const char* end = data + file.size();
+  int pixels = width * height;
+  if (file.compare(0, 5, "PDT10") == 0) {
+    int mask_pt = read_little_endian_int(data + 0x1c);
+    ReferenceLzExtract<ReferencePdt, 4>(data + 0x20,
+                                        mask_pt ? data + mask_pt : end, image,
+                                        image + pixels * 4);
+    if (mask_pt) {
+      std::unique_ptr<char[]> mask(new char[pixels + 1024]);
+      ReferenceLzExtract<ReferenceMask, 1>(data + mask_pt, end, mask.get(),
+                                           mask.get() + pixels);
+      for (int i = 0; i < pixels; ++i)
+        ((int*)image)[i] |= int((unsigned char)mask[i]) << 24;
+    }
+  } else if (data[0] == 0) {
+    int size = read_little_endian_int(data + 9);
+    std::unique_ptr<char[]> rgb(new char[size + 1024]);
+    ReferenceLzExtract<ReferenceG00Type0, 1>(data + 13, end, rgb.get(),
+                                             rgb.get() + size);
+    const unsigned char* s = (const unsigned char*)rgb.get();
+    for (int i = 0; i < pixels; ++i, s += 3) {
+      ((int*)image)[i] =
+          s[0] | (s[1] << 8) | (s[2] << 16) | int(0xff000000);
+    }
+  } else if (data[0] == 1) {
+    int size = read_little_endian_int(data + 9) + 1;
+    std::unique_ptr<char[]> buf(new char[size + 1024]);
+    ReferenceLzExtract<ReferenceScn2k, 1>(data + 13, end, buf.get(),
+                                          buf.get() + size);
+    int colortable[256] = {0};
+    int colors = std::min(256, read_little_endian_short(buf.get()));
+    for (int i = 0; i < colors; ++i)
+      colortable[i] = read_little_endian_int(buf.get() + 2 + i * 4);
+    const unsigned char* s = (const unsigned char*)buf.get() + 2 +
+                             read_little_endian_short(buf.get()) * 4;
+    for (int i = 0; i < pixels; ++i)
+      ((int*)image)[i] = colortable[s[i]];
+  } else {
+    memset(image, 0, pixels * 4);
+    // A single region with a single part, as MakeG00Type2() writes.
+    const char* head = data + 9 + 24;
+    int size = read_little_endian_int(head + 4);
+    std::unique_ptr<char[]> buf(new char[size + 1024]);
+    ReferenceLzExtract<ReferenceScn2k, 1>(head + 8, end, buf.get(),
+                                          buf.get() + size);
+    int offset = read_little_endian_int(buf.get() + 4);
+    const char* part = buf.get() + offset + 0x74;
+    int w = read_little_endian_short(part + 6);
+    int h = read_little_endian_short(part + 8);
+    const char* src = part + 0x5c;
+    int* dest = (int*)image;
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x) {
+        dest[y * width + x] = read_little_endian_int(src);
+        src += 4;
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------
+
+struct TestImage {
+  std::string name;
+  std::string data;
+  int width, height;
+};
+
+void AddImage(std::vector<TestImage>& images,
+              const std::string& name,
+              const std::string& data) {
+  std::unique_ptr<GRPCONV> conv(
+      GRPCONV::AssignConverter(data.data(), data.size(), name.c_str()));
+  if (!conv)
+    return;
+  images.push_back({name, data, conv->Width(), conv->Height()});
+}
+
+std::vector<TestImage> LoadTestImages() {
+  std::vector<TestImage> images;
+
+  std::vector<Pixel> cg = MakeCg();
+  AddImage(images, "synthetic type 0 g00", MakeG00Type0(cg));
+  AddImage(images, "synthetic type 1 g00", MakeG00Type1(cg));
+  AddImage(images, "synthetic type 2 g00", MakeG00Type2(cg));
+  AddImage(images, "synthetic masked pdt", MakePdt10(cg));
+
+  // Plus whatever real images the test game directories carry.
+  fs::path root = fs::path(locateTestCase("Gameroot")).parent_path();
+  for (fs::recursive_directory_iterator it(root), end; it != end; ++it) {
+    std::string ext = it->path().extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if ((ext != ".g00" && ext != ".pdt") || fs::file_size(it->path()) == 0)
+      continue;
+    std::ifstream file(it->path().string().c_str(), std::ios::binary);
+    AddImage(images, it->path().string(),
+             std::string(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>()));
+  }
+  return images;
+}
+
+}  // namespace
+
+// Decodes every test image through GRPCONV and through the per-unit decoders
+// it replaced, checking that both produce the same pixels.
+RLVM_BENCHMARK(ImageDecode) {
+  std::vector<TestImage> images = LoadTestImages();
+  size_t total_bytes = 0;
+  size_t largest = 0;
+  for (const TestImage& image : images) {
+    size_t bytes = size_t(image.width) * image.height * 4;
+    total_bytes += bytes;
+    largest = std::max(largest, bytes);
+  }
+  bench.Report("images", images.size(), "");
+  bench.Report("decoded pixels", total_bytes, "bytes");
+
+  std::vector<char> fast(largest + 1024), reference(largest + 1024);
+  auto decode = [](const TestImage& image, char* out) {
+    std::unique_ptr<GRPCONV> conv(GRPCONV::AssignConverter(
+        image.data.data(), image.data.size(), image.name.c_str()));
+    conv->Read(out);
+  };
+
+  for (const TestImage& image : images) {
+    size_t bytes = size_t(image.width) * image.height * 4;
+    std::fill(fast.begin(), fast.end(), 0);
+    std::fill(reference.begin(), reference.end(), 0);
+    decode(image, fast.data());
+    ReferenceRead(image.data, image.width, image.height, reference.data());
+    if (memcmp(fast.data(), reference.data(), bytes) != 0) {
+      bench.Fail("GRPCONV output differs from the reference decoder for " +
+                 image.name);
+      return;
+    }
+  }
+
+  for (const TestImage& image : images) {
+    size_t bytes = size_t(image.width) * image.height * 4;
+    bench.Time("reference, " + image.name, [&]() {
+      ReferenceRead(image.data, image.width, image.height, reference.data());
+    }, bytes);
+    bench.Time("GRPCONV, " + image.name, [&]() {
+      decode(image, fast.data());
+    }, bytes);
+  }
+}
@@ -0,0 +1,99 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <string>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/intmemref.h"
+#include "machine/memory.h"
+#include "machine/rlmachine.h"
+#include "test_system/test_system.h"
+#include "test_utils.h"
+
+using libreallive::IntMemRef;
+
+namespace {
+
+struct BankView {
+  const char* label;
+  const char* access;
+  int elements;
+};
+
+const BankView kViews[] = {
+  {"Ab[]", "b", 64000},
+  {"A4b[]", "4b", 16000},
+  {"A8b[]", "8b", 8000},
+  {"A[]", "", 2000},
+};
+
+}  // namespace
+
+// Clears, fills and sums a whole bit bank the way setrng() and sum() used to,
+// one element at a time through Memory, and with the range operations.
+RLVM_BENCHMARK(BitBankRanges) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine machine(system, arc);
+  Memory& memory = machine.memory();
+
+  for (const BankView& view : kViews) {
+    const std::string label = view.label;
+    IntMemRef first('A', view.access, 0);
+    auto at = [&](int i) { return IntMemRef('A', view.access, i); };
+
+    int element_sum = 0;
+    bench.Time(label + " setrng+sum, per element", [&]() {
+      for (int i = 0; i < view.elements; ++i)
+        memory.SetIntValue(at(i), i);
+      element_sum = 0;
+      for (int i = 0; i < view.elements; ++i)
+        element_sum += memory.GetIntValue(at(i));
+    });
+
+    int range_sum = 0;
+    bench.Time(label + " setrng+sum, range", [&]() {
+      memory.FillIntRange(first, view.elements, 0);
+      memory.FillIntRange(at(view.elements / 3), view.elements / 3, 5);
+      range_sum = memory.SumIntRange(first, view.elements);
+    });
+
+    // Both paths must agree on what they read back.
+    memory.FillIntRange(first, view.elements, 0);
+    memory.FillIntRange(at(view.elements / 3), view.elements / 3, 5);
+    int expected = 0;
+    for (int i = 0; i < view.elements; ++i)
+      expected += memory.GetIntValue(at(i));
+    if (range_sum != expected || element_sum == 0)
+      bench.Fail(label + " range sum disagrees with element reads");
+
+    bench.Time(label + " cpyrng, range", [&]() {
+      memory.CopyIntRange(at(1), at(view.elements / 2), view.elements / 2);
+    });
+  }
+}
@@ -0,0 +1,208 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "systems/base/colour.h"
+#include "systems/base/pixel_transforms.h"
+
+namespace {
+
+// A full screen DC at the largest standard screen size.
+const int kWidth = 800;
+const int kHeight = 600;
+
+// -----------------------------------------------------------------------
+// The per pixel path the kernels replace
+// -----------------------------------------------------------------------
+
+struct Colour {
+  unsigned char r, g, b;
+};
+
+// Mirrors the ColourTransformer interface that TransformSurface() used to
+// call for each pixel.
+class ColourTransformer {
+ public:
+  virtual ~ColourTransformer() {}
+  virtual Colour operator()(const Colour& colour) const = 0;
+};
+
+class InvertColourTransformer : public ColourTransformer {
+ public:
+  virtual Colour operator()(const Colour& colour) const {
+    Colour out = {static_cast<unsigned char>(255 - colour.r),
+                  static_cast<unsigned char>(255 - colour.g),
+                  static_cast<unsigned char>(255 - colour.b)};
+    return out;
+  }
+};
+
+class MonoColourTransformer : public ColourTransformer {
+ public:
+  virtual Colour operator()(const Colour& colour) const {
+    float grayscale = 0.3 * colour.r + 0.59 * colour.g + 0.11 * colour.b;
+    if (grayscale > 255)
+      grayscale = 255;
+    unsigned char gray = static_cast<unsigned char>(grayscale);
+    Colour out = {gray, gray, gray};
+    return out;
+  }
+};
+
+class ApplyColourTransformer : public ColourTransformer {
+ public:
+  explicit ApplyColourTransformer(const RGBColour& colour) : colour_(colour) {}
+
+  int compose(int in_colour, int surface_colour) const {
+    if (in_colour > 0) {
+      return 255 -
+             ((static_cast<float>((255 - in_colour) * (255 - surface_colour)) /
+               (255 * 255)) *
+              255);
+    } else if (in_colour < 0) {
+      return (static_cast<float>(abs(in_colour) * surface_colour) /
+              (255 * 255)) *
+             255;
+    } else {
+      return surface_colour;
+    }
+  }
+
+  virtual Colour operator()(const Colour& colour) const {
+    Colour out = {static_cast<unsigned char>(compose(colour_.r(), colour.r)),
+                  static_cast<unsigned char>(compose(colour_.g(), colour.g)),
+                  static_cast<unsigned char>(compose(colour_.b(), colour.b))};
+    return out;
+  }
+
+ private:
+  RGBColour colour_;
+};
+
+// Unpacks each pixel, calls the transformer through its vtable and packs it
+// again, like the SDL_GetRGBA()/SDL_MapRGBA() loop did.
+void TransformReference(std::vector<uint32_t>& pixels,
+                        const ColourTransformer& transformer) {
+  for (uint32_t& pixel : pixels) {
+    Colour in = {static_cast<unsigned char>(pixel >> 16),
+                 static_cast<unsigned char>(pixel >> 8),
+                 static_cast<unsigned char>(pixel)};
+    Colour out = transformer(in);
+    pixel = (pixel & 0xff000000) | (uint32_t(out.r) << 16) |
+            (uint32_t(out.g) << 8) | out.b;
+  }
+}
+
+// A gradient with some noise, so every channel value turns up.
+std::vector<uint32_t> MakeScreen() {
+  std::vector<uint32_t> pixels(kWidth * kHeight);
+  uint32_t seed = 12345;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      seed = seed * 1103515245 + 12345;
+      uint32_t r = (x * 255 / kWidth) ^ ((seed >> 16) & 0x0f);
+      uint32_t g = y * 255 / kHeight;
+      uint32_t b = (seed >> 8) & 0xff;
+      pixels[y * kWidth + x] = 0xff000000 | (r << 16) | (g << 8) | b;
+    }
+  }
+  return pixels;
+}
+
+}  // namespace
+
+RLVM_BENCHMARK(PixelTransforms) {
+  const std::vector<uint32_t> screen = MakeScreen();
+  const size_t bytes = screen.size() * sizeof(uint32_t);
+  std::vector<uint32_t> reference, fast;
+
+  InvertColourTransformer invert;
+  MonoColourTransformer mono;
+  RGBColour colour(64, -96, 0);
+  ApplyColourTransformer apply(colour);
+  ToneCurveRGBMap apply_map = BuildApplyColourMap(colour);
+
+  struct Transform {
+    std::string name;
+    const ColourTransformer& reference;
+    std::function<void(uint32_t*, int)> kernel;
+  };
+  std::vector<Transform> transforms = {
+      {"invert", invert, &InvertPixels},
+      {"mono", mono, &MonoPixels},
+      {"apply colour",
+       apply,
+       [&](uint32_t* pixels, int count) {
+         ToneCurvePixels(pixels, count, apply_map);
+       }}};
+
+  PixelKernelLevel best = GetBestPixelKernelLevel();
+  bench.Report("best kernels: " + std::string(GetPixelKernelLevelName(best)),
+               best,
+               "");
+
+  for (const Transform& transform : transforms) {
+    reference = screen;
+    TransformReference(reference, transform.reference);
+
+    for (int level = PIXEL_KERNELS_SCALAR; level <= best; ++level) {
+      SetPixelKernelLevel(static_cast<PixelKernelLevel>(level));
+      fast = screen;
+      transform.kernel(fast.data(), fast.size());
+      if (fast != reference) {
+        bench.Fail(transform.name + " with " +
+                   GetPixelKernelLevelName(GetPixelKernelLevel()) +
+                   " kernels differs from the per pixel path");
+        SetPixelKernelLevel(best);
+        return;
+      }
+    }
+
+    bench.Time(transform.name + ", per pixel", [&]() {
+      fast = screen;
+      TransformReference(fast, transform.reference);
+    }, bytes);
+    for (int level = PIXEL_KERNELS_SCALAR; level <= best; ++level) {
+      SetPixelKernelLevel(static_cast<PixelKernelLevel>(level));
+      bench.Time(transform.name + ", " +
+                     GetPixelKernelLevelName(GetPixelKernelLevel()),
+                 [&]() {
+                   fast = screen;
+                   transform.kernel(fast.data(), fast.size());
+                 },
+                 bytes);
+    }
+  }
+
+  SetPixelKernelLevel(best);
+}
@@ -0,0 +1,232 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/intmemref.h"
+#include "machine/memory.h"
+#include "machine/rlmachine.h"
+#include "machine/serialization.h"
+#include "systems/base/graphics_object.h"
+#include "test_system/test_system.h"
+#include "test_utils.h"
+
+using libreallive::IntMemRef;
+
+namespace {
+
+// Fills local memory and the foreground objects the way a game in the middle
+// of a scene might.
+void PopulateMachine(RLMachine& machine) {
+  for (const auto& bank : LOCAL_INTEGER_BANKS) {
+    for (int i = 0; i < SIZE_OF_MEM_BANK; ++i)
+      machine.SetIntValue(IntMemRef(bank.second, i), i * 7919);
+  }
+  for (int i = 0; i < SIZE_OF_MEM_BANK; ++i)
+    machine.SetStringValue(libreallive::STRS_LOCATION, i,
+                           "String value " + std::to_string(i));
+  machine.MarkSavepoint();
+
+  GraphicsSystem& graphics = machine.system().graphics();
+  for (int i = 0; i < 256; ++i) {
+    GraphicsObject& obj = graphics.GetObject(0, i);
+    obj.SetVisible(1);
+    obj.SetX(i);
+    obj.SetPattNo(i % 4);
+    obj.SetAlpha(128);
+  }
+}
+
+}  // namespace
+
+// Saves and loads a populated machine in the binary save format and in the
+// zlib'd text archive it replaced.
+RLVM_BENCHMARK(SaveGame) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine machine(system, arc);
+  PopulateMachine(machine);
+
+  std::string binary, legacy;
+  bench.Time("save, binary", [&]() {
+    std::ostringstream oss;
+    Serialization::saveGameTo(oss, machine);
+    binary = oss.str();
+  });
+  bench.Time("save, text", [&]() {
+    std::ostringstream oss;
+    Serialization::saveLegacyGameTo(oss, machine);
+    legacy = oss.str();
+  });
+  bench.Report("size, binary", binary.size(), "bytes");
+  bench.Report("size, text", legacy.size(), "bytes");
+
+  bench.Time("header, binary", [&]() {
+    std::istringstream iss(binary);
+    Serialization::loadHeaderFrom(iss);
+  });
+  bench.Time("header, text", [&]() {
+    std::istringstream iss(legacy);
+    Serialization::loadHeaderFrom(iss);
+  });
+
+  RLMachine binary_machine(system, arc);
+  bench.Time("load, binary", [&]() {
+    std::istringstream iss(binary);
+    Serialization::loadGameFrom(iss, binary_machine);
+  });
+  RLMachine legacy_machine(system, arc);
+  bench.Time("load, text", [&]() {
+    std::istringstream iss(legacy);
+    Serialization::loadGameFrom(iss, legacy_machine);
+  });
+
+  for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+    if (binary_machine.GetIntValue(IntMemRef('A', i)) != i * 7919 ||
+        legacy_machine.GetIntValue(IntMemRef('A', i)) != i * 7919) {
+      bench.Fail("A loaded game doesn't match the saved one");
+      break;
+    }
+  }
+}
+
+// Writes global memory after one kidoku bit changes, as a full snapshot and
+// as a journal entry.
+RLVM_BENCHMARK(SaveGlobalMemory) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine machine(system, arc);
+  PopulateMachine(machine);
+  for (int i = 0; i < 100; ++i)
+    machine.memory().RecordKidoku(i, 1000);
+
+  int kidoku = 0;
+  size_t snapshot_size = 0, journal_size = 0;
+  bench.Time("snapshot", [&]() {
+    machine.memory().RecordKidoku(1, kidoku++);
+    std::ostringstream oss;
+    Serialization::saveGlobalMemoryTo(oss, machine);
+    snapshot_size = oss.str().size();
+  });
+  bench.Time("journal", [&]() {
+    machine.memory().RecordKidoku(1, kidoku++);
+    std::ostringstream oss;
+    Serialization::saveGlobalMemoryChangesTo(oss, machine);
+    journal_size = oss.str().size();
+  });
+  bench.Report("size, snapshot", snapshot_size, "bytes");
+  bench.Report("size, journal", journal_size, "bytes");
+}
+
+// Initialises every local integer and string bank and marks a savepoint, the
+// way a script setting up big arrays does. Compares the savepoint journal
+// with the std::map of original values each bank used to have.
+RLVM_BENCHMARK(SavepointWrites) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine machine(system, arc);
+
+  const int writes = (LOCAL_INTEGER_BANKS.size() + 1) * SIZE_OF_MEM_BANK;
+  int round = 0;
+  auto fill = [&]() {
+    round++;
+    for (const auto& bank : LOCAL_INTEGER_BANKS) {
+      for (int i = 0; i < SIZE_OF_MEM_BANK; ++i)
+        machine.SetIntValue(IntMemRef(bank.second, i), i + round);
+    }
+    for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+      machine.SetStringValue(libreallive::STRS_LOCATION, i,
+                             round % 2 ? "odd" : "even");
+    }
+    machine.MarkSavepoint();
+  };
+
+  fill();
+  size_t before = Benchmark::allocations();
+  fill();
+  bench.Report("allocations per write",
+               double(Benchmark::allocations() - before) / writes,
+               "");
+  bench.Time("fill banks and mark a savepoint", fill);
+
+  // The same writes on bare banks, without going through RLMachine, first
+  // with the journal and then with a map of original values per bank, which
+  // is what each write used to cost.
+  static int bank[SIZE_OF_MEM_BANK];
+  static std::string strings[SIZE_OF_MEM_BANK];
+  std::vector<SavepointJournal<int>> journals(LOCAL_INTEGER_BANKS.size());
+  SavepointJournal<std::string> string_journal;
+  auto fill_with_journals = [&]() {
+    round++;
+    for (SavepointJournal<int>& journal : journals) {
+      for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+        journal.Record(i, bank[i]);
+        bank[i] = i + round;
+      }
+    }
+    for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+      string_journal.Record(i, strings[i]);
+      strings[i] = round % 2 ? "odd" : "even";
+    }
+    for (SavepointJournal<int>& journal : journals)
+      journal.Clear();
+    string_journal.Clear();
+  };
+  bench.Time("bare banks, journal", fill_with_journals);
+
+  std::vector<std::map<int, int>> originals(LOCAL_INTEGER_BANKS.size());
+  std::vector<std::map<int, std::string>> original_strings(1);
+  auto fill_with_maps = [&]() {
+    round++;
+    for (std::map<int, int>& original : originals) {
+      for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+        if (original.find(i) == original.end())
+          original.emplace(i, bank[i]);
+        bank[i] = i + round;
+      }
+    }
+    for (int i = 0; i < SIZE_OF_MEM_BANK; ++i) {
+      if (original_strings[0].find(i) == original_strings[0].end())
+        original_strings[0].emplace(i, strings[i]);
+      strings[i] = round % 2 ? "odd" : "even";
+    }
+    for (std::map<int, int>& original : originals)
+      original.clear();
+    original_strings[0].clear();
+  };
+  before = Benchmark::allocations();
+  fill_with_maps();
+  bench.Report("allocations per write, std::map",
+               double(Benchmark::allocations() - before) / writes,
+               "");
+  bench.Time("bare banks, std::map", fill_with_maps);
+}
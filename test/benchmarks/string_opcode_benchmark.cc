@@ -0,0 +1,145 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "benchmarks/benchmark.h"
+#include "libreallive/archive.h"
+#include "libreallive/expression.h"
+#include "libreallive/intmemref.h"
+#include "machine/rlmachine.h"
+#include "machine/rlmodule.h"
+#include "machine/rloperation.h"
+#include "machine/rloperation/rlop_store.h"
+#include "modules/module_str.h"
+#include "test_system/test_system.h"
+#include "test_utils.h"
+
+using libreallive::ExpressionPiecesVector;
+using libreallive::PrintableToParsableString;
+
+namespace {
+
+const int kDispatches = 10000;
+
+// strlen() as it was written against StrConstant_T, for comparison.
+struct CopyingStrlen : public RLStoreOpcode<StrConstant_T> {
+  int operator()(RLMachine& machine, std::string value) {
+    return value.size();
+  }
+};
+
+RLOperation* FindOperation(RLModule& module, int opcode, int overload) {
+  int packed = RLModule::PackOpcodeNumber(opcode, overload);
+  auto it = std::find_if(module.begin(), module.end(),
+                         [&](const RLModule::OpcodeMap::value_type& op) {
+                           return op.first == packed;
+                         });
+  return it == module.end() ? nullptr : it->second.get();
+}
+
+// Parses |printable| parameters for |op| and dispatches it kDispatches times.
+// Returns the number of allocations per dispatch.
+double DispatchRepeatedly(RLMachine& machine,
+                          RLOperation& op,
+                          const std::vector<std::string>& printable) {
+  std::vector<std::string> input;
+  for (const std::string& param : printable) {
+    input.push_back(param[0] == '"' ? param
+                                    : PrintableToParsableString(param));
+  }
+  ExpressionPiecesVector parameters;
+  op.ParseParameters(input, parameters);
+
+  // Let any destination strings grow to size first.
+  op.Dispatch(machine, parameters);
+
+  size_t before = Benchmark::allocations();
+  for (int i = 0; i < kDispatches; ++i)
+    op.Dispatch(machine, parameters);
+  return double(Benchmark::allocations() - before) / kDispatches;
+}
+
+}  // namespace
+
+// Dispatches the common Str opcodes on strings long enough to defeat the
+// small string optimization and counts what each call allocates.
+RLVM_BENCHMARK(StringOpcodes) {
+  TestSystem system(locateTestCase("Gameexe_data/Gameexe.ini"));
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine machine(system, arc);
+  StrModule module;
+
+  machine.SetStringValue(libreallive::STRS_LOCATION, 0,
+                         "The quick brown fox jumps over the lazy dog.");
+  machine.SetStringValue(libreallive::STRS_LOCATION, 1,
+                         "Pack my box with five dozen liquor jugs.");
+
+  const std::string kStrS0 = "$ 12 [ $ FF 00 00 00 00 ]";
+  const std::string kStrS1 = "$ 12 [ $ FF 01 00 00 00 ]";
+  const std::string kStrS2 = "$ 12 [ $ FF 02 00 00 00 ]";
+  struct Case {
+    const char* label;
+    int opcode;
+    std::vector<std::string> params;
+  } cases[] = {
+    {"strcpy", 0, {kStrS2, kStrS0}},
+    {"strlen", 3, {kStrS0}},
+    {"strcmp", 4, {kStrS0, kStrS1}},
+    {"strpos", 30, {kStrS0, "\"lazy dog and a much longer needle\""}},
+  };
+
+  double borrowed = 0;
+  for (const Case& c : cases) {
+    RLOperation* op = FindOperation(module, c.opcode, 0);
+    if (!op) {
+      bench.Fail(std::string("No Str opcode for ") + c.label);
+      return;
+    }
+
+    double allocations = 0;
+    bench.Time(c.label, [&]() {
+      allocations = DispatchRepeatedly(machine, *op, c.params);
+    });
+    bench.Report(std::string(c.label) + " allocations", allocations,
+                 "per call");
+    borrowed += allocations;
+  }
+
+  CopyingStrlen copying;
+  double copies = 0;
+  bench.Time("strlen, by value", [&]() {
+    copies = DispatchRepeatedly(machine, copying, {kStrS0});
+  });
+  bench.Report("strlen, by value allocations", copies, "per call");
+
+  if (borrowed != 0)
+    bench.Fail("Borrowed string parameters still allocate");
+}
@@ -0,0 +1,113 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "libreallive/archive.h"
+#include "libreallive/compression.h"
+
+#include "test_utils.h"
+
+using namespace libreallive;
+
+namespace {
+
+const compression::XorKey* const kKeys[] = {
+    NULL,
+    compression::little_busters_xor_mask,
+    compression::clannad_full_voice_xor_mask,
+    compression::little_busters_ex_xor_mask,
+    compression::snow_standard_edition_xor_mask,
+    compression::kud_wafter_xor_mask,
+    compression::kud_wafter_all_ages_xor_mask};
+
+}  // namespace
+
+// The fast decoder must produce byte for byte the same output as the original
+// implementation on every fixture, both with and without the per game keys.
+TEST(CompressionTest, MatchesReferenceDecoder) {
+  std::vector<std::string> scenarios = locateAllTestScenarios();
+  ASSERT_FALSE(scenarios.empty());
+
+  for (const std::string& path : scenarios) {
+    Archive arc(path);
+    for (Archive::const_iterator it = arc.begin(); it != arc.end(); ++it) {
+      const char* data = it->second.data;
+      const char* src = data + read_i32(data + 0x20);
+      const size_t src_len = read_i32(data + 0x28);
+      const size_t dst_len = read_i32(data + 0x24);
+
+      for (const compression::XorKey* key : kKeys) {
+        std::vector<char> fast(dst_len), reference(dst_len);
+        compression::Decompress(src, src_len, fast.data(), dst_len, key);
+        compression::ReferenceDecompress(src, src_len, reference.data(),
+                                         dst_len, key);
+        EXPECT_TRUE(fast == reference) << "Mismatch decompressing " << path;
+      }
+    }
+  }
+}
+
+// A back reference pointing before the start of the output is an error.
+TEST(CompressionTest, RejectsCorruptBackReference) {
+  // An eight byte header followed by a flag byte and token that, once the
+  // first level xor is undone, decode to a back reference into nothing.
+  Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  const char* data = arc.begin()->second.data;
+  const char* src = data + read_i32(data + 0x20);
+
+  std::vector<char> block(src, src + 11);
+  // Flip the flag byte's first bit so the first token is a back reference.
+  block[8] ^= 0x01;
+  std::vector<char> out(64);
+  EXPECT_THROW(compression::Decompress(block.data(), block.size(), out.data(),
+                                       out.size(), NULL),
+               Error);
+  EXPECT_THROW(compression::ReferenceDecompress(block.data(), block.size(),
+                                                out.data(), out.size(), NULL),
+               Error);
+}
+
+// CompressLiterals() output decodes back to its input, including a partial
+// final group.
+TEST(CompressionTest, CompressLiteralsRoundTrips) {
+  std::string input;
+  for (int i = 0; i < 1027; ++i)
+    input.push_back(static_cast<char>(i * 37));
+
+  std::string block = CompressLiterals(input.data(), input.size());
+  std::vector<char> fast(input.size()), reference(input.size());
+  compression::Decompress(block.data(), block.size(), fast.data(),
+                          fast.size(), NULL);
+  compression::ReferenceDecompress(block.data(), block.size(),
+                                   reference.data(), reference.size(), NULL);
+  EXPECT_EQ(input, std::string(fast.begin(), fast.end()));
+  EXPECT_EQ(input, std::string(reference.begin(), reference.end()));
+}
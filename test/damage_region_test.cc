@@ -0,0 +1,78 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include "systems/base/damage_region.h"
+
+namespace {
+const Rect kScreen = Rect::REC(0, 0, 640, 480);
+}  // namespace
+
+TEST(DamageRegionTest, StartsEmpty) {
+  DamageRegion damage;
+  EXPECT_TRUE(damage.empty());
+  EXPECT_FALSE(damage.is_full());
+  EXPECT_EQ(0, damage.GetBounds(kScreen).width());
+
+  damage.Add(Rect::REC(10, 10, 0, 20));
+  EXPECT_TRUE(damage.empty());
+}
+
+TEST(DamageRegionTest, BoundsCoverEveryArea) {
+  DamageRegion damage;
+  damage.Add(Rect::REC(0, 0, 10, 10));
+  damage.Add(Rect::REC(100, 100, 10, 10));
+  damage.Add(Rect::REC(10, 0, 10, 10));
+
+  EXPECT_FALSE(damage.empty());
+  EXPECT_EQ(Rect::REC(0, 0, 110, 110), damage.GetBounds(kScreen));
+}
+
+TEST(DamageRegionTest, FullCoversTheScreenUntilCleared) {
+  DamageRegion damage;
+  damage.Add(Rect::REC(0, 0, 10, 10));
+  damage.AddAll();
+  damage.Add(Rect::REC(50, 50, 10, 10));
+
+  EXPECT_TRUE(damage.is_full());
+  EXPECT_EQ(kScreen, damage.GetBounds(kScreen));
+
+  damage.Clear();
+  EXPECT_TRUE(damage.empty());
+}
+
+TEST(DamageRegionTest, BoundsAreClippedToTheScreen) {
+  DamageRegion damage;
+  damage.Add(Rect::REC(-10, 470, 30, 30));
+  EXPECT_EQ(Rect::REC(0, 470, 20, 10), damage.GetBounds(kScreen));
+
+  DamageRegion offscreen;
+  offscreen.Add(Rect::REC(700, 0, 10, 10));
+  EXPECT_EQ(0, offscreen.GetBounds(kScreen).width());
+}
@@ -0,0 +1,153 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "systems/base/decoded_image.h"
+#include "utilities/exception.h"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void PutInt(std::vector<char>& data, size_t offset, int value) {
+  for (int i = 0; i < 4; ++i)
+    data[offset + i] = (value >> (i * 8)) & 0xff;
+}
+
+fs::path WriteFile(const fs::path& dir,
+                   const std::string& extension,
+                   const std::vector<char>& data) {
+  fs::path path = dir / fs::unique_path("%%%%%%%%" + extension);
+  fs::ofstream file(path, std::ios::binary);
+  file.write(data.data(), data.size());
+  return path;
+}
+
+// Writes a 32-bit Windows BMP, one of the formats GRPCONV reads, where every
+// pixel has |alpha|.
+fs::path WriteBitmap(const fs::path& dir, int width, int height, int alpha) {
+  std::vector<char> data(0x36 + width * height * 4);
+  data[0] = 'B';
+  data[1] = 'M';
+  PutInt(data, 0x02, data.size());
+  PutInt(data, 0x0a, 0x36);
+  PutInt(data, 0x0e, 0x28);
+  PutInt(data, 0x12, width);
+  PutInt(data, 0x16, height);
+  data[0x1a] = 1;
+  data[0x1c] = 32;
+  PutInt(data, 0x22, width * height * 4);
+  for (int i = 0; i < width * height; ++i) {
+    data[0x36 + i * 4] = 0x10;
+    data[0x36 + i * 4 + 1] = 0x20;
+    data[0x36 + i * 4 + 2] = 0x30;
+    data[0x36 + i * 4 + 3] = alpha;
+  }
+
+  return WriteFile(dir, ".bmp", data);
+}
+
+// Writes a 20x1 type 0 g00 made of two literal pixels and two back
+// references, one of which overlaps the pixels it's writing.
+fs::path WriteG00Type0(const fs::path& dir) {
+  const unsigned char compressed[] = {
+      0x05,                    // Flags: literal, copy, literal, copy.
+      0x10, 0x20, 0x30,        // Pixel A.
+      0x1f, 0x00,              // 16 pixels from 1 back.
+      0x40, 0x50, 0x60,        // Pixel B.
+      0x21, 0x00};             // 2 pixels from 2 back.
+  std::vector<char> data(13);
+  data[0] = 0;
+  data[1] = 20;
+  data[3] = 1;
+  PutInt(data, 5, 8 + sizeof(compressed));
+  PutInt(data, 9, 20 * 3);
+  data.insert(data.end(), compressed, compressed + sizeof(compressed));
+  return WriteFile(dir, ".g00", data);
+}
+
+}  // namespace
+
+class DecodedImageTest : public ::testing::Test {
+ protected:
+  DecodedImageTest()
+      : dir(fs::temp_directory_path() / fs::unique_path("rlvm-%%%%%%%%")) {
+    fs::create_directories(dir);
+  }
+
+  ~DecodedImageTest() { fs::remove_all(dir); }
+
+  fs::path dir;
+};
+
+TEST_F(DecodedImageTest, DecodesOpaqueImage) {
+  std::shared_ptr<DecodedImage> image =
+      DecodeImageFile(WriteBitmap(dir, 4, 3, 0xff));
+  EXPECT_EQ(4, image->width);
+  EXPECT_EQ(3, image->height);
+  ASSERT_TRUE(image->pixels.get());
+  EXPECT_FALSE(image->has_alpha);
+
+  ASSERT_EQ(1u, image->regions.size());
+  EXPECT_EQ(Rect(Point(0, 0), Size(4, 3)), image->regions[0].rect);
+}
+
+TEST_F(DecodedImageTest, DetectsTranslucentPixels) {
+  std::shared_ptr<DecodedImage> image =
+      DecodeImageFile(WriteBitmap(dir, 2, 2, 0x80));
+  EXPECT_TRUE(image->has_alpha);
+}
+
+TEST_F(DecodedImageTest, DecodesG00Type0) {
+  std::shared_ptr<DecodedImage> image = DecodeImageFile(WriteG00Type0(dir));
+  ASSERT_EQ(20, image->width);
+  ASSERT_EQ(1, image->height);
+  ASSERT_TRUE(image->pixels.get());
+  EXPECT_FALSE(image->has_alpha);
+
+  const unsigned int a = 0xff302010, b = 0xff605040;
+  std::vector<unsigned int> expected(17, a);
+  expected.push_back(b);
+  expected.push_back(a);
+  expected.push_back(b);
+  const unsigned int* pixels =
+      reinterpret_cast<const unsigned int*>(image->pixels.get());
+  EXPECT_EQ(expected, std::vector<unsigned int>(pixels, pixels + 20));
+}
+
+TEST_F(DecodedImageTest, ThrowsOnMissingFile) {
+  EXPECT_THROW(DecodeImageFile(dir / "missing.g00"), rlvm::Exception);
+}
@@ -0,0 +1,98 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "systems/base/decoded_voice_cache.h"
+#include "systems/base/voice_archive.h"
+
+namespace {
+
+// A sample that records how many times it has been decoded.
+class CountingVoiceSample : public VoiceSample {
+ public:
+  explicit CountingVoiceSample(char fill) : fill_(fill), decodes_(0) {}
+
+  virtual char* Decode(int* size) override {
+    decodes_++;
+    *size = 64;
+    char* data = new char[WAV_HEADER_SIZE + 64];
+    MakeWavHeader(data, 44100, 2, 2, WAV_HEADER_SIZE + 64);
+    memset(data + WAV_HEADER_SIZE, fill_, 64);
+    return data;
+  }
+
+  int decodes() const { return decodes_; }
+
+ private:
+  char fill_;
+  int decodes_;
+};
+
+}  // namespace
+
+TEST(DecodedVoiceCacheTest, PrefetchedVoicesAreHits) {
+  DecodedVoiceCache cache(4);
+  std::shared_ptr<CountingVoiceSample> sample(new CountingVoiceSample('a'));
+  cache.Prefetch(100001, sample);
+  cache.Prefetch(100001, sample);
+  cache.WaitUntilIdle();
+  EXPECT_EQ(1, sample->decodes());
+
+  std::unique_ptr<VoiceStream> stream = cache.OpenStream(100001);
+  ASSERT_TRUE(stream.get());
+  EXPECT_EQ(44100, stream->rate());
+  EXPECT_EQ(2, stream->channels());
+
+  char buffer[128];
+  EXPECT_EQ(64, stream->Read(buffer, sizeof(buffer)));
+  EXPECT_EQ('a', buffer[63]);
+
+  EXPECT_FALSE(cache.OpenStream(100002).get());
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+}
+
+TEST(DecodedVoiceCacheTest, KeepsOnlyTheNewestVoices) {
+  DecodedVoiceCache cache(2);
+  for (int id = 1; id <= 3; ++id)
+    cache.Prefetch(id, std::make_shared<CountingVoiceSample>('a' + id));
+  cache.WaitUntilIdle();
+
+  EXPECT_FALSE(cache.OpenStream(1).get());
+  std::unique_ptr<VoiceStream> stream = cache.OpenStream(3);
+  ASSERT_TRUE(stream.get());
+
+  char buffer[64];
+  EXPECT_EQ(64, stream->Read(buffer, sizeof(buffer)));
+  EXPECT_EQ('d', buffer[0]);
+}
@@ -0,0 +1,299 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+#include "systems/base/colour_filter_object_data.h"
+#include "systems/base/damage_region.h"
+#include "systems/base/draw_list.h"
+#include "systems/base/graphics_object.h"
+#include "systems/base/graphics_object_of_file.h"
+#include "systems/base/graphics_system.h"
+#include "systems/base/system.h"
+#include "test_system/mock_surface.h"
+
+#include "test_utils.h"
+
+namespace {
+
+// Keeps what would have been sent to the GPU.
+class RecordingDrawList : public DrawList {
+ public:
+  std::vector<std::vector<DrawRecord>> batches;
+
+ protected:
+  virtual void SubmitBatch(const DrawRecord* begin,
+                           const DrawRecord* end) override {
+    batches.emplace_back(begin, end);
+  }
+};
+
+std::shared_ptr<const Surface> SurfaceNamed(const std::string& name) {
+  return std::shared_ptr<const Surface>(
+      MockSurface::Create(name, Size(32, 32)));
+}
+
+DrawRecord RecordAt(std::shared_ptr<const Surface> surface, int x, int y) {
+  DrawRecord record;
+  record.surface = surface;
+  record.src = Rect(0, 0, Size(32, 32));
+  record.dst = Rect(x, y, Size(32, 32));
+  return record;
+}
+
+}  // namespace
+
+TEST(DrawListTest, GroupsDrawsOfTheSameSurface) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+  std::shared_ptr<const Surface> digit = SurfaceNamed("digit");
+
+  RecordingDrawList list;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(digit, 100, 0));
+  list.Add(RecordAt(button, 200, 0));
+  list.Add(RecordAt(digit, 300, 0));
+  list.Flush();
+
+  ASSERT_EQ(2u, list.batches.size());
+  ASSERT_EQ(2u, list.batches[0].size());
+  EXPECT_EQ(button, list.batches[0][0].surface);
+  EXPECT_EQ(0, list.batches[0][0].dst.x());
+  EXPECT_EQ(200, list.batches[0][1].dst.x());
+  ASSERT_EQ(2u, list.batches[1].size());
+  EXPECT_EQ(digit, list.batches[1][0].surface);
+
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(4, list.records_submitted());
+  EXPECT_EQ(2, list.batches_submitted());
+}
+
+TEST(DrawListTest, KeepsOrderOfOverlappingDraws) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+  std::shared_ptr<const Surface> cursor = SurfaceNamed("cursor");
+
+  // The cursor is drawn over the second button, so that button can't be
+  // moved under it to join the first.
+  RecordingDrawList list;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(cursor, 210, 10));
+  list.Add(RecordAt(button, 200, 0));
+  list.Sort();
+
+  ASSERT_EQ(3u, list.records().size());
+  EXPECT_EQ(button, list.records()[0].surface);
+  EXPECT_EQ(cursor, list.records()[1].surface);
+  EXPECT_EQ(button, list.records()[2].surface);
+  EXPECT_EQ(3u, list.GetBatches().size());
+}
+
+TEST(DrawListTest, DoesNotBatchDifferentState) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+
+  DrawRecord plain = RecordAt(button, 0, 0);
+  DrawRecord additive = RecordAt(button, 100, 0);
+  additive.composite_mode = 1;
+  DrawRecord tinted = RecordAt(button, 200, 0);
+  tinted.tint = RGBColour(255, 0, 0);
+  DrawRecord faded = RecordAt(button, 300, 0);
+  faded.alpha = 128;
+
+  EXPECT_FALSE(plain.SameState(additive));
+  EXPECT_FALSE(plain.SameState(tinted));
+  // Alpha without the shader is a vertex colour, so it doesn't split batches.
+  EXPECT_TRUE(plain.SameState(faded));
+
+  RecordingDrawList list;
+  list.Add(plain);
+  list.Add(additive);
+  list.Add(tinted);
+  list.Add(faded);
+  list.Flush();
+
+  ASSERT_EQ(3u, list.batches.size());
+  EXPECT_EQ(2u, list.batches[0].size());
+}
+
+TEST(DrawListTest, RotatedBoundsCoverTheTurnedImage) {
+  DrawRecord record = RecordAt(SurfaceNamed("arrow"), 100, 100);
+  EXPECT_EQ(record.dst, record.Bounds());
+
+  record.rotation = 450;
+  Rect bounds = record.Bounds();
+  EXPECT_LE(bounds.x(), 100 - 7);
+  EXPECT_LE(bounds.y(), 100 - 7);
+  EXPECT_GE(bounds.x2(), 132 + 7);
+  EXPECT_GE(bounds.y2(), 132 + 7);
+}
+
+TEST(DrawListTest, DamageIsWhereDrawsChanged) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+
+  RecordingDrawList list;
+  DamageRegion first;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(button, 100, 0));
+  list.CollectDamage(&first);
+  EXPECT_EQ(Rect::REC(0, 0, 132, 32),
+            first.GetBounds(Rect::REC(0, 0, 640, 480)));
+  list.Clear();
+
+  // The same frame again changes nothing.
+  DamageRegion same;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(button, 100, 0));
+  list.CollectDamage(&same);
+  EXPECT_TRUE(same.empty());
+  list.Clear();
+
+  // Moving the second button damages where it was and where it went.
+  DamageRegion moved;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(button, 100, 200));
+  list.CollectDamage(&moved);
+  EXPECT_EQ(Rect::REC(100, 0, 32, 232),
+            moved.GetBounds(Rect::REC(0, 0, 640, 480)));
+  list.Clear();
+
+  // Dropping it damages where it was.
+  DamageRegion removed;
+  list.Add(RecordAt(button, 0, 0));
+  list.CollectDamage(&removed);
+  EXPECT_EQ(Rect::REC(100, 200, 32, 32),
+            removed.GetBounds(Rect::REC(0, 0, 640, 480)));
+}
+
+TEST(DrawListTest, CustomDrawsRunInOrderOnTheirOwn) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+  int drawn = 0;
+
+  DrawRecord filter;
+  filter.dst = Rect::REC(0, 0, 640, 480);
+  filter.custom_draw = [&drawn]() { ++drawn; };
+  EXPECT_FALSE(filter.SameState(filter));
+
+  RecordingDrawList list;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(filter);
+  list.Add(RecordAt(button, 100, 0));
+  list.Flush();
+
+  // The filter covers both buttons, so they stay on either side of it.
+  EXPECT_EQ(1, drawn);
+  ASSERT_EQ(2u, list.batches.size());
+  EXPECT_EQ(3, list.batches_submitted());
+}
+
+TEST(DrawListTest, ClipToDropsDrawsOutsideTheArea) {
+  std::shared_ptr<const Surface> button = SurfaceNamed("button");
+
+  RecordingDrawList list;
+  list.Add(RecordAt(button, 0, 0));
+  list.Add(RecordAt(button, 100, 0));
+  list.Add(RecordAt(button, 200, 0));
+  // Touching the edge of the first button doesn't reach into it.
+  list.ClipTo(Rect::REC(32, 0, 100, 10));
+
+  ASSERT_EQ(1u, list.records().size());
+  EXPECT_EQ(100, list.records()[0].dst.x());
+}
+
+class DrawListObjectTest : public FullSystemTest {};
+
+TEST_F(DrawListObjectTest, ObjectsQueueTheirDraws) {
+  GraphicsObject obj;
+  obj.SetObjectData(new GraphicsObjectOfFile(system, "doesntmatter"));
+  obj.SetVisible(1);
+  obj.SetX(40);
+  obj.SetY(60);
+  obj.SetCompositeMode(1);
+
+  RecordingDrawList list;
+  obj.Render(0, NULL, &list, NULL);
+
+  ASSERT_EQ(1u, list.records().size());
+  const DrawRecord& record = list.records()[0];
+  EXPECT_TRUE(record.surface != nullptr);
+  EXPECT_EQ(Point(40, 60), record.dst.origin());
+  EXPECT_EQ(255, record.alpha);
+  EXPECT_EQ(1, record.composite_mode);
+  EXPECT_TRUE(list.batches.empty());
+}
+
+TEST_F(DrawListObjectTest, FadingAColourFilterIsDamage) {
+  GraphicsObject obj;
+  obj.SetObjectData(
+      new ColourFilterObjectData(system.graphics(), Rect::REC(0, 0, 64, 48)));
+  obj.SetVisible(1);
+  obj.SetColour(RGBAColour(255, 0, 0, 128));
+
+  RecordingDrawList list;
+  DamageRegion first;
+  obj.Render(0, NULL, &list, NULL);
+  list.CollectDamage(&first);
+  list.Clear();
+
+  // Only the filter's alpha changes.
+  obj.SetAlpha(100);
+  DamageRegion faded;
+  obj.Render(0, NULL, &list, NULL);
+  ASSERT_EQ(1u, list.records().size());
+  EXPECT_EQ(100, list.records()[0].alpha);
+  list.CollectDamage(&faded);
+  EXPECT_EQ(Rect::REC(0, 0, 64, 48),
+            faded.GetBounds(Rect::REC(0, 0, 640, 480)));
+}
+
+TEST_F(DrawListObjectTest, ScreenDamage) {
+  GraphicsSystem& graphics = system.graphics();
+  graphics.Refresh(NULL);
+  EXPECT_TRUE(graphics.damage().empty());
+  EXPECT_EQ(graphics.screen_rect(),
+            graphics.frame_statistics().last_frame_area);
+
+  // Moving the mouse and changing objects don't damage anything by
+  // themselves.
+  graphics.MarkScreenAsDirty(GUT_MOUSE_MOTION);
+  graphics.MarkScreenAsDirty(GUT_DISPLAY_OBJ);
+  EXPECT_TRUE(graphics.damage().empty());
+
+  graphics.MarkScreenAreaAsDirty(GUT_TEXTSYS, Rect::REC(10, 10, 20, 20));
+  EXPECT_EQ(Rect::REC(10, 10, 20, 20),
+            graphics.damage().GetBounds(graphics.screen_rect()));
+  EXPECT_FALSE(graphics.damage().is_full());
+
+  graphics.MarkScreenAsDirty(GUT_DRAW_DC0);
+  EXPECT_TRUE(graphics.damage().is_full());
+
+  int frames = graphics.frame_statistics().frames;
+  graphics.Refresh(NULL);
+  EXPECT_TRUE(graphics.damage().empty());
+  EXPECT_EQ(frames + 1, graphics.frame_statistics().frames);
+}
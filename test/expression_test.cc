@@ -28,8 +28,11 @@
 #include "gtest/gtest.h"
 
 #include "libreallive/archive.h"
+#include "libreallive/bytecode.h"
 #include "libreallive/expression.h"
+#include "libreallive/expression_program.h"
 #include "libreallive/intmemref.h"
+#include "libreallive/scenario.h"
 #include "machine/rlmachine.h"
 #include "modules/module_jmp.h"
 #include "test_system/test_system.h"
@@ -148,3 +151,149 @@ TEST(ExpressionTest, ParseQuotedEnglishString) {
 
   ASSERT_EQ(16, libreallive::NextString(s.c_str()));
 }
+
+// Compiled expressions fold constant subexpressions, including the uniary
+// minus the parser leaves alone.
+TEST(ExpressionTest, CompiledConstantFolding) {
+  ExpressionPiece piece = ExpressionPiece::BinaryExpression(
+      2,
+      ExpressionPiece::UniaryExpression(1, ExpressionPiece::IntConstant(5)),
+      ExpressionPiece::BinaryExpression(
+          0,
+          ExpressionPiece::IntConstant(3),
+          ExpressionPiece::UniaryExpression(
+              1, ExpressionPiece::IntConstant(1))));
+  ExpressionProgram program(piece);
+  ASSERT_TRUE(program.IsConstant());
+
+  TestSystem system;
+  libreallive::Archive arc(
+      locateTestCase("ExpressionTest_SEEN/basicOperators.TXT"));
+  RLMachine rlmachine(system, arc);
+  EXPECT_EQ(-10, program.Evaluate(rlmachine));
+  EXPECT_EQ(-10, piece.GetIntegerValue(rlmachine));
+}
+
+// intA[intB[0]] += intA[1] has to read the location before the value and
+// read it again to store, just like the tree walk.
+TEST(ExpressionTest, CompiledIndirectCompoundAssignment) {
+  ExpressionPiece piece = ExpressionPiece::BinaryExpression(
+      20,
+      ExpressionPiece::MemoryReference(
+          INTA_LOCATION,
+          ExpressionPiece::MemoryReference(INTB_LOCATION,
+                                           ExpressionPiece::IntConstant(0))),
+      ExpressionPiece::MemoryReference(INTA_LOCATION,
+                                       ExpressionPiece::IntConstant(1)));
+  ExpressionProgram program(piece);
+  ASSERT_FALSE(program.empty());
+
+  TestSystem system;
+  libreallive::Archive arc(
+      locateTestCase("ExpressionTest_SEEN/basicOperators.TXT"));
+  RLMachine rlmachine(system, arc);
+  rlmachine.SetIntValue(IntMemRef('B', 0), 3);
+  rlmachine.SetIntValue(IntMemRef('A', 1), 4);
+  rlmachine.SetIntValue(IntMemRef('A', 3), 10);
+
+  EXPECT_EQ(14, program.Evaluate(rlmachine));
+  EXPECT_EQ(14, rlmachine.GetIntValue(IntMemRef('A', 3)));
+  EXPECT_EQ(18, program.Evaluate(rlmachine));
+  EXPECT_EQ(18, rlmachine.GetIntValue(IntMemRef('A', 3)));
+}
+
+// Every expression statement in the test scenarios evaluates to the same
+// value and leaves memory in the same state whether it is compiled or not.
+TEST(ExpressionTest, CompiledMatchesTree) {
+  int compiled = 0;
+  for (const std::string& path : locateAllTestScenarios()) {
+    libreallive::Archive arc(path);
+    for (auto it = arc.begin(); it != arc.end(); ++it) {
+      libreallive::Scenario* scenario = arc.GetScenario(it->first);
+      for (const BytecodeElement* element : *scenario) {
+        const ExpressionElement* expression =
+            dynamic_cast<const ExpressionElement*>(element);
+        if (!expression || expression->CompiledExpression().empty())
+          continue;
+
+        TestSystem tree_system, compiled_system;
+        RLMachine tree(tree_system, arc), program(compiled_system, arc);
+        for (RLMachine* machine : {&tree, &program}) {
+          for (int i = 0; i < 10; ++i) {
+            machine->SetIntValue(IntMemRef('A', i), i * 7 % 10);
+            machine->SetIntValue(IntMemRef('B', i), 9 - i);
+          }
+          machine->set_store_register(5);
+        }
+
+        // Out of range accesses must fail the same way, too.
+        int tree_value = 0, compiled_value = 0;
+        bool tree_threw = false, compiled_threw = false;
+        try {
+          tree_value = expression->ParsedExpression().GetIntegerValue(tree);
+        } catch (std::exception& e) {
+          tree_threw = true;
+        }
+        try {
+          compiled_value = expression->CompiledExpression().Evaluate(program);
+        } catch (std::exception& e) {
+          compiled_threw = true;
+        }
+        EXPECT_EQ(tree_threw, compiled_threw)
+            << expression->ParsedExpression().GetDebugString();
+        EXPECT_EQ(tree_value, compiled_value)
+            << expression->ParsedExpression().GetDebugString();
+        EXPECT_EQ(tree.store_register(), program.store_register());
+        for (char bank : std::string("ABCDEFGZL")) {
+          for (int i = 0; i < 20; ++i) {
+            EXPECT_EQ(tree.GetIntValue(IntMemRef(bank, i)),
+                      program.GetIntValue(IntMemRef(bank, i)))
+                << expression->ParsedExpression().GetDebugString();
+          }
+        }
+        compiled++;
+      }
+    }
+  }
+
+  EXPECT_GT(compiled, 0);
+}
+
+// Compiled opcode parameters evaluate through their program, keep it when
+// copied, and leave string parameters to the tree.
+TEST(ExpressionTest, CompiledParameters) {
+  ExpressionPiece tree = ExpressionPiece::BinaryExpression(
+      43,
+      ExpressionPiece::BinaryExpression(
+          0,
+          ExpressionPiece::MemoryReference(
+              INTA_LOCATION,
+              ExpressionPiece::MemoryReference(
+                  INTB_LOCATION, ExpressionPiece::IntConstant(0))),
+          ExpressionPiece::IntConstant(2)),
+      ExpressionPiece::MemoryReference(INTA_LOCATION,
+                                       ExpressionPiece::IntConstant(1)));
+  ExpressionPiece compiled(tree);
+  compiled.CompileIntegerValue();
+  ExpressionPiece copy(compiled);
+
+  TestSystem system;
+  libreallive::Archive arc(
+      locateTestCase("ExpressionTest_SEEN/basicOperators.TXT"));
+  RLMachine rlmachine(system, arc);
+  rlmachine.SetIntValue(IntMemRef('B', 0), 3);
+  rlmachine.SetIntValue(IntMemRef('A', 1), 12);
+  for (int value : {5, 10, 11}) {
+    rlmachine.SetIntValue(IntMemRef('A', 3), value);
+    EXPECT_EQ(tree.GetIntegerValue(rlmachine),
+              compiled.GetIntegerValue(rlmachine)) << value;
+    EXPECT_EQ(tree.GetIntegerValue(rlmachine),
+              copy.GetIntegerValue(rlmachine)) << value;
+  }
+
+  ExpressionPiece string_ref = ExpressionPiece::MemoryReference(
+      STRS_LOCATION, ExpressionPiece::IntConstant(0));
+  string_ref.CompileIntegerValue();
+  rlmachine.SetStringValue(STRS_LOCATION, 0, "Text");
+  EXPECT_EQ("Text", string_ref.GetStringValue(rlmachine));
+}
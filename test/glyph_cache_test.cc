@@ -0,0 +1,173 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "systems/base/colour.h"
+#include "systems/base/glyph_cache.h"
+
+namespace {
+
+std::vector<uint8_t> MakeMask(const Size& size, uint8_t seed) {
+  std::vector<uint8_t> mask(size.width() * size.height());
+  for (size_t i = 0; i < mask.size(); ++i)
+    mask[i] = static_cast<uint8_t>(seed + i * 37);
+  return mask;
+}
+
+const GlyphCache::Glyph* InsertMask(GlyphCache& cache,
+                                    const std::string& text,
+                                    int size,
+                                    const std::vector<uint8_t>& mask,
+                                    const Size& mask_size) {
+  return cache.Insert(
+      text, size, false, mask_size, mask.data(), mask_size.width());
+}
+
+}  // namespace
+
+TEST(GlyphCacheTest, KeysOnTextSizeAndItalic) {
+  GlyphCache cache(Size(64, 64), 1);
+  std::vector<uint8_t> mask = MakeMask(Size(8, 10), 3);
+  EXPECT_EQ(NULL, cache.Find("\xe6\xbc\xa2", 25, false));
+  InsertMask(cache, "\xe6\xbc\xa2", 25, mask, Size(8, 10));
+
+  const GlyphCache::Glyph* glyph = cache.Find("\xe6\xbc\xa2", 25, false);
+  ASSERT_TRUE(glyph != NULL);
+  EXPECT_EQ(Size(8, 10), glyph->size);
+  for (int y = 0; y < 10; ++y) {
+    for (int x = 0; x < 8; ++x)
+      EXPECT_EQ(mask[y * 8 + x], glyph->coverage[y * glyph->pitch + x]);
+  }
+
+  EXPECT_EQ(NULL, cache.Find("\xe6\xbc\xa2", 26, false));
+  EXPECT_EQ(NULL, cache.Find("\xe6\xbc\xa2", 25, true));
+  EXPECT_EQ(NULL, cache.Find("a", 25, false));
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(4, cache.misses());
+}
+
+TEST(GlyphCacheTest, StartsOverWhenThePagesFill) {
+  GlyphCache cache(Size(16, 16), 1);
+  std::vector<uint8_t> mask = MakeMask(Size(8, 8), 0);
+  for (int i = 0; i < 4; ++i)
+    InsertMask(cache, std::string(1, 'a' + i), 12, mask, Size(8, 8));
+  EXPECT_EQ(4, cache.glyph_count());
+  EXPECT_EQ(1, cache.page_count());
+
+  const GlyphCache::Glyph* glyph =
+      InsertMask(cache, "e", 12, mask, Size(8, 8));
+  ASSERT_TRUE(glyph != NULL);
+  EXPECT_EQ(1, cache.glyph_count());
+  EXPECT_EQ(1, cache.page_count());
+  EXPECT_EQ(NULL, cache.Find("a", 12, false));
+  EXPECT_EQ(glyph, cache.Find("e", 12, false));
+}
+
+TEST(GlyphCacheTest, KeepsGlyphsTooBigForAPage) {
+  GlyphCache cache(Size(16, 16), 1);
+  std::vector<uint8_t> mask = MakeMask(Size(20, 4), 9);
+  const GlyphCache::Glyph* glyph =
+      InsertMask(cache, "W", 40, mask, Size(20, 4));
+  ASSERT_TRUE(glyph != NULL);
+  EXPECT_EQ(0, cache.page_count());
+  EXPECT_EQ(mask[3 * 20 + 19], glyph->coverage[3 * glyph->pitch + 19]);
+}
+
+TEST(GlyphCacheTest, RemembersAdvances) {
+  GlyphCache cache(Size(16, 16), 1);
+  int advance = 0;
+  EXPECT_FALSE(cache.FindAdvance(25, 0x6f22, &advance));
+  cache.SetAdvance(25, 0x6f22, 25);
+  cache.SetAdvance(12, 0x6f22, 12);
+  ASSERT_TRUE(cache.FindAdvance(25, 0x6f22, &advance));
+  EXPECT_EQ(25, advance);
+  ASSERT_TRUE(cache.FindAdvance(12, 0x6f22, &advance));
+  EXPECT_EQ(12, advance);
+
+  // Advances outlive the glyphs.
+  cache.Clear();
+  EXPECT_TRUE(cache.FindAdvance(25, 0x6f22, &advance));
+}
+
+// The blend must match pygame's ALPHA_BLEND() on a TTF_RenderUTF8_Blended()
+// surface, which is the colour everywhere with the coverage as alpha.
+TEST(GlyphCacheTest, BlendsLikePygame) {
+  GlyphCache cache(Size(64, 64), 1);
+  const uint8_t coverage[] = {0, 128, 255, 64};
+  const GlyphCache::Glyph* glyph =
+      cache.Insert("x", 10, false, Size(4, 1), coverage, 4);
+
+  RGBColour colour(200, 100, 50);
+  std::vector<uint32_t> surface = {
+      0x00000000, 0x00000000, 0x80102030, 0xff102030, 0xff102030};
+  Rect written = GlyphCache::Blend(
+      *glyph, colour, Point(1, 0), surface.data(), 20, Size(5, 1));
+  EXPECT_EQ(Rect::REC(1, 0, 4, 1), written);
+
+  // Untouched, then straight copies onto transparent pixels.
+  EXPECT_EQ(0x00000000u, surface[0]);
+  EXPECT_EQ(0x00c86432u, surface[1]);
+
+  int dR = 0x10, dG = 0x20, dB = 0x30;
+  auto blend = [](int s, int d, int a) {
+    return ((d << 8) + (s - d) * a + s) >> 8;
+  };
+  EXPECT_EQ((uint32_t(128 + 0x80 - (128 * 0x80) / 255) << 24) |
+                (blend(200, dR, 128) << 16) | (blend(100, dG, 128) << 8) |
+                blend(50, dB, 128),
+            surface[2]);
+  EXPECT_EQ((0xffu << 24) | (blend(200, dR, 255) << 16) |
+                (blend(100, dG, 255) << 8) | blend(50, dB, 255),
+            surface[3]);
+  EXPECT_EQ((0xffu << 24) | (blend(200, dR, 64) << 16) |
+                (blend(100, dG, 64) << 8) | blend(50, dB, 64),
+            surface[4]);
+}
+
+TEST(GlyphCacheTest, BlendClipsToTheSurface) {
+  GlyphCache cache(Size(64, 64), 1);
+  std::vector<uint8_t> mask(16, 255);
+  const GlyphCache::Glyph* glyph =
+      cache.Insert("x", 10, false, Size(4, 4), mask.data(), 4);
+
+  std::vector<uint32_t> surface(9, 0xff000000);
+  Rect written = GlyphCache::Blend(*glyph,
+                                   RGBColour::White(),
+                                   Point(-2, 1),
+                                   surface.data(),
+                                   12,
+                                   Size(3, 3));
+  EXPECT_EQ(Rect::REC(0, 1, 2, 2), written);
+  EXPECT_EQ(0xff000000u, surface[0]);
+  EXPECT_EQ(0xffffffffu, surface[3]);
+  EXPECT_EQ(0xffffffffu, surface[4]);
+  EXPECT_EQ(0xff000000u, surface[5]);
+  EXPECT_EQ(0xffffffffu, surface[7]);
+}
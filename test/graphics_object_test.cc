@@ -286,12 +286,12 @@ TEST_F(GraphicsObjectTest, TestColourFilter) {
   EXPECT_CALL(*filter, Fill(_, two, _));
 
   // Render as is (for the first call).
-  data->Render(obj, NULL, NULL);
+  data->Render(obj, NULL, NULL, NULL);
 
   data->set_rect(two);
 
   // Render with the modified rect (for the second call).
-  data->Render(obj, NULL, NULL);
+  data->Render(obj, NULL, NULL, NULL);
 }
 
 TEST_F(GraphicsObjectTest, objFgFreeAll) {
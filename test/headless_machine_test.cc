@@ -0,0 +1,96 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "libreallive/archive.h"
+#include "libreallive/intmemref.h"
+#include "long_operations/wait_long_operation.h"
+#include "modules/module_jmp.h"
+#include "modules/module_str.h"
+#include "test_system/headless_machine.h"
+#include "test_system/test_system.h"
+
+#include "test_utils.h"
+
+using libreallive::IntMemRef;
+
+class HeadlessMachineTest : public ::testing::Test {
+ protected:
+  HeadlessMachineTest()
+      : arc(locateTestCase("Module_Jmp_SEEN/fibonacci.TXT")),
+        rlmachine(system, arc) {
+    rlmachine.AttachModule(new JmpModule);
+    rlmachine.AttachModule(new StrModule);
+    rlmachine.SetIntValue(IntMemRef('D', 0), 10);
+  }
+
+  libreallive::Archive arc;
+  TestSystem system;
+  HeadlessMachine rlmachine;
+};
+
+TEST_F(HeadlessMachineTest, TimeOnlyMovesWhenWaiting) {
+  rlmachine.Run();
+  EXPECT_TRUE(rlmachine.halted());
+  EXPECT_EQ(55, rlmachine.GetIntValue(IntMemRef('E', 0)));
+  EXPECT_LT(0u, rlmachine.instructions());
+  EXPECT_EQ(0u, rlmachine.frames());
+  EXPECT_EQ(0u, rlmachine.virtual_time());
+}
+
+TEST_F(HeadlessMachineTest, WaitsTakeVirtualTime) {
+  rlmachine.set_frame_length(10);
+  WaitLongOperation* wait = new WaitLongOperation(rlmachine);
+  wait->WaitMilliseconds(5000);
+  rlmachine.PushLongOperation(wait);
+
+  rlmachine.Run();
+  EXPECT_TRUE(rlmachine.halted());
+  EXPECT_EQ(55, rlmachine.GetIntValue(IntMemRef('E', 0)));
+  EXPECT_GT(rlmachine.virtual_time(), 5000u);
+  EXPECT_LE(rlmachine.virtual_time(), 5010u);
+  EXPECT_EQ(0, rlmachine.clicks());
+}
+
+TEST_F(HeadlessMachineTest, EventSystemWaitAdvancesClock) {
+  unsigned int before = system.event().GetTicks();
+  system.event().Wait(250);
+  EXPECT_EQ(before + 250, system.event().GetTicks());
+}
+
+TEST_F(HeadlessMachineTest, ClicksThroughStalledOperations) {
+  rlmachine.set_stall_limit(1000);
+  WaitLongOperation* wait = new WaitLongOperation(rlmachine);
+  wait->BreakOnClicks();
+  rlmachine.PushLongOperation(wait);
+
+  rlmachine.Run();
+  EXPECT_TRUE(rlmachine.halted());
+  EXPECT_EQ(1, rlmachine.clicks());
+  EXPECT_EQ(55, rlmachine.GetIntValue(IntMemRef('E', 0)));
+}
@@ -268,7 +268,7 @@ int main(int argc, char* argv[]) {
       sdlSystem.set_force_wait(false);
     }
 
-    Serialization::saveGlobalMemory(rlmachine);
+    Serialization::compactGlobalMemory(rlmachine);
   }
   catch (rlvm::Exception& e) {
     cerr << "Fatal RLVM error: " << e.what() << endl;
@@ -0,0 +1,198 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "machine/packed_bank.h"
+
+namespace {
+
+const int kWords = 64;
+const int kWidths[] = {1, 2, 4, 8, 16, 32};
+
+// The element at a time definitions from Memory::GetIntValue() and
+// Memory::SetIntValue() that the word level operations must match.
+int Get(const std::vector<int>& bank, int width, int location) {
+  if (width == 32)
+    return bank[location];
+  int per_word = 32 / width;
+  uint32_t word = bank[location / per_word];
+  return (word >> ((location % per_word) * width)) & ((1u << width) - 1);
+}
+
+void Set(std::vector<int>& bank, int width, int location, int value) {
+  if (width == 32) {
+    bank[location] = value;
+    return;
+  }
+  int per_word = 32 / width;
+  uint32_t mask = (1u << width) - 1;
+  int shift = (location % per_word) * width;
+  uint32_t word = bank[location / per_word];
+  word = (word & ~(mask << shift)) | ((uint32_t(value) & mask) << shift);
+  bank[location / per_word] = word;
+}
+
+std::vector<int> RandomBank(std::mt19937& rng) {
+  std::vector<int> bank(kWords);
+  for (int& word : bank)
+    word = rng();
+  return bank;
+}
+
+}  // namespace
+
+TEST(PackedBankTest, FillMatchesElementWrites) {
+  std::mt19937 rng(1);
+  for (int width : kWidths) {
+    int elements = kWords * 32 / width;
+    for (int trial = 0; trial < 200; ++trial) {
+      int first = rng() % elements;
+      int count = rng() % (elements - first + 1);
+      int value = rng();
+
+      std::vector<int> actual = RandomBank(rng);
+      std::vector<int> expected = actual;
+      packed_bank::Fill(actual.data(), width, first, count, value);
+      for (int i = 0; i < count; ++i)
+        Set(expected, width, first + i, value);
+      ASSERT_EQ(expected, actual) << "width " << width << " first " << first
+                                  << " count " << count;
+    }
+  }
+}
+
+TEST(PackedBankTest, StoreAndLoadMatchElementAccess) {
+  std::mt19937 rng(2);
+  for (int width : kWidths) {
+    int elements = kWords * 32 / width;
+    for (int trial = 0; trial < 200; ++trial) {
+      int first = rng() % elements;
+      int count = rng() % (elements - first + 1);
+      std::vector<int> values(count);
+      for (int& value : values)
+        value = rng();
+
+      std::vector<int> actual = RandomBank(rng);
+      std::vector<int> expected = actual;
+      packed_bank::Store(actual.data(), width, first, values.data(), count);
+      for (int i = 0; i < count; ++i)
+        Set(expected, width, first + i, values[i]);
+      ASSERT_EQ(expected, actual) << "width " << width;
+
+      std::vector<int> loaded(count);
+      packed_bank::Load(actual.data(), width, first, loaded.data(), count);
+      for (int i = 0; i < count; ++i)
+        ASSERT_EQ(Get(expected, width, first + i), loaded[i]);
+    }
+  }
+}
+
+TEST(PackedBankTest, SumMatchesElementReads) {
+  std::mt19937 rng(3);
+  for (int width : kWidths) {
+    int elements = kWords * 32 / width;
+    for (int trial = 0; trial < 200; ++trial) {
+      int first = rng() % elements;
+      int count = rng() % (elements - first + 1);
+      std::vector<int> bank = RandomBank(rng);
+
+      uint32_t expected = 0;
+      for (int i = 0; i < count; ++i)
+        expected += Get(bank, width, first + i);
+      ASSERT_EQ(int(expected),
+                packed_bank::Sum(bank.data(), width, first, count))
+          << "width " << width << " first " << first << " count " << count;
+    }
+  }
+}
+
+// Covers aligned and unaligned copies, copies between widths, and
+// overlapping copies in both directions within one bank.
+TEST(PackedBankTest, CopyMatchesReadingEverythingFirst) {
+  std::mt19937 rng(4);
+  for (int source_width : kWidths) {
+    for (int dest_width : kWidths) {
+      int elements = kWords * 32 / std::max(source_width, dest_width);
+      for (int trial = 0; trial < 100; ++trial) {
+        bool same_bank = trial % 2;
+        int count = rng() % (elements / 2);
+        int source_first = rng() % (elements - count + 1);
+        int dest_first = rng() % (elements - count + 1);
+
+        std::vector<int> source = RandomBank(rng);
+        std::vector<int> actual = same_bank ? source : RandomBank(rng);
+        std::vector<int> expected = actual;
+        const std::vector<int>& read = same_bank ? actual : source;
+
+        std::vector<int> values;
+        for (int i = 0; i < count; ++i)
+          values.push_back(Get(read, source_width, source_first + i));
+        for (int i = 0; i < count; ++i)
+          Set(expected, dest_width, dest_first + i, values[i]);
+
+        packed_bank::Copy(same_bank ? actual.data() : source.data(),
+                          source_width, source_first,
+                          actual.data(), dest_width, dest_first,
+                          count);
+        ASSERT_EQ(expected, actual)
+            << source_width << " -> " << dest_width << " from "
+            << source_first << " to " << dest_first << " count " << count;
+      }
+    }
+  }
+}
+
+TEST(PackedBankTest, EqualComparesOnlyTheRange) {
+  for (int width : kWidths) {
+    int elements = kWords * 32 / width;
+    std::vector<int> lhs(kWords, 0), rhs(kWords, 0);
+    for (int i = 0; i < elements / 2; ++i) {
+      Set(lhs, width, i + 3, i * 7);
+      Set(rhs, width, i + 5, i * 7);
+    }
+    // Noise just outside the compared ranges.
+    Set(lhs, width, 2, 1);
+    Set(rhs, width, 4, 1);
+
+    EXPECT_TRUE(packed_bank::Equal(lhs.data(), 3, rhs.data(), 5, width,
+                                   elements / 2));
+    EXPECT_FALSE(packed_bank::Equal(lhs.data(), 2, rhs.data(), 5, width,
+                                    elements / 2));
+    EXPECT_TRUE(packed_bank::Equal(lhs.data(), 3, lhs.data(), 3, width,
+                                   elements / 2));
+
+    Set(rhs, width, 5 + elements / 2 - 1, 0);
+    Set(lhs, width, 3 + elements / 2 - 1, 1);
+    EXPECT_FALSE(packed_bank::Equal(lhs.data(), 3, rhs.data(), 5, width,
+                                    elements / 2));
+  }
+}
@@ -0,0 +1,144 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "systems/base/colour.h"
+#include "systems/base/pixel_transforms.h"
+
+namespace {
+
+// Some pixels with every kind of byte in every position. An odd count, so
+// that the SIMD kernels have leftovers to do a pixel at a time.
+std::vector<uint32_t> NoisyPixels() {
+  std::vector<uint32_t> pixels(1001);
+  uint32_t seed = 42;
+  for (uint32_t& pixel : pixels) {
+    seed = seed * 1103515245 + 12345;
+    pixel = seed ^ (seed >> 13);
+  }
+  pixels[0] = 0xffffffff;
+  pixels[1] = 0;
+  return pixels;
+}
+
+// Restores the kernel level when a test is done with it.
+class PixelTransformsTest : public ::testing::Test {
+ protected:
+  PixelTransformsTest() : level_(GetPixelKernelLevel()) {}
+  ~PixelTransformsTest() { SetPixelKernelLevel(level_); }
+
+ private:
+  PixelKernelLevel level_;
+};
+
+}  // namespace
+
+TEST_F(PixelTransformsTest, InvertKeepsAlpha) {
+  uint32_t pixel = 0x80ff2000;
+  InvertPixels(&pixel, 1);
+  EXPECT_EQ(0x8000dfffu, pixel);
+}
+
+TEST_F(PixelTransformsTest, MonoMatchesTheFloatingPointFormula) {
+  // Every colour, a row of blues at a time.
+  std::vector<uint32_t> row(256);
+  for (int r = 0; r < 256; ++r) {
+    for (int g = 0; g < 256; ++g) {
+      for (int b = 0; b < 256; ++b)
+        row[b] = 0x7f000000 | (r << 16) | (g << 8) | b;
+      MonoPixels(&row[0], row.size());
+
+      for (int b = 0; b < 256; ++b) {
+        float grayscale = 0.3 * r + 0.59 * g + 0.11 * b;
+        uint32_t gray = static_cast<unsigned char>(grayscale);
+        uint32_t expected = 0x7f000000 | (gray << 16) | (gray << 8) | gray;
+        if (row[b] != expected) {
+          ADD_FAILURE() << "Wrong gray for " << r << ", " << g << ", " << b;
+          return;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(PixelTransformsTest, EveryLevelAgreesWithScalar) {
+  std::vector<uint32_t> input = NoisyPixels();
+
+  SetPixelKernelLevel(PIXEL_KERNELS_SCALAR);
+  ASSERT_EQ(PIXEL_KERNELS_SCALAR, GetPixelKernelLevel());
+  std::vector<uint32_t> inverted(input), mono(input);
+  InvertPixels(&inverted[0], inverted.size());
+  MonoPixels(&mono[0], mono.size());
+
+  for (int level = PIXEL_KERNELS_SSE2; level <= GetBestPixelKernelLevel();
+       ++level) {
+    SetPixelKernelLevel(static_cast<PixelKernelLevel>(level));
+    std::vector<uint32_t> out(input);
+    InvertPixels(&out[0], out.size());
+    EXPECT_EQ(inverted, out) << GetPixelKernelLevelName(GetPixelKernelLevel());
+
+    out = input;
+    MonoPixels(&out[0], out.size());
+    EXPECT_EQ(mono, out) << GetPixelKernelLevelName(GetPixelKernelLevel());
+  }
+}
+
+TEST_F(PixelTransformsTest, UnsupportedLevelsFallBack) {
+  SetPixelKernelLevel(PIXEL_KERNELS_AVX2);
+  EXPECT_EQ(GetBestPixelKernelLevel(), GetPixelKernelLevel());
+}
+
+TEST_F(PixelTransformsTest, ToneCurveMapsEachChannel) {
+  ToneCurveRGBMap map;
+  for (int i = 0; i < 256; ++i) {
+    map[0][i] = 255 - i;
+    map[1][i] = i / 2;
+    map[2][i] = 7;
+  }
+
+  uint32_t pixel = 0x12405060;
+  ToneCurvePixels(&pixel, 1, map);
+  EXPECT_EQ(0x12bf2807u, pixel);
+}
+
+TEST_F(PixelTransformsTest, ApplyColourLightensAndDarkens) {
+  ToneCurveRGBMap map = BuildApplyColourMap(RGBColour(255, -128, 0));
+  uint32_t pixel = 0xff00ff80;
+  ToneCurvePixels(&pixel, 1, map);
+
+  // Red goes all the way to white, green is roughly halved and blue is left
+  // alone.
+  EXPECT_EQ(0xffu, (pixel >> 16) & 0xff);
+  EXPECT_EQ(128u, (pixel >> 8) & 0xff);
+  EXPECT_EQ(0x80u, pixel & 0xff);
+  EXPECT_EQ(0xffu, pixel >> 24);
+}
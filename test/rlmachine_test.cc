@@ -37,6 +37,7 @@
 #include "machine/serialization.h"
 #include "modules/module_str.h"
 #include "utilities/exception.h"
+#include "libreallive/defs.h"
 #include "libreallive/intmemref.h"
 #include "test_utils.h"
 
@@ -242,6 +243,109 @@ TEST_F(RLMachineTest, SerializationOfKidoku) {
   }
 }
 
+// Only the global memory changed since the last save goes in the journal,
+// and replaying it over the snapshot restores everything.
+TEST_F(RLMachineTest, GlobalMemoryJournal) {
+  stringstream snapshot, journal;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  {
+    RLMachine saveMachine(system, arc);
+    setIntMemoryCountingFrom(saveMachine, GLOBAL_INTEGER_BANKS, 0);
+    saveMachine.memory().RecordKidoku(5, 0);
+    Serialization::saveGlobalMemoryTo(snapshot, saveMachine);
+    EXPECT_TRUE(saveMachine.memory().global().changes.empty());
+
+    saveMachine.SetIntValue(IntMemRef('G', 3), -1);
+    saveMachine.SetIntValue(IntMemRef('Z', "b", 116), 1);
+    saveMachine.SetStringValue(STRM_LOCATION, 5, "changed");
+    saveMachine.memory().SetName(2, "Carol");
+    saveMachine.memory().RecordKidoku(5, 9);
+    saveMachine.SetIntValue(IntMemRef('G', 3), -1);
+    EXPECT_EQ(1u, saveMachine.memory().global().changes.intG.size());
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+    EXPECT_TRUE(saveMachine.memory().global().changes.empty());
+    EXPECT_GT(200u, journal.str().size());
+
+    // Nothing changed, so nothing more is written.
+    size_t size = journal.str().size();
+    saveMachine.memory().RecordKidoku(5, 9);
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+    EXPECT_EQ(size, journal.str().size());
+  }
+
+  {
+    RLMachine loadMachine(system, arc);
+    Serialization::loadGlobalMemoryFrom(snapshot, loadMachine);
+    EXPECT_TRUE(
+        Serialization::loadGlobalMemoryChangesFrom(journal, loadMachine));
+
+    EXPECT_EQ(-1, loadMachine.GetIntValue(IntMemRef('G', 3)));
+    EXPECT_EQ(4, loadMachine.GetIntValue(IntMemRef('G', 4)));
+    EXPECT_EQ(2003 + (1 << 20), loadMachine.GetIntValue(IntMemRef('Z', 3)));
+    EXPECT_EQ("changed", loadMachine.GetStringValue(STRM_LOCATION, 5));
+    EXPECT_EQ("Carol", loadMachine.memory().GetName(2));
+    EXPECT_TRUE(loadMachine.memory().HasBeenRead(5, 0));
+    EXPECT_TRUE(loadMachine.memory().HasBeenRead(5, 9));
+    EXPECT_FALSE(loadMachine.memory().HasBeenRead(5, 8));
+    EXPECT_TRUE(loadMachine.memory().global().changes.empty());
+  }
+}
+
+// A record torn by a crash mid-write is dropped; the ones before it apply.
+TEST_F(RLMachineTest, GlobalMemoryJournalIgnoresTornRecords) {
+  stringstream journal;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  {
+    RLMachine saveMachine(system, arc);
+    saveMachine.SetIntValue(IntMemRef('G', 0), 1);
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+    saveMachine.SetStringValue(STRM_LOCATION, 0, "lost");
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+  }
+
+  string data = journal.str();
+  stringstream torn(data.substr(0, data.size() - 2));
+  RLMachine loadMachine(system, arc);
+  EXPECT_FALSE(Serialization::loadGlobalMemoryChangesFrom(torn, loadMachine));
+  EXPECT_EQ(1, loadMachine.GetIntValue(IntMemRef('G', 0)));
+  EXPECT_EQ("", loadMachine.GetStringValue(STRM_LOCATION, 0));
+}
+
+// A crash can also leave part of a record's header.
+TEST_F(RLMachineTest, GlobalMemoryJournalIgnoresTornHeaders) {
+  stringstream journal;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  {
+    RLMachine saveMachine(system, arc);
+    saveMachine.SetIntValue(IntMemRef('G', 0), 1);
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+  }
+
+  stringstream torn(journal.str() + string("\x01\x00\x00\x00\x05", 5));
+  RLMachine loadMachine(system, arc);
+  EXPECT_FALSE(Serialization::loadGlobalMemoryChangesFrom(torn, loadMachine));
+  EXPECT_EQ(1, loadMachine.GetIntValue(IntMemRef('G', 0)));
+}
+
+// A garbage length is dropped as torn rather than allocated.
+TEST_F(RLMachineTest, GlobalMemoryJournalRejectsHugeLengths) {
+  stringstream journal;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  {
+    RLMachine saveMachine(system, arc);
+    saveMachine.SetIntValue(IntMemRef('G', 0), 1);
+    Serialization::saveGlobalMemoryChangesTo(journal, saveMachine);
+  }
+
+  // A JOURNAL_STR_M record claiming to be nearly 4 GiB long.
+  string garbage("\x03\x00\x00\x00\x00\x00\x00\x00\xf0\xff\xff\xff", 12);
+  stringstream torn(journal.str() + garbage + "short");
+  RLMachine loadMachine(system, arc);
+  EXPECT_FALSE(Serialization::loadGlobalMemoryChangesFrom(torn, loadMachine));
+  EXPECT_EQ(1, loadMachine.GetIntValue(IntMemRef('G', 0)));
+  EXPECT_EQ("", loadMachine.GetStringValue(STRM_LOCATION, 0));
+}
+
 TEST_F(RLMachineTest, SerializationOfSavepointValues) {
   stringstream ss;
   libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
@@ -276,3 +380,187 @@ TEST_F(RLMachineTest, SerializationOfSavepointValues) {
     verifyStrMemoryCountingFrom(loadMachine, STRS_LOCATION, 0);
   }
 }
+
+// Values written after the last savepoint aren't saved, no matter how often
+// they're rewritten or through which bit width, until the next savepoint.
+TEST_F(RLMachineTest, SavepointJournalKeepsTheFirstOriginal) {
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine saveMachine(system, arc);
+  saveMachine.SetIntValue(IntMemRef('A', 10), 5);
+  saveMachine.SetStringValue(STRS_LOCATION, 3, "first");
+  saveMachine.MarkSavepoint();
+
+  saveMachine.SetIntValue(IntMemRef('A', 10), 6);
+  saveMachine.SetIntValue(IntMemRef('A', 10), 7);
+  saveMachine.SetIntValue(IntMemRef('A', "8b", 44), 255);
+  saveMachine.SetStringValue(STRS_LOCATION, 3, "second");
+  saveMachine.SetStringValue(STRS_LOCATION, 3, "third");
+
+  {
+    stringstream ss;
+    Serialization::saveGameTo(ss, saveMachine);
+    RLMachine loadMachine(system, arc);
+    Serialization::loadGameFrom(ss, loadMachine);
+    EXPECT_EQ(5, loadMachine.GetIntValue(IntMemRef('A', 10)));
+    EXPECT_EQ(0, loadMachine.GetIntValue(IntMemRef('A', 11)));
+    EXPECT_EQ("first", loadMachine.GetStringValue(STRS_LOCATION, 3));
+  }
+
+  saveMachine.MarkSavepoint();
+  {
+    stringstream ss;
+    Serialization::saveGameTo(ss, saveMachine);
+    RLMachine loadMachine(system, arc);
+    Serialization::loadGameFrom(ss, loadMachine);
+    EXPECT_EQ(7, loadMachine.GetIntValue(IntMemRef('A', 10)));
+    EXPECT_EQ(255, loadMachine.GetIntValue(IntMemRef('A', "8b", 44)));
+    EXPECT_EQ("third", loadMachine.GetStringValue(STRS_LOCATION, 3));
+  }
+}
+
+// Journaling the original of a slot must not disturb the live value, which
+// may be the very string being written back into it.
+TEST_F(RLMachineTest, SavepointJournalCopiesTheOriginal) {
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine saveMachine(system, arc);
+  saveMachine.SetStringValue(STRS_LOCATION, 0, "a string past the SSO limit");
+  saveMachine.MarkSavepoint();
+
+  const std::string& live = saveMachine.GetStringValue(STRS_LOCATION, 0);
+  saveMachine.SetStringValue(STRS_LOCATION, 0, live);
+  EXPECT_EQ("a string past the SSO limit",
+            saveMachine.GetStringValue(STRS_LOCATION, 0));
+}
+
+// Range writes to bit banks journal every word they touch, just like writes to
+// the individual elements would.
+TEST_F(RLMachineTest, IntRangesJournalAndCheckBounds) {
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  RLMachine saveMachine(system, arc);
+  Memory& memory = saveMachine.memory();
+  memory.FillIntRange(IntMemRef('B', "4b", 0), 24, 9);
+  saveMachine.MarkSavepoint();
+
+  memory.FillIntRange(IntMemRef('B', "4b", 4), 16, 3);
+  EXPECT_EQ(9, saveMachine.GetIntValue(IntMemRef('B', "4b", 3)));
+  EXPECT_EQ(3, saveMachine.GetIntValue(IntMemRef('B', "4b", 4)));
+  EXPECT_EQ(3, saveMachine.GetIntValue(IntMemRef('B', "4b", 19)));
+  EXPECT_EQ(9, saveMachine.GetIntValue(IntMemRef('B', "4b", 20)));
+  EXPECT_EQ(4 * 9 + 16 * 3 + 4 * 9,
+            memory.SumIntRange(IntMemRef('B', "4b", 0), 24));
+  EXPECT_TRUE(memory.IntRangesEqual(IntMemRef('B', "4b", 4),
+                                    IntMemRef('B', "4b", 5), 15));
+
+  {
+    stringstream ss;
+    Serialization::saveGameTo(ss, saveMachine);
+    RLMachine loadMachine(system, arc);
+    Serialization::loadGameFrom(ss, loadMachine);
+    EXPECT_EQ(9 * 24,
+              loadMachine.memory().SumIntRange(IntMemRef('B', "4b", 0), 24));
+  }
+
+  EXPECT_THROW(memory.FillIntRange(IntMemRef('B', "b", 63990), 11, 1),
+               rlvm::Exception);
+  EXPECT_THROW(memory.SumIntRange(IntMemRef('B', -1), 1), rlvm::Exception);
+  EXPECT_EQ(0, saveMachine.GetIntValue(IntMemRef('B', "b", 63999)));
+}
+
+// Save games written by older versions of rlvm must still load.
+TEST_F(RLMachineTest, LoadsLegacySaveGames) {
+  stringstream ss;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  {
+    RLMachine saveMachine(system, arc);
+    setIntMemoryCountingFrom(saveMachine, LOCAL_INTEGER_BANKS, 0);
+    setStrMemoryCountingFrom(saveMachine, STRS_LOCATION, 0);
+    saveMachine.MarkSavepoint();
+    Serialization::saveLegacyGameTo(ss, saveMachine);
+  }
+
+  string legacy = ss.str();
+  {
+    stringstream header_stream(legacy);
+    SaveGameHeader header = Serialization::loadHeaderFrom(header_stream);
+    EXPECT_EQ(system.graphics().window_subtitle(), header.title);
+  }
+  {
+    stringstream memory_stream(legacy);
+    RLMachine machine(system, arc);
+    Memory memory(machine, system.gameexe());
+    Serialization::loadLocalMemoryFrom(memory_stream, memory);
+    EXPECT_EQ(7, memory.local().intA[7]);
+  }
+  {
+    stringstream game_stream(legacy);
+    RLMachine loadMachine(system, arc);
+    Serialization::loadGameFrom(game_stream, loadMachine);
+    verifyIntMemoryCountingFrom(loadMachine, LOCAL_INTEGER_BANKS, 0);
+    verifyStrMemoryCountingFrom(loadMachine, STRS_LOCATION, 0);
+  }
+}
+
+// The header and local memory of a save game can be read on their own.
+TEST_F(RLMachineTest, LoadsPartsOfSaveGames) {
+  stringstream ss;
+  libreallive::Archive arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT"));
+  SaveGameHeader saved;
+  {
+    RLMachine saveMachine(system, arc);
+    setIntMemoryCountingFrom(saveMachine, LOCAL_INTEGER_BANKS, 0);
+    saveMachine.MarkSavepoint();
+    Serialization::saveGameTo(ss, saveMachine);
+  }
+
+  string data = ss.str();
+  {
+    stringstream header_stream(data);
+    SaveGameHeader header = Serialization::loadHeaderFrom(header_stream);
+    EXPECT_EQ(system.graphics().window_subtitle(), header.title);
+    EXPECT_LE(header.save_time, SaveGameHeader().save_time);
+    EXPECT_GT(header.save_time, saved.save_time - boost::posix_time::hours(1));
+  }
+  {
+    stringstream memory_stream(data);
+    RLMachine machine(system, arc);
+    Memory memory(machine, system.gameexe());
+    Serialization::loadLocalMemoryFrom(memory_stream, memory);
+    EXPECT_EQ(7, memory.local().intA[7]);
+  }
+  {
+    // A save game from a newer rlvm is refused rather than misread.
+    string newer = data;
+    libreallive::insert_i32(newer, 0x0c, 1000);
+    stringstream header_stream(newer);
+    EXPECT_THROW(Serialization::loadHeaderFrom(header_stream),
+                 rlvm::Exception);
+    stringstream game_stream(newer);
+    RLMachine loadMachine(system, arc);
+    EXPECT_THROW(Serialization::loadGameFrom(game_stream, loadMachine),
+                 rlvm::Exception);
+  }
+  {
+    // Sections from a machine with another byte order, type sizes or Boost
+    // version are refused, but their header can still be listed.
+    string foreign = data;
+    foreign[0x20] ^= 1;
+    stringstream header_stream(foreign);
+    EXPECT_EQ(system.graphics().window_subtitle(),
+              Serialization::loadHeaderFrom(header_stream).title);
+    stringstream memory_stream(foreign);
+    RLMachine machine(system, arc);
+    Memory memory(machine, system.gameexe());
+    EXPECT_THROW(Serialization::loadLocalMemoryFrom(memory_stream, memory),
+                 rlvm::Exception);
+    stringstream game_stream(foreign);
+    RLMachine loadMachine(system, arc);
+    EXPECT_THROW(Serialization::loadGameFrom(game_stream, loadMachine),
+                 rlvm::Exception);
+  }
+  {
+    stringstream truncated(data.substr(0, data.size() / 2));
+    RLMachine loadMachine(system, arc);
+    EXPECT_THROW(Serialization::loadGameFrom(truncated, loadMachine),
+                 std::exception);
+  }
+}
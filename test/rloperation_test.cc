@@ -39,6 +39,8 @@
 #include "machine/rloperation/complex_t.h"
 #include "machine/rloperation/default_value.h"
 #include "machine/rloperation/references.h"
+#include "machine/rlmodule.h"
+#include "modules/module_str.h"
 #include "test_system/test_system.h"
 
 #include "test_utils.h"
@@ -229,6 +231,71 @@ TEST_F(RLOperationTest, TestStringReference_T) {
 
 // -----------------------------------------------------------------------
 
+// Records where each StrRef_T argument points.
+struct BorrowedStrCapturer
+    : public RLOpcode<StrRef_T, StrRef_T, StrRef_T> {
+  std::vector<const std::string*> args_;
+  std::vector<std::string> values_;
+
+  virtual void operator()(RLMachine& machine,
+                          const std::string& in_one,
+                          const std::string& in_two,
+                          const std::string& in_three) {
+    for (const std::string* str : {&in_one, &in_two, &in_three}) {
+      args_.push_back(str);
+      values_.push_back(*str);
+    }
+  }
+};
+
+// Tests that StrRef_T lends out strS[] directly but copies strK[], which
+// lives in a vector that can be resized during the call.
+TEST_F(RLOperationTest, TestStrRef_T) {
+  rlmachine.SetStringValue(STRS_LOCATION, 5, "string one");
+  rlmachine.SetStringValue(STRK_LOCATION, 1, "string two");
+
+  BorrowedStrCapturer capturer;
+  vector<string> unparsed = {
+      PrintableToParsableString("$ 12 [ $ FF 05 00 00 00 ]"),
+      PrintableToParsableString("$ 0A [ $ FF 01 00 00 00 ]"),
+      "\"string three\""};
+  ExpressionPiecesVector expression_pieces;
+  capturer.ParseParameters(unparsed, expression_pieces);
+  capturer.Dispatch(rlmachine, expression_pieces);
+
+  ASSERT_EQ(3u, capturer.args_.size());
+  EXPECT_EQ("string one", capturer.values_[0]);
+  EXPECT_EQ("string two", capturer.values_[1]);
+  EXPECT_EQ("string three", capturer.values_[2]);
+  EXPECT_EQ(&rlmachine.GetStringValue(STRS_LOCATION, 5), capturer.args_[0]);
+  EXPECT_NE(&rlmachine.GetStringValue(STRK_LOCATION, 1), capturer.args_[1]);
+}
+
+// Regression test: strcpy(strS[0], strS[0]) right after a savepoint used to
+// empty strS[0], since the borrowed argument was journaled away before the
+// assignment read it.
+TEST_F(RLOperationTest, StrRefSelfCopyAfterSavepoint) {
+  rlmachine.SetStringValue(STRS_LOCATION, 0, "a string past the SSO limit");
+  rlmachine.MarkSavepoint();
+
+  StrModule module;
+  int strcpy_0 = RLModule::PackOpcodeNumber(0, 0);
+  auto op = std::find_if(module.begin(), module.end(),
+                         [&](const RLModule::OpcodeMap::value_type& entry) {
+                           return entry.first == strcpy_0;
+                         });
+  ASSERT_NE(module.end(), op);
+
+  vector<string> unparsed = {"$ 12 [ $ FF 00 00 00 00 ]",
+                             "$ 12 [ $ FF 00 00 00 00 ]"};
+  runDataTest(*op->second, rlmachine, unparsed);
+
+  EXPECT_EQ("a string past the SSO limit",
+            rlmachine.GetStringValue(STRS_LOCATION, 0));
+}
+
+// -----------------------------------------------------------------------
+
 struct ArgcCapturer : public RLOpcode<Argc_T<IntConstant_T>> {
   std::vector<int>& out_;
   explicit ArgcCapturer(std::vector<int>& out) : out_(out) {}
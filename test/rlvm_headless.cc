@@ -0,0 +1,183 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+// Runs a game on the null systems with a virtual clock, as fast as the CPU
+// allows, and reports how fast it went. Meant for verifying whole routes in
+// batch; see HeadlessMachine.
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libreallive/gameexe.h"
+#include "libreallive/reallive.h"
+#include "machine/game_hacks.h"
+#include "modules/modules.h"
+#include "systems/base/system_error.h"
+#include "test_system/headless_machine.h"
+#include "test_system/test_system.h"
+#include "utilities/exception.h"
+#include "utilities/file.h"
+
+using namespace std;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+void printUsage(const string& name, po::options_description& opts) {
+  cout << "Usage: " << name << " [options] <game root>" << endl << opts
+       << endl;
+}
+
+int main(int argc, char* argv[]) {
+  po::options_description opts("Options");
+  opts.add_options()("help", "Produce help message")(
+      "start-seen", po::value<int>(), "Force start at SEEN#")(
+      "memory", "Forces debug mode (Sets #MEMORY=1 in the Gameexe.ini file)")(
+      "decisions", po::value<string>(),
+      "File with the text of the option to pick at each selection, one per "
+      "line. Without it, the first option shown is picked.")(
+      "frame-length", po::value<unsigned int>()->default_value(16),
+      "Virtual milliseconds that pass per frame spent waiting")(
+      "stall-limit", po::value<unsigned int>()->default_value(60000),
+      "Virtual milliseconds to wait on input before clicking")(
+      "max-instructions", po::value<uint64_t>()->default_value(0),
+      "Stop after this many bytecode elements (0 runs until the game ends)")(
+      "undefined-opcodes", "Display a message on undefined opcodes")(
+      "count-undefined",
+      "On exit, present a summary table about how many times each undefined "
+      "opcode was called");
+
+  po::options_description hidden("Hidden");
+  hidden.add_options()(
+      "game-root", po::value<string>(), "Location of game root");
+
+  po::positional_options_description p;
+  p.add("game-root", 1);
+
+  po::options_description commandLineOpts;
+  commandLineOpts.add(opts).add(hidden);
+
+  po::variables_map vm;
+  po::store(po::basic_command_line_parser<char>(argc, argv)
+                .options(commandLineOpts)
+                .positional(p)
+                .run(),
+            vm);
+  po::notify(vm);
+
+  if (vm.count("help") || !vm.count("game-root")) {
+    printUsage(argv[0], opts);
+    return vm.count("help") ? 0 : -1;
+  }
+
+  fs::path gamerootPath = vm["game-root"].as<string>();
+  fs::path gameexePath = CorrectPathCase(gamerootPath / "Gameexe.ini");
+  fs::path seenPath = CorrectPathCase(gamerootPath / "Seen.txt");
+  if (gameexePath.empty() || seenPath.empty()) {
+    cerr << "ERROR: Path '" << gamerootPath << "' doesn't contain a RealLive "
+         << "game." << endl;
+    return -1;
+  }
+
+  vector<string> decisions;
+  if (vm.count("decisions")) {
+    fs::ifstream file(vm["decisions"].as<string>());
+    if (!file) {
+      cerr << "ERROR: Couldn't open decision list." << endl;
+      return -1;
+    }
+    string line;
+    while (getline(file, line)) {
+      if (!line.empty())
+        decisions.push_back(line);
+    }
+  }
+
+  try {
+    TestSystem system(gameexePath.string());
+    Gameexe& gameexe = system.gameexe();
+    gameexe("__GAMEPATH") = gamerootPath.string();
+
+    if (vm.count("start-seen"))
+      gameexe("SEEN_START") = vm["start-seen"].as<int>();
+
+    if (vm.count("memory"))
+      gameexe("MEMORY") = 1;
+
+    libreallive::Archive arc(seenPath.string(), gameexe("REGNAME"));
+    HeadlessMachine rlmachine(system, arc);
+    AddAllModules(rlmachine);
+    AddGameHacks(rlmachine);
+
+    rlmachine.set_frame_length(vm["frame-length"].as<unsigned int>());
+    rlmachine.set_stall_limit(vm["stall-limit"].as<unsigned int>());
+    rlmachine.SetDecisionList(decisions);
+
+    if (vm.count("undefined-opcodes"))
+      rlmachine.SetPrintUndefinedOpcodes(true);
+
+    if (vm.count("count-undefined"))
+      rlmachine.RecordUndefinedOpcodeCounts();
+
+    rlmachine.SetHaltOnException(false);
+    rlmachine.Run(vm["max-instructions"].as<uint64_t>());
+
+    double wall = rlmachine.wall_time();
+    cout << "Instructions:     " << rlmachine.instructions() << endl
+         << "Waiting frames:   " << rlmachine.frames() << endl
+         << "Injected clicks:  " << rlmachine.clicks() << endl
+         << "Virtual time:     " << rlmachine.virtual_time() / 1000.0 << " s"
+         << endl
+         << "Wall time:        " << wall << " s" << endl
+         << "Instructions/sec: "
+         << (wall > 0 ? rlmachine.instructions() / wall : 0) << endl;
+  }
+  catch (rlvm::Exception& e) {
+    cerr << "Fatal RLVM error: " << e.what() << endl;
+    return 1;
+  }
+  catch (libreallive::Error& e) {
+    cerr << "Fatal libreallive error: " << e.what() << endl;
+    return 1;
+  }
+  catch (SystemError& e) {
+    cerr << "Fatal local system error: " << e.what() << endl;
+    return 1;
+  }
+  catch (std::exception& e) {
+    cerr << "Uncaught exception: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+// Parses every scenario of a game on all cores and checks that each command
+// has an implementation and parseable parameters; see ValidateArchive().
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libreallive/gameexe.h"
+#include "libreallive/reallive.h"
+#include "machine/archive_validator.h"
+#include "machine/game_hacks.h"
+#include "machine/rlmachine.h"
+#include "modules/modules.h"
+#include "systems/base/system_error.h"
+#include "test_system/test_system.h"
+#include "utilities/exception.h"
+#include "utilities/file.h"
+
+using namespace std;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+void printUsage(const string& name, po::options_description& opts) {
+  cout << "Usage: " << name << " [options] <game root>" << endl << opts
+       << endl;
+}
+
+int main(int argc, char* argv[]) {
+  po::options_description opts("Options");
+  opts.add_options()("help", "Produce help message")(
+      "threads", po::value<int>()->default_value(0),
+      "Number of threads to parse with (0 for one per core)");
+
+  po::options_description hidden("Hidden");
+  hidden.add_options()(
+      "game-root", po::value<string>(), "Location of game root");
+
+  po::positional_options_description p;
+  p.add("game-root", 1);
+
+  po::options_description commandLineOpts;
+  commandLineOpts.add(opts).add(hidden);
+
+  po::variables_map vm;
+  po::store(po::basic_command_line_parser<char>(argc, argv)
+                .options(commandLineOpts)
+                .positional(p)
+                .run(),
+            vm);
+  po::notify(vm);
+
+  if (vm.count("help") || !vm.count("game-root")) {
+    printUsage(argv[0], opts);
+    return vm.count("help") ? 0 : -1;
+  }
+
+  fs::path gamerootPath = vm["game-root"].as<string>();
+  fs::path gameexePath = CorrectPathCase(gamerootPath / "Gameexe.ini");
+  fs::path seenPath = CorrectPathCase(gamerootPath / "Seen.txt");
+  if (gameexePath.empty() || seenPath.empty()) {
+    cerr << "ERROR: Path '" << gamerootPath << "' doesn't contain a RealLive "
+         << "game." << endl;
+    return -1;
+  }
+
+  try {
+    TestSystem system(gameexePath.string());
+    Gameexe& gameexe = system.gameexe();
+    gameexe("__GAMEPATH") = gamerootPath.string();
+
+    libreallive::Archive arc(seenPath.string(), gameexe("REGNAME"));
+    RLMachine rlmachine(system, arc);
+    AddAllModules(rlmachine);
+    AddGameHacks(rlmachine);
+
+    auto start = chrono::steady_clock::now();
+    vector<ScenarioValidation> results =
+        ValidateArchive(rlmachine, arc, vm["threads"].as<int>());
+    double seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    PrintArchiveValidation(cout, results);
+    cout << "Wall time: " << seconds << " s" << endl;
+
+    for (const ScenarioValidation& result : results) {
+      if (result.parse_failed || result.bad_parameters)
+        return 1;
+    }
+  }
+  catch (rlvm::Exception& e) {
+    cerr << "Fatal RLVM error: " << e.what() << endl;
+    return 1;
+  }
+  catch (libreallive::Error& e) {
+    cerr << "Fatal libreallive error: " << e.what() << endl;
+    return 1;
+  }
+  catch (SystemError& e) {
+    cerr << "Fatal local system error: " << e.what() << endl;
+    return 1;
+  }
+  catch (std::exception& e) {
+    cerr << "Uncaught exception: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <memory>
+#include <string>
+
+#include "libreallive/archive.h"
+#include "machine/rlmachine.h"
+#include "machine/save_game_index.h"
+#include "machine/serialization.h"
+#include "test_system/mock_surface.h"
+#include "test_system/test_system.h"
+
+#include "test_utils.h"
+
+namespace fs = boost::filesystem;
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+
+class SaveGameIndexTest : public ::testing::Test {
+ protected:
+  SaveGameIndexTest()
+      : dir(fs::temp_directory_path() / fs::unique_path("rlvm-%%%%%%%%")),
+        arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT")),
+        rlmachine(system, arc) {
+    fs::create_directories(dir);
+  }
+
+  ~SaveGameIndexTest() { fs::remove_all(dir); }
+
+  // Saves the machine to |slot| the way saveGameForSlot() does, without
+  // going through the home directory.
+  SaveGameHeader Save(SaveGameIndex& index, int slot, const std::string& title,
+                      const Surface* screenshot) {
+    SaveGameHeader header(title);
+    fs::ofstream file(dir / SaveGameIndex::FilenameForSlot(slot),
+                      std::ios::binary);
+    Serialization::saveGameTo(file, rlmachine, header);
+    file.close();
+    index.Update(slot, header, screenshot);
+    return header;
+  }
+
+  fs::path dir;
+  libreallive::Archive arc;
+  TestSystem system;
+  RLMachine rlmachine;
+};
+
+TEST_F(SaveGameIndexTest, RemembersSavesAcrossInstances) {
+  std::unique_ptr<MockSurface> screen(
+      MockSurface::Create("screen", Size(640, 480)));
+  EXPECT_CALL(*screen, GetDCPixel(_, _, _, _))
+      .WillRepeatedly(DoAll(
+          SetArgReferee<1>(10), SetArgReferee<2>(20), SetArgReferee<3>(30)));
+
+  SaveGameHeader saved;
+  {
+    SaveGameIndex index(dir);
+    saved = Save(index, 3, "Chapter 1", screen.get());
+    Save(index, 12, "Chapter 2", NULL);
+  }
+
+  SaveGameIndex index(dir);
+  const SaveGameIndex::Entry* entry = index.Find(3);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("Chapter 1", entry->header.title);
+  EXPECT_EQ(saved.save_time, entry->header.save_time);
+  EXPECT_EQ(SaveGameIndex::kThumbnailWidth, entry->thumbnail_width);
+  EXPECT_EQ(120, entry->thumbnail_height);
+  ASSERT_EQ(160u * 120 * 3, entry->thumbnail.size());
+  EXPECT_EQ(10, entry->thumbnail[0]);
+  EXPECT_EQ(30, entry->thumbnail[2]);
+
+  entry = index.Find(12);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("Chapter 2", entry->header.title);
+  EXPECT_TRUE(entry->thumbnail.empty());
+
+  EXPECT_FALSE(index.Find(4));
+}
+
+TEST_F(SaveGameIndexTest, RebuildsMissingIndex) {
+  {
+    SaveGameIndex index(dir);
+    Save(index, 1, "First", NULL);
+  }
+  fs::remove(dir / "saveindex.dat");
+
+  SaveGameIndex index(dir);
+  const SaveGameIndex::Entry* entry = index.Find(1);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("First", entry->header.title);
+  EXPECT_TRUE(fs::exists(dir / "saveindex.dat"));
+}
+
+TEST_F(SaveGameIndexTest, NoticesChangedSaveFiles) {
+  SaveGameIndex index(dir);
+  Save(index, 1, "First", NULL);
+  Save(index, 2, "Second", NULL);
+  ASSERT_TRUE(index.Find(1));
+
+  // Overwrite slot 1 behind the index's back, and delete slot 2.
+  {
+    SaveGameIndex other(dir);
+    Save(other, 1, "Replaced", NULL);
+  }
+  fs::path path = dir / SaveGameIndex::FilenameForSlot(1);
+  fs::last_write_time(path, fs::last_write_time(path) + 10);
+  fs::remove(dir / SaveGameIndex::FilenameForSlot(2));
+
+  const SaveGameIndex::Entry* entry = index.Find(1);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("Replaced", entry->header.title);
+  EXPECT_FALSE(index.Find(2));
+}
+
+TEST_F(SaveGameIndexTest, RemembersUnreadableSaveFiles) {
+  {
+    fs::ofstream file(dir / SaveGameIndex::FilenameForSlot(5),
+                      std::ios::binary);
+    file << "not a save game";
+  }
+
+  SaveGameIndex index(dir);
+  EXPECT_FALSE(index.Find(5));
+
+  // Rescanning writes the index, so a second lookup of the same broken file
+  // mustn't bring it back.
+  fs::remove(dir / "saveindex.dat");
+  EXPECT_FALSE(index.Find(5));
+  EXPECT_FALSE(fs::exists(dir / "saveindex.dat"));
+
+  // Once the slot is saved over, it's read again.
+  Save(index, 5, "Fixed", NULL);
+  const SaveGameIndex::Entry* entry = index.Find(5);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("Fixed", entry->header.title);
+}
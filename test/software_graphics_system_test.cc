@@ -0,0 +1,345 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "libreallive/gameexe.h"
+#include "systems/base/colour.h"
+#include "systems/base/draw_list.h"
+#include "systems/base/graphics_system.h"
+#include "systems/software/software_graphics_system.h"
+#include "systems/software/software_rasterizer.h"
+#include "systems/software/software_surface.h"
+#include "test_system/test_system.h"
+
+namespace {
+
+const uint32_t kBlack = MakePixel(0, 0, 0, 255);
+const uint32_t kRed = MakePixel(255, 0, 0, 255);
+const uint32_t kBlue = MakePixel(0, 0, 255, 255);
+
+// A |width| by |height| image that's all |pixel|.
+std::vector<uint32_t> SolidImage(int width, int height, uint32_t pixel) {
+  return std::vector<uint32_t>(width * height, pixel);
+}
+
+// x / 255 rounded to nearest, the slow way.
+int RoundedDiv255(int x) { return (x * 2 + 255) / 510; }
+
+int Channel(uint32_t pixel, int shift) { return (pixel >> shift) & 0xff; }
+
+}  // namespace
+
+TEST(SoftwareRasterizerTest, BlendSpanMatchesPlainArithmetic) {
+  // An odd count so that both the four-at-a-time path and the leftovers run.
+  const int kCount = 37;
+  std::vector<uint32_t> src(kCount), dst(kCount);
+  uint32_t seed = 12345;
+  for (int i = 0; i < kCount; ++i) {
+    seed = seed * 1103515245 + 12345;
+    src[i] = seed;
+    seed = seed * 1103515245 + 12345;
+    dst[i] = seed;
+  }
+  src[0] |= 0xff000000;
+  src[1] &= 0x00ffffff;
+
+  for (BlendMode mode : {BLEND_NORMAL, BLEND_ADD, BLEND_SUBTRACT}) {
+    std::vector<uint32_t> out(dst);
+    BlendSpan(mode, &src[0], &out[0], kCount);
+
+    for (int i = 0; i < kCount; ++i) {
+      int a = src[i] >> 24;
+      EXPECT_EQ(dst[i] >> 24, out[i] >> 24);
+      for (int shift = 0; shift < 24; shift += 8) {
+        int s = Channel(src[i], shift);
+        int d = Channel(dst[i], shift);
+        int expected;
+        if (mode == BLEND_NORMAL)
+          expected = RoundedDiv255(s * a + d * (255 - a));
+        else if (mode == BLEND_ADD)
+          expected = std::min(255, d + RoundedDiv255(s * a));
+        else
+          expected = std::max(0, d - RoundedDiv255(s * a));
+        EXPECT_EQ(expected, Channel(out[i], shift)) << "pixel " << i;
+      }
+    }
+  }
+}
+
+TEST(SoftwareRasterizerTest, BlendsWithAlpha) {
+  std::vector<uint32_t> image = SolidImage(2, 2, kRed);
+  std::vector<uint32_t> screen = SolidImage(4, 4, kBlue);
+  PixelBuffer target(&screen[0], 4, 4);
+
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 2, 2);
+  op.dst = Rect::REC(1, 1, 2, 2);
+  op.alpha = 128;
+  Rasterize(PixelBuffer(&image[0], 2, 2), op, target, target.rect());
+
+  EXPECT_EQ(MakePixel(128, 0, 127, 255), screen[1 * 4 + 1]);
+  EXPECT_EQ(MakePixel(128, 0, 127, 255), screen[2 * 4 + 2]);
+  EXPECT_EQ(kBlue, screen[0]);
+  EXPECT_EQ(kBlue, screen[3 * 4 + 3]);
+}
+
+TEST(SoftwareRasterizerTest, AddsAndSubtracts) {
+  std::vector<uint32_t> image = SolidImage(1, 1, MakePixel(255, 0, 0, 128));
+  uint32_t gray = MakePixel(100, 100, 100, 255);
+
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 1, 1);
+  op.dst = Rect::REC(0, 0, 1, 1);
+
+  uint32_t screen = gray;
+  op.mode = BLEND_ADD;
+  Rasterize(PixelBuffer(&image[0], 1, 1), op, PixelBuffer(&screen, 1, 1),
+            Rect::REC(0, 0, 1, 1));
+  EXPECT_EQ(MakePixel(228, 100, 100, 255), screen);
+
+  screen = gray;
+  op.mode = BLEND_SUBTRACT;
+  Rasterize(PixelBuffer(&image[0], 1, 1), op, PixelBuffer(&screen, 1, 1),
+            Rect::REC(0, 0, 1, 1));
+  EXPECT_EQ(MakePixel(0, 100, 100, 255), screen);
+}
+
+TEST(SoftwareRasterizerTest, ScalesAndClips) {
+  uint32_t a = MakePixel(1, 0, 0, 255), b = MakePixel(2, 0, 0, 255),
+           c = MakePixel(3, 0, 0, 255), d = MakePixel(4, 0, 0, 255);
+  std::vector<uint32_t> image = {a, b, c, d};
+  std::vector<uint32_t> screen = SolidImage(4, 4, kBlack);
+  PixelBuffer target(&screen[0], 4, 4);
+
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 2, 2);
+  op.dst = Rect::REC(0, 0, 4, 4);
+  Rasterize(PixelBuffer(&image[0], 2, 2), op, target, Rect::REC(0, 0, 4, 3));
+
+  EXPECT_EQ(a, screen[0]);
+  EXPECT_EQ(a, screen[1 * 4 + 1]);
+  EXPECT_EQ(b, screen[1 * 4 + 2]);
+  EXPECT_EQ(c, screen[2 * 4 + 1]);
+  EXPECT_EQ(d, screen[2 * 4 + 3]);
+  // Clipped off.
+  EXPECT_EQ(kBlack, screen[3 * 4 + 3]);
+}
+
+TEST(SoftwareRasterizerTest, Rotates) {
+  // Four columns, two rows.
+  std::vector<uint32_t> image(8);
+  for (int i = 0; i < 8; ++i)
+    image[i] = MakePixel(i + 1, 0, 0, 255);
+  std::vector<uint32_t> screen = SolidImage(20, 20, kBlack);
+  PixelBuffer target(&screen[0], 20, 20);
+
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 4, 2);
+  op.dst = Rect::REC(10, 10, 4, 2);
+  op.rotation = 900;
+  Rasterize(PixelBuffer(&image[0], 4, 2), op, target, target.rect());
+
+  // A quarter turn clockwise about (12, 11): the left column ends up along
+  // the top, the top row down the right.
+  EXPECT_EQ(image[0], screen[9 * 20 + 12]);
+  EXPECT_EQ(image[4], screen[9 * 20 + 11]);
+  EXPECT_EQ(image[3], screen[12 * 20 + 12]);
+  EXPECT_EQ(image[7], screen[12 * 20 + 11]);
+  // Where the unturned image would have been.
+  EXPECT_EQ(kBlack, screen[10 * 20 + 10]);
+  EXPECT_EQ(kBlack, screen[11 * 20 + 13]);
+}
+
+TEST(SoftwareRasterizerTest, BlendsCornerAlphas) {
+  std::vector<uint32_t> image = SolidImage(4, 1, kRed);
+  std::vector<uint32_t> screen = SolidImage(4, 1, kBlack);
+
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 4, 1);
+  op.dst = Rect::REC(0, 0, 4, 1);
+  op.use_corner_alpha = true;
+  op.corner_alpha[0] = 0;
+  op.corner_alpha[1] = 255;
+  op.corner_alpha[2] = 255;
+  op.corner_alpha[3] = 0;
+  Rasterize(PixelBuffer(&image[0], 4, 1), op, PixelBuffer(&screen[0], 4, 1),
+            Rect::REC(0, 0, 4, 1));
+
+  EXPECT_EQ(MakePixel(32, 0, 0, 255), screen[0]);
+  EXPECT_EQ(MakePixel(96, 0, 0, 255), screen[1]);
+  EXPECT_EQ(MakePixel(223, 0, 0, 255), screen[3]);
+}
+
+TEST(SoftwareRasterizerTest, Shades) {
+  std::vector<uint32_t> image = SolidImage(1, 1, kRed);
+  RasterOp op;
+  op.src = Rect::REC(0, 0, 1, 1);
+  op.dst = Rect::REC(0, 0, 1, 1);
+  op.shade = true;
+
+  auto draw = [&]() {
+    uint32_t screen = kBlack;
+    Rasterize(PixelBuffer(&image[0], 1, 1), op, PixelBuffer(&screen, 1, 1),
+              Rect::REC(0, 0, 1, 1));
+    return screen;
+  };
+
+  op.mono = 255;
+  EXPECT_EQ(MakePixel(76, 76, 76, 255), draw());
+  op.mono = 0;
+
+  op.invert = 255;
+  EXPECT_EQ(MakePixel(0, 255, 255, 255), draw());
+  op.invert = 0;
+
+  op.light = 128;
+  EXPECT_EQ(MakePixel(255, 128, 128, 255), draw());
+  op.light = -128;
+  EXPECT_EQ(MakePixel(128, 0, 0, 255), draw());
+  op.light = 0;
+
+  op.colour = RGBAColour(0, 0, 255, 255);
+  EXPECT_EQ(kBlue, draw());
+}
+
+TEST(SoftwareRasterizerTest, ColourMasks) {
+  std::vector<uint32_t> mask = SolidImage(1, 1, MakePixel(0, 0, 0, 255));
+  RGBAColour red(255, 0, 0, 128);
+
+  uint32_t screen = kBlue;
+  RasterizeColourMask(PixelBuffer(&mask[0], 1, 1), Rect::REC(0, 0, 1, 1),
+                      Rect::REC(0, 0, 1, 1), red, 1,
+                      PixelBuffer(&screen, 1, 1), Rect::REC(0, 0, 1, 1));
+  EXPECT_EQ(MakePixel(128, 0, 127, 255), screen);
+
+  screen = kBlue;
+  RasterizeColourMask(PixelBuffer(&mask[0], 1, 1), Rect::REC(0, 0, 1, 1),
+                      Rect::REC(0, 0, 1, 1), red, 0,
+                      PixelBuffer(&screen, 1, 1), Rect::REC(0, 0, 1, 1));
+  EXPECT_EQ(MakePixel(0, 0, 127, 255), screen);
+}
+
+// -----------------------------------------------------------------------
+
+class SoftwareGraphicsSystemTest : public ::testing::Test {
+ protected:
+  SoftwareGraphicsSystemTest() : graphics(system, SetScreenSize()) {}
+
+  Gameexe& SetScreenSize() {
+    system.gameexe()("SCREENSIZE_MOD") = 0;
+    return system.gameexe();
+  }
+
+  uint32_t ScreenPixel(int x, int y) {
+    return graphics.framebuffer().row(y)[x];
+  }
+
+  TestSystem system;
+  SoftwareGraphicsSystem graphics;
+};
+
+TEST_F(SoftwareGraphicsSystemTest, RefreshDrawsDC0) {
+  graphics.GetDC(0)->Fill(RGBAColour(255, 0, 0, 255), Rect::REC(0, 0, 100, 50));
+  graphics.Refresh(NULL);
+
+  EXPECT_EQ(kRed, ScreenPixel(0, 0));
+  EXPECT_EQ(kRed, ScreenPixel(99, 49));
+  EXPECT_EQ(kBlack, ScreenPixel(100, 49));
+  EXPECT_EQ(graphics.screen_rect(),
+            graphics.frame_statistics().last_frame_area);
+}
+
+TEST_F(SoftwareGraphicsSystemTest, RefreshOnlyRedrawsWhatChanged) {
+  graphics.GetDC(0)->Fill(RGBAColour(255, 0, 0, 255), Rect::REC(0, 0, 100, 50));
+  graphics.Refresh(NULL);
+
+  graphics.GetDC(0)->Fill(RGBAColour(0, 0, 255, 255), Rect::REC(10, 10, 5, 5));
+  graphics.Refresh(NULL);
+
+  EXPECT_EQ(Rect::REC(10, 10, 5, 5),
+            graphics.frame_statistics().last_frame_area);
+  EXPECT_EQ(25, graphics.frame_statistics().last_frame_pixels);
+  EXPECT_EQ(kBlue, ScreenPixel(12, 12));
+  // Kept from the last frame.
+  EXPECT_EQ(kRed, ScreenPixel(0, 0));
+  EXPECT_EQ(kBlack, ScreenPixel(200, 200));
+}
+
+TEST_F(SoftwareGraphicsSystemTest, RenderToSurfaceHasRealPixels) {
+  graphics.GetDC(0)->Fill(RGBAColour(0, 0, 255, 255));
+  std::shared_ptr<Surface> image = graphics.BuildSurface(Size(2, 2));
+  image->Fill(RGBAColour(255, 0, 0, 255));
+
+  // Draw an inverted image over the blue background through an object
+  // draw, as the draw list would.
+  graphics.BeginFrame();
+  graphics.GetDC(0)->RenderToScreen(graphics.screen_rect(),
+                                    graphics.screen_rect(), 255);
+  DrawRecord record;
+  record.src = Rect::REC(0, 0, 2, 2);
+  record.dst = Rect::REC(20, 20, 2, 2);
+  record.alpha = 255;
+  record.invert = 255;
+  image->RenderToScreenAsObject(record);
+  std::shared_ptr<Surface> frame = graphics.EndFrameToSurface();
+
+  int r, g, b;
+  frame->GetDCPixel(Point(21, 21), r, g, b);
+  EXPECT_EQ(0, r);
+  EXPECT_EQ(255, g);
+  EXPECT_EQ(255, b);
+
+  frame->GetDCPixel(Point(22, 22), r, g, b);
+  EXPECT_EQ(0, r);
+  EXPECT_EQ(0, g);
+  EXPECT_EQ(255, b);
+}
+
+TEST_F(SoftwareGraphicsSystemTest, BlitsBetweenSurfaces) {
+  std::shared_ptr<Surface> image = graphics.BuildSurface(Size(2, 2));
+  image->Fill(RGBAColour(255, 0, 0, 128));
+  graphics.GetDC(1)->Fill(RGBAColour(0, 0, 255, 255));
+
+  image->BlitToSurface(*graphics.GetDC(1), Rect::REC(0, 0, 2, 2),
+                       Rect::REC(0, 0, 4, 4));
+
+  int r, g, b;
+  graphics.GetDC(1)->GetDCPixel(Point(3, 3), r, g, b);
+  EXPECT_EQ(128, r);
+  EXPECT_EQ(0, g);
+  EXPECT_EQ(127, b);
+  graphics.GetDC(1)->GetDCPixel(Point(4, 4), r, g, b);
+  EXPECT_EQ(0, r);
+  EXPECT_EQ(255, b);
+}
@@ -0,0 +1,135 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+#include "systems/base/surface_cache.h"
+#include "test_system/mock_surface.h"
+
+namespace {
+
+const size_t kMegabyte = 1024 * 1024;
+
+// A surface whose 32-bit pixels take |kilobytes| (rounded to whole rows of
+// 256 pixels).
+std::shared_ptr<const Surface> SurfaceOf(const std::string& name,
+                                         int kilobytes) {
+  return std::shared_ptr<const Surface>(
+      MockSurface::Create(name, Size(256, kilobytes)));
+}
+
+}  // namespace
+
+TEST(SurfaceCacheTest, CountsHitsAndMisses) {
+  SurfaceCache cache(kMegabyte);
+  EXPECT_TRUE(cache.Fetch("button") == nullptr);
+  cache.Insert("button", SurfaceOf("button", 16));
+  EXPECT_TRUE(cache.Fetch("button") != nullptr);
+  EXPECT_TRUE(cache.Contains("button"));
+
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+  EXPECT_EQ(16 * 1024u, cache.bytes());
+}
+
+TEST(SurfaceCacheTest, StaysWithinByteBudget) {
+  SurfaceCache cache(2 * kMegabyte);
+  for (int i = 0; i < 8; ++i)
+    cache.Insert("cg" + std::to_string(i), SurfaceOf("cg", 512));
+
+  EXPECT_LE(cache.bytes(), 2 * kMegabyte);
+  EXPECT_EQ(4u, cache.size());
+  EXPECT_EQ(4, cache.evictions());
+  EXPECT_TRUE(cache.Contains("cg7"));
+  EXPECT_FALSE(cache.Contains("cg0"));
+}
+
+TEST(SurfaceCacheTest, EvictsLargeImagesBeforeSmallOnes) {
+  SurfaceCache cache(2 * kMegabyte);
+  for (int i = 0; i < 8; ++i)
+    cache.Insert("button" + std::to_string(i), SurfaceOf("button", 16));
+  cache.Insert("cg0", SurfaceOf("cg", 1024));
+
+  // Another CG doesn't fit; the older CG goes rather than the buttons that
+  // were loaded before it.
+  cache.Insert("cg1", SurfaceOf("cg", 1024));
+  EXPECT_FALSE(cache.Contains("cg0"));
+  EXPECT_TRUE(cache.Contains("cg1"));
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE(cache.Contains("button" + std::to_string(i)));
+}
+
+TEST(SurfaceCacheTest, RecentlyUsedEntriesSurvive) {
+  SurfaceCache cache(2 * kMegabyte);
+  cache.Insert("cg0", SurfaceOf("cg", 768));
+  cache.Insert("cg1", SurfaceOf("cg", 768));
+  cache.Fetch("cg0");
+  cache.Insert("cg2", SurfaceOf("cg", 768));
+
+  EXPECT_TRUE(cache.Contains("cg0"));
+  EXPECT_FALSE(cache.Contains("cg1"));
+  EXPECT_TRUE(cache.Contains("cg2"));
+}
+
+TEST(SurfaceCacheTest, PinnedAndInUseSurfacesAreKept) {
+  SurfaceCache cache(kMegabyte);
+  cache.Pin("preloaded");
+  cache.Insert("preloaded", SurfaceOf("preloaded", 768));
+  std::shared_ptr<const Surface> shown = SurfaceOf("shown", 768);
+  cache.Insert("shown", shown);
+  cache.Insert("other", SurfaceOf("other", 768));
+
+  // Nothing could be freed (the caller of Insert() is about to use "other"),
+  // so the cache is over budget until it can be.
+  EXPECT_TRUE(cache.Contains("preloaded"));
+  EXPECT_TRUE(cache.Contains("shown"));
+  EXPECT_TRUE(cache.Contains("other"));
+  EXPECT_GT(cache.bytes(), kMegabyte);
+
+  shown.reset();
+  cache.Unpin("preloaded");
+  EXPECT_LE(cache.bytes(), kMegabyte);
+  EXPECT_EQ(1u, cache.size());
+}
+
+TEST(SurfaceCacheTest, ShrinkingTheBudgetEvicts) {
+  SurfaceCache cache(4 * kMegabyte);
+  for (int i = 0; i < 4; ++i)
+    cache.Insert("cg" + std::to_string(i), SurfaceOf("cg", 1024));
+  EXPECT_EQ(4u, cache.size());
+
+  cache.set_byte_budget(kMegabyte);
+  EXPECT_EQ(1u, cache.size());
+
+  cache.EvictAll();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(4, cache.evictions());
+}
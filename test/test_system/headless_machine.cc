@@ -0,0 +1,155 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#include "test_system/headless_machine.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "long_operations/button_object_select_long_operation.h"
+#include "long_operations/select_long_operation.h"
+#include "systems/base/text_system.h"
+#include "test_system/test_system.h"
+
+using std::cerr;
+using std::endl;
+
+namespace {
+
+// Roughly one frame at 60fps.
+const unsigned int kDefaultFrameLength = 16;
+
+// A minute of virtual time is far longer than any scripted wait that isn't
+// really waiting for the player.
+const unsigned int kDefaultStallLimit = 60 * 1000;
+
+}  // namespace
+
+// -----------------------------------------------------------------------
+// HeadlessMachine
+// -----------------------------------------------------------------------
+HeadlessMachine::HeadlessMachine(TestSystem& system,
+                                 libreallive::Archive& archive)
+    : RLMachine(system, archive),
+      clock_(new VirtualClock),
+      frame_length_(kDefaultFrameLength),
+      stall_limit_(kDefaultStallLimit),
+      current_decision_(0),
+      stalled_operation_(NULL),
+      stalled_time_(0),
+      instructions_(0),
+      frames_(0),
+      clicks_(0),
+      start_(0),
+      wall_time_(0) {
+  static_cast<TestEventSystem&>(system.event()).SetMockHandler(clock_);
+  system.text().SetAutoMode(1);
+}
+
+HeadlessMachine::~HeadlessMachine() {}
+
+void HeadlessMachine::SetDecisionList(
+    const std::vector<std::string>& decisions) {
+  decisions_ = decisions;
+  current_decision_ = 0;
+}
+
+void HeadlessMachine::Run(uint64_t max_instructions) {
+  instructions_ = 0;
+  frames_ = 0;
+  clicks_ = 0;
+  start_ = clock_->GetTicks();
+
+  auto wall_start = std::chrono::steady_clock::now();
+  while (!halted() &&
+         (max_instructions == 0 || instructions_ < max_instructions)) {
+    if (CurrentLongOperation()) {
+      RunFrame();
+    } else {
+      ExecuteNextInstruction();
+      ++instructions_;
+    }
+  }
+  wall_time_ = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - wall_start).count();
+}
+
+void HeadlessMachine::RunFrame() {
+  ExecuteNextInstruction();
+  ++frames_;
+
+  std::shared_ptr<LongOperation> op = CurrentLongOperation();
+  if (!op) {
+    stalled_operation_ = NULL;
+    return;
+  }
+
+  if (op.get() != stalled_operation_) {
+    stalled_operation_ = op.get();
+    stalled_time_ = 0;
+  }
+
+  // Nothing in the VM can change until time passes, so let it.
+  clock_->Advance(frame_length_);
+  stalled_time_ += frame_length_;
+
+  if (stalled_time_ >= stall_limit_) {
+    system().event().InjectMouseDown(*this);
+    system().event().InjectMouseUp(*this);
+    ++clicks_;
+    stalled_time_ = 0;
+  }
+}
+
+void HeadlessMachine::PushLongOperation(LongOperation* long_operation) {
+  if (SelectLongOperation* sel =
+          dynamic_cast<SelectLongOperation*>(long_operation)) {
+    bool selected = false;
+    if (current_decision_ < decisions_.size()) {
+      const std::string& choice = decisions_[current_decision_++];
+      selected = sel->SelectByText(choice);
+      if (!selected)
+        cerr << "WARNING! Option '" << choice << "' isn't offered." << endl;
+    }
+
+    // Otherwise take the first option that's shown.
+    for (const std::string& option : sel->GetOptions()) {
+      if (selected)
+        break;
+      selected = sel->SelectByText(option);
+    }
+  } else if (dynamic_cast<ButtonObjectSelectLongOperation*>(long_operation)) {
+    // Like lua_rlvm, pick the first button.
+    set_store_register(1);
+    delete long_operation;
+    return;
+  }
+
+  RLMachine::PushLongOperation(long_operation);
+}
@@ -0,0 +1,105 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+#ifndef TEST_TEST_SYSTEM_HEADLESS_MACHINE_H_
+#define TEST_TEST_SYSTEM_HEADLESS_MACHINE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "machine/rlmachine.h"
+#include "test_system/test_event_system.h"
+
+class TestSystem;
+
+// An RLMachine that runs a game as fast as the CPU allows on the null test
+// systems. Instead of giving the VM a 10ms slice and sleeping like
+// RLVMInstance::Run(), it executes bytecode back to back and only moves a
+// VirtualClock forward when a LongOperation would otherwise be waiting on the
+// wall clock. Waits, effects and text display all finish after the same
+// amount of virtual time they'd take on screen, but in no real time at all.
+//
+// Text pauses are advanced by auto mode, selections are made from a decision
+// list (falling back to the first option shown), and any LongOperation which
+// is still waiting after |stall_limit| virtual milliseconds gets a click.
+class HeadlessMachine : public RLMachine {
+ public:
+  HeadlessMachine(TestSystem& system, libreallive::Archive& archive);
+  virtual ~HeadlessMachine();
+
+  const VirtualClock& clock() const { return *clock_; }
+
+  // Virtual milliseconds that pass each time a LongOperation isn't finished.
+  void set_frame_length(unsigned int ms) { frame_length_ = ms; }
+
+  // Virtual milliseconds a LongOperation may wait before we click on it.
+  void set_stall_limit(unsigned int ms) { stall_limit_ = ms; }
+
+  // Sets the text of the options to pick at each selection, in order.
+  void SetDecisionList(const std::vector<std::string>& decisions);
+
+  // Runs until the machine halts, or until |max_instructions| bytecode
+  // elements have run if it's nonzero.
+  void Run(uint64_t max_instructions = 0);
+
+  // Statistics about the last Run().
+  uint64_t instructions() const { return instructions_; }
+  uint64_t frames() const { return frames_; }
+  int clicks() const { return clicks_; }
+  unsigned int virtual_time() const { return clock_->GetTicks() - start_; }
+  double wall_time() const { return wall_time_; }
+
+  // Overridden from RLMachine:
+  virtual void PushLongOperation(LongOperation* long_operation) override;
+
+ private:
+  // Lets the current LongOperation run once, then moves the clock forward a
+  // frame if it's still waiting.
+  void RunFrame();
+
+  std::shared_ptr<VirtualClock> clock_;
+
+  unsigned int frame_length_;
+  unsigned int stall_limit_;
+
+  std::vector<std::string> decisions_;
+  size_t current_decision_;
+
+  // The LongOperation RunFrame() last saw, and how long it has been waiting.
+  LongOperation* stalled_operation_;
+  unsigned int stalled_time_;
+
+  uint64_t instructions_;
+  uint64_t frames_;
+  int clicks_;
+  unsigned int start_;
+  double wall_time_;
+};
+
+#endif  // TEST_TEST_SYSTEM_HEADLESS_MACHINE_H_
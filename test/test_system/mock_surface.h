@@ -30,6 +30,7 @@
 #include "gmock/gmock.h"
 
 #include "systems/base/surface.h"
+#include "systems/base/draw_list.h"
 #include "systems/base/graphics_object.h"
 
 #include <string>
@@ -57,9 +58,7 @@ class MockSurface : public Surface {
                      void(const Rect&, const Rect&, const RGBAColour&, int));
   MOCK_CONST_METHOD3(RenderToScreen,
                      void(const Rect&, const Rect&, const int[4]));
-  MOCK_CONST_METHOD4(
-      RenderToScreenAsObject,
-      void(const GraphicsObject&, const Rect&, const Rect&, int));
+  MOCK_CONST_METHOD1(RenderToScreenAsObject, void(const DrawRecord&));
   MOCK_CONST_METHOD0(numPatterns, int());
   MOCK_CONST_METHOD1(getPattern, const GrpRect&(int patt_no));
   MOCK_METHOD1(Fill, void(const RGBAColour&));
@@ -27,6 +27,11 @@
 
 #include "test_system/test_event_system.h"
 
+#include <functional>
+
+#include "machine/rlmachine.h"
+#include "systems/base/event_listener.h"
+
 // -----------------------------------------------------------------------
 // TestEventSystem
 // -----------------------------------------------------------------------
@@ -53,7 +58,7 @@ unsigned int TestEventSystem::GetTicks() const {
 }
 
 void TestEventSystem::Wait(unsigned int milliseconds) const {
-  // waiting is a noop.
+  event_system_mock_->Wait(milliseconds);
 }
 
 Point TestEventSystem::GetCursorPos() {
@@ -73,6 +78,12 @@ unsigned int TestEventSystem::TimeOfLastMouseMove() {
 void TestEventSystem::InjectMouseMovement(RLMachine& machine,
                                           const Point& loc) {}
 
-void TestEventSystem::InjectMouseDown(RLMachine& machine) {}
+void TestEventSystem::InjectMouseDown(RLMachine& machine) {
+  DispatchEvent(machine, std::bind(&EventListener::MouseButtonStateChanged,
+                                   std::placeholders::_1, MOUSE_LEFT, true));
+}
 
-void TestEventSystem::InjectMouseUp(RLMachine& machine) {}
+void TestEventSystem::InjectMouseUp(RLMachine& machine) {
+  DispatchEvent(machine, std::bind(&EventListener::MouseButtonStateChanged,
+                                   std::placeholders::_1, MOUSE_LEFT, false));
+}
@@ -41,11 +41,31 @@ class EventSystemMockHandler {
   virtual bool shiftPressed() const { return false; }
   virtual bool ctrlPressed() const { return false; }
   virtual unsigned int GetTicks() const { return counter_++; }
+  virtual void Wait(unsigned int milliseconds) const {}
 
  private:
   mutable int counter_;
 };
 
+// A clock that only moves when told to. Time stands still while the machine
+// executes bytecode; it moves forward when something explicitly waits, or
+// when a driver like HeadlessMachine decides a frame has passed.
+class VirtualClock : public EventSystemMockHandler {
+ public:
+  VirtualClock() : now_(0) {}
+
+  void Advance(unsigned int milliseconds) const { now_ += milliseconds; }
+
+  // Overridden from EventSystemMockHandler:
+  virtual unsigned int GetTicks() const override { return now_; }
+  virtual void Wait(unsigned int milliseconds) const override {
+    Advance(milliseconds);
+  }
+
+ private:
+  mutable unsigned int now_;
+};
+
 // Mock enabled event system. Returned values are controlled by
 // EventSystemMockHandler.
 class TestEventSystem : public EventSystem {
@@ -75,6 +75,12 @@ bool TestTextWindow::DisplayCharacter(const std::string& current,
   return ret;
 }
 
+void TestTextWindow::DisplayPlacedCharacter(const std::string& current,
+                                            const GlyphPlacement& placement) {
+  TextWindow::DisplayPlacedCharacter(current, placement);
+  current_contents_ += current;
+}
+
 void TestTextWindow::SetName(const std::string& utf8name,
                              const std::string& next_char) {
   TextWindow::SetName(utf8name, next_char);
@@ -41,6 +41,8 @@ class TestTextWindow : public TextWindow {
   virtual std::shared_ptr<Surface> GetNameSurface() override;
   virtual bool DisplayCharacter(const std::string& current,
                                 const std::string& next) override;
+  virtual void DisplayPlacedCharacter(const std::string& current,
+                                      const GlyphPlacement& placement) override;
 
   virtual void RenderNameInBox(const std::string& utf8str);
   virtual void ClearWin() override;
@@ -26,12 +26,16 @@
 // -----------------------------------------------------------------------
 
 #include "test_utils.h"
+#include <algorithm>
 #include <vector>
 #include <boost/filesystem/operations.hpp>
 #include <stdexcept>
 #include <sstream>
 #include <string>
 
+#include "libreallive/alldefs.h"
+#include "libreallive/compression.h"
+
 using std::string;
 using std::vector;
 using std::ostringstream;
@@ -58,6 +62,51 @@ string locateTestCase(const string& baseName) {
 
 // -----------------------------------------------------------------------
 
+vector<string> locateAllTestScenarios() {
+  vector<string> scenarios;
+  for (vector<string>::const_iterator it = testPaths.begin();
+       it != testPaths.end();
+       ++it) {
+    fs::path root(*it);
+    if (!fs::exists(root / "Module_Str_SEEN"))
+      continue;
+
+    fs::directory_iterator end;
+    for (fs::directory_iterator dir(root); dir != end; ++dir) {
+      string dirname = dir->path().filename().string();
+      if (!fs::is_directory(dir->path()) || dirname.size() < 5 ||
+          dirname.compare(dirname.size() - 5, 5, "_SEEN") != 0)
+        continue;
+
+      for (fs::directory_iterator file(dir->path()); file != end; ++file) {
+        if (file->path().extension() == ".TXT")
+          scenarios.push_back(file->path().string());
+      }
+    }
+    break;
+  }
+
+  std::sort(scenarios.begin(), scenarios.end());
+  return scenarios;
+}
+
+string CompressLiterals(const char* src, size_t src_len) {
+  string out(8, '\0');
+  out.reserve(8 + src_len + (src_len + 7) / 8);
+  for (size_t i = 0; i < src_len; i += 8) {
+    out.push_back('\xff');
+    out.append(src + i, std::min(src_len - i, size_t(8)));
+  }
+  libreallive::insert_i32(out, 0, out.size());
+  libreallive::insert_i32(out, 4, src_len);
+
+  for (size_t i = 0; i < out.size(); ++i)
+    out[i] ^= libreallive::compression::xor_mask[i & 0xff];
+  return out;
+}
+
+// -----------------------------------------------------------------------
+
 FullSystemTest::FullSystemTest()
     : arc(locateTestCase("Module_Str_SEEN/strcpy_0.TXT")),
       system(locateTestCase("Gameexe_data/Gameexe.ini")),
@@ -29,6 +29,7 @@
 #define TEST_TESTUTILS_HPP_
 
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "libreallive/archive.h"
@@ -38,6 +39,15 @@
 // Locates a test file in the test/ directory.
 std::string locateTestCase(const std::string& baseName);
 
+// Returns the path of every compiled SEEN.TXT fixture in the *_SEEN
+// directories under test/.
+std::vector<std::string> locateAllTestScenarios();
+
+// Encodes |src| as a compressed bytecode block made only of literal tokens,
+// so compression::Decompress() gives back |src|. It doesn't save any space;
+// it lets the tests and benchmarks build scenarios out of synthetic bytecode.
+std::string CompressLiterals(const char* src, size_t src_len);
+
 // A base class for all tests that instantiate an archive, a System and a
 // Machine.
 class FullSystemTest : public ::testing::Test {
@@ -167,6 +167,77 @@ TEST_F(TextSystemTest, BackLogFunctionality) {
 
 // -----------------------------------------------------------------------
 
+TEST_F(TextSystemTest, BackLogIsBoundedByPagesAndMemory) {
+  TextSystem& text = rlmachine.system().text();
+  text.SetBacklogLimits(2, 1024 * 1024);
+
+  WriteString("Page one.", true);
+  SnapshotAndClear();
+  WriteString("Page two.", true);
+  SnapshotAndClear();
+  WriteString("Page three.", true);
+  SnapshotAndClear();
+  EXPECT_EQ(2u, text.backlog_page_count());
+  size_t two_pages = text.backlog_bytes();
+  EXPECT_GT(two_pages, 0u);
+
+  // Shrinking the memory budget drops pages, but never the newest.
+  text.SetBacklogLimits(100, two_pages - 1);
+  EXPECT_EQ(1u, text.backlog_page_count());
+  text.SetBacklogLimits(100, 0);
+  EXPECT_EQ(1u, text.backlog_page_count());
+  EXPECT_LT(text.backlog_bytes(), two_pages);
+
+  // Going back past the oldest page kept stops at it.
+  text.BackPage();
+  text.BackPage();
+  EXPECT_EQ("Page three.", GetTextWindow(0).current_contents());
+}
+
+// Backlog limits of zero or less in the Gameexe.ini (or from --backlog-pages
+// and --backlog-mb) fall back to the defaults instead of wrapping around.
+TEST_F(TextSystemTest, NonPositiveBacklogLimitsUseDefaults) {
+  Gameexe& gexe = system.gameexe();
+  gexe("__BACKLOG_PAGES") = 0;
+  gexe("__BACKLOG_MB") = -1;
+  TestTextSystem defaults(system, gexe);
+  EXPECT_EQ(100u, defaults.max_backlog_pages());
+  EXPECT_EQ(4u * 1024 * 1024, defaults.max_backlog_bytes());
+
+  gexe("__BACKLOG_PAGES") = 3;
+  gexe("__BACKLOG_MB") = 1;
+  TestTextSystem configured(system, gexe);
+  EXPECT_EQ(3u, configured.max_backlog_pages());
+  EXPECT_EQ(1024u * 1024, configured.max_backlog_bytes());
+}
+
+// -----------------------------------------------------------------------
+
+// Scrolling back to a page a second time draws its characters where they went
+// the first time instead of laying them out again.
+TEST_F(TextSystemTest, BackLogReplaysRecordedLayout) {
+  TextSystem& text = rlmachine.system().text();
+  MockTextWindow& win = GetTextWindow(0);
+
+  WriteString("This line is long enough that it has to wrap onto the next.",
+              true);
+  SnapshotAndClear();
+  WriteString("Page two.", true);
+
+  text.BackPage();
+  std::string laid_out = win.current_contents();
+  EXPECT_NE(std::string::npos, laid_out.find('\n'))
+      << "The first page should have wrapped.";
+
+  text.ForwardPage();
+  EXPECT_CALL(win, DisplayCharacter(_, _)).Times(0);
+  text.BackPage();
+  EXPECT_EQ(laid_out, win.current_contents());
+  ASSERT_TRUE(::testing::Mock::VerifyAndClearExpectations(&win));
+}
+
+// -----------------------------------------------------------------------
+
 // Tests that the TextPage::name construct repeats correctly.
 TEST_F(TextSystemTest, RepeatsTextPageName) {
   TestTextSystem& sys = GetTextSystem();
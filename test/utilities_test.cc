@@ -26,9 +26,14 @@
 
 #include "gtest/gtest.h"
 
+#include <future>
+#include <stdexcept>
+#include <vector>
+
 #include "libreallive/gameexe.h"
 #include "systems/base/rect.h"
 #include "utilities/graphics.h"
+#include "utilities/thread_pool.h"
 
 TEST(UtilitiesTest, ClipDestination_Superset) {
   Rect clip(Point(5, 5), Size(5, 5));
@@ -64,3 +69,17 @@ TEST(UtilitiesTest, ScreenSizeModKey) {
   me.parseLine("#SCREENSIZE_MOD=999,800,600");
   EXPECT_EQ(Size(800, 600), GetScreenSize(me));
 }
+
+TEST(UtilitiesTest, ThreadPoolRunsEveryTask) {
+  ThreadPool pool(3);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 20; ++i)
+    results.push_back(pool.Post([i]() { return i * i; }));
+
+  for (int i = 0; i < 20; ++i)
+    EXPECT_EQ(i * i, results[i].get());
+
+  std::future<int> failure =
+      pool.Post([]() -> int { throw std::runtime_error("failed"); });
+  EXPECT_THROW(failure.get(), std::runtime_error);
+}
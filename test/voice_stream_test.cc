@@ -0,0 +1,77 @@
+// -*- Mode: C++; tab-width:2; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi:tw=80:et:ts=2:sts=2
+//
+// -----------------------------------------------------------------------
+//
+// This file is part of RLVM, a RealLive virtual machine clone.
+//
+// -----------------------------------------------------------------------
+//
+// Copyright (C) 2026 The rlvm contributors
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// -----------------------------------------------------------------------
+
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "systems/base/voice_archive.h"
+
+namespace {
+
+// A sample whose Decode() returns |pcm| behind a WAV header, the way the
+// formats without their own stream do.
+class FakeVoiceSample : public VoiceSample {
+ public:
+  explicit FakeVoiceSample(const std::vector<char>& pcm) : pcm_(pcm) {}
+
+  virtual char* Decode(int* size) override {
+    *size = pcm_.size();
+    char* data = new char[WAV_HEADER_SIZE + pcm_.size()];
+    MakeWavHeader(data, 22050, 1, 2, WAV_HEADER_SIZE + pcm_.size());
+    memcpy(data + WAV_HEADER_SIZE, pcm_.data(), pcm_.size());
+    return data;
+  }
+
+ private:
+  std::vector<char> pcm_;
+};
+
+}  // namespace
+
+TEST(VoiceStreamTest, DefaultStreamReadsDecodedSample) {
+  std::vector<char> pcm;
+  for (int i = 0; i < 1000; ++i)
+    pcm.push_back(i * 7);
+
+  std::shared_ptr<VoiceSample> sample(new FakeVoiceSample(pcm));
+  std::unique_ptr<VoiceStream> stream = sample->OpenStream();
+  EXPECT_EQ(22050, stream->rate());
+  EXPECT_EQ(1, stream->channels());
+
+  std::vector<char> read;
+  char buffer[96];
+  int count;
+  while ((count = stream->Read(buffer, sizeof(buffer))) > 0)
+    read.insert(read.end(), buffer, buffer + count);
+
+  EXPECT_EQ(pcm, read);
+  EXPECT_EQ(0, stream->Read(buffer, sizeof(buffer)));
+}